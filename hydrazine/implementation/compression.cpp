@@ -21,33 +21,98 @@
 
 // Standard Library Includes
 #include <stdexcept>
+#include <sstream>
 #include <cstdint>
 
 namespace hydrazine
 {
 
-void decompress(void* output, uint64_t& outputSize, const void* input,
-	uint64_t inputSize)
+typedef int (*ZlibFunction)(uint8_t*, unsigned long*, const uint8_t*,
+	unsigned long);
+
+/*! \brief The zlib library, opened on first use and kept open so that
+	repeated calls do not pay for dlopen */
+class Zlib
 {
-	#if __GNUC__
-	void* libz = dlopen("libz.so", RTLD_LAZY);
+public:
+	Zlib()
+	: library(dlopen("libz.so", RTLD_LAZY)), uncompress(0), compress(0)
+	{
+		// systems without the development package only have the soname
+		if(library == 0) library = dlopen("libz.so.1", RTLD_LAZY);
+		
+		if(library == 0) return;
+		
+		uncompress = hydrazine::bit_cast<ZlibFunction>(
+			dlsym(library, "uncompress"));
+		compress = hydrazine::bit_cast<ZlibFunction>(
+			dlsym(library, "compress"));
+	}
+	
+	~Zlib()
+	{
+		if(library != 0) dlclose(library);
+	}
+
+public:
+	void* library;
+	
+	ZlibFunction uncompress;
+	ZlibFunction compress;
+};
+
+static const Zlib& zlib()
+{
+	static Zlib library;
 	
-	if(libz == 0)
+	if(library.uncompress == 0 || library.compress == 0)
 	{
 		throw std::runtime_error(
 			"Failed to load compression library 'libz.so'");
 	}
 	
-	typedef int (*UncompressFunction)(uint8_t*, unsigned long*, const uint8_t*,
-		unsigned long);
+	return library;
+}
+
+void decompress(void* output, uint64_t& outputSize, const void* input,
+	uint64_t inputSize)
+{
+	#if __GNUC__
+	int result = zlib().uncompress((uint8_t*)output,
+		(unsigned long*)&outputSize, (const uint8_t*)input,
+		(unsigned long) inputSize);
 	
-	UncompressFunction uncompress = hydrazine::bit_cast<UncompressFunction>(
-		dlsym(libz, "uncompress"));
+	if(result != 0)
+	{
+		std::stringstream errorcode;
+		
+		errorcode << result;
 	
-	int result = uncompress((uint8_t*)output, (unsigned long*)&outputSize,
-		(const uint8_t*)input, (unsigned long) inputSize);
+		throw std::runtime_error("Failed to decompress input. ("
+			+ errorcode.str() + ")");
+	}
 	
-	dlclose(libz);
+	#else
+	
+	throw std::runtime_error("Compression not supported on this platform.");
+	
+	#endif
+}
+
+uint64_t compressBound(uint64_t inputSize)
+{
+	// zlib's bound for the default settings
+	return inputSize + (inputSize >> 12) + (inputSize >> 14) +
+		(inputSize >> 25) + 13;
+}
+
+void compress(void* output, uint64_t& outputSize, const void* input,
+	uint64_t inputSize)
+{
+	#if __GNUC__
+	int result = zlib().compress((uint8_t*)output,
+		(unsigned long*)&outputSize, (const uint8_t*)input,
+		(unsigned long) inputSize);
 	
 	if(result != 0)
 	{
@@ -55,7 +120,7 @@ void decompress(void* output, uint64_t& outputSize, const void* input,
 		
 		errorcode << result;
 	
-		throw std::runtime_error("Failed to decompress input. ("
+		throw std::runtime_error("Failed to compress input. ("
 			+ errorcode.str() + ")");
 	}
 	
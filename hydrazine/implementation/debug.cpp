@@ -16,6 +16,18 @@
 #include <hydrazine/interface/debug.h>
 
 #include <configure.h>
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/tss.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <list>
+#include <map>
+#include <set>
 #ifdef HAVE_MPICXX
 #include <mpi.h>
 #endif
@@ -64,32 +76,363 @@ namespace hydrazine
 		return stream.str();
 	}
 	
+	/*! \brief A bounded ring of report text written by one thread and read 
+		by the log writer, without locks */
+	class ReportBuffer
+	{
+	public:
+		static const size_t capacity = 1 << 16;
+	
+	public:
+		ReportBuffer();
+		
+		//! \brief Append a message, dropping it if the ring is full
+		void push(const std::string& message);
+		//! \brief Move everything written so far to the output string
+		void drain(std::string& output);
+	
+	public:
+		//! \brief set once the owning thread has exited
+		std::atomic<bool> retired;
+	
+	private:
+		char _data[capacity];
+		//! \brief total bytes written and read
+		std::atomic<size_t> _head;
+		std::atomic<size_t> _tail;
+		//! \brief messages that did not fit
+		std::atomic<size_t> _dropped;
+	};
+	
+	ReportBuffer::ReportBuffer()
+	: retired(false), _head(0), _tail(0), _dropped(0)
+	{
+	
+	}
+	
+	void ReportBuffer::push(const std::string& message)
+	{
+		size_t head = _head.load(std::memory_order_relaxed);
+		size_t tail = _tail.load(std::memory_order_acquire);
+		
+		if(message.size() > capacity - (head - tail))
+		{
+			_dropped.fetch_add(1, std::memory_order_relaxed);
+			return;
+		}
+		
+		size_t offset = head % capacity;
+		size_t first  = std::min(message.size(), capacity - offset);
+		
+		std::memcpy(_data + offset, message.data(), first);
+		std::memcpy(_data, message.data() + first, message.size() - first);
+		
+		_head.store(head + message.size(), std::memory_order_release);
+	}
+	
+	void ReportBuffer::drain(std::string& output)
+	{
+		size_t tail = _tail.load(std::memory_order_relaxed);
+		size_t head = _head.load(std::memory_order_acquire);
+		
+		size_t bytes  = head - tail;
+		size_t offset = tail % capacity;
+		size_t first  = std::min(bytes, capacity - offset);
+		
+		output.append(_data + offset, first);
+		output.append(_data, bytes - first);
+		
+		_tail.store(head, std::memory_order_release);
+		
+		size_t dropped = _dropped.exchange(0, std::memory_order_relaxed);
+		if(dropped)
+		{
+			std::stringstream stream;
+			stream << "(" << _debugTime() << ") " << dropped 
+				<< " report message(s) dropped, log buffer full\n";
+			output.append(stream.str());
+		}
+	}
+	
+	static void retireReportBuffer(ReportBuffer* buffer)
+	{
+		buffer->retired.store(true, std::memory_order_release);
+	}
+	
 	/*! \brief Global logging infrastructure */
 	class LogDatabase
 	{		
+	public:
+		typedef std::map<std::string, std::atomic<int> > ThresholdMap;
+		typedef std::set<std::string> ModuleSet;
+		typedef std::list<ReportBuffer*> ReportBufferList;
+	
 	public:
 		LogDatabase();
 		
+		//! \brief Get the threshold slot of a module, creating it if needed
+		const std::atomic<int>* threshold(const std::string& module);
+		void setThreshold(const std::string& module, int threshold);
+		
+		//! \brief Queue a message from the calling thread
+		void submit(const std::string& message);
+		//! \brief Write out all queued messages
+		void flush();
+		//! \brief Stop the writer, later messages are written synchronously
+		void shutdown();
+		
+	private:
+		//! \brief Move the queued messages to output, _flushMutex is held
+		void _drain(std::string& output);
+		void _run();
+		
 	public:
 		bool enableAll;
+	
+	private:
+		boost::mutex _mutex;
+		boost::mutex _flushMutex;
+		boost::condition_variable _condition;
+		
+		ThresholdMap _thresholds;
+		ModuleSet _explicitModules;
+		int _defaultThreshold;
+		
+		ReportBufferList _buffers;
+		boost::thread_specific_ptr<ReportBuffer> _threadBuffer;
+		boost::thread* _writer;
+		
+		std::atomic<bool> _synchronous;
+		bool _stop;
 	};
 	
+	static void shutdownLogDatabase();
+	
+	static LogDatabase& logDatabase()
+	{
+		// never destroyed, static destructors of other objects still report
+		static LogDatabase* database = new LogDatabase;
+		return *database;
+	}
+	
 	LogDatabase::LogDatabase()
-	: enableAll(false)
+	: enableAll(false), _defaultThreshold(REPORT_ERROR_LEVEL),
+		_threadBuffer(retireReportBuffer), _writer(0), _synchronous(false),
+		_stop(false)
+	{
+		const char* levels = std::getenv("HYDRAZINE_REPORT");
+		
+		if(levels != 0)
+		{
+			std::stringstream stream(levels);
+			std::string level;
+			
+			while(std::getline(stream, level, ','))
+			{
+				size_t equals = level.find('=');
+				if(equals == std::string::npos) continue;
+				
+				setThreshold(level.substr(0, equals), 
+					std::atoi(level.substr(equals + 1).c_str()));
+			}
+		}
+		
+		std::atexit(shutdownLogDatabase);
+	}
+	
+	const std::atomic<int>* LogDatabase::threshold(const std::string& module)
+	{
+		boost::unique_lock<boost::mutex> lock(_mutex);
+		
+		ThresholdMap::iterator threshold = _thresholds.find(module);
+		if(threshold == _thresholds.end())
+		{
+			threshold = _thresholds.insert(std::make_pair(module, 
+				_defaultThreshold)).first;
+		}
+		
+		return &threshold->second;
+	}
+	
+	void LogDatabase::setThreshold(const std::string& module, int threshold)
+	{
+		boost::unique_lock<boost::mutex> lock(_mutex);
+		
+		if(module == "*")
+		{
+			_defaultThreshold = threshold;
+			
+			for(ThresholdMap::iterator entry = _thresholds.begin(); 
+				entry != _thresholds.end(); ++entry)
+			{
+				if(_explicitModules.count(entry->first)) continue;
+				entry->second.store(threshold, std::memory_order_relaxed);
+			}
+			
+			return;
+		}
+		
+		_explicitModules.insert(module);
+		_thresholds[module].store(threshold, std::memory_order_relaxed);
+	}
+	
+	void LogDatabase::submit(const std::string& message)
+	{
+		if(_synchronous.load(std::memory_order_acquire))
+		{
+			boost::unique_lock<boost::mutex> lock(_flushMutex);
+			std::cout << message << std::flush;
+			return;
+		}
+		
+		/* a message larger than the ring never fits, it is written here 
+			after the messages queued before it */
+		if(message.size() > ReportBuffer::capacity)
+		{
+			boost::unique_lock<boost::mutex> lock(_flushMutex);
+			
+			std::string output;
+			_drain(output);
+			output.append(message);
+			
+			std::cout << output << std::flush;
+			return;
+		}
+	
+		ReportBuffer* buffer = _threadBuffer.get();
+		
+		if(buffer == 0)
+		{
+			buffer = new ReportBuffer;
+			_threadBuffer.reset(buffer);
+			
+			boost::unique_lock<boost::mutex> lock(_mutex);
+			_buffers.push_back(buffer);
+			
+			if(_writer == 0 && !_stop)
+			{
+				_writer = new boost::thread(&LogDatabase::_run, this);
+			}
+		}
+		
+		buffer->push(message);
+	}
+	
+	void LogDatabase::flush()
+	{
+		boost::unique_lock<boost::mutex> flushLock(_flushMutex);
+		
+		std::string output;
+		_drain(output);
+		
+		if(!output.empty())
+		{
+			std::cout << output << std::flush;
+		}
+	}
+	
+	void LogDatabase::_drain(std::string& output)
+	{
+		boost::unique_lock<boost::mutex> lock(_mutex);
+		
+		for(ReportBufferList::iterator buffer = _buffers.begin();
+			buffer != _buffers.end(); )
+		{
+			bool retired = (*buffer)->retired.load(std::memory_order_acquire);
+			
+			(*buffer)->drain(output);
+			
+			if(retired)
+			{
+				delete *buffer;
+				buffer = _buffers.erase(buffer);
+			}
+			else
+			{
+				++buffer;
+			}
+		}
+	}
+	
+	void LogDatabase::shutdown()
+	{
+		boost::thread* writer = 0;
+	
+		{
+			boost::unique_lock<boost::mutex> lock(_mutex);
+			_stop = true;
+			writer = _writer;
+			_writer = 0;
+			_condition.notify_all();
+		}
+		
+		if(writer != 0)
+		{
+			writer->join();
+			delete writer;
+		}
+		
+		_synchronous.store(true, std::memory_order_release);
+		flush();
+	}
+	
+	void LogDatabase::_run()
+	{
+		boost::unique_lock<boost::mutex> lock(_mutex);
+		
+		while(!_stop)
+		{
+			_condition.timed_wait(lock, boost::posix_time::milliseconds(10));
+			
+			lock.unlock();
+			flush();
+			lock.lock();
+		}
+	}
+	
+	static void shutdownLogDatabase()
 	{
+		logDatabase().shutdown();
+	}
 	
+	ReportSite::ReportSite( const char* f )
+	: file(f)
+	{
+		std::string module = stripReportPath<'/'>(f);
+		threshold = logDatabase().threshold(module.substr(0, module.find('.')));
+	}
+	
+	ReportMessage::ReportMessage( const ReportSite& site, unsigned int line )
+	: stream(_buffer)
+	{
+		stream << "(" << _debugTime() << ") " << _debugFile( site.file, line ) 
+			<< " ";
 	}
 	
-	static LogDatabase logDatabase;
+	ReportMessage::~ReportMessage()
+	{
+		stream << "\n";
+		logDatabase().submit(_buffer);
+	}
+	
+	void setReportLevel( const std::string& module, int threshold )
+	{
+		logDatabase().setThreshold(module, threshold);
+	}
+	
+	void flushReports()
+	{
+		logDatabase().flush();
+	}
 	
 	void enableAllLogs()
 	{
-		logDatabase.enableAll = true;
+		logDatabase().enableAll = true;
 	}
 	
 	std::ostream& _getStream(const std::string& name)
 	{
-		if(logDatabase.enableAll)
+		if(logDatabase().enableAll)
 		{
 			std::cout << "(" << _debugTime() << "): " << name << ": ";
 			
@@ -0,0 +1,62 @@
+/*!
+	\file BufferStream.h
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief The header file for an output stream that appends directly to a
+		growable character buffer
+*/
+
+#ifndef BUFFER_STREAM_H_INCLUDED
+#define BUFFER_STREAM_H_INCLUDED
+
+#include <ostream>
+#include <streambuf>
+#include <string>
+
+namespace hydrazine
+{
+	/*! \brief A stream buffer that appends to a std::string owned by the
+		caller. Unlike std::stringbuf, the characters are never copied out
+		again and capacity can be reserved up front. */
+	class BufferStreamBuffer : public std::streambuf
+	{
+		public:
+			BufferStreamBuffer( std::string& buffer ) : _buffer( buffer ) {}
+
+		protected:
+			int_type overflow( int_type c )
+			{
+				if( !traits_type::eq_int_type( c, traits_type::eof() ) )
+				{
+					_buffer.push_back( traits_type::to_char_type( c ) );
+				}
+				return traits_type::not_eof( c );
+			}
+
+			std::streamsize xsputn( const char* s, std::streamsize n )
+			{
+				_buffer.append( s, n );
+				return n;
+			}
+
+		private:
+			std::string& _buffer;
+	};
+
+	/*! \brief An output stream writing into a growable character buffer */
+	class BufferStream : public std::ostream
+	{
+		public:
+			BufferStream( std::string& buffer, size_t reserve = 0 ) :
+				std::ostream( 0 ), _streamBuffer( buffer )
+			{
+				buffer.reserve( buffer.size() + reserve );
+				rdbuf( &_streamBuffer );
+			}
+
+		private:
+			BufferStreamBuffer _streamBuffer;
+	};
+}
+
+#endif
@@ -15,6 +15,15 @@ namespace hydrazine
 void decompress(void* output, uint64_t& outputSize, const void* input,
 	uint64_t inputSize);
 
+/*! \brief The largest compressed size of an input of inputSize bytes */
+uint64_t compressBound(uint64_t inputSize);
+
+/*! \brief Compress input into output, outputSize holds the capacity of
+	output on entry (at least compressBound(inputSize)) and the compressed
+	size on return */
+void compress(void* output, uint64_t& outputSize, const void* input,
+	uint64_t inputSize);
+
 }
 
 
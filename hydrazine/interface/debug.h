@@ -16,7 +16,10 @@
 #include <iostream>
 #include <sstream>
 #include <cassert>
+#include <atomic>
+#include <string>
 #include <hydrazine/interface/Timer.h>
+#include <hydrazine/interface/BufferStream.h>
 
 #include <iosfwd>
 
@@ -31,6 +34,48 @@ namespace hydrazine
 	/*! \brief Return a formatted line number and file name. */
 	extern std::string _debugFile( const std::string& file, unsigned int line );
 
+	/*! \brief A report call site, bound once to the runtime threshold of the 
+		module (source file) it lives in. Checking a disabled site is a 
+		single load, and no message is formatted for it. */
+	class ReportSite
+	{
+		public:
+			ReportSite( const char* file );
+			
+			bool enabled( int level ) const
+			{
+				return level >= threshold->load( std::memory_order_relaxed );
+			}
+		
+		public:
+			const char* file;
+			const std::atomic<int>* threshold;
+	};
+	
+	/*! \brief Formats one report message and hands it to the calling 
+		thread's log buffer when it goes out of scope */
+	class ReportMessage
+	{
+		public:
+			ReportMessage( const ReportSite& site, unsigned int line );
+			~ReportMessage();
+		
+		private:
+			std::string _buffer;
+		
+		public:
+			BufferStream stream;
+	};
+	
+	/*! \brief Set the report threshold of a module (a source file name 
+		without its extension, or "*" for all modules without their own). 
+		Messages below the threshold are not formatted. Thresholds can also 
+		be given as HYDRAZINE_REPORT="Module=2,CudaDevice=9,*=1" */
+	extern void setReportLevel( const std::string& module, int threshold );
+	
+	/*! \brief Write out all buffered report messages */
+	extern void flushReports();
+
 	/*! \brief Convert an iterable range to a string
 		
 		T must implement the concept of a forward iterator and the object being
@@ -172,6 +217,10 @@ inline hydrazine::NullStream & operator<<(hydrazine::NullStream & s,
 	greater than REPORT_ERROR_LEVEL, or exits the program if the error level 
 	is greater than EXIT_ERROR_LEVEL.  
 	
+	Messages are also filtered by the runtime threshold of the module, and 
+	are queued in a bounded per-thread buffer that a background thread 
+	writes out.
+	
 	If MPI_DEBUG is defined, it appends the rank to the beginning of the error 
 	message.
 	
@@ -184,10 +233,11 @@ inline hydrazine::NullStream & operator<<(hydrazine::NullStream & s,
 	#define reportE(x, y) \
 		if(REPORT_BASE >= REPORT_ERROR_LEVEL && (x) >= REPORT_ERROR_LEVEL)\
 		{ \
+			static const hydrazine::ReportSite _reportSite( __FILE__ ); \
+			if(_reportSite.enabled( x ))\
 			{\
-			std::cout << "(" << hydrazine::_debugTime() << ") " \
-				<< hydrazine::_debugFile( __FILE__, __LINE__ ) \
-				<< " " << y << "\n";\
+			hydrazine::ReportMessage _reportMessage( _reportSite, __LINE__ ); \
+			_reportMessage.stream << y;\
 			}\
 		 \
 		}
@@ -202,16 +252,7 @@ inline hydrazine::NullStream & operator<<(hydrazine::NullStream & s,
 */
 
 #ifndef NDEBUG
-	#define report(y) \
-		if(REPORT_BASE >= REPORT_ERROR_LEVEL)\
-		{ \
-			{\
-			std::cout << "(" << hydrazine::_debugTime() << ") " \
-				<< hydrazine::_debugFile( __FILE__, __LINE__ ) \
-					<< " " << y << "\n";\
-			}\
-		 \
-		}
+	#define report(y) reportE(REPORT_ERROR_LEVEL, y)
 #else
 	#define report(y)
 #endif
@@ -223,6 +264,7 @@ inline hydrazine::NullStream & operator<<(hydrazine::NullStream & s,
 		if(!(x))\
 		{ \
 			{\
+			hydrazine::flushReports();\
 			std::cout << "(" << hydrazine::_debugTime() << ") " \
 				<< hydrazine::_debugFile( __FILE__, __LINE__ ) \
 					<< " Assertion message: " << y << "\n";\
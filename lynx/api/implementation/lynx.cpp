@@ -12,6 +12,7 @@
 #include <lynx/instrumentation/interface/InstrumentationContext.h>
 
 #include <boost/thread/thread.hpp>
+#include <boost/thread/locks.hpp>
 
 #include <map>
 
@@ -25,30 +26,30 @@ namespace lynx
 {
 
     static instrumentation::InstrumentationRuntime::InstrumentationContextMap::iterator get() {
+        /* threads that did not create a context may launch on it too */
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
+
 		instrumentation::InstrumentationRuntime::InstrumentationContextMap::iterator context = 
 		    instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.find(
 		boost::this_thread::get_id());
 	
-		assert(context != instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.end());
+		if(context == instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.end())
+		{
+		    context = instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.
+                insert(std::make_pair(boost::this_thread::get_id(), instrumentation::InstrumentationContext())).first;
+		}
 
 	    return context;    		    
 	}
 
     void initialize()
     {
-        instrumentation::InstrumentationRuntime::InstrumentationContextMap::iterator context = 
-		    instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.find(
-		boost::this_thread::get_id());
-		
-		if(context == instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.end())
-        {
-            instrumentation::InstrumentationRuntime::Singleton.instrumentationContexts.
-                insert(std::make_pair(boost::this_thread::get_id(), instrumentation::InstrumentationContext()));
-        }    
+        instrumentation::InstrumentationRuntime::InstrumentationContextMap::iterator context = get();
         
         if(instrumentation::InstrumentationRuntime::Singleton.instrumentors.size() > 0)
         {
-            get()->second.setActiveInstrumentor(
+            context->second.setActiveInstrumentor(
                 *(instrumentation::InstrumentationRuntime::Singleton.instrumentors.begin()));  
         }
         
@@ -84,8 +85,12 @@ namespace lynx
 	    get()->second.setActiveInstrumentor(instrumentor);
 	}
 	
-	bool validateInstrumentor(std::string moduleName, std::string kernelName)
+	bool validateInstrumentor(const std::string & moduleName, 
+	    const std::string & kernelName)
 	{
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
+
         bool passed = false;
         
 	    instrumentation::PTXInstrumentor *instrumentor = getInstrumentor();
@@ -93,9 +98,7 @@ namespace lynx
 	    if(!instrumentor)
 	        return passed;
 
-	    instrumentor->kernelName = kernelName;
-	    
-	    if(instrumentor->conditionsMet())
+	    if(instrumentor->conditionsMet(kernelName))
 	    {
 	        if(!instrumentor->on)
                 get()->second.toggled = true;	            
@@ -129,6 +132,9 @@ namespace lynx
     
     void instrument(ir::Module & module) 
     {
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
+
         instrumentation::PTXInstrumentor *activeInstrumentor = getInstrumentor();
         
         report("instrument: checking if active ...");
@@ -136,31 +142,76 @@ namespace lynx
         {
             report("analyzing and instrumenting module ...");
             activeInstrumentor->analyze(module);
-	    report("instrument....activeInstrumentor->analyze(()");
             activeInstrumentor->instrument(module);       
-	    report("instrument....activeInstrumentor->instrument(()");
         }        
     }
     
-    void initializeKernelLaunch(std::string kernelName, unsigned int threads, unsigned int threadBlocks)
+    void initializeKernelLaunch(instrumentation::PTXInstrumentor *instance,
+        const std::string & kernelName, unsigned int threads, 
+        unsigned int threadBlocks)
     {
         report("initializing kernel launch ...");
-        instrumentation::PTXInstrumentor *instrumentor = getInstrumentor();
-        if(instrumentor && instrumentor->on)
-        {
-            instrumentor->kernelName = kernelName;
-            instrumentor->threads = threads;
-            instrumentor->threadBlocks = threadBlocks;         
-            instrumentor->initialize();
-        }    
+        
+        /* the instance belongs to the thread, device and stream of the 
+            launch, it is set up without holding the runtime lock */
+        instance->kernelName = kernelName;
+        instance->threads = threads;
+        instance->threadBlocks = threadBlocks;         
+        instance->initialize();
+    }
+    
+    void finalizeKernelLaunch(instrumentation::PTXInstrumentor *instance)
+    {
+        instance->finalize();
+    }
+    
+    void enableInstrumentation(bool enabled)
+    {
+        instrumentation::InstrumentationRuntime::Singleton.enabled = enabled;
     }
     
-    void finalizeKernelLaunch()
+    bool instrumentationEnabled()
     {
-        instrumentation::PTXInstrumentor *instrumentor = getInstrumentor();
+        return instrumentation::InstrumentationRuntime::Singleton.enabled;
+    }
+    
+    bool validateKernelLaunch(instrumentation::PTXInstrumentor *instrumentor,
+        const std::string & moduleName, const std::string & kernelName,
+        bool & disabled)
+    {
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
+        
+        resetInstrumentor(instrumentor);
+        
+        disabled = instrumentor->disabledKernels.count(kernelName) != 0;
+        
+        return validateInstrumentor(moduleName, kernelName);
+    }
+    
+    instrumentation::PTXInstrumentor *getLaunchInstance(
+        instrumentation::PTXInstrumentor *instrumentor, int device, 
+        const void *stream, const std::string & kernelName)
+    {
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
         
-        if(instrumentor && instrumentor->on)
-            instrumentor->finalize();
+        return instrumentor->instance(device, stream, kernelName);
+    }
+    
+    void collectKernelLaunches(int device)
+    {
+        boost::unique_lock<boost::recursive_mutex> lock(
+            instrumentation::InstrumentationRuntime::Singleton.mutex);
+        
+        /* waits for the launches of every thread on the device */
+        for(PTXInstrumentorVector::iterator instrumentor = 
+            getConfiguredInstrumentors()->begin(); 
+            instrumentor != getConfiguredInstrumentors()->end(); 
+            ++instrumentor)
+        {
+            (*instrumentor)->collectLaunches(device, true);
+        }
     }
 
     trace::Profiler *getProfiler()
@@ -168,20 +219,10 @@ namespace lynx
         return &(instrumentation::InstrumentationRuntime::Singleton.profiler);
     }
     
-    trace::Profiler::KernelProfiler *getKernelProfiler(std::string kernelName)
+    trace::Profiler::KernelProfiler *getKernelProfiler(int device, 
+        const std::string & kernelName)
     {
-        trace::Profiler::KernelProfilerMap::iterator found = 
-            instrumentation::InstrumentationRuntime::Singleton.profiler.
-                kernelProfilers.find(kernelName);
-    
-        if(found == instrumentation::InstrumentationRuntime::Singleton.profiler.
-            kernelProfilers.end())
-            instrumentation::InstrumentationRuntime::Singleton.profiler.
-                kernelProfilers.insert(std::make_pair(
-                kernelName, trace::Profiler::KernelProfiler()));
-    
-        return &(instrumentation::InstrumentationRuntime::Singleton.
-            profiler.kernelProfilers[kernelName]);
+        return getProfiler()->device(device).kernelProfiler(kernelName);
     }
 
 }
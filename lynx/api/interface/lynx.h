@@ -38,19 +38,34 @@ namespace lynx
     
     void instrument(ir::Module & module);
     
-    void initializeKernelLaunch(std::string kernelName, unsigned int threads, unsigned int threadBlocks);
-    void finalizeKernelLaunch();
+    void initializeKernelLaunch(instrumentation::PTXInstrumentor *instance,
+        const std::string & kernelName, unsigned int threads, 
+        unsigned int threadBlocks);
+    void finalizeKernelLaunch(instrumentation::PTXInstrumentor *instance);
+    
+    void enableInstrumentation(bool enabled);
+    bool instrumentationEnabled();
+    
+    bool validateKernelLaunch(instrumentation::PTXInstrumentor *instrumentor,
+        const std::string & moduleName, const std::string & kernelName,
+        bool & disabled);
+    instrumentation::PTXInstrumentor *getLaunchInstance(
+        instrumentation::PTXInstrumentor *instrumentor, int device, 
+        const void *stream, const std::string & kernelName);
+    void collectKernelLaunches(int device);
     
     instrumentation::PTXInstrumentor *getInstrumentor();
     void resetInstrumentor(instrumentation::PTXInstrumentor *instrumentor);
     
-    bool validateInstrumentor(std::string moduleName, std::string kernelName = "");
+    bool validateInstrumentor(const std::string & moduleName, 
+        const std::string & kernelName = "");
     
     bool getInstrumentorSwitch();
     void setInstrumentorSwitch(bool toggled);
     
     trace::Profiler *getProfiler();
-    trace::Profiler::KernelProfiler *getKernelProfiler(std::string kernelName);
+    trace::Profiler::KernelProfiler *getKernelProfiler(int device, 
+        const std::string & kernelName);
     
 }
 
@@ -8,6 +8,7 @@
 #include <lynx/cuda/interface/CudaContext.h>
 #include <lynx/cuda/interface/CudaRuntimeContext.h>
 #include <lynx/cuda/interface/CudaRuntimeInterface.h>
+#include <lynx/cuda/interface/OriginalKernels.h>
 
 //#include <ocelot/transforms/interface/PassManager.h>
 //#include <ocelot/ir/interface/Module.h>
@@ -37,7 +38,8 @@
 // whether debugging messages are printed
 #define REPORT_BASE 1
 
-#define REPORT_INSTRUMENTED_PTX 1
+// print every instrumented module
+#define REPORT_INSTRUMENTED_PTX 0
 
 namespace cuda {
 
@@ -97,9 +99,12 @@ namespace cuda {
         lynx::initialize();
         report("getting instrumentors ...");
         instrumentors = lynx::getConfiguredInstrumentors();
+        _profiler = &lynx::getProfiler()->device(deviceId);
     }
 
     CudaContext::~CudaContext() {
+        _timer.collect(true);
+        lynx::collectKernelLaunches(_deviceId);
         lynx::finalize();
         delete _device;
         (void) cuCtxDestroy(_cuContext);
@@ -121,21 +126,46 @@ namespace cuda {
     void CudaContext::registerModule(ir::Module & module)
     {
         report("REGISTER-MODULE");
-        if(module.loaded()) return;    
+        if(collectModule(module, true)) return;
+        if(_device->moduleLoaded(module.path())) return;    
     
         report("loading module now");
         module.loadNow();
-        report("instrumenting module");
-        lynx::instrument(module);
+        
+        /* a module instrumented for another device, or whose background 
+            instrumentation failed, is loaded as it is */
+        bool instrument = !OriginalKernels::instrumented(module) &&
+            !cudaRuntime()->_compiler.failed(module.path());
+        
+        /* keep a clean copy of every kernel in the instrumented module, so
+            that launches which are not sampled run without instrumentation
+            overhead and still share the globals of the module */
+        instrumentation::PTXInstrumentor *instrumentor = lynx::getInstrumentor();
+        OriginalKernels originals;
+        if(instrument && instrumentor && instrumentor->on)
+            originals.save(module);
+        
+        if(instrument)
+        {
+            report("instrumenting module");
+            lynx::instrument(module);
+        }
+        
+        if(!originals.empty())
+            originals.insert(module);
 
 	report("module.writeIR");
-        #if REPORT_BASE && REPORT_INSTRUMENTED_PTX 
-        module.writeIR(std::cout);
-        #endif
+        reportE(REPORT_INSTRUMENTED_PTX, 
+            module.toString(ir::PTXEmitter::Target_NVIDIA_PTX30));
 
         report("loading module on device ...");
         _device->loadModule(&module);
-
+        
+        registerModuleSymbols(module);
+    }
+    
+    void CudaContext::registerModuleSymbols(ir::Module & module)
+    {
         report("loading kernels on device ...");
         for (CudaRuntimeContext::RegisteredKernelMap::const_iterator 
 		        kernel = cudaRuntime()->_kernels.begin(); 
@@ -164,8 +194,49 @@ namespace cuda {
                 _device->loadTexture(texture->second.texture);
             }
         }
+        
+        /* resolve registered variables now, globals looked up by name are 
+            resolved on their first use */
+        for (CudaRuntimeContext::RegisteredGlobalMap::const_iterator 
+		        global = cudaRuntime()->_globals.begin(); 
+		        global != cudaRuntime()->_globals.end();
+		        ++global) 
+        {
+            if(global->second.module == module.path())
+            {
+                _device->loadSymbol(global->first, global->second.global, 
+                    global->second.module, false);
+            }
+        }
     }
     
+    bool CudaContext::collectModule(ir::Module & module, bool wait)
+    {
+        CUmodule moduleHandle = 0;
+        if(!cudaRuntime()->_compiler.collect(module.path(), _cuContext, 
+            _deviceId, moduleHandle, wait))
+        {
+            return false;
+        }
+        
+        report("installing module compiled in the background - " 
+            << module.path());
+        _device->setModule(module.path(), moduleHandle);
+        
+        registerModuleSymbols(module);
+        
+        return true;
+    }
+    
+    CUfunction CudaContext::loadBinaryKernel(const std::string & kernelName, 
+        const std::string & moduleName, size_t cubinHandle)
+    {
+        _device->loadBinary(moduleName, 
+            cudaRuntime()->_fatBinaries[cubinHandle].cubin_ptr);
+        
+        return _device->loadBinaryKernel(kernelName, moduleName);
+    }
+
     void CudaContext::registerAllModules() {
 	for(CudaRuntimeContext::ModuleMap::iterator module = cudaRuntime()->_modules.begin(); 
 		module != cudaRuntime()->_modules.end(); ++module) {
@@ -175,7 +246,8 @@ namespace cuda {
 }
 
     cudaError_t CudaContext::launchKernel(CUfunction kernelHandle, 
-        KernelLaunchConfiguration launch) 
+        KernelLaunchConfiguration launch, bool hiddenParameter, 
+        const void *baseAddress) 
     {
 
         report("launchKernel ...");
@@ -195,6 +267,19 @@ namespace cuda {
             memcpy(paramBlock + launch.args[i]->offset,
                 launch.args[i]->param, launch.args[i]->size);
         }
+        
+        /* the parameter appended by the instrumentation comes last */
+        if (hiddenParameter) {
+            size_t offset = (paramSize + sizeof(void *) - 1) / 
+                sizeof(void *) * sizeof(void *);
+            
+            if (offset + sizeof(void *) > sizeof(paramBlock)) {
+                return cudaErrorInvalidValue;
+            }
+            
+            memcpy(paramBlock + offset, &baseAddress, sizeof(void *));
+            paramSize = offset + sizeof(void *);
+        }
 
         void * paramConfig[] = {
             CU_LAUNCH_PARAM_BUFFER_POINTER, paramBlock,
@@ -246,101 +331,246 @@ namespace cuda {
     }
 
 
-    cudaError_t CudaContext::cudaLaunch(const void *entry) {
-        boost::unique_lock<boost::mutex> lock(_mutex);
-
-        report("cudaLaunch ...");
-
-        cudaError_t result = cudaErrorLaunchFailure;
-
+    LaunchHandle* CudaContext::resolveLaunchHandle(const void *entry, 
+        const KernelLaunchConfiguration & launch, cudaError_t & result)
+    {
         CudaRuntimeContext::RegisteredKernelMap::iterator kernel = 
             _cudaRuntime->_kernels.find((void *)entry);
         assert(kernel != _cudaRuntime->_kernels.end());
-        std::string moduleName = kernel->second.module;
-        std::string kernelName = kernel->second.kernel;
+        const std::string & moduleName = kernel->second.module;
+        const std::string & kernelName = kernel->second.kernel;
     
-        report("module: " << moduleName << ", kernel: " << kernelName);
+        report("resolving module: " << moduleName << ", kernel: " 
+            << kernelName);
        
         CudaRuntimeContext::ModuleMap::iterator module = 
             _cudaRuntime->_modules.find(moduleName);
         assert(module != _cudaRuntime->_modules.end());
+        
+        /* launch the original binary while the instrumented module is still
+            being compiled in the background, unless the binary has globals
+            of its own that the compiled module would not see */
+        if(!collectModule(module->second, false) && 
+            cudaRuntime()->_compiler.launchable(moduleName))
+        {
+            CUfunction kernelHandle = loadBinaryKernel(kernelName, moduleName,
+                kernel->second.cubinHandle);
+            
+            report("launching original kernel, module still compiling ...");
+            
+            _timer.start(launch.stream);
+            
+            result = launchKernel(kernelHandle, launch);
+            
+            _timer.stop(launch.stream, _profiler, 
+                _profiler->kernelProfiler(kernelName), 0);
+            _timer.collect();
+		    lynx::getProfiler()->jitPendingLaunches++;
+		    
+            return 0;
+        }
+        
+        instrumentation::PTXInstrumentorVector *instrumentors = 
+            lynx::getConfiguredInstrumentors();
+        
+        /* the module is instrumented for the first instrumentor, as if it 
+            was registered by the first launch of the kernel */
+        if(instrumentors->size() != 0)
+        {
+            lynx::resetInstrumentor(instrumentors->front());
+            lynx::validateInstrumentor(moduleName, kernelName);
+        }
+        
+        registerModule(module->second);
+        
+        LaunchHandle & handle = _launchHandles.insert(entry);
+        
+        handle.kernelName = kernelName;
+        handle.moduleName = moduleName;
+        handle.module = &module->second;
+        
+        CudaKernelMap::const_iterator instrumented = 
+            _device->kernels.find(kernelName);
+        handle.instrumented = instrumented == _device->kernels.end() ? 0 : 
+            instrumented->second;
+        
+        CudaKernelMap::const_iterator original = 
+            _device->originalKernels.find(kernelName);
+        handle.original = original == _device->originalKernels.end() ? 0 : 
+            original->second;
+        
+        handle.hiddenParameter = false;
+        for(instrumentation::PTXInstrumentorVector::const_iterator 
+            instrumentor = instrumentors->begin();
+            instrumentor != instrumentors->end(); ++instrumentor)
+        {
+            if((*instrumentor)->parameterKernels.count(kernelName) != 0)
+                handle.hiddenParameter = true;
+        }
+        
+        handle.generation = _device->generation;
+        handle.profiler = _profiler->kernelProfiler(kernelName);
+        
+        /* which instrumentors apply to the kernel is decided once, the 
+            sampling state of the launches so far is kept */
+        handle.probes.resize(instrumentors->size());
+        
+        LaunchProbeVector::iterator probe = handle.probes.begin();
+        for(instrumentation::PTXInstrumentorVector::const_iterator 
+            instrumentor = instrumentors->begin();
+            instrumentor != instrumentors->end(); ++instrumentor, ++probe)
+        {
+            probe->instrumentor = *instrumentor;
+            probe->validated = lynx::validateKernelLaunch(*instrumentor, 
+                moduleName, kernelName, probe->disabled);
+            probe->instance = 0;
+        }
+        
+        if(instrumentors->size() != 0)
+            lynx::resetInstrumentor(instrumentors->front());
+        
+        return &handle;
+    }
+
+    cudaError_t CudaContext::cudaLaunch(const void *entry) {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        report("cudaLaunch ...");
+
+        cudaError_t result = cudaErrorLaunchFailure;
 
         assert(launchConfigurations.size());
 
         KernelLaunchConfiguration launch(launchConfigurations.back());
         launchConfigurations.pop_back();
         
-        instrumentation::PTXInstrumentorVector *instrumentors = 
-            lynx::getConfiguredInstrumentors();
+        /* handles are resolved again once any module or kernel of the 
+            device was replaced */
+        LaunchHandle *handle = _launchHandles.find(entry);
+        if(handle == 0 || handle->generation != _device->generation)
+        {
+            handle = resolveLaunchHandle(entry, launch, result);
+            if(handle == 0)
+                return setLastError(result);
+        }
         
-        if(instrumentors->size() == 0)
+        const std::string & kernelName = handle->kernelName;
+    
+        report("module: " << handle->moduleName << ", kernel: " << kernelName);
+        
+        if(handle->probes.size() == 0)
         {
-            registerModule(module->second);
-                
-            assert(_device->kernels.find(kernelName) != _device->kernels.end());
-            CUfunction kernelHandle = _device->kernels.find(kernelName)->second;
+            CUfunction kernelHandle = handle->function(true);
             assert(kernelHandle);
 
             report("launching non-instrumented kernel ...");
             
-            lynx::getProfiler()->startTimer();   
+            _timer.start(launch.stream);
             
             result = launchKernel(kernelHandle, launch);
             
-            lynx::getProfiler()->stopKernelTimer(
-		    & trace::Profiler::kernelsExecute, kernelName); 
+            _timer.stop(launch.stream, _profiler, handle->profiler, 0);
         }
 
-        report("instrumentors size: " << instrumentors->size());
+        report("instrumentors size: " << handle->probes.size());
         
-        for(instrumentation::PTXInstrumentorVector::iterator instrumentor = 
-            instrumentors->begin();
-            instrumentor != instrumentors->end(); ++instrumentor)
+        /* only what was resolved with the handle is used, the runtime lock
+            is taken when the thread or stream needs another instance */
+        for(LaunchProbeVector::iterator probe = handle->probes.begin();
+            probe != handle->probes.end(); ++probe)
         {
-            report((*instrumentor)->description);
-            lynx::resetInstrumentor(*instrumentor);
+            report(probe->instrumentor->description);
 
-            if(lynx::validateInstrumentor(moduleName, kernelName))
+            if(probe->validated)
             {
-                registerModule(module->second);
+                /* a module registered while the instrumentor was off only
+                    has the clean kernels, and launches made while 
+                    instrumentation is switched off are not part of the 
+                    sampled population */
+                bool recorded = handle->hasInstrumentation() && 
+                    lynx::instrumentationEnabled();
+                bool sampled = false;
+                
+                trace::LaunchTime *time = 0;
+                instrumentation::PTXInstrumentor *instance = 0;
+                
+                if(recorded)
+                {
+                    instance = handle->instance(*probe, launch.stream);
+                    if(instance == 0)
+                    {
+                        instance = lynx::getLaunchInstance(probe->instrumentor,
+                            _deviceId, launch.stream, kernelName);
+                        
+                        probe->instance = instance;
+                        probe->stream = launch.stream;
+                        probe->thread = boost::this_thread::get_id();
+                    }
+                    
+                    sampled = probe->instrumentor->sampleLaunch(
+                        probe->sampling, probe->disabled, instance->launch, 
+                        time);
+                    
+                    instance->on = true;
+                    instance->sampled = sampled;
+                }
                 
-                lynx::initializeKernelLaunch(kernelName, 
-                    launch.blockDim.x * launch.blockDim.y * launch.blockDim.z,
-                    launch.gridDim.x * launch.gridDim.y * launch.gridDim.z);
+                if(sampled)
+                {
+                    lynx::initializeKernelLaunch(instance, kernelName, 
+                        launch.blockDim.x * launch.blockDim.y * launch.blockDim.z,
+                        launch.gridDim.x * launch.gridDim.y * launch.gridDim.z);
+                }
 
-                assert(_device->kernels.find(kernelName) != _device->kernels.end());
-                CUfunction kernelHandle = _device->kernels.find(kernelName)->second;
+                CUfunction kernelHandle = handle->function(sampled);
                 assert(kernelHandle);
-                report("launching instrumented kernel ...");
+                report("launching " << (sampled ? "instrumented" : "original") 
+                    << " kernel ...");
                 
-                lynx::getProfiler()->startTimer();   
+                /* only the kernel is timed, the buffers of the instance
+                    are set up and read before and after it */
+                trace::LaunchTimer & timer = instance ? *instance->timer : 
+                    _timer;
                 
-                result = launchKernel(kernelHandle, launch);
+                timer.start(launch.stream);
                 
-                lynx::getProfiler()->stopKernelTimer(
-		            & trace::Profiler::kernelsExecute, kernelName);           
+                result = launchKernel(kernelHandle, launch, 
+                    handle->takesBaseAddress(kernelHandle),
+                    instance ? instance->baseAddress : 0);
+                
+                timer.stop(launch.stream, _profiler, handle->profiler, time);
         
-                lynx::finalizeKernelLaunch();
+                if(sampled)
+                    lynx::finalizeKernelLaunch(instance);
+                
+                if(instance)
+                    timer.collect();
+                
+                if(recorded)
+                    _profiler->recordLaunch(handle->profiler, sampled);
             }
             else
             {
                 report("Instrumentor validation failed ...");
-                registerModule(module->second);
                 
-                assert(_device->kernels.find(kernelName) != _device->kernels.end());
-                CUfunction kernelHandle = _device->kernels.find(kernelName)->second;
+                CUfunction kernelHandle = handle->function(false);
                 assert(kernelHandle);
                 report("launching non-instrumented kernel ...");
                 
-                lynx::getProfiler()->startTimer();   
+                _timer.start(launch.stream);
                 
-                result = launchKernel(kernelHandle, launch);
+                /* keeps the parameter layout if only the instrumented 
+                    variant was loaded */
+                result = launchKernel(kernelHandle, launch,
+                    handle->takesBaseAddress(kernelHandle), 0);
                 
-                lynx::getProfiler()->stopKernelTimer(
-		            & trace::Profiler::kernelsExecute, kernelName); 
-
+                _timer.stop(launch.stream, _profiler, handle->profiler, 0);
             }
         }
+        
+        /* times of the launches that finished feed the sampling of the 
+            next ones */
+        _timer.collect();
       
         return setLastError(result);
     }
@@ -674,7 +904,7 @@ namespace cuda {
 
     cudaError_t CudaContext::cudaGetDeviceProperties(struct cudaDeviceProp *prop,
             int deviceId) {
-	std::cout << "CudaContext::cudaGetDeviceProperties" << std::endl;
+	report("CudaContext::cudaGetDeviceProperties");
         return CudaRuntimeInterface::cudaGetDeviceProperties(prop, deviceId);
     }
 
@@ -694,13 +924,21 @@ namespace cuda {
         return ret;
     }
 
-    void CudaContext::findSymbol(const void *symbol, std::string & name, std::string & moduleName) 
+    const CudaSymbol* CudaContext::findSymbol(const void *symbol) 
     {
+        report("findSymbol -- " << (void *)symbol);
+        
+        const CudaSymbol* cached = _device->getSymbol(symbol);
+        if(cached)
+            return cached;
+        
+        std::string name;
+        std::string moduleName;
+        bool byName = false;
+        
         CudaRuntimeContext::RegisteredGlobalMap::iterator global = 
         cudaRuntime()->_globals.find((void*)symbol);
 
-        report("findSymbol -- " << (void *)symbol);
-        
         if(global != cudaRuntime()->_globals.end())
         {
             name = global->second.global;
@@ -710,6 +948,7 @@ namespace cuda {
         else
         {
             name = (char *)symbol;
+            byName = true;
             // register all modules -- this ensures that all global variables
             // added via instrumentation have been incorporated into the modules
             report("registering all modules ...");
@@ -729,6 +968,18 @@ namespace cuda {
 			}
 
         }
+        
+        report("name: " << name << ", module: " << moduleName);
+        
+        CudaRuntimeContext::ModuleMap::iterator module = 
+            cudaRuntime()->_modules.find(moduleName);
+        if(module == cudaRuntime()->_modules.end())
+            return 0;
+
+        if(_device->modules.find(moduleName) == _device->modules.end())
+            registerModule(module->second);
+
+        return _device->loadSymbol(symbol, name, moduleName, byName);
     }
 
     cudaError_t CudaContext::cudaGetSymbolAddress(void **devPtr,
@@ -740,30 +991,12 @@ namespace cuda {
             return setLastError(cudaErrorInvalidValue);
         }
         
-        std::string name;
-        std::string moduleName;
-
-        findSymbol(symbol, name, moduleName);
-
-        report("name: " << name << ", module: " << moduleName);
-
-        if(_device->modules.find(moduleName) == _device->modules.end())
-        {
-            CudaRuntimeContext::ModuleMap::iterator moduleToLoad = 
-                cudaRuntime()->_modules.find(moduleName);
-            assert(moduleToLoad != cudaRuntime()->_modules.end());
-            registerModule(moduleToLoad->second);
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        CUmodule moduleHandle = _device->modules.find(moduleName)->second;
-        assert(moduleHandle);
-
-        size_t bytes;
-        CUdeviceptr tmp;
-
-        report("retrieving symbol address ...");
-        assert(cuModuleGetGlobal(&tmp, &bytes, moduleHandle, name.c_str()) == CUDA_SUCCESS);
-        *devPtr = (char *)tmp;
+        *devPtr = (char *)resolved->address;
         report("devPtr = " << *devPtr);
 
         return setLastError(cudaSuccess);
@@ -775,27 +1008,12 @@ namespace cuda {
             return setLastError(cudaErrorInvalidValue);
         }
 
-        std::string name;
-        std::string moduleName;
-
-        findSymbol(symbol, name, moduleName);
-
-        report("name: " << name << ", module: " << moduleName);
-
-        if(_device->modules.find(moduleName) == _device->modules.end())
-        {
-            CudaRuntimeContext::ModuleMap::iterator moduleToLoad = 
-                cudaRuntime()->_modules.find(moduleName);
-            assert(moduleToLoad != cudaRuntime()->_modules.end());
-            registerModule(moduleToLoad->second);
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        CUmodule moduleHandle = _device->modules.find(moduleName)->second;
-        assert(moduleHandle);
-
-        CUdeviceptr devPtr;
-        report("retrieving symbol size ..");
-        assert(cuModuleGetGlobal(&devPtr, size, moduleHandle, name.c_str()) == CUDA_SUCCESS);
+        *size = resolved->size;
         report("size: " << *size);
 
         return setLastError(cudaSuccess);
@@ -1063,19 +1281,14 @@ namespace cuda {
             const void *symbol, size_t count, size_t offset,
             enum cudaMemcpyKind kind) {
 
-        uint8_t * symbolPtr;
-        cudaError_t ret = CudaContext::cudaGetSymbolAddress((void **) &symbolPtr, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        size_t symbolSize;
-        ret = CudaContext::cudaGetSymbolSize(&symbolSize, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
-        }
+        uint8_t * symbolPtr = (uint8_t *)resolved->address;
 
-        if (symbolSize < count + offset) {
+        if (resolved->size < count + offset) {
             return cudaErrorInvalidValue;
         }
 
@@ -1100,19 +1313,14 @@ namespace cuda {
             const void *symbol, size_t count, size_t offset,
             enum cudaMemcpyKind kind, cudaStream_t stream) {
 
-        uint8_t * symbolPtr;
-        cudaError_t ret = CudaContext::cudaGetSymbolAddress((void **) &symbolPtr, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        size_t symbolSize;
-        ret = CudaContext::cudaGetSymbolSize(&symbolSize, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
-        }
+        uint8_t * symbolPtr = (uint8_t *)resolved->address;
 
-        if (symbolSize < count + offset) {
+        if (resolved->size < count + offset) {
             return cudaErrorInvalidValue;
         }
 
@@ -1164,19 +1372,14 @@ namespace cuda {
             enum cudaMemcpyKind kind) {
         
         report("cudaMemcpyToSymbol - symbol: " << (void *)symbol);
-        uint8_t * symbolPtr;
-        cudaError_t ret = CudaContext::cudaGetSymbolAddress((void **) &symbolPtr, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        size_t symbolSize;
-        ret = CudaContext::cudaGetSymbolSize(&symbolSize, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
-        }
+        uint8_t * symbolPtr = (uint8_t *)resolved->address;
 
-        if (symbolSize < count + offset) {
+        if (resolved->size < count + offset) {
             return cudaErrorInvalidValue;
         }
 
@@ -1201,19 +1404,14 @@ namespace cuda {
             const void *src, size_t count, size_t offset,
             enum cudaMemcpyKind kind, cudaStream_t stream) {
 
-        uint8_t * symbolPtr;
-        cudaError_t ret = CudaContext::cudaGetSymbolAddress((void **) &symbolPtr, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
+        const CudaSymbol* resolved = findSymbol(symbol);
+        if (!resolved) {
+            return setLastError(cudaErrorInvalidSymbol);
         }
 
-        size_t symbolSize;
-        ret = CudaContext::cudaGetSymbolSize(&symbolSize, symbol);
-        if (ret != cudaSuccess) {
-            return ret;
-        }
+        uint8_t * symbolPtr = (uint8_t *)resolved->address;
 
-        if (symbolSize < count + offset) {
+        if (resolved->size < count + offset) {
             return cudaErrorInvalidValue;
         }
 
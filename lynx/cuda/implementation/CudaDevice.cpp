@@ -5,6 +5,7 @@
 */
 
 #include <lynx/cuda/interface/CudaDevice.h>
+#include <lynx/cuda/interface/OriginalKernels.h>
 
 // Hydrazine includes
 #include <hydrazine/interface/Exception.h>
@@ -26,6 +27,9 @@
 // whether debugging messages are printed
 #define REPORT_BASE 1
 
+// print the PTX of every module loaded on the device
+#define REPORT_EMITTED_PTX 0
+
 
 ////////////////////////////////////////////////////////////////////////////////
 
@@ -33,7 +37,7 @@
 namespace cuda {
 
     CudaDevice::CudaDevice(int id)
-    : id(id)
+    : id(id), generation(0)
     {
     }
     
@@ -41,21 +45,89 @@ namespace cuda {
 	{	
         modules.clear();
         kernels.clear();
+        symbols.clear();
+        originalKernels.clear();
+        binaryModules.clear();
+        binaryKernels.clear();
 	}
 
     void CudaDevice::loadModule(const ir::Module* module) 
     {
-        std::stringstream stream;
-        module->writeIR(stream, ir::PTXEmitter::Target_NVIDIA_PTX30);
+        std::string ptx;
+        module->writeIR(ptx, ir::PTXEmitter::Target_NVIDIA_PTX30, 0);
         
-        report(stream.str());
+        reportE(REPORT_EMITTED_PTX, ptx);
 
-        if(modules.find(module->path()) != modules.end())
+        setModule(module->path(), compile(ptx, id));
+    }
+    
+    void CudaDevice::loadBinary(std::string moduleName, const void *binary)
+    {
+        if(binaryModules.count(moduleName) != 0)
+            return;
+            
+        CUmodule moduleHandle;
+        CUresult ret = cuModuleLoadFatBinary(&moduleHandle, binary);
+        
+        report("loading fat binary for " << moduleName << ", ret: " << ret);
+        assert(ret == CUDA_SUCCESS && moduleHandle);
+        
+        binaryModules.insert(std::make_pair(moduleName, moduleHandle));
+    }
+    
+    CUfunction CudaDevice::loadBinaryKernel(const std::string& kernelName,
+        const std::string& moduleName)
+    {
+        CudaKernelMap::iterator kernel = binaryKernels.find(kernelName);
+        if(kernel != binaryKernels.end())
+            return kernel->second;
+        
+        CudaModuleMap::iterator module = binaryModules.find(moduleName);
+        if(module == binaryModules.end())
         {
-            CUresult ret = cuModuleUnload(modules.find(module->path())->second);
+            throw hydrazine::Exception("Fat binary was never loaded on device!");
+        }
+        
+        CUfunction kernelHandle;
+        CUresult ret = cuModuleGetFunction(&kernelHandle, module->second, 
+            kernelName.c_str());
+        
+        assert(ret == CUDA_SUCCESS && kernelHandle);
+        
+        binaryKernels.insert(std::make_pair(kernelName, kernelHandle));
+        
+        return kernelHandle;
+    }
+    
+    void CudaDevice::setModule(std::string moduleName, CUmodule moduleHandle)
+    {
+        if(modules.find(moduleName) != modules.end())
+        {
+            CUresult ret = cuModuleUnload(modules.find(moduleName)->second);
             assert(ret == CUDA_SUCCESS);
         }   
 
+        /* allow a moduleHandle to be re-inserted -- this requires removing
+            any previously inserted moduleHandles with the same key since
+            STL map does not allow duplicate keys and if a key is found, it 
+            doesn't over-write the old value with the new one */
+        modules.erase(moduleName);
+        modules.insert(std::make_pair(moduleName, moduleHandle));
+        ++generation;
+        
+        /* the globals of a module that was JIT-compiled again moved */
+        for(CudaSymbolMap::iterator symbol = symbols.begin(); 
+            symbol != symbols.end(); )
+        {
+            if(symbol->second.module == moduleName)
+                symbol = symbols.erase(symbol);
+            else
+                ++symbol;
+        }
+    }
+    
+    CUmodule CudaDevice::compile(const std::string& ptx, int id)
+    {
         CUjit_option options[] = {
 			CU_JIT_TARGET,
 			CU_JIT_ERROR_LOG_BUFFER, 
@@ -86,26 +158,25 @@ namespace cuda {
         if(major == 3) {
             optionValues[0] = (void*)CU_TARGET_COMPUTE_30;
         }
-	optionValues[0] = (void*)CU_TARGET_COMPUTE_35; 
+        /* the PTX of registered modules is selected for jitArchitecture */
+        optionValues[0] = (void*)CU_TARGET_COMPUTE_35;
         CUmodule moduleHandle;
-        ret = cuModuleLoadDataEx(&moduleHandle, stream.str().c_str(),
+        ret = cuModuleLoadDataEx(&moduleHandle, ptx.c_str(),
             3, options, optionValues);
 
         report("ret: " << ret);
-	char *errorStr = new char[1024];
-	ret = cuGetErrorName(ret, (const char **)&errorStr);
-	report("Error name : " << errorStr);
-	ret = cuGetErrorString(ret, (const char **)&errorStr);
-	report("Error string : " << errorStr);
-        assert(ret == CUDA_SUCCESS && moduleHandle);
-
-        /* allow a moduleHandle to be re-inserted -- this requires removing
-            any previously inserted moduleHandles with the same key since
-            STL map does not allow duplicate keys and if a key is found, it 
-            doesn't over-write the old value with the new one */
-        modules.erase(module->path());
-        modules.insert(std::make_pair(module->path(), moduleHandle));
+        
+        if(ret != CUDA_SUCCESS)
+        {
+            const char *errorName = 0;
+            cuGetErrorName(ret, &errorName);
+            
+            throw hydrazine::Exception(std::string("JIT compilation failed (")
+                + (errorName ? errorName : "unknown error") + "): " 
+                + (const char *)errorLogBuffer);
+        }
 
+        return moduleHandle;
     }
 
     void CudaDevice::loadKernel(std::string kernelName, std::string moduleName) 
@@ -124,6 +195,35 @@ namespace cuda {
 
         kernels.erase(kernelName);
         kernels.insert(std::make_pair(kernelName, kernelHandle));
+        
+        /* an instrumented module carries a copy of every kernel, a module
+            loaded without instrumentation only has clean kernels */
+        CUfunction originalHandle;
+        ret = cuModuleGetFunction(&originalHandle, module->second, 
+            OriginalKernels::originalName(kernelName).c_str());
+        
+        if(ret == CUDA_ERROR_NOT_FOUND)
+            originalHandle = kernelHandle;
+        else
+            assert(ret == CUDA_SUCCESS && originalHandle);
+        
+        originalKernels.erase(kernelName);
+        originalKernels.insert(std::make_pair(kernelName, originalHandle));
+        ++generation;
+    }
+    
+    CUfunction CudaDevice::getKernel(const std::string& kernelName, 
+        bool instrumented)
+    {
+        CudaKernelMap & loaded = instrumented ? kernels : originalKernels;
+    
+        CudaKernelMap::iterator kernel = loaded.find(kernelName);
+        if(kernel == loaded.end())
+        {
+            throw hydrazine::Exception("Kernel was never loaded on device!");
+        }
+        
+        return kernel->second;
     }
 
     void CudaDevice::loadTexture(std::string textureName)
@@ -134,6 +234,47 @@ namespace cuda {
         textures.insert(std::make_pair(textureName, texRef));
     }
 
+    const CudaSymbol* CudaDevice::loadSymbol(const void *symbol, 
+        const std::string& name, const std::string& moduleName, bool byName)
+    {
+        CudaModuleMap::iterator module = modules.find(moduleName);
+        if(module == modules.end())
+            return 0;
+        
+        CudaSymbol resolved;
+        resolved.name = name;
+        resolved.module = moduleName;
+        resolved.byName = byName;
+        
+        CUresult ret = cuModuleGetGlobal(&resolved.address, &resolved.size, 
+            module->second, name.c_str());
+        
+        report("resolving symbol " << name << " in " << moduleName 
+            << ", ret: " << ret);
+        
+        if(ret != CUDA_SUCCESS)
+            return 0;
+        
+        CudaSymbol & cached = symbols[symbol];
+        cached = resolved;
+        
+        return &cached;
+    }
+    
+    const CudaSymbol* CudaDevice::getSymbol(const void *symbol) const
+    {
+        CudaSymbolMap::const_iterator cached = symbols.find(symbol);
+        if(cached == symbols.end())
+            return 0;
+        
+        /* a name may be passed from a buffer that was reused since */
+        if(cached->second.byName && 
+            cached->second.name != (const char *)symbol)
+            return 0;
+        
+        return &cached->second;
+    }
+
     bool CudaDevice::moduleLoaded(std::string moduleName) 
     {
         return modules.count(moduleName) != 0; 
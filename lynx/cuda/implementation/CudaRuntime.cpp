@@ -37,13 +37,7 @@ static void *cudart = NULL;
 
 extern "C"
 void** __cudaRegisterFatBinary(void *fatCubin) {
-	std::cout << "__cudaRegisterFatBinary XXXX" << std::endl; 
-    FatBinaryContext fatBinaryContextInstance(fatCubin);
-    ir::Module moduleInstance;
-    std::stringstream ptxIstream(fatBinaryContextInstance.ptx());
-    std::string nameString(fatBinaryContextInstance.name());
-    moduleInstance.load(ptxIstream, nameString);
-    //lynx::instrument(moduleInstance);
+	report("__cudaRegisterFatBinary XXXX");
     if(!dll_opened){
     cudart = dlopen("/usr/local/cuda-6.0/lib64/libcudart.so", RTLD_NOW);
     assert(cudart);
@@ -62,7 +56,7 @@ extern "C"
 void __cudaRegisterFunction(void **fatCubinHandle, const char *hostFun,
         char *deviceFun, const char *deviceName, int thread_limit, uint3 *tid,
         uint3 *bid, dim3 *bDim, dim3 *gDim, int *wSize) {
-	std::cout << "__cudaRegisterFunction" << std::endl; 
+	report("__cudaRegisterFunction");
     CudaRuntimeContext::instance().cudaRegisterFunction(
         fatCubinHandle, hostFun, deviceFun, deviceName, thread_limit, tid,
         bid, bDim, gDim, wSize);
@@ -257,12 +251,12 @@ cudaError_t cudaGetDevice(int *device) {
 }
 
 cudaError_t cudaGetDeviceCount(int *count) {
-	std::cout << "cudaGetDeviceCount" << std::endl;
+	report("cudaGetDeviceCount");
     return CudaRuntimeContext::instance().cudaGetDeviceCount(count);
 }
 
 cudaError_t cudaGetDeviceProperties(struct cudaDeviceProp *prop, int device) {
-	std::cout << "cudaGetDeviceProperties" << std::endl;
+	report("cudaGetDeviceProperties");
     return CudaRuntimeContext::instance().context().cudaGetDeviceProperties(
         prop, device);
 }
@@ -663,7 +657,7 @@ cudaError_t cudaRuntimeGetVersion(int *runtimeVersion) {
 }
 
 cudaError_t cudaSetDevice(int device) {
-	std::cout << "cudaSetDevice" << std::endl;
+	report("cudaSetDevice");
     return CudaRuntimeContext::instance().cudaSetDevice(device);
 }
 
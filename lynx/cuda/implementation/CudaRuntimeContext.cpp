@@ -7,6 +7,7 @@
 #include <lynx/cuda/interface/CudaRuntimeContext.h>
 #include <lynx/cuda/interface/CudaRuntimeInterface.h>
 #include <lynx/cuda/interface/CudaContext.h>
+#include <lynx/instrumentation/interface/InstrumentationRuntime.h>
 
 #include <cuda.h>
 
@@ -63,6 +64,8 @@ namespace cuda {
         if (!(context)) {
             context = cudaContextFactory(static_cast<int>(device), _deviceFlags);
             _deviceContexts[device] = context;
+            _compiler.attach(context->_cuContext, 
+                static_cast<int>(device));
         } 
         else if (!(current->contextSetOnThread)) {
             CUresult ret = cuCtxSetCurrent(context->_cuContext);
@@ -86,6 +89,8 @@ namespace cuda {
         if (!(context)) {
             context = cudaContextFactory(static_cast<int>(device), _deviceFlags);
             _deviceContexts[device] = context;
+            _compiler.attach(context->_cuContext, 
+                static_cast<int>(device));
         } 
         else if (!(current->contextSetOnThread)) {
             CUresult ret = cuCtxSetCurrent(context->_cuContext);
@@ -113,7 +118,7 @@ namespace cuda {
     }
 
     CudaRuntimeContext::CudaRuntimeContext() {
-	std::cout << "CudaRuntimeContext ctor" << std::endl; 
+	report("CudaRuntimeContext ctor");
         cuInit(0);
 
         int tmp;
@@ -157,6 +162,21 @@ namespace cuda {
     }
 
     
+    /*! \brief The compute capability of a device as major * 10 + minor,
+        0 if it cannot be queried */
+    static unsigned int deviceArchitecture(unsigned int id) {
+        CUdevice device;
+        int major = 0, minor = 0;
+
+        if(cuInit(0) != CUDA_SUCCESS || cuDeviceGet(&device, id) != CUDA_SUCCESS
+            || cuDeviceComputeCapability(&major, &minor, device) != CUDA_SUCCESS)
+        {
+            return 0;
+        }
+
+        return major * 10 + minor;
+    }
+
     void** CudaRuntimeContext::cudaRegisterFatBinary(void *fatCubin) 
     {
 	    report("entering CudaRuntimeContext::cudaRegisterFatBinary");
@@ -171,32 +191,6 @@ namespace cuda {
 		    handle,	FatBinaryContext(fatCubin))).first;
 	    report("after touching fatCubin");
 	
-	char *errorStr = new char[1024];
-	CUresult ret;
-        ret = cuInit(0);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuInit : " << errorStr);
-	CUdevice devHandle;
-	cuDeviceGet(&devHandle, 0);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuDeviceGet : " << errorStr);
-	char *devName = new char[1024];
-	cuDeviceGetName(devName, 1024, devHandle);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuDeviceGetName : " << errorStr);
-	report("Device Name : " << devName);
-	CUcontext ctxHandle;
-	cuCtxCreate(&ctxHandle, 0, devHandle);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuCtxCreate : " << errorStr);
-	cuCtxSetCurrent(ctxHandle);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuCtxSetCurrent : " << errorStr);
-        CUmodule moduleHandle;
-        ret = cuModuleLoadFatBinary(&moduleHandle, fatCubin);
-	cuGetErrorName(ret, (const char **)&errorStr);
-	report("cuModuleLoadFatBinary : " << errorStr);
-
 	    for (FatBinaryMap::const_iterator it = _fatBinaries.begin();
 		    it != _fatBinaries.end(); ++it) {
 		    if(fatbin == it) continue;
@@ -210,11 +204,24 @@ namespace cuda {
 	    // register associated PTX
 	    ModuleMap::iterator module = _modules.insert(
 		    std::make_pair(fatbin->second.name(), ir::Module())).first;
-	    module->second.lazyLoad(fatbin->second.ptx(), fatbin->second.name());
-	    //module->second.lazyLoad(fatbin->second.ptx(), fatbin->second.name());
+	    // the PTX for the device is selected and decompressed on first use,
+	    // which may happen on the background compiler, so the device of
+	    // the registering thread is looked up here
+	    unsigned int architecture = deviceArchitecture(currentDevice());
+	    if(architecture == 0 || architecture > CudaDevice::jitArchitecture)
+	        architecture = CudaDevice::jitArchitecture;
+	    
+	    FatBinaryContext binary = fatbin->second;
+	    module->second.lazyLoad([binary, architecture]() {
+	        const char* ptx = binary.ptx(architecture);
+	        reportE(REPORT_ALL_PTX, " with PTX\n" << ptx);
+	        return ptx;
+	    }, fatbin->second.name());
 	
 	    report("Loading module (fatbin) - " << module->first);
-	    reportE(REPORT_ALL_PTX, " with PTX\n" << fatbin->second.ptx());
+
+        if(instrumentation::InstrumentationRuntime::Singleton.configuration.backgroundJIT)
+            _compiler.enqueue(&module->second);
 
         return (void **)handle;
     }
@@ -273,7 +280,11 @@ namespace cuda {
     }
 
     void CudaRuntimeContext::cudaUnregisterFatBinary(void **fatCubinHandle) {
-
+        /* fat binaries are unregistered when the application exits, before
+            the static objects of the runtime are destroyed, so the
+            background compiler is stopped here while the driver and the
+            instrumentation runtime are still alive */
+        _compiler.stop();
     }
 
     cudaError_t CudaRuntimeContext::cudaDeviceReset() {
@@ -299,7 +310,7 @@ namespace cuda {
     }
 
     cudaError_t CudaRuntimeContext::cudaGetDeviceCount(int *count) const {
-	std::cout << "CudaRuntimeContext::cudaGetDeviceCount" << std::endl;
+	report("CudaRuntimeContext::cudaGetDeviceCount");
         boost::unique_lock<boost::mutex> lock(_mutex);
 
         *count = static_cast<int>(_deviceCount);
@@ -307,7 +318,7 @@ namespace cuda {
     }
 
     cudaError_t CudaRuntimeContext::cudaSetDevice(int device) {
-	std::cout << "CudaRuntimeContext::cudaSetDevice" << std::endl;
+	report("CudaRuntimeContext::cudaSetDevice");
         boost::unique_lock<boost::mutex> lock(_mutex);
 
         const unsigned udevice = static_cast<unsigned>(device);
@@ -322,7 +333,7 @@ namespace cuda {
         if (current->contextSetOnThread) {
             CudaContext * ctx = _deviceContexts[udevice];
             if (ctx) {
-		    std::cout << "Calling cuCtxSetCurrent from CudaRuntimeContext::cudaSetDevice" << std::endl;
+		    report("Calling cuCtxSetCurrent from CudaRuntimeContext::cudaSetDevice");
                 assert(cuCtxSetCurrent(ctx->_cuContext) == CUDA_SUCCESS);
             } 
             else {
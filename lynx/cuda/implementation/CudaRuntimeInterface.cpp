@@ -13,6 +13,16 @@
 #endif
 #include <dlfcn.h>
 
+// Hydrazine includes
+#include <hydrazine/interface/debug.h>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 1
+
 static void *cudart = NULL;
 
 #define DYNLINK(function)   dlsym(cudart, #function)
@@ -430,7 +440,7 @@ cudaError_t CudaRuntimeInterface::cudaGetDeviceCount(int * count) {
 
 cudaError_t CudaRuntimeInterface::cudaGetDeviceProperties(struct cudaDeviceProp *prop,
         int device) {
-	std::cout << "CudaRuntimeInterface::cudaGetDeviceProperties" <<std::endl;
+	report("CudaRuntimeInterface::cudaGetDeviceProperties");
     return ((cudaGetDeviceProperties_t)
         DYNLINK(cudaGetDeviceProperties))
     	(prop, device);
@@ -824,7 +834,7 @@ cudaError_t CudaRuntimeInterface::cudaPointerGetAttributes(
 
 cudaError_t CudaRuntimeInterface::cudaRuntimeGetVersion(int *runtimeVersion) {
     //cudart = dlopen("libcudart.so", RTLD_LAZY);
-	std::cout << "CudaRuntimeInterface::cudaRuntimeGetVersion" << std::endl;
+	report("CudaRuntimeInterface::cudaRuntimeGetVersion");
     //cudart = dlopen("libcudart.so", RTLD_NOW);
     cudart = dlopen("/usr/local/cuda-6.0/lib64/libcudart.so", RTLD_NOW);
     assert(cudart);
@@ -833,7 +843,7 @@ cudaError_t CudaRuntimeInterface::cudaRuntimeGetVersion(int *runtimeVersion) {
 cudaError_t (*cudaRuntimeGetVersionPtr)(int *runtimeVersion);
     cudaRuntimeGetVersionPtr = (cudaError_t (*)(int*))dlsym(cudart, "cudaRuntimeGetVersion");
     cudaError_t cerr = cudaRuntimeGetVersionPtr(runtimeVersion);
-    std::cout << "cudaRuntimeGetVersion returned " << cerr << " runtimeVersion " << runtimeVersion << std::endl;
+    report("cudaRuntimeGetVersion returned " << cerr << " runtimeVersion " << runtimeVersion);
     return cerr;
 }
 
@@ -0,0 +1,168 @@
+/*! \file LaunchHandleMap.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the cache of resolved kernel launches
+*/
+
+#include <lynx/cuda/interface/LaunchHandleMap.h>
+
+#include <hydrazine/interface/Exception.h>
+
+#include <stdint.h>
+
+namespace cuda {
+
+    LaunchProbe::LaunchProbe() : instrumentor(0), validated(false), 
+        disabled(false), instance(0), stream(0)
+    {
+
+    }
+
+    LaunchHandle::LaunchHandle() : module(0), instrumented(0), original(0),
+        hiddenParameter(false), generation(0), profiler(0)
+    {
+
+    }
+
+    CUfunction LaunchHandle::function(bool instrumentedVariant) const
+    {
+        CUfunction kernel = instrumentedVariant ? instrumented : original;
+
+        /* never substitute one variant for the other, the instrumented one
+            needs its launch to be set up */
+        if(!kernel)
+        {
+            throw hydrazine::Exception("Kernel was never loaded on device!");
+        }
+
+        return kernel;
+    }
+
+    bool LaunchHandle::hasInstrumentation() const
+    {
+        return instrumented != original;
+    }
+
+    bool LaunchHandle::takesBaseAddress(CUfunction kernelHandle) const
+    {
+        return hiddenParameter && hasInstrumentation() &&
+            kernelHandle == instrumented;
+    }
+
+    instrumentation::PTXInstrumentor *LaunchHandle::instance(
+        const LaunchProbe & probe, const void *stream) const
+    {
+        if(probe.instance == 0 || probe.stream != stream || 
+            probe.thread != boost::this_thread::get_id())
+        {
+            return 0;
+        }
+
+        return probe.instance;
+    }
+
+    LaunchHandleMap::LaunchHandleMap() : _size(0), _bits(0)
+    {
+
+    }
+
+    LaunchHandleMap::~LaunchHandleMap()
+    {
+        clear();
+    }
+
+    size_t LaunchHandleMap::_slot(const void *entry) const
+    {
+        /* kernel entries are aligned, the multiplication mixes the high
+            bits into the ones that select the slot */
+        uint64_t hash = (uint64_t)(uintptr_t)entry * 0x9E3779B97F4A7C15ULL;
+
+        return (size_t)(hash >> (64 - _bits));
+    }
+
+    LaunchHandle* LaunchHandleMap::find(const void *entry)
+    {
+        if(_size == 0)
+            return 0;
+
+        size_t mask = _entries.size() - 1;
+
+        for(size_t slot = _slot(entry); _entries[slot] != 0;
+            slot = (slot + 1) & mask)
+        {
+            if(_entries[slot] == entry)
+                return _handles[slot];
+        }
+
+        return 0;
+    }
+
+    LaunchHandle& LaunchHandleMap::insert(const void *entry)
+    {
+        LaunchHandle *handle = find(entry);
+        if(handle)
+            return *handle;
+
+        if(2 * (_size + 1) > _entries.size())
+            _grow();
+
+        size_t mask = _entries.size() - 1;
+        size_t slot = _slot(entry);
+
+        while(_entries[slot] != 0)
+            slot = (slot + 1) & mask;
+
+        _entries[slot] = entry;
+        _handles[slot] = new LaunchHandle;
+        ++_size;
+
+        return *_handles[slot];
+    }
+
+    void LaunchHandleMap::_grow()
+    {
+        std::vector<const void *> entries;
+        std::vector<LaunchHandle *> handles;
+
+        entries.swap(_entries);
+        handles.swap(_handles);
+
+        _bits = _bits == 0 ? 4 : _bits + 1;
+        _entries.assign((size_t)1 << _bits, 0);
+        _handles.assign((size_t)1 << _bits, 0);
+
+        size_t mask = _entries.size() - 1;
+
+        for(size_t old = 0; old < entries.size(); ++old)
+        {
+            if(entries[old] == 0)
+                continue;
+
+            size_t slot = _slot(entries[old]);
+            while(_entries[slot] != 0)
+                slot = (slot + 1) & mask;
+
+            _entries[slot] = entries[old];
+            _handles[slot] = handles[old];
+        }
+    }
+
+    size_t LaunchHandleMap::size() const
+    {
+        return _size;
+    }
+
+    void LaunchHandleMap::clear()
+    {
+        for(std::vector<LaunchHandle *>::iterator handle = _handles.begin();
+            handle != _handles.end(); ++handle)
+        {
+            delete *handle;
+        }
+
+        _entries.clear();
+        _handles.clear();
+        _size = 0;
+        _bits = 0;
+    }
+}
@@ -0,0 +1,427 @@
+/*! \file ModuleCompiler.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the background module compiler
+*/
+
+#include <lynx/cuda/interface/ModuleCompiler.h>
+#include <lynx/cuda/interface/CudaDevice.h>
+#include <lynx/cuda/interface/OriginalKernels.h>
+
+#include <lynx/api/interface/lynx.h>
+#include <lynx/instrumentation/interface/InstrumentationRuntime.h>
+
+#include <boost/thread/locks.hpp>
+
+#include <iostream>
+
+// Hydrazine includes
+#include <hydrazine/interface/Exception.h>
+#include <hydrazine/interface/Timer.h>
+#include <hydrazine/interface/debug.h>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+////////////////////////////////////////////////////////////////////////////////
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+////////////////////////////////////////////////////////////////////////////////
+
+namespace cuda {
+
+    ModuleCompiler::ModuleCompiler(): _thread(0), _stop(false)
+    {
+    }
+
+    /* the worker is stopped by the runtime teardown, by the time static
+        objects are destroyed the instrumentation runtime it uses may be
+        gone, so a worker still running is not waited for */
+    ModuleCompiler::~ModuleCompiler()
+    {
+        if(_thread)
+        {
+            _thread->detach();
+            delete _thread;
+        }
+    }
+
+    void ModuleCompiler::enqueue(ir::Module *module)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        report("queueing module " << module->path());
+
+        _modules.erase(module->path());
+        _modules.insert(std::make_pair(module->path(),
+            CompiledModule(module)));
+        _queue.push_back(module->path());
+
+        trace::Profiler *profiler = lynx::getProfiler();
+        profiler->jitQueueDepth = std::max(profiler->jitQueueDepth,
+            (unsigned long)_queue.size());
+
+        if(!_thread)
+        {
+            _stop = false;
+            _thread = new boost::thread(&ModuleCompiler::run, this);
+        }
+
+        _condition.notify_all();
+    }
+
+    void ModuleCompiler::attach(CUcontext context, int device)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        for(ContextVector::const_iterator attached = _contexts.begin();
+            attached != _contexts.end(); ++attached)
+        {
+            if(attached->first == context) return;
+        }
+
+        _contexts.push_back(std::make_pair(context, device));
+
+        _condition.notify_all();
+    }
+
+    bool ModuleCompiler::pending(const std::string & moduleName)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        CompiledModuleMap::const_iterator module = _modules.find(moduleName);
+        if(module == _modules.end())
+            return false;
+
+        return module->second.state == Queued ||
+            module->second.state == Compiling;
+    }
+
+    bool ModuleCompiler::launchable(const std::string & moduleName)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        CompiledModuleMap::const_iterator module = _modules.find(moduleName);
+        if(module == _modules.end())
+            return false;
+
+        return module->second.stateless && (module->second.state == Queued ||
+            module->second.state == Compiling);
+    }
+
+    bool ModuleCompiler::failed(const std::string & moduleName)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        CompiledModuleMap::const_iterator module = _modules.find(moduleName);
+        if(module == _modules.end())
+            return false;
+
+        return module->second.state == Failed;
+    }
+
+    bool ModuleCompiler::collect(const std::string & moduleName,
+        CUcontext context, int device, CUmodule & handle, bool wait)
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        CompiledModuleMap::iterator module = _modules.find(moduleName);
+        if(module == _modules.end())
+            return false;
+
+        while(wait && (module->second.state == Queued ||
+            module->second.state == Compiling))
+        {
+            _condition.wait(lock);
+        }
+
+        if(module->second.state == Failed)
+        {
+            if(!module->second.reported)
+            {
+                std::cerr << "==LYNX== WARNING: Background compilation of "
+                    "module '" << moduleName << "' failed, its kernels run "
+                    "uninstrumented.\n";
+                module->second.reported = true;
+            }
+
+            return false;
+        }
+
+        if(module->second.state != Ready ||
+            module->second.collected.count(context) != 0)
+        {
+            return false;
+        }
+
+        ModuleHandleMap::iterator compiled = 
+            module->second.handles.find(context);
+
+        if(compiled != module->second.handles.end())
+        {
+            handle = compiled->second;
+            module->second.handles.erase(compiled);
+        }
+        else
+        {
+            /* the context was attached after the module was compiled */
+            std::string ptx = module->second.ptx;
+
+            lock.unlock();
+
+            report("compiling module " << moduleName << " for device " 
+                << device);
+
+            CUmodule compiledHandle = 0;
+
+            try
+            {
+                cuCtxPushCurrent(context);
+                compiledHandle = CudaDevice::compile(ptx, device);
+                cuCtxPopCurrent(0);
+            }
+            catch(const std::exception & exception)
+            {
+                cuCtxPopCurrent(0);
+
+                std::cerr << "==LYNX== WARNING: Compiling module '" 
+                    << moduleName << "' for device " << device 
+                    << " failed, " << exception.what() << ".\n";
+
+                return false;
+            }
+
+            lock.lock();
+
+            module = _modules.find(moduleName);
+            assert(module != _modules.end());
+
+            handle = compiledHandle;
+        }
+
+        module->second.collected.insert(context);
+
+        return true;
+    }
+
+    void ModuleCompiler::stop()
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            _stop = true;
+            _condition.notify_all();
+        }
+
+        if(_thread)
+        {
+            _thread->join();
+            delete _thread;
+            _thread = 0;
+        }
+    }
+
+    size_t ModuleCompiler::queueDepth()
+    {
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        return _queue.size();
+    }
+
+    bool ModuleCompiler::emit(ir::Module *module, std::string & ptx,
+        OriginalKernels & originals)
+    {
+        instrumentation::InstrumentationRuntime & runtime =
+            instrumentation::InstrumentationRuntime::Singleton;
+
+        boost::unique_lock<boost::recursive_mutex> lock(runtime.mutex);
+
+        if(runtime.instrumentors.empty())
+            return false;
+
+        /* the default active instrumentor of every thread */
+        instrumentation::PTXInstrumentor *instrumentor =
+            runtime.instrumentors.front();
+
+        /* the application thread may be registering a module with this
+            instrumentor, restore its state when done */
+        bool on = instrumentor->on;
+
+        bool instrument = instrumentor->conditionsMet("");
+
+        if(instrument)
+        {
+            module->loadNow();
+
+            /* kernels of a module without state of its own can run from
+                the fat binary until the module is collected. Shared and
+                local variables are created again by every launch. Global
+                and constant variables, textures, surfaces and samplers
+                are set by the host through one of the two modules. */
+            bool stateless = module->textures().empty();
+
+            for(ir::Module::GlobalMap::const_iterator 
+                global = module->globals().begin();
+                global != module->globals().end(); ++global)
+            {
+                if(global->second.space() != ir::PTXInstruction::Shared &&
+                    global->second.space() != ir::PTXInstruction::Local)
+                    stateless = false;
+            }
+
+            {
+                boost::unique_lock<boost::mutex> modulesLock(_mutex);
+
+                CompiledModuleMap::iterator compiled = 
+                    _modules.find(module->path());
+                if(compiled != _modules.end())
+                    compiled->second.stateless = stateless;
+            }
+
+            originals.save(*module);
+
+            instrumentor->on = true;
+            instrumentor->analyze(*module);
+            instrumentor->instrument(*module);
+
+            originals.insert(*module);
+
+            module->writeIR(ptx, ir::PTXEmitter::Target_NVIDIA_PTX30, 0);
+        }
+
+        instrumentor->on = on;
+
+        return instrument;
+    }
+
+    void ModuleCompiler::run()
+    {
+        report("background compiler started");
+
+        boost::unique_lock<boost::mutex> lock(_mutex);
+
+        while(true)
+        {
+            while(!_stop && _queue.empty())
+                _condition.wait(lock);
+
+            if(_queue.empty())
+                break;
+
+            std::string moduleName = _queue.front();
+            _queue.pop_front();
+
+            CompiledModuleMap::iterator module = _modules.find(moduleName);
+            if(module == _modules.end() || module->second.state != Queued)
+                continue;
+
+            module->second.state = Compiling;
+            ir::Module *irModule = module->second.module;
+
+            /* analyses may touch the device, instrument with a context */
+            while(!_stop && _contexts.empty())
+                _condition.wait(lock);
+
+            ContextVector contexts = _contexts;
+
+            lock.unlock();
+
+            hydrazine::Timer timer;
+            timer.start();
+
+            State state = Ready;
+            std::string ptx;
+            ModuleHandleMap handles;
+            OriginalKernels originals;
+
+            try
+            {
+                if(contexts.empty())
+                {
+                    state = Declined;
+                }
+                else if(cuCtxSetCurrent(contexts.front().first) != 
+                    CUDA_SUCCESS)
+                {
+                    state = Failed;
+                }
+                else if(emit(irModule, ptx, originals))
+                {
+                    for(ContextVector::const_iterator 
+                        context = contexts.begin();
+                        context != contexts.end(); ++context)
+                    {
+                        report("compiling module " << moduleName 
+                            << " for device " << context->second);
+
+                        if(cuCtxSetCurrent(context->first) != CUDA_SUCCESS)
+                        {
+                            throw hydrazine::Exception(
+                                "Could not switch to the device's context");
+                        }
+
+                        handles[context->first] = CudaDevice::compile(ptx, 
+                            context->second);
+                    }
+                }
+                else
+                {
+                    state = Declined;
+                }
+            }
+            catch(const std::exception & exception)
+            {
+                report("compiling module " << moduleName << " failed: "
+                    << exception.what());
+                state = Failed;
+            }
+
+            if(state == Failed)
+            {
+                for(ModuleHandleMap::const_iterator 
+                    handle = handles.begin(); handle != handles.end(); 
+                    ++handle)
+                {
+                    cuCtxSetCurrent(handle->first);
+                    cuModuleUnload(handle->second);
+                }
+
+                handles.clear();
+
+                /* the module is loaded as it was before instrumenting */
+                if(!originals.empty())
+                {
+                    boost::unique_lock<boost::recursive_mutex> runtimeLock(
+                        instrumentation::InstrumentationRuntime::
+                        Singleton.mutex);
+
+                    originals.restore(*irModule);
+                }
+            }
+
+            timer.stop();
+
+            lock.lock();
+
+            module = _modules.find(moduleName);
+            if(module != _modules.end())
+            {
+                module->second.state = state;
+                module->second.ptx.swap(ptx);
+                module->second.handles.swap(handles);
+            }
+
+            trace::Profiler *profiler = lynx::getProfiler();
+            profiler->jitCompile += timer.seconds();
+            if(state == Ready)
+                profiler->jitModulesReady++;
+
+            _condition.notify_all();
+        }
+
+        report("background compiler stopped");
+    }
+
+}
@@ -0,0 +1,170 @@
+/*! \file OriginalKernels.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the uninstrumented copies of the kernels of
+	    a module
+*/
+
+#include <lynx/cuda/interface/OriginalKernels.h>
+
+#include <ocelot/ir/interface/PTXInstruction.h>
+
+// Hydrazine includes
+#include <hydrazine/interface/debug.h>
+
+#include <set>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace cuda {
+
+    static const std::string originalPrefix = "__lynx_original_";
+
+    OriginalKernels::OriginalKernels()
+    {
+    }
+
+    OriginalKernels::~OriginalKernels()
+    {
+        _clear();
+    }
+
+    void OriginalKernels::save(const ir::Module & module)
+    {
+        _clear();
+
+        for(ir::Module::KernelMap::const_iterator 
+            kernel = module.kernels().begin();
+            kernel != module.kernels().end(); ++kernel)
+        {
+            _kernels.push_back(new ir::PTXKernel(*kernel->second));
+
+            ir::Module::FunctionPrototypeMap::const_iterator prototype =
+                module.prototypes().find(kernel->first);
+            assert(prototype != module.prototypes().end());
+
+            _prototypes.push_back(prototype->second);
+        }
+
+        report("saved " << _kernels.size() << " kernels of module " 
+            << module.path());
+    }
+
+    void OriginalKernels::insert(ir::Module & module) const
+    {
+        std::set<std::string> functions;
+
+        for(KernelVector::const_iterator kernel = _kernels.begin();
+            kernel != _kernels.end(); ++kernel)
+        {
+            if((*kernel)->function())
+                functions.insert((*kernel)->name);
+        }
+
+        for(size_t k = 0; k < _kernels.size(); ++k)
+        {
+            ir::PTXKernel *copy = new ir::PTXKernel(*_kernels[k]);
+            copy->name = originalName(copy->name);
+
+            for(ir::ControlFlowGraph::iterator block = copy->cfg()->begin();
+                block != copy->cfg()->end(); ++block)
+            {
+                for(ir::ControlFlowGraph::InstructionList::iterator 
+                    instruction = block->instructions.begin();
+                    instruction != block->instructions.end(); ++instruction)
+                {
+                    ir::PTXInstruction & ptx = 
+                        static_cast<ir::PTXInstruction &>(**instruction);
+
+                    if(ptx.opcode == ir::PTXInstruction::Call &&
+                        ptx.a.addressMode == ir::PTXOperand::FunctionName &&
+                        functions.count(ptx.a.identifier) != 0)
+                    {
+                        ptx.a.identifier = originalName(ptx.a.identifier);
+                    }
+                }
+            }
+
+            ir::PTXKernel::Prototype prototype = _prototypes[k];
+            prototype.identifier = copy->name;
+
+            module.addPrototype(copy->name, prototype);
+            module.insertKernel(copy);
+        }
+
+        report("added " << _kernels.size() << " original kernels to module "
+            << module.path());
+    }
+
+    void OriginalKernels::restore(ir::Module & module) const
+    {
+        std::vector<std::string> names;
+
+        for(ir::Module::KernelMap::const_iterator 
+            kernel = module.kernels().begin();
+            kernel != module.kernels().end(); ++kernel)
+        {
+            names.push_back(kernel->first);
+        }
+
+        for(std::vector<std::string>::const_iterator name = names.begin();
+            name != names.end(); ++name)
+        {
+            module.removeKernel(*name);
+            module.removePrototype(*name);
+        }
+
+        for(size_t k = 0; k < _kernels.size(); ++k)
+        {
+            module.addPrototype(_kernels[k]->name, _prototypes[k]);
+            module.insertKernel(new ir::PTXKernel(*_kernels[k]));
+        }
+
+        report("restored " << _kernels.size() << " kernels of module "
+            << module.path());
+    }
+
+    bool OriginalKernels::empty() const
+    {
+        return _kernels.empty();
+    }
+
+    std::string OriginalKernels::originalName(const std::string & kernelName)
+    {
+        return originalPrefix + kernelName;
+    }
+
+    bool OriginalKernels::instrumented(const ir::Module & module)
+    {
+        for(ir::Module::KernelMap::const_iterator 
+            kernel = module.kernels().begin();
+            kernel != module.kernels().end(); ++kernel)
+        {
+            if(kernel->first.compare(0, originalPrefix.size(), 
+                originalPrefix) == 0)
+            {
+                return true;
+            }
+        }
+
+        return false;
+    }
+
+    void OriginalKernels::_clear()
+    {
+        for(KernelVector::iterator kernel = _kernels.begin();
+            kernel != _kernels.end(); ++kernel)
+        {
+            delete *kernel;
+        }
+
+        _kernels.clear();
+        _prototypes.clear();
+    }
+
+}
@@ -12,8 +12,10 @@
 #include <cuda_runtime.h>
 
 #include <lynx/cuda/interface/CudaDevice.h>
+#include <lynx/cuda/interface/LaunchHandleMap.h>
 #include <lynx/cuda/interface/CudaRuntimeContext.h>
 #include <lynx/instrumentation/interface/PTXInstrumentor.h>
+#include <lynx/trace/interface/LaunchTimer.h>
 
 namespace cuda {
 
@@ -106,15 +108,46 @@ class CudaContext {
         instrumentation::PTXInstrumentorVector *instrumentors;
 
     private:
+        //! resolved launches by host entry
+        LaunchHandleMap _launchHandles;
+        
+        //! times the launches of the context on their streams
+        trace::LaunchTimer _timer;
+        
+        //! kernel times and counters of the device
+        trace::Profiler::DeviceProfiler *_profiler;
 
-        void findSymbol(const void *symbol, std::string & name, std::string & moduleName);
+        /*! \brief Resolve a symbol passed to the runtime, by the address of 
+            a registered variable or by name, returns 0 if it is unknown */
+        const CudaSymbol* findSymbol(const void *symbol);
         cudaError_t locateTexture(
             const struct textureReference *texref, CUtexref & texHandle,
             CudaRuntimeContext::RegisteredTextureMap::iterator & texture);
 
         void registerModule(ir::Module & module);
+        void registerModuleSymbols(ir::Module & module);
+        
+        /*! \brief Install a module compiled in the background, returning 
+            false if it is not available (yet) */
+        bool collectModule(ir::Module & module, bool wait);
+        
+        /*! \brief Load a kernel from its fat binary */
+        CUfunction loadBinaryKernel(const std::string & kernelName, 
+            const std::string & moduleName, size_t cubinHandle);
         void registerAllModules();
-        cudaError_t launchKernel(CUfunction kernelHandle, KernelLaunchConfiguration launch); 
+        
+        /*! \brief Register the module of a kernel and cache what its 
+            launches need, returns 0 if the kernel was launched from its fat
+            binary because the module is still being compiled */
+        LaunchHandle* resolveLaunchHandle(const void *entry, 
+            const KernelLaunchConfiguration & launch, cudaError_t & result);
+        
+        
+        /*! \brief Launch a kernel, appending the instrumentation buffer to 
+            the parameters if hiddenParameter is set */
+        cudaError_t launchKernel(CUfunction kernelHandle, 
+            KernelLaunchConfiguration launch, bool hiddenParameter = false, 
+            const void *baseAddress = 0); 
 
     public:
 
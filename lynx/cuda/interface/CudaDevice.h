@@ -9,6 +9,8 @@
 
 // C++ standard library includes
 #include <map>
+#include <string>
+#include <unordered_map>
 
 #include <cuda.h>
 #include <ocelot/ir/interface/Module.h>
@@ -19,6 +21,26 @@ namespace cuda {
     typedef std::unordered_map<std::string, CUfunction> CudaKernelMap;
     typedef std::unordered_map<std::string, CUtexref> CudaTextureMap;
     
+    /*! A global variable resolved on the device */
+    class CudaSymbol {
+    
+        public:
+            CudaSymbol() : address(0), size(0), byName(false) { }
+    
+        public:
+            std::string name;
+            std::string module;
+            CUdeviceptr address;
+            size_t size;
+            
+            //! the symbol was looked up by a pointer to its name rather 
+            //! than by the address of a registered host variable
+            bool byName;
+    };
+    
+    /* keyed by the host variable or the name passed to the runtime */
+    typedef std::unordered_map<const void *, CudaSymbol> CudaSymbolMap;
+    
     /*! Interface that should be bound to a single CUDA enabled device */
     class CudaDevice {
 
@@ -27,24 +49,73 @@ namespace cuda {
             CudaDevice(int id);
             ~CudaDevice();
             
+            /*! \brief The architecture (major * 10 + minor) that modules are
+                compiled for, their PTX must not target a newer one */
+            static const unsigned int jitArchitecture = 35;
+            
             const int id;    
 
             /* modules, kernels, and textures loaded on this device */
             CudaModuleMap modules;
             CudaKernelMap kernels;
             CudaTextureMap textures;
+            
+            /* globals of the loaded modules that were already resolved, so 
+                that symbol copies do not query the driver again */
+            CudaSymbolMap symbols;
+            
+            /* changes whenever a module or kernel handle is replaced */
+            unsigned int generation;
+            
+            /* uninstrumented kernels, copies that live in the same modules
+                as the instrumented ones so that both share their globals */
+            CudaKernelMap originalKernels;
+            
+            /* modules loaded straight from their fat binaries, only used
+                while the module is compiled in the background */
+            CudaModuleMap binaryModules;
+            CudaKernelMap binaryKernels;
 
         public:
             /*! \brief Load module, kernel, and texture */
 			void loadModule(const ir::Module* module);
             bool moduleLoaded(std::string moduleName); 
+            
+            /*! \brief Load a module straight from its fat binary, letting
+                the driver pick the best image */
+            void loadBinary(std::string moduleName, const void *binary);
+            
+            /*! \brief Get a kernel of a module loaded from its fat binary */
+            CUfunction loadBinaryKernel(const std::string& kernelName, 
+                const std::string& moduleName);
+            
+            /*! \brief Install a module that was JIT-compiled elsewhere */
+            void setModule(std::string moduleName, CUmodule moduleHandle);
+            
+            /*! \brief JIT-compile PTX for the device with the given id */
+            static CUmodule compile(const std::string& ptx, int id);
 
             void loadKernel(std::string kernelName, std::string moduleName);
             bool kernelLoaded(std::string kernel);
+            
+            /*! \brief Get the instrumented or the original variant of a 
+                kernel, the two are the same if the module was loaded without
+                instrumentation */
+            CUfunction getKernel(const std::string& kernelName, 
+                bool instrumented);
 
             void loadTexture(std::string textureName);
             bool textureLoaded(std::string texture);
             
+            /*! \brief Resolve a global of a loaded module, returns 0 if the
+                module does not define it */
+            const CudaSymbol* loadSymbol(const void *symbol, 
+                const std::string& name, const std::string& moduleName, 
+                bool byName);
+            
+            /*! \brief A resolved symbol, or 0 if it has to be resolved */
+            const CudaSymbol* getSymbol(const void *symbol) const;
+            
     };
 }
 
@@ -15,6 +15,7 @@
 #include <vector>
 
 #include <ocelot/cuda/interface/FatBinaryContext.h>
+#include <lynx/cuda/interface/ModuleCompiler.h>
 #include <ocelot/ir/interface/Module.h>
 
 #include <cuda_runtime.h>
@@ -161,6 +162,9 @@ class CudaRuntimeContext : public boost::noncopyable {
             RegisteredKernelMap _kernels;
             RegisteredGlobalMap _globals;       
             RegisteredTextureMap _textures;
+            
+            //! instruments and compiles registered modules in the background
+            mutable ModuleCompiler _compiler;
 
     public:
 
@@ -0,0 +1,148 @@
+/*! \file LaunchHandleMap.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the cache of resolved kernel launches
+*/
+
+#ifndef LAUNCH_HANDLE_MAP_H_INCLUDED
+#define LAUNCH_HANDLE_MAP_H_INCLUDED
+
+#include <lynx/instrumentation/interface/PTXInstrumentor.h>
+#include <lynx/trace/interface/Profiler.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <cuda.h>
+
+#include <string>
+#include <vector>
+
+namespace ir {
+    class Module;
+}
+
+namespace test {
+    class TestLaunchHandleMap;
+}
+
+namespace cuda {
+
+    /*! What the launches of a kernel need from one configured instrumentor,
+        resolved with the handle so that a launch takes no runtime lock */
+    class LaunchProbe {
+
+        public:
+            LaunchProbe();
+
+        public:
+            instrumentation::PTXInstrumentor *instrumentor;
+
+            //! the instrumentor applies to the kernel
+            bool validated;
+            //! the instrumentor disabled the instrumented variant
+            bool disabled;
+
+            //! launches of the kernel on the device of the handle, kept
+            //! when the handle is resolved again
+            instrumentation::PTXInstrumentor::SamplingState sampling;
+
+            //! the instance of the last launch and its stream and thread,
+            //! 0 until a launch asks for one
+            instrumentation::PTXInstrumentor *instance;
+            const void *stream;
+            boost::thread::id thread;
+    };
+
+    typedef std::vector<LaunchProbe> LaunchProbeVector;
+
+    /*! Everything a launch of a registered kernel needs, resolved once */
+    class LaunchHandle {
+
+        public:
+            LaunchHandle();
+
+            /*! \brief The instrumented or the original variant */
+            CUfunction function(bool instrumented) const;
+
+            /*! \brief Was the module of the kernel instrumented? */
+            bool hasInstrumentation() const;
+
+            /*! \brief Does the variant take the instrumentation buffer as a
+                hidden last parameter? */
+            bool takesBaseAddress(CUfunction kernelHandle) const;
+
+            /*! \brief The cached instance of a probe if it belongs to the 
+                stream and the calling thread, 0 otherwise */
+            instrumentation::PTXInstrumentor *instance(const LaunchProbe & probe,
+                const void *stream) const;
+
+        public:
+            std::string kernelName;
+            std::string moduleName;
+            ir::Module *module;
+
+            //! the kernel as loaded, instrumented or not, 0 if not loaded
+            CUfunction instrumented;
+            //! the uninstrumented copy in the same module, the same as
+            //! instrumented if the module was not instrumented
+            CUfunction original;
+
+            //! the instrumented kernel ends with the hidden parameter
+            bool hiddenParameter;
+
+            //! the CudaDevice::generation the handle was resolved in
+            unsigned int generation;
+
+            //! the profile of the kernel on the device of the handle
+            trace::Profiler::KernelProfiler *profiler;
+
+            //! one probe per configured instrumentor, in their order
+            LaunchProbeVector probes;
+    };
+
+    /*! \brief A map from the host entry of a kernel to its LaunchHandle.
+
+        Slots are kept in a flat array probed linearly from the multiplicative
+        hash of the entry, which is never more than half full, so that a
+        lookup usually touches a single slot. Handles are never removed,
+        a stale one is resolved again in place, and they do not move when
+        the table grows, since launches that are still running refer to
+        their sampling state.
+    */
+    class LaunchHandleMap {
+
+        public:
+            LaunchHandleMap();
+            ~LaunchHandleMap();
+
+            /*! \brief The handle of an entry, or 0 if there is none */
+            LaunchHandle* find(const void *entry);
+
+            /*! \brief The handle of an entry, created if there is none */
+            LaunchHandle& insert(const void *entry);
+
+            size_t size() const;
+            void clear();
+
+        public:
+            LaunchHandleMap(const LaunchHandleMap&) = delete;
+            const LaunchHandleMap& operator=(const LaunchHandleMap&) = delete;
+
+        private:
+            size_t _slot(const void *entry) const;
+            void _grow();
+
+        private:
+            //! 0 marks an empty slot
+            std::vector<const void *> _entries;
+            std::vector<LaunchHandle *> _handles;
+
+            size_t _size;
+            //! log2 of the number of slots
+            unsigned int _bits;
+
+        friend class test::TestLaunchHandleMap;
+    };
+}
+
+#endif
@@ -0,0 +1,141 @@
+/*! \file ModuleCompiler.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the background module compiler, which
+	    instruments and JIT-compiles registered modules off the application
+	    thread
+*/
+
+#ifndef MODULE_COMPILER_H_INCLUDED
+#define MODULE_COMPILER_H_INCLUDED
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/condition_variable.hpp>
+
+#include <deque>
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+
+#include <cuda.h>
+#include <lynx/cuda/interface/OriginalKernels.h>
+#include <ocelot/ir/interface/Module.h>
+
+namespace cuda {
+
+    /*! \brief Instruments and emits modules on a worker thread as soon as
+        they are registered, and JIT-compiles them for every attached
+        context. Until a module has been collected, launches of its kernels
+        may use the original binary if that cannot change the results. */
+    class ModuleCompiler {
+
+        public:
+
+            enum State {
+                //! waiting in the queue
+                Queued,
+                //! being instrumented and compiled
+                Compiling,
+                //! compiled, waiting to be collected by the contexts
+                Ready,
+                //! left to the synchronous path (e.g. kernel filters apply)
+                Declined,
+                //! instrumentation or compilation failed, the module was
+                //! restored and is loaded without instrumentation
+                Failed
+            };
+
+            typedef std::map<CUcontext, CUmodule> ModuleHandleMap;
+            typedef std::set<CUcontext> ContextSet;
+            typedef std::vector<std::pair<CUcontext, int> > ContextVector;
+
+            class CompiledModule {
+                public:
+                    CompiledModule(ir::Module *module = 0): module(module),
+                        state(Queued), stateless(false), reported(false) { }
+
+                public:
+                    ir::Module *module;
+                    State state;
+                    //! the module has no variables, textures, surfaces or
+                    //! samplers that outlive a launch
+                    bool stateless;
+                    //! the failure was reported
+                    bool reported;
+                    //! the emitted PTX, kept for contexts attached later
+                    std::string ptx;
+                    //! compiled modules not yet collected, by context
+                    ModuleHandleMap handles;
+                    //! contexts that collected the module
+                    ContextSet collected;
+            };
+
+            typedef std::map<std::string, CompiledModule> CompiledModuleMap;
+            typedef std::deque<std::string> ModuleQueue;
+
+        public:
+
+            ModuleCompiler();
+            ~ModuleCompiler();
+
+            /*! \brief Queue a registered module, starting the worker thread
+                if it is not running yet */
+            void enqueue(ir::Module *module);
+
+            /*! \brief Add a CUDA context (and its device) modules are
+                compiled for. The first one is current while instrumenting. */
+            void attach(CUcontext context, int device);
+
+            /*! \brief Is the module queued or being compiled? */
+            bool pending(const std::string & moduleName);
+
+            /*! \brief Is the module still being compiled and free of state
+                that outlives a launch, so that its kernels can run from the
+                fat binary in the meantime without splitting its state? */
+            bool launchable(const std::string & moduleName);
+
+            /*! \brief Did the background compilation of the module fail? */
+            bool failed(const std::string & moduleName);
+
+            /*! \brief Hand over the module compiled for a context,
+                optionally waiting for it. Returns false if the module is
+                not (or no longer) owned by the compiler, or failed. */
+            bool collect(const std::string & moduleName, CUcontext context,
+                int device, CUmodule & handle, bool wait);
+
+            /*! \brief Stop the worker thread once the queue is drained. The
+                runtime stops it at teardown, while the driver and the
+                instrumentation runtime are still alive. A module queued
+                later starts the worker again. */
+            void stop();
+
+            /*! \brief Number of modules waiting to be compiled */
+            size_t queueDepth();
+
+        private:
+
+            void run();
+
+            /*! \brief Instrument and emit a module, returning false if it
+                should be left to the synchronous path */
+            bool emit(ir::Module *module, std::string & ptx,
+                OriginalKernels & originals);
+
+        private:
+
+            boost::mutex _mutex;
+            boost::condition_variable _condition;
+            boost::thread *_thread;
+
+            CompiledModuleMap _modules;
+            ModuleQueue _queue;
+
+            ContextVector _contexts;
+            bool _stop;
+    };
+
+}
+
+#endif
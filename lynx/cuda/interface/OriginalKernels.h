@@ -0,0 +1,68 @@
+/*! \file OriginalKernels.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the uninstrumented copies of the kernels of
+	    a module
+*/
+
+#ifndef ORIGINAL_KERNELS_H_INCLUDED
+#define ORIGINAL_KERNELS_H_INCLUDED
+
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+
+#include <string>
+#include <vector>
+
+namespace cuda {
+
+    /*! \brief Clean copies of the kernels of a module, taken before it is
+        instrumented and added back to it under originalName() afterwards.
+
+        Both variants of a kernel then live in the same CUmodule, so they
+        share the globals, constants and textures the application sets up
+        through the runtime, and a launch that is not sampled sees the
+        state of every launch before it. Calls between copied functions are
+        redirected to the copies. */
+    class OriginalKernels {
+
+        public:
+            OriginalKernels();
+            ~OriginalKernels();
+
+            /*! \brief Copy every kernel and function of a loaded module */
+            void save(const ir::Module & module);
+
+            /*! \brief Add the copies to the instrumented module */
+            void insert(ir::Module & module) const;
+
+            /*! \brief Replace every kernel of the module by its copy, undoing
+                the instrumentation */
+            void restore(ir::Module & module) const;
+
+            /*! \brief Were kernels saved? */
+            bool empty() const;
+
+        public:
+            /*! \brief The name of the uninstrumented copy of a kernel */
+            static std::string originalName(const std::string & kernelName);
+
+            /*! \brief Does the module hold uninstrumented copies, that is,
+                was it instrumented? */
+            static bool instrumented(const ir::Module & module);
+
+        private:
+            typedef std::vector<ir::PTXKernel *> KernelVector;
+            typedef std::vector<ir::PTXKernel::Prototype> PrototypeVector;
+
+        private:
+            void _clear();
+
+        private:
+            KernelVector _kernels;
+            PrototypeVector _prototypes;
+    };
+
+}
+
+#endif
@@ -0,0 +1,381 @@
+/*!
+	\file TestLaunchHandleMap.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the map from the host entry of a kernel to its
+		resolved launch handle. Random entries are inserted and looked up,
+		entries that share a slot are probed past each other, and handles
+		must keep their address and contents while the table grows.
+*/
+
+#ifndef TEST_LAUNCH_HANDLE_MAP_CPP_INCLUDED
+#define TEST_LAUNCH_HANDLE_MAP_CPP_INCLUDED
+
+#include <lynx/cuda/interface/LaunchHandleMap.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Insert, find and grow a LaunchHandleMap */
+	class TestLaunchHandleMap : public Test
+	{
+		private:
+			typedef std::vector<const void*> EntryVector;
+			typedef std::vector<cuda::LaunchHandle*> HandleVector;
+
+		private:
+			/*! \brief distinct, aligned and non-zero host entries */
+			EntryVector _entries(unsigned int count);
+
+			/*! \brief the table is never more than half full */
+			bool _halfFull(const cuda::LaunchHandleMap& map);
+
+			bool _testSlot();
+			bool _testInsert();
+			bool _testCollisions();
+			bool _testGrowth();
+			bool _testClear();
+			bool doTest();
+
+		public:
+			TestLaunchHandleMap();
+
+		public:
+			unsigned int entries;
+	};
+
+	TestLaunchHandleMap::EntryVector TestLaunchHandleMap::_entries(
+		unsigned int count)
+	{
+		std::set<const void*> unique;
+		EntryVector result;
+
+		while(result.size() < count)
+		{
+			/* kernel stubs are at least 16 byte aligned */
+			uintptr_t address = ((uintptr_t)random() << 20 ^
+				(uintptr_t)random()) << 4;
+
+			if(address == 0 || !unique.insert((const void*)address).second)
+			{
+				continue;
+			}
+
+			result.push_back((const void*)address);
+		}
+
+		return result;
+	}
+
+	bool TestLaunchHandleMap::_halfFull(const cuda::LaunchHandleMap& map)
+	{
+		return 2 * map._size <= map._entries.size() &&
+			map._entries.size() == ((size_t)1 << map._bits);
+	}
+
+	bool TestLaunchHandleMap::_testSlot()
+	{
+		cuda::LaunchHandleMap map;
+
+		map.insert(_entries(1)[0]);
+
+		/* consecutive kernel stubs must not pile up in a few slots */
+		std::set<size_t> slots;
+		for(uintptr_t entry = 0x400000; entry < 0x400000 + 16 * 16;
+			entry += 16)
+		{
+			size_t slot = map._slot((const void*)entry);
+
+			if(slot >= map._entries.size())
+			{
+				status << "Slot " << slot << " of entry " << (void*)entry
+					<< " is outside of the " << map._entries.size()
+					<< " slots of the table.\n";
+				return false;
+			}
+
+			slots.insert(slot);
+		}
+
+		if(slots.size() < 8)
+		{
+			status << "16 consecutive entries only use " << slots.size()
+				<< " of " << map._entries.size() << " slots.\n";
+			return false;
+		}
+
+		status << "16 consecutive entries use " << slots.size() << " of "
+			<< map._entries.size() << " slots.\n";
+
+		return true;
+	}
+
+	bool TestLaunchHandleMap::_testInsert()
+	{
+		cuda::LaunchHandleMap map;
+
+		if(map.find(_entries(1)[0]) != 0)
+		{
+			status << "An empty map found an entry.\n";
+			return false;
+		}
+
+		EntryVector inserted = _entries(2 * entries);
+		EntryVector missing(inserted.begin() + entries, inserted.end());
+		inserted.resize(entries);
+
+		HandleVector handles;
+
+		for(EntryVector::const_iterator entry = inserted.begin();
+			entry != inserted.end(); ++entry)
+		{
+			cuda::LaunchHandle& handle = map.insert(*entry);
+
+			std::stringstream name;
+			name << *entry;
+			handle.kernelName = name.str();
+
+			handles.push_back(&handle);
+		}
+
+		if(map.size() != entries)
+		{
+			status << "The map holds " << map.size() << " handles after "
+				<< entries << " were inserted.\n";
+			return false;
+		}
+
+		for(unsigned int i = 0; i < entries; ++i)
+		{
+			/* a stale handle is resolved again in place */
+			if(map.find(inserted[i]) != handles[i] ||
+				&map.insert(inserted[i]) != handles[i])
+			{
+				status << "Entry " << inserted[i] << " did not find its "
+					<< "handle.\n";
+				return false;
+			}
+		}
+
+		if(map.size() != entries)
+		{
+			status << "Inserting existing entries changed the size to "
+				<< map.size() << ".\n";
+			return false;
+		}
+
+		for(EntryVector::const_iterator entry = missing.begin();
+			entry != missing.end(); ++entry)
+		{
+			if(map.find(*entry) != 0)
+			{
+				status << "Entry " << *entry << " was never inserted but "
+					<< "found a handle.\n";
+				return false;
+			}
+		}
+
+		status << "Found " << entries << " inserted entries, and none of "
+			<< missing.size() << " other ones.\n";
+
+		return true;
+	}
+
+	bool TestLaunchHandleMap::_testCollisions()
+	{
+		cuda::LaunchHandleMap map;
+
+		map.insert(_entries(1)[0]);
+
+		size_t last = map._entries.size() - 1;
+
+		/* entries of the last slot wrap around to the first ones */
+		EntryVector colliding;
+		while(colliding.size() < 4)
+		{
+			EntryVector candidates = _entries(64);
+
+			for(EntryVector::const_iterator entry = candidates.begin();
+				entry != candidates.end() && colliding.size() < 4; ++entry)
+			{
+				if(map._slot(*entry) == last && map.find(*entry) == 0)
+				{
+					colliding.push_back(*entry);
+				}
+			}
+		}
+
+		HandleVector handles;
+		for(EntryVector::const_iterator entry = colliding.begin();
+			entry != colliding.end(); ++entry)
+		{
+			handles.push_back(&map.insert(*entry));
+		}
+
+		if(map._entries.size() != last + 1)
+		{
+			status << "The table grew from " << last + 1 << " to "
+				<< map._entries.size() << " slots below half full.\n";
+			return false;
+		}
+
+		for(unsigned int i = 0; i < colliding.size(); ++i)
+		{
+			if(map.find(colliding[i]) != handles[i])
+			{
+				status << "Colliding entry " << i << " did not find its "
+					<< "handle.\n";
+				return false;
+			}
+		}
+
+		if(map._entries[0] == 0)
+		{
+			status << "Probing from the last slot did not wrap around.\n";
+			return false;
+		}
+
+		status << "Probed " << colliding.size() << " entries of the last "
+			<< "slot past the end of the table.\n";
+
+		return true;
+	}
+
+	bool TestLaunchHandleMap::_testGrowth()
+	{
+		cuda::LaunchHandleMap map;
+
+		EntryVector inserted = _entries(entries);
+		HandleVector handles;
+
+		size_t slots = 0;
+		unsigned int grown = 0;
+
+		for(unsigned int i = 0; i < entries; ++i)
+		{
+			cuda::LaunchHandle& handle = map.insert(inserted[i]);
+
+			handle.generation = i;
+			handle.probes.resize(1);
+			handle.probes[0].sampling.launches = i;
+
+			handles.push_back(&handle);
+
+			if(!_halfFull(map))
+			{
+				status << "The table has " << map._entries.size()
+					<< " slots for " << map.size() << " handles.\n";
+				return false;
+			}
+
+			if(map._entries.size() != slots)
+			{
+				slots = map._entries.size();
+				++grown;
+			}
+		}
+
+		/* running launches refer to the sampling state of their handle */
+		for(unsigned int i = 0; i < entries; ++i)
+		{
+			cuda::LaunchHandle* handle = map.find(inserted[i]);
+
+			if(handle != handles[i])
+			{
+				status << "The handle of entry " << i << " moved from "
+					<< handles[i] << " to " << handle << ".\n";
+				return false;
+			}
+
+			if(handle->generation != i ||
+				handle->probes[0].sampling.launches != i)
+			{
+				status << "The handle of entry " << i << " lost its "
+					<< "contents while the table grew.\n";
+				return false;
+			}
+		}
+
+		status << "Grew the table " << grown << " times to " << slots
+			<< " slots for " << entries << " handles.\n";
+
+		return true;
+	}
+
+	bool TestLaunchHandleMap::_testClear()
+	{
+		cuda::LaunchHandleMap map;
+
+		EntryVector inserted = _entries(entries);
+
+		for(EntryVector::const_iterator entry = inserted.begin();
+			entry != inserted.end(); ++entry)
+		{
+			map.insert(*entry);
+		}
+
+		map.clear();
+
+		if(map.size() != 0 || map.find(inserted[0]) != 0)
+		{
+			status << "A cleared map still found an entry.\n";
+			return false;
+		}
+
+		cuda::LaunchHandle& handle = map.insert(inserted[0]);
+
+		if(map.find(inserted[0]) != &handle || map.size() != 1)
+		{
+			status << "A cleared map could not be filled again.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TestLaunchHandleMap::doTest()
+	{
+		return _testSlot() && _testInsert() && _testCollisions()
+			&& _testGrowth() && _testClear();
+	}
+
+	TestLaunchHandleMap::TestLaunchHandleMap()
+	{
+		name = "TestLaunchHandleMap";
+
+		description = "Checks that consecutive kernel entries spread over ";
+		description += "the slots of the table, that random entries find ";
+		description += "the handle they were inserted with and others find ";
+		description += "none, that entries of the same slot are probed ";
+		description += "past each other and past the end of the table, and ";
+		description += "that handles keep their address and contents while ";
+		description += "the table grows and stays at most half full.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestLaunchHandleMap test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-e", "--entries", test.entries, 1000,
+		"Entries inserted into the map.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
@@ -24,6 +24,7 @@
 #include <hydrazine/interface/Exception.h>
 
 #include <fstream>
+#include <algorithm>
 
 using namespace hydrazine;
 
@@ -51,26 +52,26 @@ namespace instrumentation
         
     }
 
-    void BasicBlockInstrumentor::initialize() {
+    size_t BasicBlockInstrumentor::counterCount() {
         
-        counter = 0;
-
-        if(cudaMalloc((void **) &counter, 
-            (entries * kernelDataMap[kernelName] * threadBlocks * threads) 
-                * sizeof(size_t)) != cudaSuccess){
-            throw hydrazine::Exception( 
-            "Could not allocate sufficient memory on device (cudaMalloc failed)!" );
-        }
-        if(cudaMemset( counter, 0, 
-            (entries * kernelDataMap[kernelName] * threadBlocks * threads) * 
-            sizeof( size_t )) != cudaSuccess){
-            throw hydrazine::Exception( "cudaMemset failed!" );
+        if(counterPlacements != 0)
+        {
+            transforms::CounterPlacementMap::const_iterator placement = 
+                counterPlacements->find(kernelName);
+            if(placement != counterPlacements->end())
+                return std::max<size_t>(placement->second.counters(), 1);
         }
         
-        if(cudaMemcpyToSymbol(symbol.c_str(), &counter, sizeof(size_t *), 0, 
-            cudaMemcpyHostToDevice) != cudaSuccess) {
-            throw hydrazine::Exception( "cudaMemcpyToSymbol failed!");
-        }
+        return kernelDataMap[kernelName];
+    }
+
+    void BasicBlockInstrumentor::initialize() {
+        
+        counter = (size_t *)counterBuffer(
+            (entries * counterCount() * threadBlocks * threads) * 
+            sizeof( size_t ));
+        
+        setBaseAddress(counter);
     }
 
     std::string BasicBlockInstrumentor::specificationPath() {
@@ -83,12 +84,14 @@ namespace instrumentation
             {
                 resource = "resources/basicBlockExecutionCount.c";
                 _profile.type = EXECUTION_COUNT;
+                counterPlacements = optimizedCounterPlacement ? &placements : 0;
                 break;
             }
             case instructionCount:
             {
                 resource = "resources/threadInstructionCount.c";
                 _profile.type = INST_COUNT;
+                counterPlacements = 0;
                 break;
             }
             default:
@@ -100,19 +103,51 @@ namespace instrumentation
 
     void BasicBlockInstrumentor::extractResults(std::ostream *out) {
 
-        size_t *info = new size_t[(entries * kernelDataMap[kernelName] * 
+        size_t counters = counterCount();
+        size_t *info = new size_t[(entries * counters * 
             threadBlocks * threads)];
         if(counter) {
-            cudaMemcpy(info, counter, (entries * kernelDataMap[kernelName] * 
-                threadBlocks * threads) * sizeof( size_t ), cudaMemcpyDeviceToHost);
-            cudaFree(counter);
+            readCounterBuffer(info, (entries * counters * 
+                threadBlocks * threads) * sizeof( size_t ));
         }
 
         unsigned long instructionCount = 0;
         
+        transforms::CounterPlacementMap::const_iterator placement = 
+            placements.end();
+        if(counterPlacements != 0)
+            placement = placements.find(kernelName);
+        
         size_t j = 0;
-        for(j = 0; j < kernelDataMap[kernelName] * threads * threadBlocks; j++) {
-            instructionCount += info[j];
+        if(placement != placements.end()) {
+            
+            /* each thread owns basicBlockCount() consecutive counters, the
+                totals over all threads are enough since the block counts are
+                linear in the counter values */
+            transforms::CounterPlacement::CountVector totals(
+                placement->second.counters(), 0);
+            
+            if(!totals.empty()) {
+                for(j = 0; j < counters * threads * threadBlocks; j++) {
+                    totals[j % counters] += info[j];
+                }
+            }
+            
+            transforms::CounterPlacement::CountVector blocks = 
+                placement->second.reconstruct(totals, threads * threadBlocks);
+            
+            for(j = 0; j < blocks.size(); j++) {
+                if(placement->second.instrumentable(j))
+                    instructionCount += blocks[j];
+            }
+            
+            report("Rebuilt " << blocks.size() - 2 << " block counts of " 
+                << kernelName << " from " << totals.size() << " counters");
+        }
+        else {
+            for(j = 0; j < kernelDataMap[kernelName] * threads * threadBlocks; j++) {
+                instructionCount += info[j];
+            }
         }
 
         _profile.data.instruction_count = instructionCount;
@@ -124,6 +159,25 @@ namespace instrumentation
             
     }
 
+    PTXInstrumentor *BasicBlockInstrumentor::clone() const {
+        BasicBlockInstrumentor *copy = new BasicBlockInstrumentor(*this);
+        
+        if(copy->counterPlacements != 0)
+            copy->counterPlacements = &copy->placements;
+        
+        return copy;
+    }
+
+    void BasicBlockInstrumentor::synchronize(
+        const PTXInstrumentor & prototype, const std::string & kernelName) {
+        
+        PTXInstrumentor::synchronize(prototype, kernelName);
+        
+        synchronizeKernel(placements, 
+            static_cast<const BasicBlockInstrumentor &>(
+            prototype).placements, kernelName);
+    }
+
     BasicBlockInstrumentor::BasicBlockInstrumentor(){
         description = "Basic Block Execution Count Per Thread";        
     }
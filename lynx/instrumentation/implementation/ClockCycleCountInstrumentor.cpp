@@ -53,13 +53,11 @@ namespace instrumentation
 
     void ClockCycleCountInstrumentor::initialize() {
 
-        clock_sm_info = 0;
         report("threadBlocks: " << threadBlocks);
 
-        cudaMalloc((void **) &clock_sm_info, 2 * threadBlocks * sizeof(size_t));
-        cudaMemset( clock_sm_info, 0, 2 * threadBlocks * sizeof( size_t ));
-        cudaMemcpyToSymbol(symbol.c_str(), &clock_sm_info, sizeof(size_t *), 0, 
-            cudaMemcpyHostToDevice);
+        clock_sm_info = (size_t *)counterBuffer(
+            2 * threadBlocks * sizeof( size_t ));
+        setBaseAddress(clock_sm_info);
     }            
     
     std::string ClockCycleCountInstrumentor::specificationPath() 
@@ -72,46 +70,44 @@ namespace instrumentation
         size_t *info = new size_t[2 * threadBlocks];
         
         if(clock_sm_info) {
-            cudaMemcpy(info, clock_sm_info, 2 * threadBlocks * sizeof( size_t ), 
-                cudaMemcpyDeviceToHost);      
-            cudaFree(clock_sm_info);
+            readCounterBuffer(info, 2 * threadBlocks * sizeof( size_t ));
         }
 
         struct cudaDeviceProp properties;
-        cudaGetDeviceProperties(&properties, 0);
+        cudaGetDeviceProperties(&properties, device);
 
         std::vector<size_t> threadBlockInfo;
         threadBlockInfo.resize(2, 0);
 
         size_t smid = 0;
-        lynx::getKernelProfiler(kernelName)->processorToThreadBlockCount.clear();
-        lynx::getKernelProfiler(kernelName)->threadBlockToProcessor.clear();
-        lynx::getKernelProfiler(kernelName)->processorToClockCycles.clear();
+        lynx::getKernelProfiler(device, kernelName)->processorToThreadBlockCount.clear();
+        lynx::getKernelProfiler(device, kernelName)->threadBlockToProcessor.clear();
+        lynx::getKernelProfiler(device, kernelName)->processorToClockCycles.clear();
         
         for(size_t i = 0; i < threadBlocks; i++) {
             smid = info[i*2+1];
             threadBlockInfo[0] = info[i*2];
             threadBlockInfo[1] = smid;
-            lynx::getKernelProfiler(kernelName)->processorToThreadBlockCount[smid]++;
-            lynx::getKernelProfiler(kernelName)->processorToClockCycles[smid] += info[i*2];
-            lynx::getKernelProfiler(kernelName)->threadBlockToProcessor[i] = threadBlockInfo;        
+            lynx::getKernelProfiler(device, kernelName)->processorToThreadBlockCount[smid]++;
+            lynx::getKernelProfiler(device, kernelName)->processorToClockCycles[smid] += info[i*2];
+            lynx::getKernelProfiler(device, kernelName)->threadBlockToProcessor[i] = threadBlockInfo;        
         } 
 
         std::vector<double> clockCyclesPerSM;
         clockCyclesPerSM.clear();
 
         for(trace::Profiler::KernelProfiler::ProcessorToClockCyclesMap::
-            const_iterator it = lynx::getKernelProfiler(kernelName)->processorToClockCycles.begin();
-            it != lynx::getKernelProfiler(kernelName)->processorToClockCycles.end(); ++it) {
+            const_iterator it = lynx::getKernelProfiler(device, kernelName)->processorToClockCycles.begin();
+            it != lynx::getKernelProfiler(device, kernelName)->processorToClockCycles.end(); ++it) {
             clockCyclesPerSM.push_back(it->second);
         }
 
-        lynx::getKernelProfiler(kernelName)->runtime = 
+        lynx::getKernelProfiler(device, kernelName)->runtime = 
             *(std::max_element(clockCyclesPerSM.begin(), 
                 clockCyclesPerSM.end()))/properties.clockRate;
         
         _profile.type = KERNEL_RUNTIME;
-        _profile.data.kernel_runtime = lynx::getKernelProfiler(kernelName)->runtime;
+        _profile.data.kernel_runtime = lynx::getKernelProfiler(device, kernelName)->runtime;
         
         int err = sendKernelProfile(InstrumentationRuntime::Singleton.messageQueue);
         if(err < 0)
@@ -122,6 +118,10 @@ namespace instrumentation
      
     }
 
+    PTXInstrumentor *ClockCycleCountInstrumentor::clone() const {
+        return new ClockCycleCountInstrumentor(*this);
+    }
+
     ClockCycleCountInstrumentor::ClockCycleCountInstrumentor() {
         description = "Clock Cycles and SM (Processor) ID";
     }
@@ -15,6 +15,7 @@
 #include <lynx/instrumentation/interface/BasicBlockInstrumentor.h>
 #include <lynx/instrumentation/interface/ClockCycleCountInstrumentor.h>
 #include <lynx/instrumentation/interface/WarpInstrumentor.h>
+#include <lynx/instrumentation/interface/MemoryTraceInstrumentor.h>
 
 // Hydrazine includes
 #include <hydrazine/interface/Exception.h>
@@ -22,6 +23,7 @@
 #include <hydrazine/interface/json.h>
 
 #include <errno.h>
+#include <cstring>
 
 #ifdef REPORT_BASE
 #undef REPORT_BASE
@@ -33,11 +35,32 @@ namespace instrumentation
 {
 
     InstrumentationRuntime InstrumentationRuntime::Singleton;
+    
+    static void controlSignalHandler(int signal)
+    {
+        InstrumentationRuntime::Singleton.enabled = (signal == SIGUSR1);
+    }
 
-    InstrumentationRuntime::InstrumentationRuntime() : toggledActiveInstrumentor(false)
+    InstrumentationRuntime::InstrumentationRuntime() : toggledActiveInstrumentor(false),
+        enabled(configuration.enabled)
     {
         report("InstrumentationRuntime Constructor");
         
+        if(configuration.controlSignals)
+        {
+            report( "Installing instrumentation control signal handlers" );
+            
+            struct sigaction action;
+            std::memset(&action, 0, sizeof(action));
+            action.sa_handler = controlSignalHandler;
+            sigemptyset(&action.sa_mask);
+            action.sa_flags = SA_RESTART;
+            
+            if(sigaction(SIGUSR1, &action, 0) != 0 || 
+                sigaction(SIGUSR2, &action, 0) != 0)
+                report( "Failed to install control signal handlers" );
+        }
+        
         // Open a message queue for writing (sending data)
         messageQueue = mq_open (MSG_QUEUE, O_RDWR | O_NONBLOCK);
         if(messageQueue < 0)
@@ -69,8 +92,11 @@ namespace instrumentation
 	    if(configuration.branchDivergence)
 	    {
 	        report( "Creating branch divergence instrumentor" );
-	        lynx::addInstrumentor(new WarpInstrumentor(
-	        instrumentation::WarpInstrumentor::branchDivergence));
+	        WarpInstrumentor *instrumentor = new WarpInstrumentor(
+	            instrumentation::WarpInstrumentor::branchDivergence);
+	        instrumentor->divergenceGuidedBranches = 
+	            configuration.divergenceGuidedBranches;
+	        lynx::addInstrumentor(instrumentor);
 	    }
 	    
 	    if(configuration.activityFactor)
@@ -107,10 +133,39 @@ namespace instrumentation
 	        instrumentation::BasicBlockInstrumentor::executionCount));
 	    }
 	    
+	    if(configuration.memoryTrace)
+	    {
+	        report( "Creating memory trace instrumentor" );
+	        MemoryTraceInstrumentor *instrumentor = new MemoryTraceInstrumentor();
+	        instrumentor->capacity = configuration.memoryTraceCapacity;
+	        lynx::addInstrumentor(instrumentor);
+	    }
+	    
 	    for(PTXInstrumentorVector::iterator instrumentor = instrumentors.begin();
 	        instrumentor != instrumentors.end(); ++instrumentor)
 	    {
 	        (*instrumentor)->iterations = configuration.iterations;
+	        (*instrumentor)->samplingPeriod = configuration.samplingPeriod;
+	        (*instrumentor)->overheadBudget = configuration.overheadBudget;
+	        (*instrumentor)->autoDisable = configuration.autoDisable;
+	        (*instrumentor)->registerReuse = configuration.registerReuse;
+	        (*instrumentor)->maxExtraRegisters = 
+	            configuration.maxExtraRegisters;
+	        (*instrumentor)->hiddenParameter = configuration.hiddenParameter;
+	        (*instrumentor)->warpAggregatedAtomics = 
+	            configuration.warpAggregatedAtomics;
+	        (*instrumentor)->sharedCounterStaging = 
+	            configuration.sharedCounterStaging;
+	        (*instrumentor)->optimizedCounterPlacement = 
+	            configuration.optimizedCounterPlacement;
+	        (*instrumentor)->loopHoisting = configuration.loopHoisting;
+	        (*instrumentor)->optimizeInstrumentation = 
+	            configuration.optimizeInstrumentation;
+	        (*instrumentor)->shuffleUniqueElementCount = 
+	            configuration.shuffleUniqueElementCount;
+	        (*instrumentor)->memorySegmentSize = 
+	            configuration.memorySegmentSize;
+	        (*instrumentor)->analysisCache = &analysisCache;
 	        
 	        for(PTXInstrumentor::KernelVector::const_iterator kernel = 
 	            configuration.kernelsToInstrument.begin(); 
@@ -131,7 +186,26 @@ namespace instrumentation
     threadInstructionCount(false),
     warpInstructionCount(false),
     barrierCount(false),
-    basicBlockExecutionCount(false)
+    basicBlockExecutionCount(false),
+    memoryTrace(false),
+    samplingPeriod(0),
+    overheadBudget(0),
+    autoDisable(0),
+    registerReuse(false),
+    maxExtraRegisters(0),
+    hiddenParameter(false),
+    divergenceGuidedBranches(false),
+    warpAggregatedAtomics(true),
+    sharedCounterStaging(false),
+    optimizedCounterPlacement(false),
+    loopHoisting(false),
+    optimizeInstrumentation(true),
+    shuffleUniqueElementCount(false),
+    memorySegmentSize(64),
+    memoryTraceCapacity(1 << 16),
+    enabled(true),
+    controlSignals(false),
+    backgroundJIT(false)
     {
     
         std::ifstream stream("configure.lynx");
@@ -167,6 +241,34 @@ namespace instrumentation
                 }
         
                 iterations = instrumentConfig.parse<int>("iterations", -1);   
+                samplingPeriod = instrumentConfig.parse<int>("samplingPeriod", 0);
+                overheadBudget = instrumentConfig.parse<double>("overheadBudget", 0.0);
+                autoDisable = instrumentConfig.parse<double>("autoDisable", 0.0);
+                registerReuse = instrumentConfig.parse<bool>("registerReuse", false);
+                maxExtraRegisters = instrumentConfig.parse<int>("maxExtraRegisters", 0);
+                hiddenParameter = instrumentConfig.parse<bool>("hiddenParameter", false);
+                divergenceGuidedBranches = instrumentConfig.parse<bool>("divergenceGuidedBranches", false);
+                enabled = instrumentConfig.parse<bool>("enabled", true);
+                controlSignals = instrumentConfig.parse<bool>("controlSignals", false);
+                backgroundJIT = instrumentConfig.parse<bool>("backgroundJIT", false);
+                warpAggregatedAtomics = instrumentConfig.parse<bool>("warpAggregatedAtomics", true);
+                sharedCounterStaging = instrumentConfig.parse<bool>("sharedCounterStaging", false);
+                optimizedCounterPlacement = instrumentConfig.parse<bool>("optimizedCounterPlacement", false);
+                loopHoisting = instrumentConfig.parse<bool>("loopHoisting", false);
+                optimizeInstrumentation = instrumentConfig.parse<bool>("optimizeInstrumentation", true);
+                shuffleUniqueElementCount = instrumentConfig.parse<bool>("shuffleUniqueElementCount", false);
+                memorySegmentSize = instrumentConfig.parse<int>("memorySegmentSize", 64);
+                
+                if(memorySegmentSize != 32 && memorySegmentSize != 64 &&
+                    memorySegmentSize != 128)
+                {
+                    throw hydrazine::Exception("memorySegmentSize must be 32, 64 or 128 bytes.");
+                }
+                
+                memoryTraceCapacity = instrumentConfig.parse<int>("memoryTraceCapacity", 1 << 16);
+                
+                if(memoryTraceCapacity == 0)
+                    throw hydrazine::Exception("memoryTraceCapacity must be positive.");
 
                 clockCycleCount = instrumentConfig.parse<bool>("clockCycleCount", false);
                 memoryEfficiency = instrumentConfig.parse<bool>("memoryEfficiency", false);
@@ -176,6 +278,7 @@ namespace instrumentation
 		        barrierCount = instrumentConfig.parse<bool>("barrierCount", false);
 		        threadInstructionCount = instrumentConfig.parse<bool>("threadInstructionCount", false);
 		        basicBlockExecutionCount = instrumentConfig.parse<bool>("basicBlockExecutionCount", false);
+		        memoryTrace = instrumentConfig.parse<bool>("memoryTrace", false);
 		
 	        }
 	    } catch (std::exception exp) {
@@ -0,0 +1,238 @@
+/*! \file MemoryTraceInstrumentor.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the MemoryTraceInstrumentor class.
+*/
+
+#ifndef MEMORY_TRACE_INSTRUMENTOR_CPP_INCLUDED
+#define MEMORY_TRACE_INSTRUMENTOR_CPP_INCLUDED
+
+#include <lynx/instrumentation/interface/MemoryTraceInstrumentor.h>
+#include <lynx/transforms/interface/CToPTXModulePass.h>
+#include <lynx/translator/interface/CToPTXTranslator.h>
+
+#include <cuda_runtime.h>
+
+#include <ocelot/ir/interface/Module.h>
+
+#include <hydrazine/interface/debug.h>
+#include <hydrazine/interface/Exception.h>
+
+#include <cstring>
+#include <fstream>
+#include <sstream>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+namespace instrumentation
+{
+
+    bool MemoryTraceInstrumentor::validate() {
+        return true;
+    }
+
+    void MemoryTraceInstrumentor::analyze(ir::Module &module) {
+        /* No static analysis necessary for this instrumentation */
+	    report("MemoryTraceInstrumentor::analyze...");
+    }
+
+    std::string MemoryTraceInstrumentor::specificationPath()
+    {
+        return "";
+    }
+
+    void MemoryTraceInstrumentor::createPasses(std::string resource)
+    {
+        report("MemoryTraceInstrumentor::createPasses...");
+
+        transforms::MemoryTracePass *pass = new transforms::MemoryTracePass();
+        pass->instructions = &instructions;
+
+        ir::PTXStatement global(ir::PTXStatement::Global);
+        global.name = GLOBAL_MEM_BASE_ADDRESS;
+        global.type = ir::PTXOperand::u64;
+
+        transforms::CToPTXModulePass *modulePass =
+            new transforms::CToPTXModulePass(MEMORY_TRACE_RESERVE,
+            ir::PTXKernel::PTXStatementVector(1, global));
+        modulePass->instrumentationPass = pass->name;
+
+        passes[0] = pass;
+        passes[1] = modulePass;
+    }
+
+    void MemoryTraceInstrumentor::initialize() {
+
+        /* a launch that was never finalized */
+        if(_drain)
+            extractResults(0);
+
+        /* the ring lives in mapped host memory so that it can be drained
+            while the kernel runs, it is kept across launches */
+        if(!_records)
+        {
+            void *records = 0;
+            void *tail = 0;
+
+            if(cudaHostAlloc(&records, capacity * sizeof(trace::MemoryTraceRecord),
+                cudaHostAllocMapped) != cudaSuccess ||
+                cudaHostAlloc(&tail, sizeof(unsigned long long),
+                cudaHostAllocMapped) != cudaSuccess)
+            {
+                throw hydrazine::Exception(
+                    "Could not allocate the memory trace ring (cudaHostAlloc failed)");
+            }
+
+            _records = (trace::MemoryTraceRecord *)records;
+            _tail = (volatile unsigned long long *)tail;
+
+            if(cudaMalloc((void **) &_header, sizeof(trace::MemoryTraceBuffer))
+                != cudaSuccess) {
+                throw hydrazine::Exception(
+                    "Could not allocate sufficient memory on device (cudaMalloc failed)");
+            }
+        }
+
+        void *records = 0;
+        void *tail = 0;
+
+        if(cudaHostGetDevicePointer(&records, _records, 0) != cudaSuccess ||
+            cudaHostGetDevicePointer(&tail, (void *)_tail, 0) != cudaSuccess) {
+            throw hydrazine::Exception( "cudaHostGetDevicePointer failed!" );
+        }
+
+        /* records a previous launch lost must not look ready */
+        std::memset(_records, 0, capacity * sizeof(trace::MemoryTraceRecord));
+        *_tail = 0;
+
+        trace::MemoryTraceBuffer header;
+        header.head = 0;
+        header.capacity = capacity;
+        header.records = (unsigned long long)records;
+        header.tail = (unsigned long long)tail;
+        header.dropped = 0;
+
+        if(cudaMemcpy(_header, &header, sizeof(header),
+            cudaMemcpyHostToDevice) != cudaSuccess) {
+            throw hydrazine::Exception( "cudaMemcpy failed!" );
+        }
+
+        setBaseAddress(_header);
+
+        std::stringstream path;
+        path << kernelName << "." << launch << ".memtrace";
+        _path = path.str();
+
+        report("tracing " << kernelName << " into " << _path);
+
+        _writer = new trace::MemoryTraceWriter(_path);
+        _drain = new trace::MemoryTraceDrain(_records, _tail, capacity,
+            *_writer);
+        _drain->start();
+    }
+
+    void MemoryTraceInstrumentor::extractResults(std::ostream *out) {
+
+        if(!_drain)
+            return;
+
+        /* waits for the kernel, after which every reservation is final */
+        trace::MemoryTraceBuffer header;
+        std::memset(&header, 0, sizeof(header));
+
+        if(cudaMemcpy(&header, _header, sizeof(header),
+            cudaMemcpyDeviceToHost) != cudaSuccess) {
+            report("Unable to read the memory trace header");
+        }
+
+        unsigned long long missing = _drain->stop(header.head);
+        unsigned long long records = _writer->records();
+
+        delete _drain;
+        delete _writer;
+        _drain = 0;
+        _writer = 0;
+
+        writeInstructions(_path + ".instructions");
+
+        if(out)
+        {
+            *out << "\n\nKernel Name: " << kernelName << "\n";
+            *out << "Memory trace: " << records << " warp accesses in "
+                << _path << "\n";
+
+            if(missing)
+                *out << "Memory trace: " << missing << " records lost\n";
+            if(header.dropped)
+                *out << "Memory trace: " << header.dropped
+                    << " records dropped on a full ring\n";
+        }
+    }
+
+    void MemoryTraceInstrumentor::writeInstructions(const std::string & path)
+    {
+        transforms::MemoryTracePass::KernelInstructionMap::const_iterator
+            kernel = instructions.find(kernelName);
+
+        if(kernel == instructions.end())
+            return;
+
+        std::ofstream file(path.c_str());
+
+        for(transforms::MemoryTracePass::InstructionMap::const_iterator
+            instruction = kernel->second.begin();
+            instruction != kernel->second.end(); ++instruction)
+        {
+            file << instruction->first << ": " << instruction->second << "\n";
+        }
+    }
+
+    PTXInstrumentor *MemoryTraceInstrumentor::clone() const
+    {
+        MemoryTraceInstrumentor *copy = new MemoryTraceInstrumentor(*this);
+
+        copy->_header = 0;
+        copy->_records = 0;
+        copy->_tail = 0;
+        copy->_writer = 0;
+        copy->_drain = 0;
+
+        return copy;
+    }
+
+    void MemoryTraceInstrumentor::synchronize(
+        const PTXInstrumentor & prototype, const std::string & kernelName)
+    {
+        PTXInstrumentor::synchronize(prototype, kernelName);
+
+        synchronizeKernel(instructions, 
+            static_cast<const MemoryTraceInstrumentor &>(
+            prototype).instructions, kernelName);
+    }
+
+    MemoryTraceInstrumentor::MemoryTraceInstrumentor() : capacity(1 << 16),
+        _header(0), _records(0), _tail(0), _writer(0), _drain(0)
+    {
+        description = "Memory Trace";
+    }
+
+    MemoryTraceInstrumentor::~MemoryTraceInstrumentor()
+    {
+        delete _drain;
+        delete _writer;
+
+        if(_records)
+        {
+            cudaFreeHost(_records);
+            cudaFreeHost((void *)_tail);
+            cudaFree(_header);
+        }
+    }
+
+}
+
+#endif
@@ -15,13 +15,19 @@
 #include <cuda_runtime.h>
 
 #include <ocelot/transforms/interface/PassManager.h>
+#include <ocelot/transforms/interface/AnalysisCache.h>
 #include <ocelot/ir/interface/Module.h>
 
 #include <hydrazine/interface/Exception.h>
 #include <hydrazine/interface/json.h>
 
+#include <boost/thread/mutex.hpp>
+#include <boost/thread/locks.hpp>
+
 #include <fstream>
+#include <iostream>
 #include <cstring>
+#include <algorithm>
 #include <unistd.h>
 
 #define MQ_DFT_PRIO 0
@@ -36,13 +42,42 @@
 namespace instrumentation
 {
 
+    /* the translator is shared by all instrumentors, which may instrument 
+        modules on several threads */
+    static boost::mutex translatorMutex;
+
+    static translator::CToPTXData translate(const std::string & resource,
+        bool warpAggregatedAtomics, bool shuffleUniqueElementCount, 
+        unsigned int memorySegmentSize)
+    {
+        boost::lock_guard<boost::mutex> lock(translatorMutex);
+        
+	    translator::CToPTXTranslator::translator().warpAggregatedAtomics = 
+	        warpAggregatedAtomics;
+	    translator::CToPTXTranslator::translator().shuffleUniqueElementCount = 
+	        shuffleUniqueElementCount;
+	    translator::CToPTXTranslator::translator().segmentSize = 
+	        memorySegmentSize;
+        
+        return translator::CToPTXTranslator::translator().generate(resource);
+    }
+
     void PTXInstrumentor::createPasses(std::string resource) 
     {
 	    report("PTXInstrumentor::createPasses...");
-        translator::CToPTXData translation = 
-            translator::CToPTXTranslator::translator().generate(resource);
+        translator::CToPTXData translation = translate(resource, 
+            warpAggregatedAtomics, shuffleUniqueElementCount, 
+            memorySegmentSize);
         transforms::CToPTXInstrumentationPass *pass = 
             new transforms::CToPTXInstrumentationPass(translation);
+        pass->sharedCounterStaging = sharedCounterStaging;
+        pass->counterPlacements = counterPlacements;
+        pass->loopHoisting = loopHoisting;
+        pass->optimizeInstrumentation = optimizeInstrumentation;
+        pass->uniformBranches = divergenceGuidedBranches ? 
+            &uniformBranches : 0;
+        pass->stagingBranches = sharedCounterStaging ? 
+            &uniformBranches : 0;
         
         std::string function;
         
@@ -57,6 +92,13 @@ namespace instrumentation
                 function = UNIQUE_ELEMENT_COUNT;
                 break;
             }
+            
+            if((statement->toString()).find(UNIQUE_SEGMENT_COUNT) 
+                != std::string::npos)
+            {
+                function = UNIQUE_SEGMENT_COUNT;
+                break;
+            }
         }    
         
         transforms::CToPTXModulePass *modulePass = 
@@ -68,23 +110,326 @@ namespace instrumentation
     }
 
 
+    static void estimateCosts(ir::Module& module, 
+        transforms::KernelCostMap& costs, transforms::AnalysisCache *cache)
+    {
+        transforms::PassManager manager( &module );
+        manager.setAnalysisCache( cache );
+        transforms::OverheadEstimationPass pass;
+        pass.costs = &costs;
+        
+        manager.addPass( &pass );
+        manager.runOnModule();
+        manager.releasePasses();
+    }
+
     void PTXInstrumentor::instrument(ir::Module& module) {
 
 	    report("PTXInstrumentor::instrument...");
+	    
+        bool registers = registerReuse || maxExtraRegisters > 0;
+        
+        /* analyses of the original kernels are shared by all the pass 
+            managers below until the instrumentation changes the kernels */
+        transforms::AnalysisCache moduleCache;
+        transforms::AnalysisCache *cache = analysisCache ? analysisCache : 
+            &moduleCache;
+	    
+        transforms::KernelCostMap originalCosts;
+        if(autoDisable > 0 || registers)
+            estimateCosts(module, originalCosts, cache);
+        
+        for(transforms::KernelCostMap::const_iterator 
+            kernel = originalCosts.begin(); 
+            kernel != originalCosts.end(); ++kernel)
+        {
+            disabledKernels.erase(kernel->first);
+        }
+	    
         transforms::PassManager manager( &module );
-       report("PTXInstrumentor::instrument...transforms::PassManager manager()"); 
+        manager.setAnalysisCache( cache );
         createPasses(specificationPath());
-	    report("PTXInstrumentor::instrument...createPasses()");
+	    
+        /* divergence analysis leaves the dataflow graph in gated SSA form, 
+            it is run on its own before the instrumentation passes */
+        if(divergenceGuidedBranches || sharedCounterStaging)
+            analyzeBranches(module, cache);
+        
         for(PassMap::iterator pass = passes.begin(); pass != passes.end(); ++pass)
         {
             if(pass->second != NULL)
                 manager.addPass( pass->second ); 
-	    report("PTXInstrumentor::instrument...manager.addPass()");
         }
-	    manager.runOnModule();
-	    report("PTXInstrumentor::instrument...manager.runOnModule()");
+        manager.runOnModule();
         manager.releasePasses();  
-	    report("PTXInstrumentor::instrument...manager.releasePasses()");
+	    
+        if(hiddenParameter)
+        {
+            transforms::PassManager parameterManager( &module );
+            parameterManager.setAnalysisCache( cache );
+            transforms::HiddenParameterPass parameterPass;
+            parameterPass.kernels = &parameterKernels;
+            
+            parameterManager.addPass( &parameterPass );
+            parameterManager.runOnModule();
+            parameterManager.releasePasses();
+        }
+	    
+        if(registers)
+            reuseRegisters(module, originalCosts, cache);
+	    
+        if(autoDisable > 0)
+            estimateOverhead(module, originalCosts, cache);
+        
+        report("Reused " << cache->hits << " analyses, computed " 
+            << cache->misses);
+        
+        revision++;
+        
+        for(ir::Module::KernelMap::const_iterator 
+            kernel = module.kernels().begin(); 
+            kernel != module.kernels().end(); ++kernel)
+        {
+            kernelRevisions[kernel->first] = revision;
+        }
+    }
+
+    PTXInstrumentor *PTXInstrumentor::instance(int device, 
+        const void *stream, const std::string & kernelName) {
+        
+        /* threads launching on the same device and stream set up their
+            own buffers and times */
+        InstanceKey key(device, stream, boost::this_thread::get_id());
+        
+        InstanceMap::iterator instance = instances.find(key);
+        
+        if(instance == instances.end())
+        {
+            report("creating instance for device " << device << ", stream " 
+                << stream << ", thread " << std::get<2>(key));
+            
+            PTXInstrumentor *copy = clone();
+            
+            copy->out = NULL;
+            copy->instances.clear();
+            copy->device = device;
+            copy->stream = stream;
+            copy->thread = std::get<2>(key);
+            copy->timer = new trace::LaunchTimer;
+            copy->buffer = 0;
+            copy->bufferSize = 0;
+            
+            instance = instances.insert(std::make_pair(key, copy)).first;
+        }
+        
+        /* only the results of the launched kernel are copied, and only 
+            when its module was instrumented again */
+        KernelRevisionMap::const_iterator current = 
+            kernelRevisions.find(kernelName);
+        
+        if(current != kernelRevisions.end())
+        {
+            unsigned int & copied = 
+                instance->second->kernelRevisions[kernelName];
+            
+            if(copied != current->second)
+            {
+                instance->second->synchronize(*this, kernelName);
+                copied = current->second;
+            }
+        }
+        
+        return instance->second;
+    }
+
+    void PTXInstrumentor::collectLaunches(int device, bool wait) {
+    
+        for(InstanceMap::iterator instance = instances.begin(); 
+            instance != instances.end(); ++instance)
+        {
+            if(std::get<0>(instance->first) == device)
+                instance->second->timer->collect(wait);
+        }
+    }
+
+    void PTXInstrumentor::synchronize(const PTXInstrumentor & prototype,
+        const std::string & kernelName) {
+    
+        synchronizeKernel(kernelLabelsMap, prototype.kernelLabelsMap, 
+            kernelName);
+        synchronizeKernel(kernelDataMap, prototype.kernelDataMap, kernelName);
+        synchronizeKernel(kernelBasicBlocks, prototype.kernelBasicBlocks, 
+            kernelName);
+        synchronizeKernel(parameterKernels, prototype.parameterKernels, 
+            kernelName);
+        synchronizeKernel(disabledKernels, prototype.disabledKernels, 
+            kernelName);
+        synchronizeKernel(uniformBranches, prototype.uniformBranches, 
+            kernelName);
+    }
+
+    void PTXInstrumentor::synchronizeKernel(KernelSet & set, 
+        const KernelSet & prototype, const std::string & kernelName) {
+        
+        if(prototype.count(kernelName) != 0)
+            set.insert(kernelName);
+        else
+            set.erase(kernelName);
+    }
+
+    void PTXInstrumentor::setBaseAddress(const void *address) {
+    
+        if(parameterKernels.count(kernelName) != 0)
+        {
+            baseAddress = address;
+            return;
+        }
+        
+        baseAddress = 0;
+        
+        if(cudaMemcpyToSymbol(symbol.c_str(), &address, sizeof(void *), 0, 
+            cudaMemcpyHostToDevice) != cudaSuccess) {
+            throw hydrazine::Exception( "cudaMemcpyToSymbol failed!");
+        }
+    }
+
+    void *PTXInstrumentor::counterBuffer(size_t bytes) {
+    
+        if(bytes > bufferSize)
+        {
+            /* the launches of an instance are ordered on its stream */
+            if(buffer)
+                cudaFree(buffer);
+            
+            buffer = 0;
+            bufferSize = 0;
+            
+            if(cudaMalloc(&buffer, bytes) != cudaSuccess) {
+                buffer = 0;
+                throw hydrazine::Exception(
+                "Could not allocate sufficient memory on device (cudaMalloc failed)");
+            }
+            
+            bufferSize = bytes;
+        }
+        
+        if(cudaMemsetAsync(buffer, 0, bytes, (cudaStream_t)stream) 
+            != cudaSuccess) {
+            throw hydrazine::Exception( "cudaMemsetAsync failed!" );
+        }
+        
+        return buffer;
+    }
+    
+    void PTXInstrumentor::readCounterBuffer(void *host, size_t bytes) {
+    
+        if(cudaMemcpyAsync(host, buffer, bytes, cudaMemcpyDeviceToHost, 
+            (cudaStream_t)stream) != cudaSuccess ||
+            cudaStreamSynchronize((cudaStream_t)stream) != cudaSuccess) {
+            throw hydrazine::Exception( "cudaMemcpyAsync failed!" );
+        }
+    }
+
+    void PTXInstrumentor::reuseRegisters(ir::Module& module, 
+        const transforms::KernelCostMap& originalCosts, 
+        transforms::AnalysisCache *cache) {
+        
+        transforms::PassManager manager( &module );
+        manager.setAnalysisCache( cache );
+        transforms::RegisterReusePass pass;
+        pass.original = &originalCosts;
+        pass.reuse = registerReuse;
+        pass.usage = &registerUsage;
+        
+        manager.addPass( &pass );
+        manager.runOnModule();
+        manager.releasePasses();
+        
+        for(transforms::KernelCostMap::const_iterator 
+            original = originalCosts.begin(); 
+            original != originalCosts.end(); ++original)
+        {
+            transforms::RegisterUsageMap::const_iterator usage = 
+                registerUsage.find(original->first);
+            if(usage == registerUsage.end())
+                continue;
+            
+            report("Kernel " << original->first << ": " 
+                << usage->second.toString());
+            
+            if(maxExtraRegisters > 0 && 
+                usage->second.extraRegisters() > (int)maxExtraRegisters)
+            {
+                disabledKernels.insert(original->first);
+                
+                std::cerr << "==LYNX== WARNING: Not instrumenting kernel '" 
+                    << original->first << "', " << usage->second.toString() 
+                    << " (maxExtraRegisters is " << maxExtraRegisters 
+                    << ").\n";
+            }
+        }
+    }
+
+    void PTXInstrumentor::analyzeBranches(ir::Module& module, 
+        transforms::AnalysisCache *cache) {
+        
+        transforms::PassManager manager( &module );
+        manager.setAnalysisCache( cache );
+        transforms::UniformBranchPass pass;
+        pass.branches = &uniformBranches;
+        
+        manager.addPass( &pass );
+        manager.runOnModule();
+        manager.releasePasses();
+        
+        for(transforms::UniformBranchMap::const_iterator 
+            kernel = uniformBranches.begin(); 
+            kernel != uniformBranches.end(); ++kernel)
+        {
+            report("Kernel " << kernel->first << ": " 
+                << kernel->second.labels.size() << " of " 
+                << kernel->second.branches 
+                << " branches are statically uniform");
+        }
+    }
+
+    void PTXInstrumentor::estimateOverhead(ir::Module& module, 
+        const transforms::KernelCostMap& originalCosts, 
+        transforms::AnalysisCache *cache) {
+        
+        transforms::KernelCostMap instrumentedCosts;
+        estimateCosts(module, instrumentedCosts, cache);
+        
+        for(transforms::KernelCostMap::const_iterator 
+            original = originalCosts.begin(); 
+            original != originalCosts.end(); ++original)
+        {
+            transforms::KernelCostMap::const_iterator instrumented = 
+                instrumentedCosts.find(original->first);
+            if(instrumented == instrumentedCosts.end())
+                continue;
+            
+            KernelBlockWeightMap::const_iterator weights = 
+                blockWeights.find(original->first);
+            
+            transforms::OverheadEstimate estimate(original->second, 
+                instrumented->second, 
+                weights == blockWeights.end() ? 0 : &weights->second);
+            
+            overheadEstimates[original->first] = estimate;
+            
+            report("Kernel " << original->first << ": " 
+                << estimate.toString());
+            
+            if(estimate.slowdown > autoDisable)
+            {
+                disabledKernels.insert(original->first);
+                
+                std::cerr << "==LYNX== WARNING: Not instrumenting kernel '" 
+                    << original->first << "', " << estimate.toString() 
+                    << " (autoDisable is " << autoDisable << ").\n";
+            }
+        }
     }
 
     void PTXInstrumentor::finalize() {
@@ -136,8 +481,12 @@ namespace instrumentation
             return;
         }
 
+        int ordinal = device;
+        if(ordinal < 0)
+            cudaGetDevice(&ordinal);
+
         struct cudaDeviceProp properties;
-        cudaGetDeviceProperties(&properties, 0);
+        cudaGetDeviceProperties(&properties, ordinal);
     
         *out << "DEVICE INFO:\n\n";
         *out << "Multiprocessor Count: " << properties.multiProcessorCount << "\n"; 
@@ -167,7 +516,9 @@ namespace instrumentation
         
         _profile.pid = getpid();
        
-	cudaGetDevice(&_profile.device);
+        _profile.device = device;
+        if(device < 0)
+            cudaGetDevice(&_profile.device);
  
         int len = kernelName.size() > MAX_KERNEL_NAME_SIZE - 1 
             ? MAX_KERNEL_NAME_SIZE - 1 : kernelName.size();
@@ -195,7 +546,7 @@ namespace instrumentation
         return err;
     }
     
-    bool PTXInstrumentor::conditionsMet()
+    bool PTXInstrumentor::conditionsMet(const std::string & kernelName)
     {
         bool conditionsMet = false;
     
@@ -216,37 +567,86 @@ namespace instrumentation
             }
         }
 
-        
-
         if(conditionsMet)
+            return validate();
+
+        return false;
+    }
+
+    bool PTXInstrumentor::sampleLaunch(SamplingState & state, bool disabled,
+        unsigned long & launch, trace::LaunchTime *& time) const
+    {
+        bool sampled = true;
+        launch = state.launches++;
+
+        report("launch: " << launch << ", iterations: " << iterations);
+
+        if(disabled)
         {
-            report("kernelName: " << kernelName << ", iterations: " << iterations );
-            if(iterations == 0) {
-                conditionsMet = false;
+            report("estimated overhead or registers over the limit");
+            sampled = false;
+        }
+        else if(iterations == 0 || (iterations > 0 && 
+            state.sampledLaunches >= (unsigned long)iterations))
+        {
+            report("iterations condition failed");
+            sampled = false;
+        }
+        else if(samplingPeriod > 1 && launch % samplingPeriod != 0)
+        {
+            sampled = false;
+        }
+        else if(overheadBudget > 0 && state.sampledLaunches > 0)
+        {
+            unsigned long originalLaunches = launch - state.sampledLaunches;
+            
+            /* the overhead of instrumentation is estimated once an 
+                uninstrumented and an instrumented launch have finished */
+            if(originalLaunches == 0 || state.original.launches == 0 ||
+                state.instrumented.launches == 0)
+            {
+                sampled = false;
             }
-            else if(iterations > 0 && !kernelName.empty()){
-                KernelDataMap::iterator kernelData = kernelDataMap.find(kernelName);
-                if(kernelData == kernelDataMap.end())
-                {
-                    kernelDataMap.insert(std::make_pair(kernelName, 0));
-                }
-                else if(kernelData->second >= iterations){
-                    report("iterations condition failed");
-                    conditionsMet = false;
-                }
-                (kernelDataMap.find(kernelName)->second)++;
+            else
+            {
+                double originalMean = state.original.mean();
+                double instrumentedMean = state.instrumented.mean();
+                
+                /* launches that are still running count at the mean time
+                    of their variant */
+                double cost = std::max(instrumentedMean - originalMean, 0.0);
+                double overhead = cost * state.sampledLaunches;
+                double total = originalMean * originalLaunches + 
+                    instrumentedMean * state.sampledLaunches;
+            
+                sampled = (overhead + cost) <= 
+                    overheadBudget * (total + instrumentedMean);
+                
+                report("overhead: " << overhead << ", budget: " 
+                    << overheadBudget * (total + instrumentedMean));
             }
         }
-       
-        if(conditionsMet)
-            return validate();
-
-        return false;
+        
+        if(sampled)
+            state.sampledLaunches++;
+        
+        time = sampled ? &state.instrumented : &state.original;
+        
+        return sampled;
     }
 
     PTXInstrumentor::PTXInstrumentor() : description(""),
         symbol(GLOBAL_MEM_BASE_ADDRESS), on(false), fmt(text), 
-        deviceInfoWritten(false), sharedMemSize(0), iterations(-1)
+        deviceInfoWritten(false), sharedMemSize(0), iterations(-1),
+        samplingPeriod(0), overheadBudget(0), warpAggregatedAtomics(true),
+        sharedCounterStaging(false), optimizedCounterPlacement(false),
+        counterPlacements(0), loopHoisting(false),
+        optimizeInstrumentation(true), shuffleUniqueElementCount(false),
+        memorySegmentSize(64), autoDisable(0), registerReuse(false), 
+        maxExtraRegisters(0), hiddenParameter(false), baseAddress(0), 
+        buffer(0), bufferSize(0), divergenceGuidedBranches(false), 
+        analysisCache(0), sampled(false), device(-1), stream(0), timer(0), 
+        launch(0), revision(0)
     {
         out = NULL;
     }
@@ -255,6 +655,18 @@ namespace instrumentation
         if(out != &std::cout && out != NULL){
             delete out;
         }
+        
+        for(InstanceMap::iterator instance = instances.begin(); 
+            instance != instances.end(); ++instance)
+        {
+            delete instance->second;
+        }
+        
+        delete timer;
+        
+        /* the context may already be gone at exit */
+        if(buffer)
+            cudaFree(buffer);
     }
 
 }
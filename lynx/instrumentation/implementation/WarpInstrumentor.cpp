@@ -49,26 +49,26 @@ namespace instrumentation
     void WarpInstrumentor::initialize() {
         
         counter = 0;
+        uniformCounters = 0;
 
         warpCount = (threads * threadBlocks)/32;
         
         if(warpCount == 0)
             warpCount = 1;
 
-        unsigned long size = entries * warpCount;
+        /* no code is inserted at uniform branches, the warps taking them 
+            are counted per branch */
+        transforms::UniformBranchMap::const_iterator branches = 
+            uniformBranches.find(kernelName);
+        if(type == branchDivergence && divergenceGuidedBranches && 
+            branches != uniformBranches.end())
+            uniformCounters = branches->second.labels.size();
+
+        unsigned long size = uniformCounters + entries * warpCount;
         
-        if(cudaMalloc((void **) &counter, size * sizeof(size_t)) != cudaSuccess){
-            throw hydrazine::Exception(
-            "Could not allocate sufficient memory on device (cudaMalloc failed)");
-        }
-        if(cudaMemset( counter, 0, size * sizeof(size_t)) != cudaSuccess){
-            throw hydrazine::Exception( "cudaMemset failed!" );
-        }
+        counter = (size_t *)counterBuffer(size * sizeof(size_t));
         
-        if(cudaMemcpyToSymbol(symbol.c_str(), &counter, sizeof(size_t *), 0, 
-            cudaMemcpyHostToDevice) != cudaSuccess) {
-            throw hydrazine::Exception( "cudaMemcpyToSymbol failed!");
-        }
+        setBaseAddress(counter + uniformCounters);
     }
 
     std::string WarpInstrumentor::specificationPath() {
@@ -125,14 +125,14 @@ namespace instrumentation
 
     void WarpInstrumentor::extractResults(std::ostream *out) {
 
-        unsigned long size = entries * warpCount;
+        unsigned long size = uniformCounters + entries * warpCount;
         
-        size_t *info = new size_t[size];
+        size_t *uniform = new size_t[size];
         if(counter) {
-            cudaMemcpy(info, counter, size * sizeof( size_t ), 
-                cudaMemcpyDeviceToHost);
-            cudaFree(counter);
+            readCounterBuffer(uniform, size * sizeof( size_t ));
         }
+        
+        size_t *info = uniform + uniformCounters;
 
         switch(type)
         {
@@ -151,11 +151,11 @@ namespace instrumentation
 
                 unsigned int dynamicHalfWarps = dynamicWarps * 2;
                 
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::GLOBAL_MEM_TRANSACTIONS,
                     memTransactions);
                     
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::DYNAMIC_HALF_WARPS_EXEC_MEM_TRANSACTIONS,
                     dynamicWarps); 
                 
@@ -174,13 +174,29 @@ namespace instrumentation
                     divergentBranches += info[i * entries];
                     totalBranches += info[i * entries + 1];
                 }
+                
+                /* uniform branches are taken, never divergently, by the 
+                    warps counted in front of the entries */
+                for(unsigned int i = 0; i < uniformCounters; i++)
+                    totalBranches += uniform[i];
             
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::BRANCHES, 
                     totalBranches);
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::DIVERGENT_BRANCHES, 
                     divergentBranches);
+                
+                if(uniformCounters != 0)
+                {
+                    lynx::getProfiler()->device(device).kernelProfiler(
+                        kernelName)->uniformBranches = uniformCounters;
+                    
+                    report("Kernel " << kernelName << ": " 
+                        << uniformCounters << " of " 
+                        << uniformBranches[kernelName].branches 
+                        << " conditional branches statically uniform");
+                }
             
                 _profile.data.branch_divergence = ((double)divergentBranches/
                     (double)totalBranches) * 100;
@@ -203,11 +219,11 @@ namespace instrumentation
                 report("activeThreads: " << activeThreads << 
                     ", maxThreads: " << maximumThreads);
                 
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::MAX_THREADS,
                         maximumThreads);
             
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::ACTIVE_THREADS,
                         activeThreads);            
             }
@@ -218,7 +234,7 @@ namespace instrumentation
                 for(unsigned int i = 0; i < warpCount; i++)
                     instructionCount += info[i];
                 
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::INST_COUNT, 
                     instructionCount);
                 
@@ -231,7 +247,7 @@ namespace instrumentation
                 for(unsigned int i = 0; i < warpCount; i++)
                     instructionCount += info[i];
                 
-                lynx::getProfiler()->updateCounter(kernelName, 
+                lynx::getProfiler()->device(device).updateCounter(kernelName, 
                     trace::Profiler::KernelProfiler::BARRIERS, 
                     instructionCount);
             
@@ -241,18 +257,21 @@ namespace instrumentation
 
         sendKernelProfile(InstrumentationRuntime::Singleton.messageQueue);
 
-        if(info)
-            delete[] info;
+        delete[] uniform;
             
     }
 
-    WarpInstrumentor::WarpInstrumentor() : entries(2)
+    PTXInstrumentor *WarpInstrumentor::clone() const {
+        return new WarpInstrumentor(*this);
+    }
+
+    WarpInstrumentor::WarpInstrumentor() : entries(2), uniformCounters(0)
     {
         description = "Warp Instrumentor";
     }
     
     WarpInstrumentor::WarpInstrumentor(InstrumentationType type) 
-    : type(type), entries(2)
+    : type(type), entries(2), uniformCounters(0)
     {
         description = "Warp Instrumentor";
     }
@@ -35,6 +35,9 @@ namespace instrumentation
             
             /*! \brief type of basic block instrumentation */
             BasicBlockInstrumentationType type;
+
+            /*! \brief chord counter placement of each instrumented kernel */
+            transforms::CounterPlacementMap placements;
 			
 		public:
 			/*! \brief The default constructor */
@@ -58,6 +61,19 @@ namespace instrumentation
 
             /*! \brief extracts results for the instrumentation */
             void extractResults(std::ostream *out);
+
+            /*! \brief A copy that allocates its own buffers */
+            PTXInstrumentor *clone() const;
+
+            /*! \brief Copies the counter placement of a kernel along with 
+                its analysis */
+            void synchronize(const PTXInstrumentor & prototype,
+                const std::string & kernelName);
+
+        private:
+            /*! \brief The number of counters per thread of the current 
+                kernel */
+            size_t counterCount();
 	};
 
 }
@@ -43,6 +43,9 @@ namespace instrumentation
             /*! \brief extracts results for the basic block execution count instrumentation */
             void extractResults(std::ostream *out);
 
+            /*! \brief A copy that allocates its own buffers */
+            PTXInstrumentor *clone() const;
+
         private:
             bool pred(const std::pair<size_t, size_t>& lhs, const std::pair<size_t, size_t>& rhs);
 	};
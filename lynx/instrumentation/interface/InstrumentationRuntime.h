@@ -13,8 +13,10 @@
 #include <lynx/trace/interface/Profiler.h>
 
 #include <boost/thread/thread.hpp>
+#include <boost/thread/recursive_mutex.hpp>
 
 #include <mqueue.h>
+#include <signal.h>
 
 namespace instrumentation
 {
@@ -35,6 +37,7 @@ namespace instrumentation
 		    bool warpInstructionCount;
 		    bool barrierCount;
 		    bool basicBlockExecutionCount;
+		    bool memoryTrace;
 	
 	    public:
 		    InstrumentationConfiguration();
@@ -45,6 +48,44 @@ namespace instrumentation
             bool logKernelInfo;
 			
 			int iterations;
+			
+			//! \brief instrument one out of every samplingPeriod launches
+			unsigned int samplingPeriod;
+			//! \brief fraction of kernel time that instrumentation may add
+			double overheadBudget;
+			//! \brief estimated slowdown above which kernels run uninstrumented
+			double autoDisable;
+			//! \brief rename added registers to dead ones (off by default)
+			bool registerReuse;
+			//! \brief peak live registers instrumentation may add (0: no limit)
+			unsigned int maxExtraRegisters;
+			//! \brief pass instrumentation buffers as a kernel parameter
+			bool hiddenParameter;
+			//! \brief count provably uniform branches without the divergence test
+			bool divergenceGuidedBranches;
+			//! \brief issue one atomic per warp for counter updates
+			bool warpAggregatedAtomics;
+			//! \brief accumulate counters per CTA in shared memory
+			bool sharedCounterStaging;
+			//! \brief count basic blocks on spanning tree chords only
+			bool optimizedCounterPlacement;
+			//! \brief count the blocks of counted loops once at their exit
+			bool loopHoisting;
+			//! \brief optimize inserted code beyond constant propagation
+			bool optimizeInstrumentation;
+			//! \brief count unique memory segments with warp shuffles
+			bool shuffleUniqueElementCount;
+			//! \brief bytes per memory segment (32, 64 or 128)
+			unsigned int memorySegmentSize;
+			//! \brief records in the memory trace ring
+			unsigned int memoryTraceCapacity;
+			
+			//! \brief are instrumented variants launched at start-up?
+			bool enabled;
+			//! \brief toggle instrumentation with SIGUSR1 (on)/SIGUSR2 (off)
+			bool controlSignals;
+			//! \brief instrument and JIT modules on a background thread
+			bool backgroundJIT;
 			instrumentation::PTXInstrumentor::KernelVector kernelsToInstrument;        
     };
     		
@@ -65,8 +106,16 @@ namespace instrumentation
         PTXInstrumentorVector instrumentors;
         //! check if active instrumentor has been toggled (if so, we need to reload module)
         bool toggledActiveInstrumentor;
+        //! runtime switch for all instrumentors -- both kernel variants stay
+        //! resident, so flipping it only changes which one is launched
+        volatile sig_atomic_t enabled;
+        //! serializes use of the instrumentors between the application
+        //! threads and the background module compiler
+        boost::recursive_mutex mutex;
         //! associated profiler
         trace::Profiler profiler;
+        //! kernel analyses shared by all instrumentors, used under mutex
+        transforms::AnalysisCache analysisCache;
     
         //! \brief message queue descriptor
         mqd_t messageQueue;    
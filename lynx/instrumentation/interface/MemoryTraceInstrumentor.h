@@ -0,0 +1,82 @@
+/*! \file MemoryTraceInstrumentor.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for MemoryTraceInstrumentor
+*/
+
+#ifndef MEMORY_TRACE_INSTRUMENTOR_H_INCLUDED
+#define MEMORY_TRACE_INSTRUMENTOR_H_INCLUDED
+
+#include <string>
+#include <map>
+
+#include <lynx/instrumentation/interface/PTXInstrumentor.h>
+#include <lynx/transforms/interface/MemoryTracePass.h>
+#include <lynx/trace/interface/MemoryTrace.h>
+
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/transforms/interface/Pass.h>
+
+namespace instrumentation
+{
+	/*! \brief Records the global memory accesses of each warp in a device
+	    ring buffer that is drained into a compressed trace file
+	    (kernel.launch.memtrace) while the kernel runs */
+	class MemoryTraceInstrumentor : public PTXInstrumentor
+	{
+		public:
+		    /*! \brief number of records in the ring */
+		    unsigned long long capacity;
+
+		    /*! \brief the traced instructions of each kernel by instructionId */
+		    transforms::MemoryTracePass::KernelInstructionMap instructions;
+
+		public:
+			/*! \brief The default constructor */
+			MemoryTraceInstrumentor();
+			~MemoryTraceInstrumentor();
+
+            /*! \brief The validate method verifies that the defined conditions are met for this instrumentation */
+            bool validate();
+
+            /*! \brief The analyze method performs any necessary static analysis */
+            void analyze(ir::Module &module);
+
+            /*! \brief The initialize method allocates the ring and starts the host drain */
+            void initialize();
+
+            /*! \brief No C specification is used, the trace is inserted by MemoryTracePass */
+            std::string specificationPath();
+
+            /*! \brief Creates MemoryTracePass and the module pass adding its reserve function */
+            void createPasses(std::string resource);
+
+            /*! \brief Drains the rest of the ring and closes the trace file */
+            void extractResults(std::ostream *out);
+
+            /*! \brief A copy with its own ring, which is allocated by the
+                first launch */
+            PTXInstrumentor *clone() const;
+
+            /*! \brief Copies the traced instructions of a kernel along with
+                its analysis */
+            void synchronize(const PTXInstrumentor & prototype,
+                const std::string & kernelName);
+
+        private:
+            /*! \brief Write the text of the traced instructions next to the trace */
+            void writeInstructions(const std::string & path);
+
+        private:
+            trace::MemoryTraceBuffer *_header;
+            trace::MemoryTraceRecord *_records;
+            volatile unsigned long long *_tail;
+
+            trace::MemoryTraceWriter *_writer;
+            trace::MemoryTraceDrain *_drain;
+
+            std::string _path;
+	};
+}
+
+#endif
@@ -10,11 +10,19 @@
 #include <string>
 #include <vector>
 #include <map>
+#include <set>
 
 #include <lynx/translator/interface/CToPTXTranslator.h>
+#include <lynx/transforms/interface/CounterPlacement.h>
+#include <lynx/transforms/interface/OverheadEstimationPass.h>
+#include <lynx/transforms/interface/RegisterReusePass.h>
+#include <lynx/transforms/interface/HiddenParameterPass.h>
+#include <lynx/transforms/interface/UniformBranchPass.h>
 #include <lynx/instrumentation/interface/kernel_profile.h>
+#include <lynx/trace/interface/LaunchTimer.h>
 
 #include <ocelot/transforms/interface/Pass.h>
+#include <ocelot/transforms/interface/AnalysisCache.h>
 #include <ocelot/ir/interface/Module.h>
 
 #include <hydrazine/interface/json.h>
@@ -22,6 +30,9 @@
 #include <ostream>
 
 #include <mqueue.h>
+#include <tuple>
+
+#include <boost/thread/thread.hpp>
 
 namespace instrumentation
 {
@@ -35,6 +46,23 @@ namespace instrumentation
                 json,
                 text
             };
+
+            /*! \brief Launch history of a kernel on a device used to drive
+                sampling */
+            class SamplingState {
+                public:
+                    SamplingState(): launches(0), sampledLaunches(0) { }
+
+                    /*! \brief total number of launches observed */
+                    unsigned long launches;
+                    /*! \brief number of launches that ran instrumented */
+                    unsigned long sampledLaunches;
+                    /*! \brief measured device time of uninstrumented 
+                        launches, which may lag behind launches */
+                    trace::LaunchTime original;
+                    /*! \brief measured device time of instrumented launches */
+                    trace::LaunchTime instrumented;
+            };
         
             typedef std::map<int, transforms::Pass *> PassMap;
             typedef std::map<std::string, int> KernelDataMap;
@@ -42,6 +70,12 @@ namespace instrumentation
             typedef std::vector<std::string> KernelVector;
             typedef std::map<std::string, std::vector<size_t>> KernelBasicBlockSizeMap;
             typedef std::vector<size_t> BasicBlockInstructionVector;
+            typedef std::map<std::string, transforms::BlockWeightMap> KernelBlockWeightMap;
+            typedef std::set<std::string> KernelSet;
+            typedef std::tuple<int, const void *, boost::thread::id> 
+                InstanceKey;
+            typedef std::map<InstanceKey, PTXInstrumentor *> InstanceMap;
+            typedef std::map<std::string, unsigned int> KernelRevisionMap;
 
             std::string description;
 
@@ -95,6 +129,135 @@ namespace instrumentation
 
             int iterations;
 
+            /*! \brief instrument one out of every samplingPeriod launches 
+                of each kernel (0 or 1 instruments every launch) */
+            unsigned int samplingPeriod;
+
+            /*! \brief maximum instrumentation overhead, as a fraction of the
+                total kernel time, allowed per kernel (0 disables the budget) */
+            double overheadBudget;
+
+            /*! \brief issue one atomic per warp for atomicIncrement and
+                atomicAdd instead of one per thread */
+            bool warpAggregatedAtomics;
+
+            /*! \brief stage counter updates of kernels with loops in shared
+                memory and flush them to global memory once per CTA at kernel
+                exit, also runs the divergence analysis */
+            bool sharedCounterStaging;
+
+            /*! \brief count basic block executions on spanning tree chords
+                only, for instrumentors that support it */
+            bool optimizedCounterPlacement;
+
+            /*! \brief where the instrumentation pass records the counter
+                placement of each kernel, 0 if counters are not placed */
+            transforms::CounterPlacementMap *counterPlacements;
+
+            /*! \brief add the executed instruction counts of counted loops
+                once at the loop exit instead of once per iteration */
+            bool loopHoisting;
+
+            /*! \brief propagate copies, remove dead code and compute thread
+                invariant values once per kernel in the inserted code */
+            bool optimizeInstrumentation;
+
+            /*! \brief count the unique memory segments of each half warp
+                with shuffles instead of in shared memory */
+            bool shuffleUniqueElementCount;
+
+            /*! \brief bytes per memory segment for coalescing analysis */
+            unsigned int memorySegmentSize;
+
+            /*! \brief launch kernels uninstrumented when the statically
+                estimated slowdown of their instrumentation is larger than
+                this factor (0 disables the estimate) */
+            double autoDisable;
+
+            /*! \brief measured block execution counts used by the overhead
+                estimate, loop depth estimates are used for missing blocks */
+            KernelBlockWeightMap blockWeights;
+
+            /*! \brief the estimated overhead of each instrumented kernel */
+            transforms::OverheadEstimateMap overheadEstimates;
+
+            /*! \brief rename registers added by the instrumentation to 
+                registers that are dead where they are used (off by default) */
+            bool registerReuse;
+
+            /*! \brief launch kernels uninstrumented when the instrumentation
+                adds more peak live registers than this (0 for no limit) */
+            unsigned int maxExtraRegisters;
+
+            /*! \brief the registers of each kernel before and after the
+                instrumentation */
+            transforms::RegisterUsageMap registerUsage;
+
+            /*! \brief pass the instrumentation buffer to kernels as an extra
+                parameter rather than through the global symbol */
+            bool hiddenParameter;
+
+            /*! \brief kernels that take the buffer as a parameter */
+            KernelSet parameterKernels;
+
+            /*! \brief the buffer of the current launch if the kernel takes
+                it as a parameter, appended to the parameters at launch */
+            const void *baseAddress;
+
+            /*! \brief the counter buffer an instance keeps across launches
+                and its size in bytes */
+            void *buffer;
+            size_t bufferSize;
+
+            /*! \brief insert no code at branches that divergence analysis
+                proves uniform, only the warps taking them are counted */
+            bool divergenceGuidedBranches;
+
+            /*! \brief the conditional and the uniform branches of each
+                instrumented kernel */
+            transforms::UniformBranchMap uniformBranches;
+
+            /*! \brief analyses shared with other instrumentors and later
+                calls to instrument, keyed by kernel content (0 for a cache
+                per call to instrument) */
+            transforms::AnalysisCache *analysisCache;
+
+            /*! \brief kernels whose estimated overhead exceeds autoDisable
+                or whose added registers exceed maxExtraRegisters */
+            KernelSet disabledKernels;
+
+            /*! \brief does the current launch of an instance run the 
+                instrumented variant? Launch state is only kept by instances,
+                a configured instrumentor holds the results of instrumenting
+                modules */
+            bool sampled;
+
+            /*! \brief the device, stream and host thread of an instance, 
+                -1, 0 and no thread for a configured instrumentor */
+            int device;
+            const void *stream;
+            boost::thread::id thread;
+
+            /*! \brief times the launches of an instance, 0 for a configured
+                instrumentor */
+            trace::LaunchTimer *timer;
+
+            /*! \brief the index of the current launch of kernelName */
+            unsigned long launch;
+
+            /*! \brief incremented whenever a module is instrumented */
+            unsigned int revision;
+
+            /*! \brief the revision each kernel was last instrumented in, an
+                instance copies the results of a kernel it launches when 
+                its revision is behind the one of its prototype */
+            KernelRevisionMap kernelRevisions;
+
+            /*! \brief copies of a configured instrumentor that hold the 
+                buffers of the launches of one thread on a device and 
+                stream */
+            InstanceMap instances;
+
         protected:
 
             kernel_profile _profile;
@@ -102,10 +265,20 @@ namespace instrumentation
 		public:
 		
 		    PTXInstrumentor();
-            ~PTXInstrumentor();
+            virtual ~PTXInstrumentor();
             
-            /* !\brief Ensures conditions are met to perform this instrumentation */		    
-            bool conditionsMet();
+            /* !\brief Ensures conditions are met to perform this 
+                instrumentation on a kernel (all kernels of a module if 
+                kernelName is empty) */		    
+            bool conditionsMet(const std::string & kernelName);
+
+            /*! \brief Decides whether the next launch of a kernel runs the
+                instrumented variant, based on its launch history, the 
+                iteration limit, the sampling period and the overhead budget.
+                The index of the launch is returned in launch, and the 
+                measured time of the launch is to be added to time */
+            bool sampleLaunch(SamplingState & state, bool disabled, 
+                unsigned long & launch, trace::LaunchTime *& time) const;
 
             /*! \brief Performs the instrumentation */
 			void instrument();		
@@ -113,11 +286,76 @@ namespace instrumentation
             /*! \brief Performs the instrumentation */
             void instrument(ir::Module& module);	
 
+            /*! \brief Compares the instrumented kernels of a module with
+                their original costs and disables the ones over autoDisable */
+            void estimateOverhead(ir::Module& module, 
+                const transforms::KernelCostMap& originalCosts,
+                transforms::AnalysisCache *cache = 0);
+
+            /*! \brief Makes the instrumentation buffer of a launch visible
+                to the kernel, as its parameter or through the symbol */
+            void setBaseAddress(const void *address);
+
+            /*! \brief A device buffer of at least bytes for the counters of
+                a launch, cleared on the stream of the instance. The buffer
+                is kept for later launches and only grows. */
+            void *counterBuffer(size_t bytes);
+
+            /*! \brief Copies the counters of the last launch to host on
+                the stream of the instance once the launch finished */
+            void readCounterBuffer(void *host, size_t bytes);
+
+            /*! \brief Reuses dead registers in the instrumented kernels of
+                a module and disables the ones over maxExtraRegisters */
+            void reuseRegisters(ir::Module& module, 
+                const transforms::KernelCostMap& originalCosts,
+                transforms::AnalysisCache *cache = 0);
+
+            /*! \brief Finds the branches of a module that are uniform */
+            void analyzeBranches(ir::Module& module, 
+                transforms::AnalysisCache *cache = 0);
+
             /*! \brief The finalize method performs any necessary CUDA runtime actions after instrumentation */
             void finalize();
 
+            /*! \brief The instance that launches of the calling thread on 
+                a device and stream use, created from this instrumentor and
+                holding its current results for kernelName */
+            PTXInstrumentor *instance(int device, const void *stream,
+                const std::string & kernelName);
+
+            /*! \brief Add the time of the finished launches of the 
+                instances on a device, waiting for them if wait is set */
+            void collectLaunches(int device, bool wait);
+
+            /*! \brief Copies the results of instrumenting a kernel, which 
+                its launches need, from the configured instrumentor */
+            virtual void synchronize(const PTXInstrumentor & prototype,
+                const std::string & kernelName);
+
+        protected:
+            /*! \brief Copy the entry of a kernel from the map of the 
+                prototype, or remove it if the prototype has none */
+            template<typename Map>
+            static void synchronizeKernel(Map & map, const Map & prototype,
+                const std::string & kernelName)
+            {
+                typename Map::const_iterator entry = 
+                    prototype.find(kernelName);
+                
+                if(entry == prototype.end())
+                    map.erase(kernelName);
+                else
+                    map[kernelName] = entry->second;
+            }
+            
+            static void synchronizeKernel(KernelSet & set, 
+                const KernelSet & prototype, const std::string & kernelName);
+
+        public:
+
             /*! \brief The createPasses method instantiates the instrumentation passes */
-            void createPasses(std::string resource);
+            virtual void createPasses(std::string resource);
 
             /*! \brief Output device info */
             void deviceInfo(std::ostream *out);
@@ -147,6 +385,10 @@ namespace instrumentation
 			
             /*! \brief Extracts instrumentation-specific data */
             virtual void extractResults(std::ostream *out) = 0;
+
+            /*! \brief A copy that shares no buffers or streams with this 
+                instrumentor */
+            virtual PTXInstrumentor *clone() const = 0;
 	};
 
     typedef std::vector< PTXInstrumentor *> PTXInstrumentorVector;
@@ -37,6 +37,10 @@ namespace instrumentation
             unsigned int warpCount;
             
             unsigned int entries;
+            
+            /*! \brief Warps executing each uniform branch, counted ahead of 
+                the per-warp entries */
+            unsigned int uniformCounters;
         	
 		public:
 			/*! \brief The default constructor */
@@ -60,6 +64,9 @@ namespace instrumentation
 
             /*! \brief extracts results for the instrumentation */
             void extractResults(std::ostream *out);
+
+            /*! \brief A copy that allocates its own buffers */
+            PTXInstrumentor *clone() const;
 	};
 
 }
@@ -0,0 +1,432 @@
+/*! \file BatchInstrumentor.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the BatchInstrumentor tool
+*/
+
+#ifndef BATCH_INSTRUMENTOR_CPP_INCLUDED
+#define BATCH_INSTRUMENTOR_CPP_INCLUDED
+
+#include <lynx/tools/BatchInstrumentor.h>
+#include <lynx/instrumentation/interface/BasicBlockInstrumentor.h>
+#include <lynx/instrumentation/interface/WarpInstrumentor.h>
+
+#include <ocelot/cuda/interface/FatBinaryContext.h>
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+
+#include <hydrazine/interface/Exception.h>
+#include <hydrazine/interface/debug.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+#include <boost/thread/locks.hpp>
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+
+#include <dirent.h>
+#include <sys/stat.h>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace instrumentation
+{
+
+    static bool endsWith(const std::string & string,
+        const std::string & suffix)
+    {
+        return string.size() >= suffix.size() && string.compare(
+            string.size() - suffix.size(), suffix.size(), suffix) == 0;
+    }
+
+    /* the file name of a path without its directory and extension */
+    static std::string stem(const std::string & path)
+    {
+        size_t slash = path.find_last_of('/');
+        std::string name = slash == std::string::npos ? path :
+            path.substr(slash + 1);
+
+        size_t dot = name.find_last_of('.');
+        if(dot != std::string::npos && dot != 0)
+            name = name.substr(0, dot);
+
+        return name;
+    }
+
+    /* the file name of a path without its directory */
+    static std::string fileName(const std::string & path)
+    {
+        size_t slash = path.find_last_of('/');
+        return slash == std::string::npos ? path : path.substr(slash + 1);
+    }
+
+    BatchInstrumentor::BatchInstrumentor() : threads(0), _next(0),
+        _failures(0)
+    {
+
+    }
+
+    void BatchInstrumentor::addInput(const std::string & path)
+    {
+        struct stat status;
+
+        if(stat(path.c_str(), &status) != 0)
+        {
+            throw hydrazine::Exception("Input '" + path + "' does not exist.");
+        }
+
+        if(!S_ISDIR(status.st_mode))
+        {
+            inputs.push_back(path);
+            return;
+        }
+
+        DIR *directory = opendir(path.c_str());
+
+        if(directory == 0)
+        {
+            throw hydrazine::Exception("Could not open directory '" + path
+                + "'.");
+        }
+
+        StringVector files;
+
+        for(struct dirent *entry = readdir(directory); entry != 0;
+            entry = readdir(directory))
+        {
+            std::string name = entry->d_name;
+
+            if(endsWith(name, ".ptx") || endsWith(name, ".fatbin"))
+                files.push_back(path + "/" + name);
+        }
+
+        closedir(directory);
+
+        std::sort(files.begin(), files.end());
+        inputs.insert(inputs.end(), files.begin(), files.end());
+    }
+
+    unsigned int BatchInstrumentor::run()
+    {
+        _outputs = outputNames(inputs);
+        _next = 0;
+        _failures = 0;
+
+        unsigned int workers = threads;
+
+        if(workers == 0)
+            workers = std::max(boost::thread::hardware_concurrency(), 1u);
+        workers = std::min<size_t>(workers, inputs.size());
+
+        report("Instrumenting " << inputs.size() << " inputs on "
+            << workers << " threads");
+
+        boost::thread_group group;
+
+        for(unsigned int t = 1; t < workers; ++t)
+            group.create_thread(boost::bind(&BatchInstrumentor::_work, this));
+
+        _work();
+        group.join_all();
+
+        return _failures;
+    }
+
+    PTXInstrumentor *BatchInstrumentor::create(const std::string & name)
+    {
+        if(name == "memoryEfficiency")
+            return new WarpInstrumentor(WarpInstrumentor::memoryEfficiency);
+
+        if(name == "branchDivergence")
+        {
+            WarpInstrumentor *instrumentor = new WarpInstrumentor(
+                WarpInstrumentor::branchDivergence);
+            instrumentor->divergenceGuidedBranches = true;
+            return instrumentor;
+        }
+
+        if(name == "activityFactor")
+            return new WarpInstrumentor(WarpInstrumentor::activityFactor);
+
+        if(name == "warpInstructionCount")
+            return new WarpInstrumentor(WarpInstrumentor::instructionCount);
+
+        if(name == "barrierCount")
+            return new WarpInstrumentor(WarpInstrumentor::barrierCount);
+
+        if(name == "threadInstructionCount")
+        {
+            return new BasicBlockInstrumentor(
+                BasicBlockInstrumentor::instructionCount);
+        }
+
+        if(name == "basicBlockExecutionCount")
+        {
+            return new BasicBlockInstrumentor(
+                BasicBlockInstrumentor::executionCount);
+        }
+
+        return 0;
+    }
+
+    BatchInstrumentor::StringVector BatchInstrumentor::outputNames(
+        const StringVector & inputs)
+    {
+        typedef std::map<std::string, unsigned int> CountMap;
+
+        CountMap stems;
+        CountMap files;
+
+        for(StringVector::const_iterator input = inputs.begin();
+            input != inputs.end(); ++input)
+        {
+            stems[stem(*input)]++;
+            files[fileName(*input)]++;
+        }
+
+        StringVector names;
+        CountMap occurrences;
+        std::map<std::string, std::string> owners;
+
+        for(StringVector::const_iterator input = inputs.begin();
+            input != inputs.end(); ++input)
+        {
+            std::string name = stem(*input);
+
+            if(stems[name] > 1)
+            {
+                name = fileName(*input);
+
+                if(files[name] > 1)
+                {
+                    std::stringstream numbered;
+                    numbered << name << "-" << ++occurrences[name];
+                    name = numbered.str();
+                }
+            }
+
+            /* a stem may still match the name given to another input */
+            std::map<std::string, std::string>::const_iterator owner =
+                owners.find(name);
+
+            if(owner != owners.end())
+            {
+                throw hydrazine::Exception("Inputs '" + owner->second +
+                    "' and '" + *input + "' would both be written to '" +
+                    name + "'.");
+            }
+
+            owners.insert(std::make_pair(name, *input));
+            names.push_back(name);
+        }
+
+        return names;
+    }
+
+    void BatchInstrumentor::_work()
+    {
+        while(true)
+        {
+            size_t input = 0;
+
+            {
+                boost::lock_guard<boost::mutex> lock(_mutex);
+
+                if(_next == inputs.size())
+                    return;
+
+                input = _next++;
+            }
+
+            const std::string & path = inputs[input];
+
+            std::string result;
+            bool instrumented = false;
+
+            try
+            {
+                instrumented = _instrument(path, _outputs[input], result);
+            }
+            catch(const std::exception & exception)
+            {
+                result = exception.what();
+            }
+
+            boost::lock_guard<boost::mutex> lock(_mutex);
+
+            if(!instrumented)
+            {
+                ++_failures;
+                std::cerr << "==LYNX== WARNING: Could not instrument '"
+                    << path << "', " << result << ".\n";
+            }
+            else
+            {
+                std::cout << path << ": " << result << "\n";
+            }
+        }
+    }
+
+    bool BatchInstrumentor::_instrument(const std::string & path,
+        const std::string & name, std::string & result)
+    {
+        std::ifstream file(path.c_str(), std::ios::binary);
+
+        if(!file.is_open())
+        {
+            result = "the file could not be opened";
+            return false;
+        }
+
+        std::string source((std::istreambuf_iterator<char>(file)),
+            std::istreambuf_iterator<char>());
+
+        /* a fat binary dump holds the data a __cudaFatCudaBinary2 points to */
+        const __cudaFatCudaBinary2Header *header =
+            (const __cudaFatCudaBinary2Header *)source.data();
+
+        if(source.size() >= sizeof(__cudaFatCudaBinary2Header) &&
+            header->magic == __cudaFatMAGIC3)
+        {
+            if(header->length + sizeof(__cudaFatCudaBinary2Header) >
+                source.size())
+            {
+                result = "the fat binary is truncated";
+                return false;
+            }
+
+            __cudaFatCudaBinary2 binary;
+            binary.magic = __cudaFatMAGIC2;
+            binary.version = 1;
+            binary.fatbinData = (const unsigned long long *)source.data();
+            binary.f = 0;
+
+            cuda::FatBinaryContext context(&binary);
+
+            if(context.ptx() == 0)
+            {
+                result = "the fat binary contains no PTX";
+                return false;
+            }
+
+            source = context.ptx();
+        }
+
+        ir::Module module;
+
+        {
+            std::stringstream stream(source);
+            if(!module.load(stream, path))
+            {
+                result = "the PTX could not be parsed";
+                return false;
+            }
+        }
+
+        std::unique_ptr<PTXInstrumentor> instrumentor(create(instrumentation));
+
+        if(!instrumentor.get())
+        {
+            result = "'" + instrumentation + "' is not an instrumentation that"
+                " can be applied offline";
+            return false;
+        }
+
+        /* estimate the overhead of every kernel without disabling any */
+        instrumentor->autoDisable = std::numeric_limits<double>::max();
+        instrumentor->on = true;
+
+        std::map<std::string, unsigned int> blocks;
+
+        for(ir::Module::KernelMap::const_iterator
+            kernel = module.kernels().begin();
+            kernel != module.kernels().end(); ++kernel)
+        {
+            blocks[kernel->first] = kernel->second->cfg()->size() - 2;
+        }
+
+        instrumentor->analyze(module);
+        instrumentor->instrument(module);
+
+        std::string ptx;
+        module.writeIR(ptx, ir::PTXEmitter::Target_NVIDIA_PTX30, 1);
+
+        /* the instrumented PTX must be loadable by the runtime */
+        {
+            ir::Module check;
+            std::stringstream stream(ptx);
+            if(!check.load(stream, path))
+            {
+                result = "the instrumented PTX could not be parsed";
+                return false;
+            }
+        }
+
+        std::string prefix = outputDirectory + "/" + name;
+
+        std::ofstream output((prefix + ".instrumented.ptx").c_str());
+        output << ptx;
+
+        std::ofstream statistics((prefix + ".stats").c_str());
+
+        if(!output.good() || !statistics.good())
+        {
+            result = "the results could not be written to '" +
+                outputDirectory + "'";
+            return false;
+        }
+
+        for(std::map<std::string, unsigned int>::const_iterator
+            kernel = blocks.begin(); kernel != blocks.end(); ++kernel)
+        {
+            statistics << kernel->first << ":\n";
+            statistics << "  blocks: " << kernel->second << "\n";
+
+            transforms::OverheadEstimateMap::const_iterator estimate =
+                instrumentor->overheadEstimates.find(kernel->first);
+            if(estimate != instrumentor->overheadEstimates.end())
+            {
+                statistics << "  overhead: " << estimate->second.toString()
+                    << "\n";
+            }
+
+            transforms::RegisterUsageMap::const_iterator usage =
+                instrumentor->registerUsage.find(kernel->first);
+            if(usage != instrumentor->registerUsage.end())
+            {
+                statistics << "  registers: " << usage->second.toString()
+                    << "\n";
+            }
+
+            transforms::UniformBranchMap::const_iterator branches =
+                instrumentor->uniformBranches.find(kernel->first);
+            if(branches != instrumentor->uniformBranches.end())
+            {
+                statistics << "  uniform branches: "
+                    << branches->second.labels.size() << " of "
+                    << branches->second.branches << "\n";
+            }
+        }
+
+        std::stringstream summary;
+        summary << blocks.size() << " kernels instrumented";
+        result = summary.str();
+
+        return true;
+    }
+
+}
+
+#endif
@@ -0,0 +1,89 @@
+/*! \file BatchInstrumentor.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the BatchInstrumentor tool, which instruments
+	    PTX files and fat binary dumps offline
+*/
+
+#ifndef BATCH_INSTRUMENTOR_H_INCLUDED
+#define BATCH_INSTRUMENTOR_H_INCLUDED
+
+#include <boost/thread/mutex.hpp>
+
+#include <string>
+#include <vector>
+
+namespace instrumentation
+{
+    class PTXInstrumentor;
+
+	/*! \brief Instruments PTX files and fat binary dumps without a device,
+	    several files at a time.
+
+	    Every input is parsed into its own module and instrumented by its own
+	    instrumentor, so only the C to PTX translator is shared between the
+	    threads. For an input named X.ptx or X.fatbin the instrumented PTX is
+	    written to outputDirectory/X.instrumented.ptx, after checking that it
+	    parses again, and the static statistics of its kernels to
+	    outputDirectory/X.stats. Inputs sharing the name X are told apart as
+	    described by outputNames().
+
+	    Instrumentations whose analysis allocates device buffers, the clock
+	    cycle count and the memory trace, are not supported.
+	*/
+	class BatchInstrumentor
+	{
+		public:
+		    typedef std::vector<std::string> StringVector;
+
+		public:
+		    BatchInstrumentor();
+
+		    /*! \brief Add a PTX file or fat binary dump, or every .ptx and
+		        .fatbin file in a directory */
+		    void addInput(const std::string & path);
+
+		    /*! \brief Instrument every input, returns the number of inputs
+		        that could not be instrumented */
+		    unsigned int run();
+
+		    /*! \brief A new instrumentor for an instrumentation named as in
+		        configure.lynx, 0 if it is unknown or needs a device */
+		    static PTXInstrumentor *create(const std::string & name);
+
+		    /*! \brief The name the outputs of each input start with: its
+		        file name without extension, with the extension if another
+		        input has the same stem, and with -1, -2, ... if the file
+		        name is shared as well. Throws if two names still match. */
+		    static StringVector outputNames(const StringVector & inputs);
+
+		public:
+		    //! the instrumentation, named as in configure.lynx
+		    std::string instrumentation;
+		    //! where the instrumented PTX and the statistics are written
+		    std::string outputDirectory;
+		    //! inputs instrumented at the same time (0 for one per core)
+		    unsigned int threads;
+		    //! the PTX files and fat binary dumps
+		    StringVector inputs;
+
+		private:
+		    /*! \brief Instrument inputs until there are none left */
+		    void _work();
+
+		    /*! \brief Instrument one input into the outputs starting with
+		        name, describing the result */
+		    bool _instrument(const std::string & path,
+		        const std::string & name, std::string & result);
+
+		private:
+		    //! the output name of each input
+		    StringVector _outputs;
+		    //! guards the next input, the failure count and the log
+		    boost::mutex _mutex;
+		    size_t _next;
+		    unsigned int _failures;
+	};
+}
+
+#endif
@@ -0,0 +1,60 @@
+/*! \file BatchInstrumentorMain.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The command line driver of the BatchInstrumentor tool
+*/
+
+#ifndef BATCH_INSTRUMENTOR_MAIN_CPP_INCLUDED
+#define BATCH_INSTRUMENTOR_MAIN_CPP_INCLUDED
+
+#include <lynx/tools/BatchInstrumentor.h>
+
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <iostream>
+
+int main(int argc, char** argv)
+{
+    hydrazine::ArgumentParser parser(argc, argv);
+    parser.description("Instruments PTX files and fat binary dumps without "
+        "a device, writing the instrumented PTX and the static statistics "
+        "of every kernel.");
+
+    instrumentation::BatchInstrumentor batch;
+    std::string input;
+
+    parser.parse("-i", "--input", input, "",
+        "A PTX file, a fat binary dump or a directory of .ptx and .fatbin "
+        "files.");
+    parser.parse("-o", "--output", batch.outputDirectory, ".",
+        "The directory the instrumented PTX and statistics are written to.");
+    parser.parse("-t", "--instrumentation", batch.instrumentation,
+        "basicBlockExecutionCount",
+        "The instrumentation to apply, named as in configure.lynx.");
+    parser.parse("-j", "--threads", batch.threads, 0,
+        "Inputs instrumented at the same time, 0 for one per core.");
+    parser.parse();
+
+    if(input.empty())
+    {
+        std::cerr << "No input given.\n" << parser.help();
+        return -1;
+    }
+
+    unsigned int failures = 0;
+
+    try
+    {
+        batch.addInput(input);
+        failures = batch.run();
+    }
+    catch(const std::exception & exception)
+    {
+        std::cerr << exception.what() << "\n";
+        return -1;
+    }
+
+    return failures == 0 ? 0 : -1;
+}
+
+#endif
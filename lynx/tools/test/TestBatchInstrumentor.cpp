@@ -0,0 +1,193 @@
+/*!
+	\file TestBatchInstrumentor.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the output names of the BatchInstrumentor. Inputs with
+		distinct stems keep them, inputs sharing a stem or a file name must
+		still be written to distinct outputs, and names that cannot be told
+		apart must be rejected.
+*/
+
+#ifndef TEST_BATCH_INSTRUMENTOR_CPP_INCLUDED
+#define TEST_BATCH_INSTRUMENTOR_CPP_INCLUDED
+
+#include <lynx/tools/BatchInstrumentor.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <exception>
+
+namespace test
+{
+	/*! \brief Check the output names of sets of inputs */
+	class TestBatchInstrumentor : public Test
+	{
+		private:
+			typedef instrumentation::BatchInstrumentor BatchInstrumentor;
+			typedef BatchInstrumentor::StringVector StringVector;
+
+		private:
+			static StringVector _strings(const char** strings);
+
+			bool _check(const std::string& test, const char** inputs,
+				const char** expected);
+
+			bool _testDistinct();
+			bool _testSharedStem();
+			bool _testSharedFileName();
+			bool _testCollision();
+
+			bool doTest();
+
+		public:
+			TestBatchInstrumentor();
+	};
+
+	TestBatchInstrumentor::StringVector TestBatchInstrumentor::_strings(
+		const char** strings)
+	{
+		StringVector result;
+
+		for(; *strings != 0; ++strings)
+		{
+			result.push_back(*strings);
+		}
+
+		return result;
+	}
+
+	bool TestBatchInstrumentor::_check(const std::string& test,
+		const char** inputs, const char** expected)
+	{
+		StringVector names;
+
+		try
+		{
+			names = BatchInstrumentor::outputNames(_strings(inputs));
+		}
+		catch(const std::exception& exception)
+		{
+			status << test << ": " << exception.what() << "\n";
+			return false;
+		}
+
+		StringVector golden = _strings(expected);
+
+		if(names != golden)
+		{
+			status << test << ": the inputs were named";
+
+			for(StringVector::const_iterator name = names.begin();
+				name != names.end(); ++name)
+			{
+				status << " '" << *name << "'";
+			}
+
+			status << " instead of";
+
+			for(StringVector::const_iterator name = golden.begin();
+				name != golden.end(); ++name)
+			{
+				status << " '" << *name << "'";
+			}
+
+			status << ".\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	bool TestBatchInstrumentor::_testDistinct()
+	{
+		static const char* inputs[] = {
+			"kernels/a.ptx", "kernels/b.fatbin", "c.ptx", 0
+		};
+		static const char* expected[] = { "a", "b", "c", 0 };
+
+		return _check("distinct stems", inputs, expected);
+	}
+
+	/*! The PTX and the fat binary dump of one program */
+	bool TestBatchInstrumentor::_testSharedStem()
+	{
+		static const char* inputs[] = {
+			"kernels/a.fatbin", "kernels/a.ptx", "kernels/b.ptx", 0
+		};
+		static const char* expected[] = { "a.fatbin", "a.ptx", "b", 0 };
+
+		return _check("shared stem", inputs, expected);
+	}
+
+	/*! Files of the same name added from different directories */
+	bool TestBatchInstrumentor::_testSharedFileName()
+	{
+		static const char* inputs[] = {
+			"old/a.ptx", "new/a.ptx", "new/a.fatbin", 0
+		};
+		static const char* expected[] = { "a.ptx-1", "a.ptx-2", "a.fatbin", 0 };
+
+		return _check("shared file name", inputs, expected);
+	}
+
+	/*! The stem of one input is the name given to two others */
+	bool TestBatchInstrumentor::_testCollision()
+	{
+		static const char* inputs[] = {
+			"a.ptx", "a.fatbin", "a.ptx.fatbin", 0
+		};
+
+		try
+		{
+			BatchInstrumentor::outputNames(_strings(inputs));
+		}
+		catch(const std::exception& exception)
+		{
+			status << "Rejected: " << exception.what() << "\n";
+			return true;
+		}
+
+		status << "collision: 'a.ptx' and 'a.ptx.fatbin' were both given "
+			<< "the name 'a.ptx'.\n";
+
+		return false;
+	}
+
+	bool TestBatchInstrumentor::doTest()
+	{
+		return _testDistinct() && _testSharedStem() && _testSharedFileName()
+			&& _testCollision();
+	}
+
+	TestBatchInstrumentor::TestBatchInstrumentor()
+	{
+		name = "TestBatchInstrumentor";
+
+		description = "Names the outputs of inputs with distinct stems, of ";
+		description += "a PTX file and a fat binary dump sharing a stem, ";
+		description += "and of files sharing a name in different ";
+		description += "directories; each input must get a distinct, ";
+		description += "expected name. Inputs whose names still match must ";
+		description += "be rejected.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestBatchInstrumentor test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
@@ -0,0 +1,174 @@
+/*! \file LaunchTimer.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the event based timer of kernel launches
+*/
+
+#include <lynx/trace/interface/LaunchTimer.h>
+
+// Hydrazine includes
+#include <hydrazine/interface/debug.h>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+namespace trace {
+
+    double LaunchTime::mean() const
+    {
+        return launches == 0 ? 0 : seconds / launches;
+    }
+
+    LaunchTimer::LaunchTimer() : _start(0)
+    {
+
+    }
+
+    LaunchTimer::~LaunchTimer()
+    {
+        /* the context of the events may already be gone at exit, failures
+            to destroy them are ignored */
+        for(MeasurementQueue::const_iterator measurement = _pending.begin();
+            measurement != _pending.end(); ++measurement)
+        {
+            _release(*measurement);
+        }
+
+        if(_start)
+            _events.push_back(_start);
+
+        for(EventVector::const_iterator event = _events.begin();
+            event != _events.end(); ++event)
+        {
+            cuEventDestroy(*event);
+        }
+    }
+
+    void LaunchTimer::start(CUstream stream)
+    {
+        if(!_start)
+            _start = _event();
+
+        if(_start && cuEventRecord(_start, stream) != CUDA_SUCCESS)
+        {
+            _events.push_back(_start);
+            _start = 0;
+        }
+    }
+
+    void LaunchTimer::stop(CUstream stream, Profiler::DeviceProfiler *device,
+        Profiler::KernelProfiler *kernel, LaunchTime *time)
+    {
+        if(!_start)
+            return;
+
+        Measurement measurement;
+        measurement.start = _start;
+        measurement.stop = _event();
+        measurement.device = device;
+        measurement.kernel = kernel;
+        measurement.time = time;
+
+        _start = 0;
+
+        if(!measurement.stop ||
+            cuEventRecord(measurement.stop, stream) != CUDA_SUCCESS)
+        {
+            report("Could not record the end of a launch");
+            _release(measurement);
+            return;
+        }
+
+        _pending.push_back(measurement);
+
+        /* the oldest launch is waited for rather than holding on to an
+            unbounded number of events */
+        if(_pending.size() > MaxPending)
+        {
+            cuEventSynchronize(_pending.front().stop);
+        }
+    }
+
+    void LaunchTimer::collect(bool wait)
+    {
+        for(MeasurementQueue::iterator measurement = _pending.begin();
+            measurement != _pending.end(); )
+        {
+            CUresult result = wait ? cuEventSynchronize(measurement->stop) :
+                cuEventQuery(measurement->stop);
+
+            /* launches on other streams may finish first */
+            if(result == CUDA_ERROR_NOT_READY)
+            {
+                ++measurement;
+                continue;
+            }
+
+            if(result == CUDA_SUCCESS)
+                _record(*measurement);
+
+            _release(*measurement);
+            measurement = _pending.erase(measurement);
+        }
+    }
+
+    size_t LaunchTimer::pending() const
+    {
+        return _pending.size();
+    }
+
+    CUevent LaunchTimer::_event()
+    {
+        if(!_events.empty())
+        {
+            CUevent event = _events.back();
+            _events.pop_back();
+
+            return event;
+        }
+
+        CUevent event = 0;
+
+        if(cuEventCreate(&event, CU_EVENT_DEFAULT) != CUDA_SUCCESS)
+            return 0;
+
+        return event;
+    }
+
+    void LaunchTimer::_release(const Measurement & measurement)
+    {
+        if(measurement.start)
+            _events.push_back(measurement.start);
+        if(measurement.stop)
+            _events.push_back(measurement.stop);
+    }
+
+    void LaunchTimer::_record(const Measurement & measurement)
+    {
+        float milliseconds = 0;
+
+        if(cuEventElapsedTime(&milliseconds, measurement.start,
+            measurement.stop) != CUDA_SUCCESS)
+        {
+            return;
+        }
+
+        double seconds = milliseconds * 1e-3;
+
+        if(measurement.kernel)
+            measurement.kernel->kernelExecute += seconds;
+
+        if(measurement.device)
+            measurement.device->kernelsExecute += seconds;
+
+        if(measurement.time)
+        {
+            measurement.time->seconds += seconds;
+            measurement.time->launches++;
+        }
+    }
+
+}
@@ -0,0 +1,832 @@
+/*! \file MemorySimulator.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the host side cache and coalescing simulator
+*/
+
+#include <lynx/trace/interface/MemorySimulator.h>
+
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/ControlFlowGraph.h>
+
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+// Hydrazine includes
+#include <hydrazine/interface/Exception.h>
+#include <hydrazine/interface/debug.h>
+
+#include <algorithm>
+#include <cassert>
+#include <iomanip>
+#include <sstream>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+namespace trace {
+
+    static bool isPowerOfTwo(unsigned long long value)
+    {
+        return value != 0 && (value & (value - 1)) == 0;
+    }
+
+    static unsigned int log2(unsigned long long value)
+    {
+        unsigned int result = 0;
+        while(value >>= 1)
+            ++result;
+        return result;
+    }
+
+    /* distances 0, 1, 2-3, 4-7, ... up to reuseDepth - 1 and a last bucket
+        for cold accesses */
+    static unsigned int reuseBucket(unsigned int distance)
+    {
+        return distance == 0 ? 0 : log2(distance) + 1;
+    }
+
+    static unsigned int reuseBuckets(unsigned int depth)
+    {
+        return reuseBucket(depth - 1) + 2;
+    }
+
+    static double ratio(unsigned long long numerator,
+        unsigned long long denominator)
+    {
+        return denominator == 0 ? 0.0 : (double)numerator / denominator;
+    }
+
+    CacheConfiguration::CacheConfiguration(unsigned long long s,
+        unsigned int l, unsigned int sector, unsigned int a) : size(s),
+        lineSize(l), sectorSize(sector), associativity(a)
+    {
+
+    }
+
+    unsigned int CacheConfiguration::sets() const
+    {
+        return size / ((unsigned long long)lineSize * associativity);
+    }
+
+    unsigned int CacheConfiguration::sectorsPerLine() const
+    {
+        return lineSize / sectorSize;
+    }
+
+    void CacheConfiguration::validate(const std::string & name) const
+    {
+        std::stringstream error;
+
+        if(!isPowerOfTwo(lineSize) || !isPowerOfTwo(sectorSize))
+            error << "line and sector sizes must be powers of two";
+        else if(sectorSize > lineSize)
+            error << "sectors can not be larger than lines";
+        else if(sectorsPerLine() > 16)
+            error << "at most 16 sectors per line are supported";
+        else if(associativity == 0)
+            error << "associativity must be positive";
+        else if(sets() == 0 ||
+            size != (unsigned long long)sets() * lineSize * associativity)
+            error << "size must be a multiple of line size * associativity";
+
+        if(!error.str().empty())
+        {
+            throw hydrazine::Exception("Invalid " + name +
+                " cache configuration, " + error.str() + ".");
+        }
+    }
+
+    MemorySimulator::Configuration::Configuration() :
+        l1(16 * 1024, 128, 32, 4), l2(768 * 1024, 128, 32, 16), threads(0),
+        batchRecords(1 << 18), reuseDepth(64)
+    {
+
+    }
+
+    MemorySimulator::InstructionStatistics::InstructionStatistics() :
+        warpAccesses(0), stores(0), lanes(0), inexactLanes(0),
+        requestedBytes(0), sectors(0), lines(0), l1Hits(0), l1Misses(0),
+        l2Hits(0), l2Misses(0)
+    {
+
+    }
+
+    void MemorySimulator::InstructionStatistics::merge(
+        const InstructionStatistics & s)
+    {
+        if(block.empty())
+            block = s.block;
+        if(instruction.empty())
+            instruction = s.instruction;
+
+        warpAccesses   += s.warpAccesses;
+        stores         += s.stores;
+        lanes          += s.lanes;
+        inexactLanes   += s.inexactLanes;
+        requestedBytes += s.requestedBytes;
+        sectors        += s.sectors;
+        lines          += s.lines;
+        l1Hits         += s.l1Hits;
+        l1Misses       += s.l1Misses;
+        l2Hits         += s.l2Hits;
+        l2Misses       += s.l2Misses;
+
+        if(reuse.size() < s.reuse.size())
+            reuse.resize(s.reuse.size(), 0);
+
+        for(unsigned int i = 0; i < s.reuse.size(); ++i)
+            reuse[i] += s.reuse[i];
+    }
+
+    double MemorySimulator::InstructionStatistics::l1HitRate() const
+    {
+        return ratio(l1Hits, l1Hits + l1Misses);
+    }
+
+    double MemorySimulator::InstructionStatistics::l2HitRate() const
+    {
+        return ratio(l2Hits, l2Hits + l2Misses);
+    }
+
+    double MemorySimulator::InstructionStatistics::sectorEfficiency(
+        unsigned int sectorSize) const
+    {
+        return ratio(requestedBytes, sectors * sectorSize);
+    }
+
+    /*! \brief The sets of one cache that belong to a shard, set i of the
+        cache is local set i / shards of shard i % shards */
+    class MemorySimulator::Cache {
+
+        public:
+            Cache(const CacheConfiguration & c, unsigned int shards) :
+                _sets(c.sets()), _shardBits(log2(shards)),
+                _associativity(c.associativity),
+                _tags((c.sets() / shards) * c.associativity, Empty),
+                _lastUse(_tags.size(), 0), _valid(_tags.size(), 0), _time(0)
+            {
+                assert(_sets % shards == 0);
+            }
+
+            /*! \brief the local set of a line */
+            unsigned int set(unsigned long long line) const
+            {
+                return (line % _sets) >> _shardBits;
+            }
+
+            /*! \brief access the sectors of a line, allocating it on a
+                miss. Returns the sectors that hit. */
+            unsigned int access(unsigned int index, unsigned long long line,
+                unsigned int sectors)
+            {
+                unsigned int base = index * _associativity;
+                const unsigned long long *tags = &_tags[base];
+
+                for(unsigned int way = 0; way < _associativity; ++way)
+                {
+                    if(tags[way] == line)
+                    {
+                        unsigned int hits = _valid[base + way] & sectors;
+
+                        _lastUse[base + way] = ++_time;
+                        _valid[base + way] |= sectors;
+
+                        return hits;
+                    }
+                }
+
+                /* empty ways were last used at time 0 */
+                const unsigned long long *lastUse = &_lastUse[base];
+                unsigned int victim = 0;
+
+                for(unsigned int way = 1; way < _associativity; ++way)
+                    victim = lastUse[way] < lastUse[victim] ? way : victim;
+
+                _tags[base + victim] = line;
+                _lastUse[base + victim] = ++_time;
+                _valid[base + victim] = sectors;
+
+                return 0;
+            }
+
+            void invalidate(unsigned int index, unsigned long long line,
+                unsigned int sectors)
+            {
+                unsigned int base = index * _associativity;
+
+                for(unsigned int way = 0; way < _associativity; ++way)
+                {
+                    if(_tags[base + way] == line)
+                    {
+                        _valid[base + way] &= ~sectors;
+
+                        if(_valid[base + way] == 0)
+                        {
+                            _tags[base + way] = Empty;
+                            _lastUse[base + way] = 0;
+                        }
+
+                        return;
+                    }
+                }
+            }
+
+        private:
+            //! the tag of an empty way, no line is this high
+            static const unsigned long long Empty = ~0ULL;
+
+        private:
+            unsigned int _sets;
+            unsigned int _shardBits;
+            unsigned int _associativity;
+
+            /* the ways of each set, kept in separate arrays so that the
+                searches of a set touch as little memory as possible */
+            std::vector<unsigned long long> _tags;
+            std::vector<unsigned long long> _lastUse;
+            //! one bit per valid sector
+            std::vector<unsigned int> _valid;
+
+            unsigned long long _time;
+    };
+
+    const unsigned long long MemorySimulator::Cache::Empty;
+
+    /*! \brief Simulates the requests to the sets of one shard */
+    class MemorySimulator::Shard {
+
+        public:
+            typedef std::vector<const RequestVector *> RequestVectorList;
+
+        public:
+            Shard(const Configuration & c, unsigned int shards) :
+                l1(c.l1, shards), l2(c.l2, shards), _depth(c.reuseDepth),
+                _buckets(reuseBuckets(c.reuseDepth)),
+                _stacks((c.l2.sets() / shards) * c.reuseDepth, 0),
+                _sizes(c.l2.sets() / shards, 0)
+            {
+
+            }
+
+            /*! \brief simulate the requests of each coalescer in turn */
+            void run(const RequestVectorList & requests)
+            {
+                for(RequestVectorList::const_iterator list = requests.begin();
+                    list != requests.end(); ++list)
+                {
+                    for(RequestVector::const_iterator request =
+                        (*list)->begin(); request != (*list)->end(); ++request)
+                    {
+                        access(*request);
+                    }
+                }
+            }
+
+        public:
+            Cache l1;
+            Cache l2;
+
+            StatisticsVector statistics;
+
+        private:
+            void access(const Request & request)
+            {
+                InstructionStatistics & s = _statistics(statistics,
+                    request.instructionId, _buckets);
+
+                /* the reuse stacks follow the sets of the L2 */
+                unsigned int l2Set = l2.set(request.line);
+                unsigned int l1Set = l1.set(request.line);
+
+                unsigned int reuse = distance(l2Set, request.line);
+                s.reuse[reuse == _depth ? _buckets - 1 : reuseBucket(reuse)]++;
+
+                unsigned int misses = request.sectors;
+
+                if(request.store)
+                {
+                    /* stores write through without allocating in the L1 */
+                    l1.invalidate(l1Set, request.line, request.sectors);
+                }
+                else
+                {
+                    unsigned int hits = l1.access(l1Set, request.line,
+                        request.sectors);
+
+                    misses &= ~hits;
+
+                    s.l1Hits += __builtin_popcount(hits);
+                    s.l1Misses += __builtin_popcount(misses);
+
+                    if(misses == 0)
+                        return;
+                }
+
+                unsigned int hits = l2.access(l2Set, request.line, misses);
+
+                s.l2Hits += __builtin_popcount(hits);
+                s.l2Misses += __builtin_popcount(misses & ~hits);
+            }
+
+            /*! \brief the position of line in the LRU stack of its L2 set,
+                _depth if it is not in the top _depth entries */
+            unsigned int distance(unsigned int set, unsigned long long line)
+            {
+                unsigned long long *stack = &_stacks[set * _depth];
+                unsigned int & size = _sizes[set];
+
+                unsigned int position = 0;
+                while(position < size && stack[position] != line)
+                    ++position;
+
+                unsigned int result = position;
+
+                if(position == size)
+                {
+                    result = _depth;
+
+                    if(size < _depth)
+                        ++size;
+
+                    position = size - 1;
+                }
+
+                std::copy_backward(stack, stack + position,
+                    stack + position + 1);
+                stack[0] = line;
+
+                return result;
+            }
+
+        private:
+            unsigned int _depth;
+            unsigned int _buckets;
+
+            std::vector<unsigned long long> _stacks;
+            std::vector<unsigned int> _sizes;
+    };
+
+    /*! \brief Splits records into line requests for each shard */
+    class MemorySimulator::Coalescer {
+
+        public:
+            typedef std::vector<RequestVector> RequestVectorVector;
+
+        public:
+            Coalescer(const Configuration & c, unsigned int shards) :
+                requests(shards), _sectorBits(log2(c.l1.sectorSize)),
+                _lineBits(log2(c.l1.sectorsPerLine())),
+                _buckets(reuseBuckets(c.reuseDepth))
+            {
+                _sectors.reserve(2 * MemoryTraceRecord::Lanes);
+            }
+
+            void run(const MemoryTraceRecord *begin,
+                const MemoryTraceRecord *end)
+            {
+                for(RequestVectorVector::iterator shard = requests.begin();
+                    shard != requests.end(); ++shard)
+                {
+                    shard->clear();
+                }
+
+                for(const MemoryTraceRecord *record = begin; record != end;
+                    ++record)
+                {
+                    coalesce(*record);
+                }
+            }
+
+        public:
+            //! the requests of the last batch by shard
+            RequestVectorVector requests;
+
+            StatisticsVector statistics;
+
+        private:
+            void coalesce(const MemoryTraceRecord & record)
+            {
+                InstructionStatistics & s = _statistics(statistics,
+                    record.instructionId, _buckets);
+
+                unsigned int size = std::max(record.size(), 1u);
+                unsigned int exact = record.activeMask & ~record.overflowMask;
+
+                s.warpAccesses++;
+                s.stores += record.store();
+                s.lanes += __builtin_popcount(record.activeMask);
+                s.inexactLanes += __builtin_popcount(record.activeMask &
+                    record.overflowMask);
+                s.requestedBytes += (unsigned long long)size *
+                    __builtin_popcount(exact);
+
+                /* lanes usually access increasing addresses, only sort the
+                    sectors when they do not */
+                bool sorted = true;
+                _sectors.clear();
+
+                for(unsigned int lane = 0; lane < MemoryTraceRecord::Lanes;
+                    ++lane)
+                {
+                    if(!((exact >> lane) & 1))
+                        continue;
+
+                    unsigned long long address = record.baseAddress +
+                        (long long)record.deltas[lane];
+                    unsigned long long first = address >> _sectorBits;
+                    unsigned long long last = (address + size - 1)
+                        >> _sectorBits;
+
+                    for(; first <= last; ++first)
+                    {
+                        if(!_sectors.empty())
+                        {
+                            if(_sectors.back() == first)
+                                continue;
+                            if(_sectors.back() > first)
+                                sorted = false;
+                        }
+
+                        _sectors.push_back(first);
+                    }
+                }
+
+                if(!sorted)
+                {
+                    std::sort(_sectors.begin(), _sectors.end());
+                    _sectors.erase(std::unique(_sectors.begin(),
+                        _sectors.end()), _sectors.end());
+                }
+
+                s.sectors += _sectors.size();
+
+                unsigned int shards = requests.size();
+                unsigned long long mask = (1ULL << _lineBits) - 1;
+
+                Request request;
+                request.instructionId = record.instructionId;
+                request.store = record.store();
+
+                for(std::vector<unsigned long long>::const_iterator
+                    sector = _sectors.begin(); sector != _sectors.end(); )
+                {
+                    request.line = *sector >> _lineBits;
+                    request.sectors = 0;
+
+                    for(; sector != _sectors.end() &&
+                        (*sector >> _lineBits) == request.line; ++sector)
+                    {
+                        request.sectors |= 1u << (*sector & mask);
+                    }
+
+                    s.lines++;
+
+                    requests[request.line % shards].push_back(request);
+                }
+            }
+
+        private:
+            unsigned int _sectorBits;
+            unsigned int _lineBits;
+            unsigned int _buckets;
+
+            std::vector<unsigned long long> _sectors;
+    };
+
+    MemorySimulator::MemorySimulator(const Configuration & configuration) :
+        _configuration(configuration), _resultsValid(true), _records(0)
+    {
+        _configuration.l1.validate("L1");
+        _configuration.l2.validate("L2");
+
+        if(_configuration.l1.lineSize != _configuration.l2.lineSize ||
+            _configuration.l1.sectorSize != _configuration.l2.sectorSize)
+        {
+            throw hydrazine::Exception("The L1 and L2 caches must use the "
+                "same line and sector sizes.");
+        }
+
+        if(_configuration.reuseDepth == 0)
+            _configuration.reuseDepth = 1;
+
+        if(_configuration.batchRecords == 0)
+            _configuration.batchRecords = 1;
+
+        unsigned int threads = _configuration.threads;
+
+        if(threads == 0)
+            threads = std::max(boost::thread::hardware_concurrency(), 1u);
+
+        /* a set must map to the same shard in both caches */
+        unsigned int shards = 1;
+
+        while(shards * 2 <= threads &&
+            _configuration.l1.sets() % (shards * 2) == 0 &&
+            _configuration.l2.sets() % (shards * 2) == 0)
+        {
+            shards *= 2;
+        }
+
+        report("simulating with " << threads << " coalescers and " << shards
+            << " shards");
+
+        for(unsigned int t = 0; t < threads; ++t)
+            _coalescers.push_back(new Coalescer(_configuration, shards));
+
+        for(unsigned int s = 0; s < shards; ++s)
+            _shards.push_back(new Shard(_configuration, shards));
+
+        _batch.reserve(_configuration.batchRecords);
+    }
+
+    MemorySimulator::~MemorySimulator()
+    {
+        for(CoalescerVector::iterator c = _coalescers.begin();
+            c != _coalescers.end(); ++c)
+        {
+            delete *c;
+        }
+
+        for(ShardVector::iterator s = _shards.begin(); s != _shards.end();
+            ++s)
+        {
+            delete *s;
+        }
+    }
+
+    void MemorySimulator::simulate(const MemoryTraceRecord *records,
+        size_t count)
+    {
+        while(count > 0)
+        {
+            size_t space = _configuration.batchRecords - _batch.size();
+            size_t copied = std::min(space, count);
+
+            _batch.insert(_batch.end(), records, records + copied);
+
+            records += copied;
+            count -= copied;
+
+            if(_batch.size() == _configuration.batchRecords)
+                flush();
+        }
+    }
+
+    void MemorySimulator::simulate(const MemoryTraceRecord & record)
+    {
+        simulate(&record, 1);
+    }
+
+    void MemorySimulator::simulate(MemoryTraceReader & reader)
+    {
+        MemoryTraceRecord record;
+
+        while(reader.next(record))
+            simulate(record);
+
+        flush();
+    }
+
+    void MemorySimulator::flush()
+    {
+        if(_batch.empty())
+            return;
+
+        const MemoryTraceRecord *records = _batch.data();
+        size_t count = _batch.size();
+
+        /* coalesce contiguous slices so that each shard sees the requests
+            in trace order when it takes the coalescers in turn */
+        unsigned int coalescers = std::min<size_t>(_coalescers.size(), count);
+        size_t slice = (count + coalescers - 1) / coalescers;
+
+        {
+            boost::thread_group workers;
+            for(unsigned int t = 1; t < coalescers; ++t)
+            {
+                size_t begin = std::min(t * slice, count);
+                size_t end = std::min(begin + slice, count);
+
+                workers.create_thread(boost::bind(&Coalescer::run,
+                    _coalescers[t], records + begin, records + end));
+            }
+            _coalescers[0]->run(records, records + std::min(slice, count));
+            workers.join_all();
+        }
+
+        std::vector<Shard::RequestVectorList> requests(_shards.size());
+
+        for(unsigned int s = 0; s < _shards.size(); ++s)
+        {
+            for(unsigned int t = 0; t < coalescers; ++t)
+                requests[s].push_back(&_coalescers[t]->requests[s]);
+        }
+
+        {
+            boost::thread_group workers;
+            for(unsigned int s = 1; s < _shards.size(); ++s)
+            {
+                workers.create_thread(boost::bind(&Shard::run, _shards[s],
+                    boost::cref(requests[s])));
+            }
+            _shards[0]->run(requests[0]);
+            workers.join_all();
+        }
+
+        report("simulated " << count << " records");
+
+        _records += count;
+        _batch.clear();
+        _resultsValid = false;
+    }
+
+    void MemorySimulator::attribute(const ir::PTXKernel & kernel)
+    {
+        const ir::ControlFlowGraph *cfg = kernel.cfg();
+        assert(cfg != 0);
+
+        /* the order of the DataflowGraph MemoryTracePass walks */
+        ir::ControlFlowGraph::ConstBlockPointerVector sequence =
+            cfg->executable_sequence();
+
+        unsigned int instructionId = 0;
+
+        for(ir::ControlFlowGraph::ConstBlockPointerVector::const_iterator
+            block = sequence.begin(); block != sequence.end(); ++block)
+        {
+            if(*block == cfg->get_entry_block() ||
+                *block == cfg->get_exit_block())
+                continue;
+
+            for(ir::ControlFlowGraph::InstructionList::const_iterator
+                instruction = (*block)->instructions.begin();
+                instruction != (*block)->instructions.end();
+                ++instruction, ++instructionId)
+            {
+                _attribution[instructionId] = std::make_pair(
+                    (*block)->label(), (*instruction)->toString());
+            }
+        }
+
+        _resultsValid = false;
+    }
+
+    const MemorySimulator::InstructionStatisticsMap &
+        MemorySimulator::statistics()
+    {
+        flush();
+
+        if(_resultsValid)
+            return _results;
+
+        _results.clear();
+
+        for(CoalescerVector::const_iterator c = _coalescers.begin();
+            c != _coalescers.end(); ++c)
+        {
+            for(unsigned int id = 0; id < (*c)->statistics.size(); ++id)
+            {
+                if((*c)->statistics[id].warpAccesses != 0)
+                    _results[id].merge((*c)->statistics[id]);
+            }
+        }
+
+        for(ShardVector::const_iterator s = _shards.begin();
+            s != _shards.end(); ++s)
+        {
+            for(unsigned int id = 0; id < (*s)->statistics.size(); ++id)
+            {
+                const InstructionStatistics & shard = (*s)->statistics[id];
+
+                if(shard.l1Hits + shard.l1Misses + shard.l2Hits +
+                    shard.l2Misses != 0)
+                    _results[id].merge(shard);
+            }
+        }
+
+        for(InstructionStatisticsMap::iterator result = _results.begin();
+            result != _results.end(); ++result)
+        {
+            AttributionMap::const_iterator attribution =
+                _attribution.find(result->first);
+
+            if(attribution != _attribution.end())
+            {
+                result->second.block = attribution->second.first;
+                result->second.instruction = attribution->second.second;
+            }
+        }
+
+        _resultsValid = true;
+
+        return _results;
+    }
+
+    unsigned long long MemorySimulator::records() const
+    {
+        return _records + _batch.size();
+    }
+
+    unsigned int MemorySimulator::shards() const
+    {
+        return _shards.size();
+    }
+
+    void MemorySimulator::write(std::ostream & out)
+    {
+        const InstructionStatisticsMap & results = statistics();
+
+        InstructionStatistics total;
+
+        for(InstructionStatisticsMap::const_iterator result = results.begin();
+            result != results.end(); ++result)
+        {
+            total.merge(result->second);
+        }
+
+        unsigned int sectorSize = _configuration.l1.sectorSize;
+
+        out << std::fixed << std::setprecision(2);
+        out << "Memory simulation: " << _records << " warp accesses, L1 "
+            << _configuration.l1.size / 1024 << "KB "
+            << _configuration.l1.associativity << "-way, L2 "
+            << _configuration.l2.size / 1024 << "KB "
+            << _configuration.l2.associativity << "-way, "
+            << _configuration.l1.lineSize << "B lines of "
+            << sectorSize << "B sectors\n";
+        out << "Sector efficiency: "
+            << total.sectorEfficiency(sectorSize) * 100.0
+            << "%, L1 hit rate: " << total.l1HitRate() * 100.0
+            << "%, L2 hit rate: " << total.l2HitRate() * 100.0 << "%\n";
+
+        for(InstructionStatisticsMap::const_iterator result = results.begin();
+            result != results.end(); ++result)
+        {
+            const InstructionStatistics & s = result->second;
+
+            out << "\n" << result->first << ": ";
+
+            if(s.instruction.empty())
+                out << "(unknown instruction)";
+            else
+                out << s.instruction << " (" << s.block << ")";
+
+            out << "\n  accesses: " << s.warpAccesses
+                << ", stores: " << s.stores
+                << ", sectors/access: " << ratio(s.sectors, s.warpAccesses)
+                << ", lines/access: " << ratio(s.lines, s.warpAccesses)
+                << "\n  sector efficiency: "
+                << s.sectorEfficiency(sectorSize) * 100.0
+                << "%, L1 hit rate: " << s.l1HitRate() * 100.0
+                << "%, L2 hit rate: " << s.l2HitRate() * 100.0 << "%";
+
+            if(s.inexactLanes)
+                out << ", inexact lanes: " << s.inexactLanes;
+
+            out << "\n  reuse distance:";
+
+            for(unsigned int bucket = 0; bucket < s.reuse.size(); ++bucket)
+            {
+                out << " ";
+
+                if(bucket + 1 == s.reuse.size())
+                    out << "cold";
+                else if(bucket < 2)
+                    out << bucket;
+                else
+                    out << (1u << (bucket - 1)) << "-"
+                        << (1u << bucket) - 1;
+
+                out << ":" << s.reuse[bucket];
+            }
+
+            out << "\n";
+        }
+    }
+
+    const MemorySimulator::Configuration &
+        MemorySimulator::configuration() const
+    {
+        return _configuration;
+    }
+
+    MemorySimulator::InstructionStatistics & MemorySimulator::_statistics(
+        StatisticsVector & statistics, unsigned int instructionId,
+        unsigned int buckets)
+    {
+        if(instructionId >= statistics.size())
+            statistics.resize(instructionId + 1);
+
+        InstructionStatistics & result = statistics[instructionId];
+
+        if(result.reuse.empty())
+            result.reuse.resize(buckets, 0);
+
+        return result;
+    }
+
+}
@@ -0,0 +1,277 @@
+/*! \file MemoryTrace.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the memory trace drain, writer and reader
+*/
+
+#include <lynx/trace/interface/MemoryTrace.h>
+
+#include <boost/thread/locks.hpp>
+
+// Hydrazine includes
+#include <hydrazine/interface/Exception.h>
+#include <hydrazine/interface/compression.h>
+#include <hydrazine/interface/debug.h>
+
+#include <cassert>
+#include <cstring>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+/* trace files start with this tag, followed by chunks of
+    (records, compressed bytes, compressed records) */
+#define MEMORY_TRACE_MAGIC "LYNXMTR1"
+
+namespace trace {
+
+    bool MemoryTraceRecord::active(unsigned int lane) const
+    {
+        return (activeMask >> lane) & 1;
+    }
+
+    bool MemoryTraceRecord::store() const
+    {
+        return flags & Store;
+    }
+
+    unsigned int MemoryTraceRecord::size() const
+    {
+        return (flags >> SizeShift) & 0xff;
+    }
+
+    unsigned long long MemoryTraceRecord::address(unsigned int lane) const
+    {
+        return baseAddress + (long long)deltas[lane];
+    }
+
+    MemoryTraceWriter::MemoryTraceWriter(const std::string & path,
+        unsigned int chunkRecords) : _file(path.c_str(), std::ios::binary),
+        _chunkRecords(chunkRecords), _records(0)
+    {
+        if(!_file.is_open())
+        {
+            throw hydrazine::Exception("Could not open memory trace file '" +
+                path + "'.");
+        }
+
+        _file.write(MEMORY_TRACE_MAGIC, std::strlen(MEMORY_TRACE_MAGIC));
+        _chunk.reserve(_chunkRecords);
+    }
+
+    MemoryTraceWriter::~MemoryTraceWriter()
+    {
+        flush();
+    }
+
+    void MemoryTraceWriter::write(const MemoryTraceRecord & record)
+    {
+        _chunk.push_back(record);
+        _chunk.back().sequence = 0;
+
+        if(_chunk.size() >= _chunkRecords)
+            flush();
+    }
+
+    void MemoryTraceWriter::flush()
+    {
+        if(_chunk.empty())
+            return;
+
+        uint64_t records = _chunk.size();
+        uint64_t bytes = records * sizeof(MemoryTraceRecord);
+
+        uint64_t compressedBytes = hydrazine::compressBound(bytes);
+        _compressed.resize(compressedBytes);
+
+        hydrazine::compress(_compressed.data(), compressedBytes,
+            _chunk.data(), bytes);
+
+        _file.write((const char *)&records, sizeof(records));
+        _file.write((const char *)&compressedBytes, sizeof(compressedBytes));
+        _file.write(_compressed.data(), compressedBytes);
+        _file.flush();
+
+        report("wrote " << records << " records in " << compressedBytes
+            << " bytes");
+
+        _records += records;
+        _chunk.clear();
+    }
+
+    unsigned long long MemoryTraceWriter::records() const
+    {
+        return _records + _chunk.size();
+    }
+
+    MemoryTraceReader::MemoryTraceReader(const std::string & path)
+        : _file(path.c_str(), std::ios::binary), _path(path), _position(0)
+    {
+        char magic[sizeof(MEMORY_TRACE_MAGIC)] = {0};
+        _file.read(magic, std::strlen(MEMORY_TRACE_MAGIC));
+
+        if(!_file.good() || std::strcmp(magic, MEMORY_TRACE_MAGIC) != 0)
+        {
+            throw hydrazine::Exception("'" + path +
+                "' is not a memory trace.");
+        }
+    }
+
+    bool MemoryTraceReader::next(MemoryTraceRecord & record)
+    {
+        if(_position == _chunk.size() && !_load())
+            return false;
+
+        record = _chunk[_position++];
+
+        return true;
+    }
+
+    bool MemoryTraceReader::_load()
+    {
+        uint64_t records = 0;
+        uint64_t compressedBytes = 0;
+
+        _file.read((char *)&records, sizeof(records));
+        _file.read((char *)&compressedBytes, sizeof(compressedBytes));
+
+        if(_file.eof())
+            return false;
+
+        _compressed.resize(compressedBytes);
+        _file.read(_compressed.data(), compressedBytes);
+
+        if(!_file.good())
+        {
+            throw hydrazine::Exception("Truncated memory trace '" + _path +
+                "'.");
+        }
+
+        uint64_t bytes = records * sizeof(MemoryTraceRecord);
+        _chunk.resize(records);
+
+        hydrazine::decompress(_chunk.data(), bytes, _compressed.data(),
+            compressedBytes);
+
+        if(bytes != records * sizeof(MemoryTraceRecord))
+        {
+            throw hydrazine::Exception("Corrupt chunk in memory trace '" +
+                _path + "'.");
+        }
+
+        _position = 0;
+
+        return records > 0 || _load();
+    }
+
+    MemoryTraceDrain::MemoryTraceDrain(MemoryTraceRecord *records,
+        volatile unsigned long long *tail, unsigned long long capacity,
+        MemoryTraceWriter & writer) : _records(records), _tail(tail),
+        _capacity(capacity), _writer(writer), _thread(0), _stop(false)
+    {
+        assert(capacity > 0);
+    }
+
+    MemoryTraceDrain::~MemoryTraceDrain()
+    {
+        if(_thread)
+            stop(*_tail);
+    }
+
+    void MemoryTraceDrain::start()
+    {
+        assert(!_thread);
+
+        _stop = false;
+        _thread = new boost::thread(&MemoryTraceDrain::run, this);
+    }
+
+    unsigned long long MemoryTraceDrain::stop(unsigned long long head)
+    {
+        {
+            boost::unique_lock<boost::mutex> lock(_mutex);
+            _stop = true;
+        }
+
+        if(_thread)
+        {
+            _thread->join();
+            delete _thread;
+            _thread = 0;
+        }
+
+        /* the kernel has completed, every reserved record is in the ring */
+        while(*_tail < head && poll() > 0);
+
+        unsigned long long missing = head - *_tail;
+
+        if(missing > 0)
+        {
+            report(missing << " of " << head
+                << " trace records were never written");
+        }
+
+        _writer.flush();
+
+        return missing;
+    }
+
+    unsigned long long MemoryTraceDrain::poll()
+    {
+        unsigned long long consumed = 0;
+        unsigned long long position = *_tail;
+
+        while(true)
+        {
+            MemoryTraceRecord *record = _records + (position % _capacity);
+            volatile unsigned int *sequence = &record->sequence;
+
+            if(*sequence != (unsigned int)(position + 1))
+                break;
+
+            /* the sequence is written after the rest of the record */
+            __sync_synchronize();
+
+            _writer.write(*record);
+
+            *sequence = 0;
+            __sync_synchronize();
+
+            /* producers check tail before reusing the slot */
+            *_tail = ++position;
+            consumed++;
+        }
+
+        return consumed;
+    }
+
+    unsigned long long MemoryTraceDrain::drained() const
+    {
+        return *_tail;
+    }
+
+    void MemoryTraceDrain::run()
+    {
+        report("memory trace drain started");
+
+        while(true)
+        {
+            unsigned long long consumed = poll();
+
+            {
+                boost::unique_lock<boost::mutex> lock(_mutex);
+                if(_stop)
+                    break;
+            }
+
+            if(consumed == 0)
+                boost::this_thread::sleep(boost::posix_time::microseconds(50));
+        }
+
+        report("memory trace drain stopped after " << *_tail << " records");
+    }
+
+}
@@ -12,6 +12,7 @@
 #include <iostream>
 #include <fstream>
 #include <ostream>
+#include <cmath>
 
 #ifdef REPORT_BASE
 #undef REPORT_BASE
@@ -73,9 +74,143 @@ void Profiler::KernelProfiler::updateCounter(
         break;
         default:
         break;   
-    }       
+    }
+    
+    counterSamples[type].add(type == DYNAMIC_HALF_WARPS_EXEC_MEM_TRANSACTIONS ?
+        counter * 2 : counter);
 }    
 
+void Profiler::KernelProfiler::CounterSamples::add(double value)
+{
+    samples++;
+    sum += value;
+    sumOfSquares += value * value;
+}
+
+double Profiler::KernelProfiler::CounterSamples::mean() const
+{
+    if(samples == 0)
+        return 0;
+        
+    return sum / samples;
+}
+
+double Profiler::KernelProfiler::CounterSamples::variance() const
+{
+    if(samples < 2)
+        return 0;
+    
+    double m = mean();
+    
+    return std::max((sumOfSquares - samples * m * m) / (samples - 1), 0.0);
+}
+
+void Profiler::KernelProfiler::recordLaunch(bool sampled)
+{
+    launches++;
+    if(sampled)
+        sampledLaunches++;
+}
+
+double Profiler::KernelProfiler::estimate(CounterType type, 
+    double & confidence) const
+{
+    confidence = 0;
+    
+    CounterSampleMap::const_iterator samples = counterSamples.find(type);
+    if(samples == counterSamples.end() || samples->second.samples == 0)
+        return 0;
+    
+    /* without sampling every launch was measured -- the total is exact */
+    if(launches <= samples->second.samples)
+        return samples->second.sum;
+    
+    double n = samples->second.samples;
+    double N = launches;
+    
+    /* 95% interval of the extrapolated total, with the finite population 
+        correction since the launches are sampled without replacement */
+    confidence = 1.96 * N * std::sqrt(samples->second.variance() / n) * 
+        std::sqrt(1.0 - n / N);
+    
+    return N * samples->second.mean();
+}
+
+void Profiler::KernelProfiler::merge(const KernelProfiler & profiler)
+{
+    kernelExecute += profiler.kernelExecute;
+    runtime += profiler.runtime;
+    instructionCount += profiler.instructionCount;
+    branches += profiler.branches;
+    divergentBranches += profiler.divergentBranches;
+    globalMemTransactions += profiler.globalMemTransactions;
+    dynamicHalfWarpsExecutingMemTransactions += 
+        profiler.dynamicHalfWarpsExecutingMemTransactions;
+    barriers += profiler.barriers;
+    maxThreads += profiler.maxThreads;
+    activeThreads += profiler.activeThreads;
+    warps += profiler.warps;
+    /* the same kernel has the same branches on every device */
+    uniformBranches = std::max(uniformBranches, profiler.uniformBranches);
+    launches += profiler.launches;
+    sampledLaunches += profiler.sampledLaunches;
+    
+    for(ProcessorToThreadBlockCountMap::const_iterator count = 
+        profiler.processorToThreadBlockCount.begin(); 
+        count != profiler.processorToThreadBlockCount.end(); ++count)
+    {
+        processorToThreadBlockCount[count->first] += count->second;
+    }
+    
+    for(ProcessorToClockCyclesMap::const_iterator cycles = 
+        profiler.processorToClockCycles.begin(); 
+        cycles != profiler.processorToClockCycles.end(); ++cycles)
+    {
+        processorToClockCycles[cycles->first] += cycles->second;
+    }
+    
+    for(BasicBlockToExecCountMap::const_iterator count = 
+        profiler.basicBlockToExecCount.begin(); 
+        count != profiler.basicBlockToExecCount.end(); ++count)
+    {
+        basicBlockToExecCount[count->first] += count->second;
+    }
+    
+    threadBlockToProcessor.insert(profiler.threadBlockToProcessor.begin(),
+        profiler.threadBlockToProcessor.end());
+    
+    /* the launches of every device are samples of the same population */
+    for(CounterSampleMap::const_iterator samples = 
+        profiler.counterSamples.begin(); 
+        samples != profiler.counterSamples.end(); ++samples)
+    {
+        CounterSamples & total = counterSamples[samples->first];
+        
+        total.samples += samples->second.samples;
+        total.sum += samples->second.sum;
+        total.sumOfSquares += samples->second.sumOfSquares;
+    }
+}
+
+const char *Profiler::KernelProfiler::counterName(CounterType type)
+{
+    switch(type) {
+        case BRANCHES: return "branches";
+        case DIVERGENT_BRANCHES: return "divergentBranches";
+        case GLOBAL_MEM_TRANSACTIONS: return "globalMemTransactions";
+        case DYNAMIC_HALF_WARPS_EXEC_MEM_TRANSACTIONS: 
+            return "dynamicHalfWarpsExecutingMemTransactions";
+        case BARRIERS: return "barriers";
+        case INST_COUNT: return "instructionCount";
+        case MAX_THREADS: return "maxThreads";
+        case ACTIVE_THREADS: return "activeThreads";
+        case WARPS: return "warps";
+        default: break;
+    }
+    
+    return "unknown";
+}
+
 void Profiler::KernelProfiler::updateRuntime(double r)
 {   
     runtime = r;
@@ -95,6 +230,7 @@ void Profiler::KernelProfiler::write(std::ostream *out) {
 		{ "activeThreads", &activeThreads},
 		{ "maxThreads", &maxThreads},
 		{ "warps", &warps},
+		{ "uniformBranches", &uniformBranches},
 		{ 0, 0 }  
 	};
 
@@ -106,14 +242,33 @@ void Profiler::KernelProfiler::write(std::ostream *out) {
         if(kernelProfilerMembers[i+1].ptr)
              *out << ", ";       
      }
+     
+    if(sampledLaunches < launches)
+    {
+        *out << ", \"launches\": " << launches << ", \"sampledLaunches\": " 
+            << sampledLaunches;
+        
+        for(CounterSampleMap::const_iterator samples = counterSamples.begin();
+            samples != counterSamples.end(); ++samples)
+        {
+            double confidence = 0;
+            double total = estimate(samples->first, confidence);
+            
+            *out << ", \"" << counterName(samples->first) << "Estimate\": " 
+                << total << ", \"" << counterName(samples->first) 
+                << "CI95\": " << confidence;
+        }
+    }
 }
 
 Profiler::Profiler(): 
 	dataMove(0), dataMoveSize(0), appExecute(0), kernelsExecute(0), runtime(0), 
-	branches(0), divergentBranches(0), globalMemTransactions(0), 
+	jitCompile(0), branches(0), divergentBranches(0), uniformBranches(0),
+	globalMemTransactions(0), 
 	dynamicHalfWarpsExecutingMemTransactions(0),
 	barriers(0), instructionCount(0), maxThreads(0), activeThreads(0),
-	warps(0) {
+	warps(0), jitQueueDepth(0), jitModulesReady(0), 
+	jitPendingLaunches(0) {
 }
 
 Profiler::~Profiler() {
@@ -126,6 +281,7 @@ Profiler::~Profiler() {
 		{ "appExecute", &appExecute},
 		{ "kernelsExecute", &kernelsExecute},
 		{ "runtime", &runtime},
+		{ "jitCompile", &jitCompile},
 		{ 0, 0 }
 	};
 	
@@ -136,6 +292,7 @@ Profiler::~Profiler() {
         { "dataMoveSize", &dataMoveSize },
         { "branches", &branches },
 		{ "divergentBranches", &divergentBranches},
+		{ "uniformBranches", &uniformBranches},
 		{ "globalMemTransactions", &globalMemTransactions},
 		{ "dynamicHalfWarpsExecutingMemTransactions", &dynamicHalfWarpsExecutingMemTransactions},
 		{ "barriers", &barriers},
@@ -143,9 +300,14 @@ Profiler::~Profiler() {
 		{ "activeThreads", &activeThreads},
 		{ "maxThreads", &maxThreads},
 		{ "warps", &warps},
+		{ "jitQueueDepth", &jitQueueDepth},
+		{ "jitModulesReady", &jitModulesReady},
+		{ "jitPendingLaunches", &jitPendingLaunches},
 		{ 0, 0 }
     };	    
 	
+	aggregate();
+	
 	report("log: " << instrumentation::InstrumentationRuntime::Singleton.configuration.log);
 	report("appExecute: " << appExecute);
 	if(instrumentation::InstrumentationRuntime::Singleton.configuration.log)
@@ -165,12 +327,38 @@ Profiler::~Profiler() {
 	    }       
 	    
 	    *out << "{ ";
+	    
+	    typedef std::map<KernelProfiler::CounterType, 
+	        std::pair<double, double> > EstimateMap;
+	    
+	    EstimateMap estimates;
+	    bool sampled = false;
 	
 	    for(KernelProfilerMap::iterator kernelProfiler = kernelProfilers.begin();
 	        kernelProfiler != kernelProfilers.end(); ++kernelProfiler)
         {
+            if(kernelProfiler->second.sampledLaunches < 
+                kernelProfiler->second.launches)
+                sampled = true;
+            
+            /* estimates of independent kernels add up, as do the variances
+                behind their confidence intervals */
+            for(KernelProfiler::CounterSampleMap::const_iterator samples = 
+                kernelProfiler->second.counterSamples.begin();
+                samples != kernelProfiler->second.counterSamples.end(); 
+                ++samples)
+            {
+                double confidence = 0;
+                double total = kernelProfiler->second.estimate(samples->first, 
+                    confidence);
+                
+                estimates[samples->first].first += total;
+                estimates[samples->first].second += confidence * confidence;
+            }
+            
             branches += kernelProfiler->second.branches;
             divergentBranches += kernelProfiler->second.divergentBranches;
+            uniformBranches += kernelProfiler->second.uniformBranches;
             globalMemTransactions += kernelProfiler->second.globalMemTransactions;
             dynamicHalfWarpsExecutingMemTransactions += 
                 kernelProfiler->second.dynamicHalfWarpsExecutingMemTransactions;
@@ -199,6 +387,49 @@ Profiler::~Profiler() {
 	        if(counters[i+1].ptr)
 	             *out << ", ";     
 	    }
+	    
+	    /* a single device is what the totals already describe */
+	    if(deviceProfilers.size() > 1)
+	    {
+	        for(DeviceProfilerMap::const_iterator device = 
+	            deviceProfilers.begin(); device != deviceProfilers.end(); 
+	            ++device)
+	        {
+	            KernelProfiler total;
+	            
+	            for(KernelProfilerMap::const_iterator kernelProfiler = 
+	                device->second.kernelProfilers.begin();
+	                kernelProfiler != device->second.kernelProfilers.end();
+	                ++kernelProfiler)
+	            {
+	                total.merge(kernelProfiler->second);
+	            }
+	            
+	            *out << ", \"device" << device->first << "\": {"
+	                << "\"kernelsExecute\": " << device->second.kernelsExecute
+	                << ", \"launches\": " << device->second.launches 
+	                << ", \"sampledLaunches\": " 
+	                << device->second.sampledLaunches
+	                << ", \"instructionCount\": " << total.instructionCount
+	                << ", \"branches\": " << total.branches
+	                << ", \"divergentBranches\": " << total.divergentBranches
+	                << ", \"globalMemTransactions\": " 
+	                << total.globalMemTransactions 
+	                << ", \"runtime\": " << total.runtime << "}";
+	        }
+	    }
+	    
+	    if(sampled)
+	    {
+	        for(EstimateMap::const_iterator estimate = estimates.begin();
+	            estimate != estimates.end(); ++estimate)
+	        {
+	            *out << ", \"" << KernelProfiler::counterName(estimate->first) 
+	                << "Estimate\": " << estimate->second.first << ", \"" 
+	                << KernelProfiler::counterName(estimate->first) 
+	                << "CI95\": " << std::sqrt(estimate->second.second);
+	        }
+	    }
 	
 	    *out << "}\n";
 	    
@@ -207,9 +438,38 @@ Profiler::~Profiler() {
 	}
 	
 	kernelProfilers.clear();
+	deviceProfilers.clear();
 	
 }
 
+void Profiler::aggregate() {
+
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    
+    for(DeviceProfilerMap::const_iterator device = deviceProfilers.begin();
+        device != deviceProfilers.end(); ++device)
+    {
+        kernelsExecute += device->second.kernelsExecute;
+    
+        for(KernelProfilerMap::const_iterator kernelProfiler = 
+            device->second.kernelProfilers.begin();
+            kernelProfiler != device->second.kernelProfilers.end(); 
+            ++kernelProfiler)
+        {
+            kernelProfilers[kernelProfiler->first].merge(
+                kernelProfiler->second);
+        }
+    }
+}
+
+Profiler::DeviceProfiler & Profiler::device(int device) {
+
+    /* map nodes never move, the reference stays valid after unlocking */
+    boost::unique_lock<boost::mutex> lock(_mutex);
+    
+    return deviceProfilers[device];
+}
+
 //! starts a timer
 void Profiler::startTimer() {
 	timer.start();
@@ -230,61 +490,32 @@ void Profiler::stopTimer(double Profiler::* accumulator) {
 	this->*accumulator += timer.seconds();
 }
 
-//! stops the timer and adds time to a selected accumulator
-void Profiler::stopKernelTimer(double Profiler::* accumulator,
-    std::string kernelName) {
-	timer.stop();
-
-    KernelProfilerMap::iterator kernelProfiler = kernelProfilers.find(kernelName);
-    if(kernelProfiler == kernelProfilers.end())
-    {
-        KernelProfiler newProfiler;
-        newProfiler.kernelExecute = timer.seconds();
-        kernelProfilers.insert(std::make_pair(kernelName, newProfiler));
-    }
-    else 
-    {
-        kernelProfiler->second.kernelExecute = timer.seconds();
-    }
-
-	this->*accumulator += timer.seconds();
+Profiler::KernelProfiler *Profiler::DeviceProfiler::kernelProfiler(
+    const std::string & kernelName) {
+    
+    return &kernelProfilers[kernelName];
 }
 
-void Profiler::updateCounter(std::string kernelName, KernelProfiler::CounterType type, 
-    unsigned long counter) {
+void Profiler::DeviceProfiler::updateCounter(const std::string & kernelName, 
+    KernelProfiler::CounterType type, unsigned long counter) {
     
-    KernelProfilerMap::iterator kernelProfiler = kernelProfilers.find(kernelName);
-    if(kernelProfiler == kernelProfilers.end())
-    {
-        KernelProfiler newProfiler;
-        newProfiler.updateCounter(type, counter);
-        kernelProfilers.insert(std::make_pair(kernelName, newProfiler));
-    }
-    else 
-    {
-        kernelProfiler->second.updateCounter(type, counter);
-    }    
-
+    kernelProfiler(kernelName)->updateCounter(type, counter);
 }
 
-void Profiler::updateRuntime(std::string kernelName, double r)
+void Profiler::DeviceProfiler::recordLaunch(KernelProfiler *kernel, 
+    bool sampled)
 {
-    KernelProfilerMap::iterator kernelProfiler = kernelProfilers.find(kernelName);
-    if(kernelProfiler == kernelProfilers.end())
-    {
-        KernelProfiler newProfiler;
-        newProfiler.updateRuntime(r);
-        kernelProfilers.insert(std::make_pair(kernelName, newProfiler));
-    }
-    else 
-    {
-        kernelProfiler->second.updateRuntime(r);
-    }    
+    launches++;
+    if(sampled)
+        sampledLaunches++;
+    
+    kernel->recordLaunch(sampled);
 }
 
+void Profiler::DeviceProfiler::updateRuntime(const std::string & kernelName, 
+    double r)
+{
+    kernelProfiler(kernelName)->updateRuntime(r);
 }
 
-
-
-
-
+}
\ No newline at end of file
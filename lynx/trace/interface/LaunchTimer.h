@@ -0,0 +1,101 @@
+/*! \file LaunchTimer.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the event based timer of kernel launches
+*/
+
+#ifndef TRACE_LAUNCH_TIMER_H_INCLUDED
+#define TRACE_LAUNCH_TIMER_H_INCLUDED
+
+#include <lynx/trace/interface/Profiler.h>
+
+#include <cuda.h>
+
+#include <deque>
+#include <vector>
+
+namespace trace {
+
+    /*! \brief The measured time of a set of launches */
+    class LaunchTime {
+
+        public:
+            LaunchTime(): seconds(0), launches(0) { }
+
+            /*! \brief The mean time of a measured launch */
+            double mean() const;
+
+        public:
+            double seconds;
+            unsigned long launches;
+    };
+
+    /*! \brief Measures the device time of kernel launches with events
+        recorded on the stream of the launch.
+
+        The time of a launch is known once the stream has passed its stop
+        event. Finished launches are collected without waiting by collect(),
+        which adds their time to the profile of the kernel and to an optional
+        LaunchTime, so the caller decides which lock guards them. A timer is
+        used by one thread at a time.
+    */
+    class LaunchTimer {
+
+        public:
+            LaunchTimer();
+            ~LaunchTimer();
+
+        public:
+            /*! \brief Record the start of a launch on a stream */
+            void start(CUstream stream);
+
+            /*! \brief Record the end of the launch started last, its time
+                is added to the profilers and to time (if not 0) once it 
+                finished */
+            void stop(CUstream stream, Profiler::DeviceProfiler *device,
+                Profiler::KernelProfiler *kernel, LaunchTime *time);
+
+            /*! \brief Add the time of the launches that finished, waiting
+                for all of them if wait is set */
+            void collect(bool wait = false);
+
+            /*! \brief Launches that did not finish yet */
+            size_t pending() const;
+
+        public:
+            LaunchTimer(const LaunchTimer&) = delete;
+            const LaunchTimer& operator=(const LaunchTimer&) = delete;
+
+        private:
+            class Measurement {
+                public:
+                    CUevent start;
+                    CUevent stop;
+                    Profiler::DeviceProfiler *device;
+                    Profiler::KernelProfiler *kernel;
+                    LaunchTime *time;
+            };
+
+            typedef std::deque<Measurement> MeasurementQueue;
+            typedef std::vector<CUevent> EventVector;
+
+            /*! \brief launches waited for once this many are pending */
+            static const size_t MaxPending = 64;
+
+        private:
+            CUevent _event();
+            void _release(const Measurement & measurement);
+            void _record(const Measurement & measurement);
+
+        private:
+            //! events that are not recorded
+            EventVector _events;
+            //! the start event of the launch that is not stopped yet, or 0
+            CUevent _start;
+            //! launches in the order they were stopped
+            MeasurementQueue _pending;
+    };
+
+}
+
+#endif
@@ -0,0 +1,215 @@
+/*! \file MemorySimulator.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the host side cache and coalescing simulator
+	    that replays memory traces
+*/
+
+#ifndef TRACE_MEMORY_SIMULATOR_H_INCLUDED
+#define TRACE_MEMORY_SIMULATOR_H_INCLUDED
+
+#include <lynx/trace/interface/MemoryTrace.h>
+
+#include <map>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace ir
+{
+    class PTXKernel;
+}
+
+namespace trace {
+
+    /*! \brief The geometry of one set associative, sectored cache */
+    class CacheConfiguration {
+
+        public:
+            CacheConfiguration(unsigned long long size = 16384,
+                unsigned int lineSize = 128, unsigned int sectorSize = 32,
+                unsigned int associativity = 4);
+
+            unsigned int sets() const;
+            unsigned int sectorsPerLine() const;
+
+            /*! \brief throws if the geometry can not be simulated */
+            void validate(const std::string & name) const;
+
+        public:
+            //! capacity in bytes
+            unsigned long long size;
+            //! bytes per tag
+            unsigned int lineSize;
+            //! bytes per valid bit, the unit of transfer
+            unsigned int sectorSize;
+            //! ways per set
+            unsigned int associativity;
+    };
+
+    /*! \brief Replays the warp accesses of a memory trace through a
+        coalescer, an L1 and an L2 cache.
+
+        Each record is coalesced into the unique sectors touched by its
+        active lanes. Loads look up the L1 and go to the L2 on a miss,
+        stores write through to the L2 and invalidate the sector in the L1.
+        There is a single L1, the trace does not say which multiprocessor
+        issued an access. Both levels allocate on a miss and replace the
+        least recently used line of a set.
+
+        Batches of records are coalesced by several threads, the resulting
+        sector requests are then split into shards by set index and every
+        shard is simulated by its own thread. A set belongs to exactly one
+        shard, so the shards never share state and the order of the
+        requests within each set is the order of the trace.
+
+        The reuse distance of the access of a warp to a line is the number
+        of distinct lines mapping to the same L2 set that were accessed since
+        the last access to that line.
+    */
+    class MemorySimulator {
+
+        public:
+
+            class Configuration {
+
+                public:
+                    Configuration();
+
+                public:
+                    CacheConfiguration l1;
+                    CacheConfiguration l2;
+                    //! worker threads, 0 to use one per hardware thread
+                    unsigned int threads;
+                    //! records coalesced before the shards are simulated
+                    unsigned int batchRecords;
+                    //! deepest reuse distance that is told apart from a
+                    //! cold access
+                    unsigned int reuseDepth;
+            };
+
+            /*! \brief request counts by log2 of the reuse distance, the
+                last bucket counts cold and deeper accesses */
+            typedef std::vector<unsigned long long> Histogram;
+
+            class InstructionStatistics {
+
+                public:
+                    InstructionStatistics();
+
+                    void merge(const InstructionStatistics & statistics);
+
+                    double l1HitRate() const;
+                    double l2HitRate() const;
+
+                    /*! \brief bytes requested by the lanes over the bytes
+                        of the sectors that were transferred */
+                    double sectorEfficiency(unsigned int sectorSize) const;
+
+                public:
+                    //! the PTX block and instruction, set by attribute()
+                    std::string block;
+                    std::string instruction;
+
+                    unsigned long long warpAccesses;
+                    unsigned long long stores;
+                    unsigned long long lanes;
+                    //! lanes whose address did not fit in the record
+                    unsigned long long inexactLanes;
+                    unsigned long long requestedBytes;
+                    unsigned long long sectors;
+                    unsigned long long lines;
+
+                    unsigned long long l1Hits;
+                    unsigned long long l1Misses;
+                    unsigned long long l2Hits;
+                    unsigned long long l2Misses;
+
+                    Histogram reuse;
+            };
+
+            typedef std::map<unsigned int, InstructionStatistics>
+                InstructionStatisticsMap;
+
+        public:
+            MemorySimulator(const Configuration & configuration =
+                Configuration());
+            ~MemorySimulator();
+
+            /*! \brief queue records, full batches are simulated at once */
+            void simulate(const MemoryTraceRecord *records, size_t count);
+            void simulate(const MemoryTraceRecord & record);
+
+            /*! \brief replay every record of a trace file */
+            void simulate(MemoryTraceReader & reader);
+
+            /*! \brief simulate the queued records */
+            void flush();
+
+            /*! \brief name the instructions of the statistics after the
+                kernel that was traced, in the order MemoryTracePass
+                numbers them */
+            void attribute(const ir::PTXKernel & kernel);
+
+            /*! \brief the statistics of every instruction seen so far */
+            const InstructionStatisticsMap & statistics();
+
+            /*! \brief records simulated so far */
+            unsigned long long records() const;
+
+            unsigned int shards() const;
+
+            /*! \brief write a report of every instruction */
+            void write(std::ostream & out);
+
+            const Configuration & configuration() const;
+
+        private:
+            /*! \brief the sectors of one line accessed by a warp */
+            class Request {
+                public:
+                    unsigned long long line;
+                    unsigned int instructionId;
+                    unsigned short sectors;
+                    unsigned short store;
+            };
+
+            typedef std::vector<Request> RequestVector;
+            typedef std::vector<InstructionStatistics> StatisticsVector;
+
+            class Cache;
+            class Shard;
+            class Coalescer;
+
+            typedef std::vector<Shard *> ShardVector;
+            typedef std::vector<Coalescer *> CoalescerVector;
+
+            //! the block and text of each instruction
+            typedef std::map<unsigned int, std::pair<std::string,
+                std::string> > AttributionMap;
+
+        private:
+            static InstructionStatistics & _statistics(
+                StatisticsVector & statistics, unsigned int instructionId,
+                unsigned int buckets);
+
+        private:
+            Configuration _configuration;
+
+            std::vector<MemoryTraceRecord> _batch;
+
+            CoalescerVector _coalescers;
+            ShardVector _shards;
+
+            AttributionMap _attribution;
+
+            InstructionStatisticsMap _results;
+            bool _resultsValid;
+
+            unsigned long long _records;
+    };
+
+}
+
+#endif
@@ -0,0 +1,177 @@
+/*! \file MemoryTrace.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the memory trace records written by
+	    instrumented kernels and the host side drain, writer and reader of
+	    compressed trace files
+*/
+
+#ifndef TRACE_MEMORY_TRACE_H_INCLUDED
+#define TRACE_MEMORY_TRACE_H_INCLUDED
+
+#include <boost/thread/thread.hpp>
+#include <boost/thread/mutex.hpp>
+
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace trace {
+
+    /*! \brief One memory instruction executed by one warp. The layout is
+        shared with the device code inserted by MemoryTracePass. */
+    class MemoryTraceRecord {
+
+        public:
+
+            enum {
+                Lanes = 32
+            };
+
+            enum Flags {
+                //! the access writes memory
+                Store   = 0x1,
+                //! the access reads memory
+                Load    = 0x2,
+                //! the address is generic and may not be global
+                Generic = 0x4,
+                //! bytes accessed per lane are kept in bits 8 to 15
+                SizeShift = 8
+            };
+
+        public:
+            /*! \brief ring position + 1, written last by the device and
+                cleared by the drain, 0 while the slot is free */
+            unsigned int sequence;
+            /*! \brief kernel relative index of the memory instruction */
+            unsigned int instructionId;
+            /*! \brief lanes that performed the access */
+            unsigned int activeMask;
+            /*! \brief lanes whose address is more than 2GB from the base */
+            unsigned int overflowMask;
+            /*! \brief address of the lowest active lane */
+            unsigned long long baseAddress;
+            /*! \brief Flags and access size */
+            unsigned int flags;
+            unsigned int reserved;
+            /*! \brief address of each lane relative to baseAddress */
+            int deltas[Lanes];
+
+        public:
+            bool active(unsigned int lane) const;
+            bool store() const;
+
+            /*! \brief bytes accessed by each lane */
+            unsigned int size() const;
+
+            /*! \brief the address accessed by a lane, exact unless the lane
+                is in overflowMask */
+            unsigned long long address(unsigned int lane) const;
+    };
+
+    /*! \brief The ring header, kept in device memory. The device reserves
+        records by advancing head with a compare and swap while the ring has
+        room, the host drain publishes the position it consumed up to in
+        tail. A warp that finds the ring full drops its record. */
+    class MemoryTraceBuffer {
+
+        public:
+            //! records reserved so far
+            unsigned long long head;
+            //! number of records in the ring
+            unsigned long long capacity;
+            //! device address of the records (mapped host memory)
+            unsigned long long records;
+            //! device address of the consumer position (mapped host memory)
+            unsigned long long tail;
+            //! records dropped because the ring was full
+            unsigned long long dropped;
+    };
+
+    /*! \brief Writes records into a trace file as a sequence of
+        independently compressed chunks */
+    class MemoryTraceWriter {
+
+        public:
+            MemoryTraceWriter(const std::string & path,
+                unsigned int chunkRecords = 4096);
+            ~MemoryTraceWriter();
+
+            void write(const MemoryTraceRecord & record);
+
+            /*! \brief compress and write the buffered records */
+            void flush();
+
+            /*! \brief records written so far */
+            unsigned long long records() const;
+
+        private:
+            std::ofstream _file;
+            std::vector<MemoryTraceRecord> _chunk;
+            std::vector<char> _compressed;
+            unsigned int _chunkRecords;
+            unsigned long long _records;
+    };
+
+    /*! \brief Reads back the records of a trace file */
+    class MemoryTraceReader {
+
+        public:
+            MemoryTraceReader(const std::string & path);
+
+            /*! \brief the next record, false at the end of the trace */
+            bool next(MemoryTraceRecord & record);
+
+        private:
+            bool _load();
+
+        private:
+            std::ifstream _file;
+            std::string _path;
+            std::vector<MemoryTraceRecord> _chunk;
+            std::vector<char> _compressed;
+            size_t _position;
+    };
+
+    /*! \brief Consumes the ring on a host thread while the kernel runs.
+        The drain only touches host memory, so it can be driven with a
+        synthetic ring as well as with the mapped one of a launch. */
+    class MemoryTraceDrain {
+
+        public:
+            MemoryTraceDrain(MemoryTraceRecord *records,
+                volatile unsigned long long *tail, unsigned long long capacity,
+                MemoryTraceWriter & writer);
+            ~MemoryTraceDrain();
+
+            /*! \brief start polling the ring on a worker thread */
+            void start();
+
+            /*! \brief consume everything up to head, the final number of
+                reserved records, and stop the worker thread. Returns the
+                number of records that never became ready. */
+            unsigned long long stop(unsigned long long head);
+
+            /*! \brief consume the records that are ready, in order */
+            unsigned long long poll();
+
+            /*! \brief records consumed so far */
+            unsigned long long drained() const;
+
+        private:
+            void run();
+
+        private:
+            MemoryTraceRecord *_records;
+            volatile unsigned long long *_tail;
+            unsigned long long _capacity;
+            MemoryTraceWriter & _writer;
+
+            boost::mutex _mutex;
+            boost::thread *_thread;
+            bool _stop;
+    };
+
+}
+
+#endif
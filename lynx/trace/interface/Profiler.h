@@ -12,8 +12,11 @@
 // Hydrazine includes
 #include <hydrazine/interface/Timer.h>
 
+#include <boost/thread/mutex.hpp>
+
 #include <map>
 #include <ostream>
+#include <string>
 #include <vector>
 
 namespace trace {
@@ -48,8 +51,29 @@ namespace trace {
 
                 /*! \brief Maps Basic Block ID to total number of basic block execution */
                 typedef std::map<size_t, size_t> BasicBlockToExecCountMap;
+                
+                /*! \brief Running statistics of one counter over the 
+                    instrumented (sampled) launches of a kernel */
+                class CounterSamples {
+                    public:
+                        CounterSamples(): samples(0), sum(0), 
+                            sumOfSquares(0) { }
+                        
+                        void add(double value);
+                        double mean() const;
+                        double variance() const;
+                    
+                    public:
+                        unsigned long samples;
+                        double sum;
+                        double sumOfSquares;
+                };
+                
+                typedef std::map<CounterType, CounterSamples> CounterSampleMap;
 	       
 	            
+	            //! device time of the launches of the kernel, measured on the
+	            //! streams of the launches of every thread
 	            double kernelExecute;
 	            double runtime;
 	            
@@ -63,10 +87,19 @@ namespace trace {
 	            unsigned long activeThreads;
 	            unsigned long warps;
 	            
+	            //! conditional branches of the kernel that divergence analysis
+	            //! proved uniform, counted once per kernel and not per launch
+	            unsigned long uniformBranches;
+	            
+	            //! total launches and launches that ran instrumented
+	            unsigned long launches;
+	            unsigned long sampledLaunches;
+	            
 	            ThreadBlockToProcessorMap threadBlockToProcessor;
 	            ProcessorToThreadBlockCountMap processorToThreadBlockCount;
 	            ProcessorToClockCyclesMap processorToClockCycles;
 	            BasicBlockToExecCountMap basicBlockToExecCount;
+	            CounterSampleMap counterSamples;
 	            
 	            KernelProfiler(): 
 	                kernelExecute(0),
@@ -79,15 +112,63 @@ namespace trace {
 	                barriers(0),
 	                maxThreads(0),
 	                activeThreads(0),
-	                warps(0)
+	                warps(0),
+	                uniformBranches(0),
+	                launches(0),
+	                sampledLaunches(0)
 	            { }
 	            
 	            void updateCounter(CounterType type, unsigned long counter);
 	            void updateRuntime(double r);
+	            void recordLaunch(bool sampled);
+	            
+	            /*! \brief Adds the launches and counters of the same kernel
+	                on another device */
+	            void merge(const KernelProfiler & profiler);
+	            
+	            /*! \brief Extrapolates the total of a counter over all 
+	                launches from the sampled ones, returning the estimate and
+	                the half-width of its 95% confidence interval */
+	            double estimate(CounterType type, double & confidence) const;
+	            
 	            void write(std::ostream *out);
+	            
+	            static const char *counterName(CounterType type);
 	    };
 	
 	    typedef std::map<std::string, KernelProfiler> KernelProfilerMap;
+	    
+	    /*! \brief Kernel times and counters of the launches on one device.
+	    
+	        Launches on a device are serialized by its context, so each
+	        DeviceProfiler is only updated by one thread at a time and
+	        devices are profiled without a common lock.
+	    */
+	    class DeviceProfiler {
+	    
+	        public:
+	            DeviceProfiler(): kernelsExecute(0), launches(0), 
+	                sampledLaunches(0) { }
+	            
+	            void updateCounter(const std::string & kernelName, 
+	                KernelProfiler::CounterType type, unsigned long counter);
+	            void updateRuntime(const std::string & kernelName, double r);
+	            void recordLaunch(KernelProfiler *kernel, bool sampled);
+	            
+	            KernelProfiler *kernelProfiler(const std::string & kernelName);
+	            
+	        public:
+	            //! accumulates time spent executing kernels on the device,
+	            //! measured on the streams of the launches
+	            double kernelsExecute;
+	            
+	            unsigned long launches;
+	            unsigned long sampledLaunches;
+	            
+	            KernelProfilerMap kernelProfilers;
+	    };
+	    
+	    typedef std::map<int, DeviceProfiler> DeviceProfilerMap;
 	
 		Profiler();
 		~Profiler();
@@ -99,16 +180,21 @@ namespace trace {
 		//! stops the timer and adds time to a selected accumulator
 		void stopTimer(double Profiler::* accumulator);
 		void stopAppTimer(double Profiler::* appTime);
-		void stopKernelTimer(double Profiler::* accumulator, std::string kernelName = "");
 		
-		void updateCounter(std::string kernelName, 
-		    KernelProfiler::CounterType type, unsigned long counter);
-		void updateRuntime(std::string kernelName, double r);    
+		/*! \brief The profiler of a device, created on first use */
+		DeviceProfiler & device(int device);
+	
+	private:
+		//! adds the kernels of every device up into kernelProfilers
+		void aggregate();
 	
 	private:
 		hydrazine::Timer timer;
 		hydrazine::Timer appTimer;
 		
+		//! guards the insertion of device profilers
+		boost::mutex _mutex;
+		
 	public:
 		//! accumulates time spent moving data from host to device and back
 		double dataMove;
@@ -121,10 +207,14 @@ namespace trace {
 		//! accumulates time spent executing PTX kernels
 		double kernelsExecute;
 		double runtime;
+		//! accumulates time spent instrumenting and compiling modules in the
+		//! background
+		double jitCompile;
 		
 		//! counters
 		unsigned long branches;
 		unsigned long divergentBranches;
+		unsigned long uniformBranches;
 		unsigned long globalMemTransactions;
 		unsigned long dynamicHalfWarpsExecutingMemTransactions;
 		unsigned long barriers;
@@ -133,8 +223,17 @@ namespace trace {
 		unsigned long activeThreads;
 		 unsigned long warps;
 		
-		//! maintain per-kernel counter information
+		//! background compilation: deepest queue observed, modules made ready,
+		//! and launches that ran uninstrumented while waiting for them
+		unsigned long jitQueueDepth;
+		unsigned long jitModulesReady;
+		unsigned long jitPendingLaunches;
+		
+		//! per-kernel counter information of all devices, filled at exit
 		KernelProfilerMap kernelProfilers;
+		
+		//! per-device kernel times and counters
+		DeviceProfilerMap deviceProfilers;
 	};
 
 }
@@ -0,0 +1,396 @@
+/*!
+	\file TestMemorySimulator.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the MemorySimulator class. Replays a known sequence
+		of accesses through tiny caches and checks every hit and miss, then
+		measures throughput on synthetic traces.
+*/
+
+#ifndef TEST_MEMORY_SIMULATOR_CPP_INCLUDED
+#define TEST_MEMORY_SIMULATOR_CPP_INCLUDED
+
+#include <lynx/trace/interface/MemorySimulator.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+#include <hydrazine/interface/Timer.h>
+
+#include <cstring>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Check the simulated caches against a hand computed trace */
+	class TestMemorySimulator : public Test
+	{
+		private:
+			typedef trace::MemoryTraceRecord MemoryTraceRecord;
+			typedef trace::MemorySimulator MemorySimulator;
+			typedef std::vector<MemoryTraceRecord> RecordVector;
+
+			/*! \brief the expected outcome of one access */
+			class Expectation
+			{
+				public:
+					unsigned int l1Hits;
+					unsigned int l1Misses;
+					unsigned int l2Hits;
+					unsigned int l2Misses;
+					//! reuse histogram bucket, -1 for a cold access
+					int reuse;
+			};
+
+		private:
+			static MemoryTraceRecord _record(unsigned int instructionId,
+				unsigned long long address, bool store,
+				unsigned int lanes = 1, int stride = 4);
+
+			MemorySimulator::Configuration _tinyConfiguration(
+				unsigned int workers);
+
+			void _syntheticTrace(RecordVector& records);
+
+			bool _equal(const MemorySimulator::InstructionStatisticsMap& left,
+				const MemorySimulator::InstructionStatisticsMap& right);
+
+			bool _testKnownSequence(unsigned int workers);
+			bool _testThroughput();
+
+			bool doTest();
+
+		public:
+			TestMemorySimulator();
+
+		public:
+			unsigned int records;
+			unsigned int threads;
+	};
+
+	TestMemorySimulator::MemoryTraceRecord TestMemorySimulator::_record(
+		unsigned int instructionId, unsigned long long address, bool store,
+		unsigned int lanes, int stride)
+	{
+		MemoryTraceRecord record;
+		std::memset(&record, 0, sizeof(record));
+
+		record.instructionId = instructionId;
+		record.activeMask = lanes == 32 ? ~0u : (1u << lanes) - 1;
+		record.baseAddress = address;
+		record.flags = (store ? MemoryTraceRecord::Store
+			: MemoryTraceRecord::Load) | (4 << MemoryTraceRecord::SizeShift);
+
+		for(unsigned int lane = 0; lane < lanes; ++lane)
+		{
+			record.deltas[lane] = lane * stride;
+		}
+
+		return record;
+	}
+
+	/*! A direct mapped 256B L1 and a 2-way 512B L2, both with two sets of
+		128B lines split in 32B sectors */
+	TestMemorySimulator::MemorySimulator::Configuration
+		TestMemorySimulator::_tinyConfiguration(unsigned int workers)
+	{
+		MemorySimulator::Configuration configuration;
+
+		configuration.l1 = trace::CacheConfiguration(256, 128, 32, 1);
+		configuration.l2 = trace::CacheConfiguration(512, 128, 32, 2);
+		configuration.threads = workers;
+		configuration.batchRecords = 3;
+		configuration.reuseDepth = 64;
+
+		return configuration;
+	}
+
+	/*! Each access uses its own instruction id so that its statistics
+		show exactly its outcome. Lines 0, 2 and 4 all map to set 0. */
+	bool TestMemorySimulator::_testKnownSequence(unsigned int workers)
+	{
+		const int Cold = -1;
+
+		const Expectation expected[] = {
+			/* 0: load line 0 sector 0, both caches miss */
+			{0, 1, 0, 1, Cold},
+			/* 1: the same sector hits in the L1 */
+			{1, 0, 0, 0, 0},
+			/* 2: another sector of line 0 misses in both */
+			{0, 1, 0, 1, 0},
+			/* 3: line 2 evicts line 0 from the direct mapped L1 */
+			{0, 1, 0, 1, Cold},
+			/* 4: line 0 misses in the L1 and hits in the L2 */
+			{0, 1, 1, 0, 1},
+			/* 5: line 4 evicts line 2, the least recently used in the L2 */
+			{0, 1, 0, 1, Cold},
+			/* 6: line 2 misses everywhere and evicts line 0 from the L2 */
+			{0, 1, 0, 1, 2},
+			/* 7: a store to line 0 skips the L1 and misses in the L2 */
+			{0, 0, 0, 1, 2},
+			/* 8: line 2 is still in the L1 */
+			{1, 0, 0, 0, 1},
+			/* 9: a store to line 2 invalidates it in the L1, hits the L2 */
+			{0, 0, 1, 0, 0},
+			/* 10: line 2 misses in the L1 after the store */
+			{0, 1, 1, 0, 0}
+		};
+
+		const unsigned long long addresses[] = {
+			0, 0, 32, 256, 0, 512, 256, 0, 256, 256, 256
+		};
+
+		const unsigned int accesses = sizeof(addresses) / sizeof(addresses[0]);
+
+		MemorySimulator simulator(_tinyConfiguration(workers));
+
+		for(unsigned int i = 0; i < accesses; ++i)
+		{
+			simulator.simulate(_record(i, addresses[i], i == 7 || i == 9));
+		}
+
+		/* a fully coalesced warp, one line and four sectors */
+		simulator.simulate(_record(accesses, 1024, false, 32, 4));
+		/* a warp with a 128B stride, one sector in each of 32 lines */
+		simulator.simulate(_record(accesses + 1, 4096, false, 32, 128));
+
+		const MemorySimulator::InstructionStatisticsMap& statistics =
+			simulator.statistics();
+
+		for(unsigned int i = 0; i < accesses; ++i)
+		{
+			MemorySimulator::InstructionStatisticsMap::const_iterator s =
+				statistics.find(i);
+
+			if(s == statistics.end())
+			{
+				status << "No statistics for access " << i << ".\n";
+				return false;
+			}
+
+			unsigned int bucket = expected[i].reuse == Cold
+				? s->second.reuse.size() - 1 : expected[i].reuse;
+
+			if(s->second.l1Hits != expected[i].l1Hits
+				|| s->second.l1Misses != expected[i].l1Misses
+				|| s->second.l2Hits != expected[i].l2Hits
+				|| s->second.l2Misses != expected[i].l2Misses
+				|| s->second.reuse[bucket] != 1)
+			{
+				status << "Access " << i << " with " << workers
+					<< " threads: L1 " << s->second.l1Hits << " hits "
+					<< s->second.l1Misses << " misses, L2 "
+					<< s->second.l2Hits << " hits " << s->second.l2Misses
+					<< " misses, expected L1 " << expected[i].l1Hits
+					<< " hits " << expected[i].l1Misses << " misses, L2 "
+					<< expected[i].l2Hits << " hits "
+					<< expected[i].l2Misses << " misses, reuse bucket "
+					<< bucket << ".\n";
+				return false;
+			}
+		}
+
+		const MemorySimulator::InstructionStatistics& coalesced =
+			statistics.find(accesses)->second;
+
+		if(coalesced.sectors != 4 || coalesced.lines != 1
+			|| coalesced.l1Misses != 4 || coalesced.l2Misses != 4
+			|| coalesced.sectorEfficiency(32) != 1.0)
+		{
+			status << "Coalesced warp: " << coalesced.sectors
+				<< " sectors in " << coalesced.lines << " lines, expected 4 "
+				<< "in 1.\n";
+			return false;
+		}
+
+		const MemorySimulator::InstructionStatistics& strided =
+			statistics.find(accesses + 1)->second;
+
+		if(strided.sectors != 32 || strided.lines != 32
+			|| strided.l2Misses != 32 || strided.sectorEfficiency(32) != 0.125
+			|| strided.reuse.back() != 32)
+		{
+			status << "Strided warp: " << strided.sectors << " sectors in "
+				<< strided.lines << " lines, expected 32 in 32.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! Coalesced, strided, random and reused accesses from 64
+		instructions over a 64MB footprint */
+	void TestMemorySimulator::_syntheticTrace(RecordVector& trace)
+	{
+		trace.clear();
+		trace.reserve(records);
+
+		for(unsigned int r = 0; r < records; ++r)
+		{
+			unsigned int instructionId = random() % 64;
+			unsigned long long address = (unsigned long long)(
+				random() % (1 << 26)) & ~3ULL;
+
+			switch(instructionId % 4)
+			{
+				case 0:
+				{
+					trace.push_back(_record(instructionId, address, false,
+						32, 4));
+					break;
+				}
+				case 1:
+				{
+					trace.push_back(_record(instructionId, address, true,
+						32, 4 * (1 + random() % 32)));
+					break;
+				}
+				case 2:
+				{
+					MemoryTraceRecord record = _record(instructionId,
+						address, false, 32, 0);
+					for(unsigned int lane = 0; lane < 32; ++lane)
+					{
+						record.deltas[lane] = (int)(random() % (1 << 20))
+							& ~3;
+					}
+					trace.push_back(record);
+					break;
+				}
+				default:
+				{
+					/* a small hot region that stays in the caches */
+					trace.push_back(_record(instructionId, address % 65536,
+						false, 32, 4));
+					break;
+				}
+			}
+		}
+	}
+
+	bool TestMemorySimulator::_equal(
+		const MemorySimulator::InstructionStatisticsMap& left,
+		const MemorySimulator::InstructionStatisticsMap& right)
+	{
+		if(left.size() != right.size()) return false;
+
+		for(MemorySimulator::InstructionStatisticsMap::const_iterator
+			l = left.begin(), r = right.begin(); l != left.end(); ++l, ++r)
+		{
+			if(l->first != r->first
+				|| l->second.warpAccesses != r->second.warpAccesses
+				|| l->second.sectors != r->second.sectors
+				|| l->second.lines != r->second.lines
+				|| l->second.l1Hits != r->second.l1Hits
+				|| l->second.l1Misses != r->second.l1Misses
+				|| l->second.l2Hits != r->second.l2Hits
+				|| l->second.l2Misses != r->second.l2Misses
+				|| l->second.reuse != r->second.reuse)
+			{
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	bool TestMemorySimulator::_testThroughput()
+	{
+		RecordVector trace;
+		_syntheticTrace(trace);
+
+		double megabytes = trace.size() * sizeof(MemoryTraceRecord)
+			/ (1024.0 * 1024.0);
+
+		MemorySimulator::Configuration serialConfiguration;
+		serialConfiguration.threads = 1;
+
+		MemorySimulator::Configuration parallelConfiguration;
+		parallelConfiguration.threads = threads;
+
+		MemorySimulator serial(serialConfiguration);
+		MemorySimulator parallel(parallelConfiguration);
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		serial.simulate(trace.data(), trace.size());
+		serial.flush();
+		timer.stop();
+
+		double serialSeconds = timer.seconds();
+
+		timer.start();
+		parallel.simulate(trace.data(), trace.size());
+		parallel.flush();
+		timer.stop();
+
+		double parallelSeconds = timer.seconds();
+
+		if(!_equal(serial.statistics(), parallel.statistics()))
+		{
+			status << "The statistics of 1 and " << parallel.shards()
+				<< " shards differ.\n";
+			return false;
+		}
+
+		status << "Synthetic trace of " << trace.size() << " records ("
+			<< megabytes << " MB):\n";
+		status << " 1 thread:  " << (trace.size() / serialSeconds)
+			<< " records/s, " << (megabytes / serialSeconds) << " MB/s\n";
+		status << " " << threads << " threads, " << parallel.shards()
+			<< " shards: "
+			<< (trace.size() / parallelSeconds) << " records/s, "
+			<< (megabytes / parallelSeconds) << " MB/s\n";
+
+		return true;
+	}
+
+	bool TestMemorySimulator::doTest()
+	{
+		if(!_testKnownSequence(1) || !_testKnownSequence(2))
+		{
+			return false;
+		}
+
+		status << "Known access sequence matched with 1 and 2 shards.\n";
+
+		return _testThroughput();
+	}
+
+	TestMemorySimulator::TestMemorySimulator()
+	{
+		name = "TestMemorySimulator";
+
+		description = "Replays a hand computed sequence of loads and stores ";
+		description += "through a direct mapped L1 and a 2-way L2 with two ";
+		description += "sets each and checks the hits, misses and reuse ";
+		description += "distance of every access, with one and two shards. ";
+		description += "Then simulates a synthetic trace with one thread and ";
+		description += "with several, requires identical statistics and ";
+		description += "reports the throughput.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestMemorySimulator test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-r", "--records", test.records, 1000000,
+		"Records in the synthetic trace.");
+	parser.parse("-t", "--threads", test.threads, 4,
+		"Threads for the parallel simulation, 0 for one per core.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
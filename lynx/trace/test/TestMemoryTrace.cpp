@@ -0,0 +1,460 @@
+/*!
+	\file TestMemoryTrace.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the memory trace drain, writer and reader. Producer
+		threads fill a synthetic host ring with the protocol of the device
+		code, and the records decoded from the trace file must match the
+		records that were produced.
+*/
+
+#ifndef TEST_MEMORY_TRACE_CPP_INCLUDED
+#define TEST_MEMORY_TRACE_CPP_INCLUDED
+
+#include <lynx/trace/interface/MemoryTrace.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <boost/thread/thread.hpp>
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Drain a synthetic ring and decode the resulting trace */
+	class TestMemoryTrace : public Test
+	{
+		private:
+			typedef trace::MemoryTraceRecord MemoryTraceRecord;
+			typedef std::vector<MemoryTraceRecord> RecordVector;
+
+			/*! \brief A host copy of the device ring */
+			class Ring
+			{
+				public:
+					Ring(unsigned long long capacity);
+
+				public:
+					/*! \brief reserve a position the way memoryTraceReserve
+						does, false when the ring is full */
+					bool reserve(unsigned long long& position);
+
+					/*! \brief fill the reserved slot and publish it */
+					void publish(unsigned long long position,
+						const MemoryTraceRecord& record);
+
+				public:
+					RecordVector records;
+					volatile unsigned long long head;
+					volatile unsigned long long tail;
+					volatile unsigned long long dropped;
+			};
+
+			/*! \brief One producer thread, standing in for a warp leader */
+			class Producer
+			{
+				public:
+					void operator()();
+
+				public:
+					Ring* ring;
+					RecordVector* produced;
+					unsigned int id;
+					unsigned int attempts;
+					unsigned int seed;
+			};
+
+		private:
+			static MemoryTraceRecord _record(unsigned int instructionId,
+				unsigned int seed);
+
+			bool _compare(const std::string& test, const RecordVector& expected,
+				unsigned long long records);
+
+			bool _testDecode();
+			bool _testMissing();
+			bool _testFull();
+			bool _testConcurrent();
+
+			bool doTest();
+
+		public:
+			TestMemoryTrace();
+
+		public:
+			std::string path;
+			unsigned int records;
+			unsigned int producers;
+			unsigned int capacity;
+	};
+
+	TestMemoryTrace::Ring::Ring(unsigned long long c) : records(c),
+		head(0), tail(0), dropped(0)
+	{
+		std::memset(&records[0], 0, c * sizeof(MemoryTraceRecord));
+	}
+
+	bool TestMemoryTrace::Ring::reserve(unsigned long long& position)
+	{
+		while(true)
+		{
+			position = head;
+
+			if(position - tail >= records.size())
+			{
+				__sync_fetch_and_add(&dropped, 1);
+				return false;
+			}
+
+			if(__sync_val_compare_and_swap(&head, position, position + 1)
+				== position)
+			{
+				return true;
+			}
+		}
+	}
+
+	void TestMemoryTrace::Ring::publish(unsigned long long position,
+		const MemoryTraceRecord& record)
+	{
+		MemoryTraceRecord& slot = records[position % records.size()];
+
+		slot.instructionId = record.instructionId;
+		slot.activeMask = record.activeMask;
+		slot.overflowMask = record.overflowMask;
+		slot.baseAddress = record.baseAddress;
+		slot.flags = record.flags;
+		std::memcpy(slot.deltas, record.deltas, sizeof(slot.deltas));
+
+		__sync_synchronize();
+
+		*(volatile unsigned int*)&slot.sequence = position + 1;
+	}
+
+	void TestMemoryTrace::Producer::operator()()
+	{
+		for(unsigned int i = 0; i < attempts; ++i)
+		{
+			unsigned long long position = 0;
+
+			while(!ring->reserve(position))
+			{
+				boost::this_thread::yield();
+			}
+
+			MemoryTraceRecord record = _record(id, seed + i);
+			(*produced)[position] = record;
+
+			ring->publish(position, record);
+		}
+	}
+
+	/*! A record whose fields all follow from the seed, with negative
+		deltas and a sparse active mask */
+	TestMemoryTrace::MemoryTraceRecord TestMemoryTrace::_record(
+		unsigned int instructionId, unsigned int seed)
+	{
+		MemoryTraceRecord record;
+		std::memset(&record, 0, sizeof(record));
+
+		record.instructionId = instructionId;
+		record.activeMask = seed * 2654435761u | 1;
+		record.overflowMask = seed & 0x3;
+		record.baseAddress = 0x200000000ULL + seed * 128ULL;
+		record.flags = ((seed & 1) ? MemoryTraceRecord::Store
+			: MemoryTraceRecord::Load) | ((4 << (seed % 3))
+			<< MemoryTraceRecord::SizeShift);
+
+		for(unsigned int lane = 0; lane < MemoryTraceRecord::Lanes; ++lane)
+		{
+			record.deltas[lane] = (int)(lane * 4) - (int)(seed % 64);
+		}
+
+		return record;
+	}
+
+	/*! The trace file must hold exactly the expected records, in order,
+		with the sequence cleared */
+	bool TestMemoryTrace::_compare(const std::string& test,
+		const RecordVector& expected, unsigned long long written)
+	{
+		if(written != expected.size())
+		{
+			status << test << ": the writer reported " << written
+				<< " records, expected " << expected.size() << ".\n";
+			return false;
+		}
+
+		trace::MemoryTraceReader reader(path);
+		MemoryTraceRecord record;
+
+		for(unsigned int i = 0; i < expected.size(); ++i)
+		{
+			if(!reader.next(record))
+			{
+				status << test << ": the trace ended after " << i
+					<< " of " << expected.size() << " records.\n";
+				return false;
+			}
+
+			MemoryTraceRecord reference = expected[i];
+			reference.sequence = 0;
+
+			if(std::memcmp(&record, &reference, sizeof(record)) != 0)
+			{
+				status << test << ": record " << i << " (instruction "
+					<< record.instructionId << ") differs from the produced "
+					<< "record (instruction " << reference.instructionId
+					<< ").\n";
+				return false;
+			}
+		}
+
+		if(reader.next(record))
+		{
+			status << test << ": the trace holds more than "
+				<< expected.size() << " records.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! Write records in several chunks and decode the accessors */
+	bool TestMemoryTrace::_testDecode()
+	{
+		RecordVector expected;
+
+		{
+			trace::MemoryTraceWriter writer(path, 7);
+
+			for(unsigned int i = 0; i < 30; ++i)
+			{
+				expected.push_back(_record(i, random()));
+				expected.back().sequence = i + 1;
+				writer.write(expected.back());
+			}
+		}
+
+		if(!_compare("decode", expected, expected.size())) return false;
+
+		MemoryTraceRecord record = _record(0, 5);
+
+		if(!record.store() || record.size() != 16 || !record.active(0)
+			|| record.address(0) != 0x200000000ULL + 5 * 128 - 5
+			|| record.address(31) != 0x200000000ULL + 5 * 128 + 31 * 4 - 5)
+		{
+			status << "decode: the accessors of a store of 16 bytes do not "
+				<< "match its fields.\n";
+			return false;
+		}
+
+		record = _record(0, 6);
+
+		if(record.store() || record.size() != 4)
+		{
+			status << "decode: the accessors of a load of 4 bytes do not "
+				<< "match its fields.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! A reserved record that is never published stops the drain, the
+		records before it are kept and the rest are reported missing */
+	bool TestMemoryTrace::_testMissing()
+	{
+		Ring ring(4);
+		RecordVector expected;
+		unsigned long long missing = 0;
+		unsigned long long written = 0;
+
+		{
+			trace::MemoryTraceWriter writer(path);
+			trace::MemoryTraceDrain drain(&ring.records[0], &ring.tail,
+				ring.records.size(), writer);
+
+			for(unsigned int i = 0; i < 4; ++i)
+			{
+				unsigned long long position = 0;
+				ring.reserve(position);
+
+				if(i == 2) continue;
+
+				MemoryTraceRecord record = _record(i, i);
+				ring.publish(position, record);
+
+				if(i < 2) expected.push_back(record);
+			}
+
+			if(drain.poll() != 2)
+			{
+				status << "missing: the drain passed an unpublished record.\n";
+				return false;
+			}
+
+			missing = drain.stop(ring.head);
+			written = writer.records();
+		}
+
+		if(missing != 2)
+		{
+			status << "missing: " << missing << " records reported missing, "
+				<< "expected 2.\n";
+			return false;
+		}
+
+		return _compare("missing", expected, written);
+	}
+
+	/*! A full ring drops records instead of waiting, and the slots are
+		reused once the drain has consumed them */
+	bool TestMemoryTrace::_testFull()
+	{
+		Ring ring(4);
+		RecordVector expected;
+		unsigned long long written = 0;
+
+		{
+			trace::MemoryTraceWriter writer(path);
+			trace::MemoryTraceDrain drain(&ring.records[0], &ring.tail,
+				ring.records.size(), writer);
+
+			for(unsigned int round = 0; round < 3; ++round)
+			{
+				for(unsigned int i = 0; i < 6; ++i)
+				{
+					unsigned long long position = 0;
+
+					if(!ring.reserve(position)) continue;
+
+					MemoryTraceRecord record = _record(round, i);
+					ring.publish(position, record);
+					expected.push_back(record);
+				}
+
+				drain.poll();
+			}
+
+			drain.stop(ring.head);
+			written = writer.records();
+		}
+
+		if(ring.dropped != 6 || ring.head != 12)
+		{
+			status << "full ring: " << ring.dropped << " records dropped and "
+				<< ring.head << " reserved, expected 6 and 12.\n";
+			return false;
+		}
+
+		return _compare("full ring", expected, written);
+	}
+
+	/*! Producers race for a small ring while the drain thread consumes it,
+		the ring wraps many times */
+	bool TestMemoryTrace::_testConcurrent()
+	{
+		Ring ring(capacity);
+		RecordVector produced(records * producers);
+		unsigned long long missing = 0;
+		unsigned long long written = 0;
+
+		{
+			trace::MemoryTraceWriter writer(path, 1000);
+			trace::MemoryTraceDrain drain(&ring.records[0], &ring.tail,
+				ring.records.size(), writer);
+
+			drain.start();
+
+			boost::thread_group group;
+
+			for(unsigned int p = 0; p < producers; ++p)
+			{
+				Producer producer;
+				producer.ring = &ring;
+				producer.produced = &produced;
+				producer.id = p;
+				producer.attempts = records;
+				producer.seed = random();
+
+				group.create_thread(producer);
+			}
+
+			group.join_all();
+
+			missing = drain.stop(ring.head);
+			written = writer.records();
+		}
+
+		if(missing != 0 || ring.head != produced.size())
+		{
+			status << "concurrent: " << missing << " records missing and "
+				<< ring.head << " reserved, expected none and "
+				<< produced.size() << ".\n";
+			return false;
+		}
+
+		if(!_compare("concurrent", produced, written)) return false;
+
+		status << "Drained " << written << " records from " << producers
+			<< " producers through a ring of " << capacity << " records, "
+			<< ring.dropped << " reservations found the ring full.\n";
+
+		return true;
+	}
+
+	bool TestMemoryTrace::doTest()
+	{
+		bool passed = _testDecode() && _testMissing() && _testFull()
+			&& _testConcurrent();
+
+		std::remove(path.c_str());
+
+		return passed;
+	}
+
+	TestMemoryTrace::TestMemoryTrace()
+	{
+		name = "TestMemoryTrace";
+
+		description = "Writes records in several compressed chunks and ";
+		description += "reads them back. Drains a synthetic ring with a ";
+		description += "record that is reserved but never published, and ";
+		description += "a ring that fills up and drops records. Finally ";
+		description += "several producer threads race for a small ring ";
+		description += "while the drain thread consumes it, and every ";
+		description += "decoded record must equal the produced one.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestMemoryTrace test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-f", "--file", test.path, "TestMemoryTrace.memtrace",
+		"Temporary trace file.");
+	parser.parse("-r", "--records", test.records, 20000,
+		"Records written by each producer.");
+	parser.parse("-p", "--producers", test.producers, 4,
+		"Producer threads filling the ring.");
+	parser.parse("-c", "--capacity", test.capacity, 64,
+		"Records in the ring.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
@@ -14,11 +14,131 @@
 #include <ocelot/ir/interface/PTXOperand.h>
 #include <ocelot/ir/interface/PTXKernel.h>
 #include <ocelot/analysis/interface/DataflowGraph.h>
+#include <ocelot/analysis/interface/DominatorTree.h>
+#include <ocelot/analysis/interface/PostdominatorTree.h>
 
 #include <hydrazine/interface/Exception.h>
+
+#include <set>
+#include <iterator>
+#include <cmath>
+
 #define REPORT_BASE 1 
 namespace transforms
 {
+    /* the statements following a target label are inserted as one sequence */
+    static bool isTargetLabel(const ir::PTXStatement & statement)
+    {
+        return statement.directive == ir::PTXStatement::Label &&
+            (statement.name == ENTER_KERNEL || statement.name == EXIT_KERNEL || 
+            statement.name == ENTER_BASIC_BLOCK || statement.name == EXIT_BASIC_BLOCK ||
+            statement.name == ON_INSTRUCTION);
+    }
+    
+    /* the smallest natural loop holding a block is nested in every other 
+        one holding it */
+    static NaturalLoopMap::const_iterator innermostLoop(const NaturalLoopMap & loops, 
+        const std::string & label)
+    {
+        NaturalLoopMap::const_iterator innermost = loops.end();
+        
+        for(NaturalLoopMap::const_iterator loop = loops.begin(); loop != loops.end(); ++loop)
+        {
+            if(loop->second.count(label) == 0)
+                continue;
+            
+            if(innermost == loops.end() || loop->second.size() < innermost->second.size())
+                innermost = loop;
+        }
+        
+        return innermost;
+    }
+    
+    /* special registers that keep their value for the lifetime of a thread,
+        %smid and %warpid are excluded, a thread may be migrated */
+    static bool isThreadInvariant(const ir::PTXOperand & operand)
+    {
+        switch(operand.special)
+        {
+            case ir::PTXOperand::tid:
+            case ir::PTXOperand::ntid:
+            case ir::PTXOperand::laneId:
+            case ir::PTXOperand::warpSize:
+            case ir::PTXOperand::ctaId:
+            case ir::PTXOperand::nctaId:
+            case ir::PTXOperand::nsmId:
+            case ir::PTXOperand::gridId:
+            case ir::PTXOperand::lanemask_eq:
+            case ir::PTXOperand::lanemask_le:
+            case ir::PTXOperand::lanemask_lt:
+            case ir::PTXOperand::lanemask_ge:
+            case ir::PTXOperand::lanemask_gt:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    /* instructions without side effects, which may be removed or moved */
+    static bool isPure(const ir::PTXInstruction & instruction)
+    {
+        switch(instruction.opcode)
+        {
+            case ir::PTXInstruction::Add:
+            case ir::PTXInstruction::And:
+            case ir::PTXInstruction::Cvt:
+            case ir::PTXInstruction::Div:
+            case ir::PTXInstruction::Mad:
+            case ir::PTXInstruction::Max:
+            case ir::PTXInstruction::Min:
+            case ir::PTXInstruction::Mov:
+            case ir::PTXInstruction::Mul:
+            case ir::PTXInstruction::Not:
+            case ir::PTXInstruction::Or:
+            case ir::PTXInstruction::Popc:
+            case ir::PTXInstruction::Rem:
+            case ir::PTXInstruction::SelP:
+            case ir::PTXInstruction::SetP:
+            case ir::PTXInstruction::Shl:
+            case ir::PTXInstruction::Shr:
+            case ir::PTXInstruction::Sub:
+            case ir::PTXInstruction::Xor:
+                return true;
+            default:
+                return false;
+        }
+    }
+    
+    static void countUses(const ir::PTXInstruction & instruction, 
+        std::map<std::string, unsigned int> & uses)
+    {
+        const ir::PTXOperand * operands[] = { &instruction.a, &instruction.b, 
+            &instruction.c, &instruction.pg, &instruction.d };
+        
+        for (int i = 0; i < 5; i++) 
+        {
+            const ir::PTXOperand & operand = *operands[i];
+            
+            /* the destination is read when it holds an address */
+            if(operands[i] == &instruction.d && 
+                instruction.opcode != ir::PTXInstruction::St &&
+                instruction.opcode != ir::PTXInstruction::Call &&
+                operand.addressMode != ir::PTXOperand::Indirect &&
+                operand.addressMode != ir::PTXOperand::Address)
+                continue;
+            
+            if(!operand.identifier.empty())
+                uses[operand.identifier]++;
+            
+            for(ir::PTXOperand::Array::const_iterator element = operand.array.begin();
+                element != operand.array.end(); ++element)
+            {
+                if(!element->identifier.empty())
+                    uses[element->identifier]++;
+            }
+        }
+    }
+    
     analysis::DataflowGraph& CToPTXInstrumentationPass::dfg()
 	{
 		analysis::Analysis* graph = getAnalysis(
@@ -123,7 +243,22 @@ namespace transforms
             }
         }
         
+        if(attributes.scaledExecutedInstructionCount)
+        {
+            for (int i = 0; i < 3; i++) 
+            {
+                if((statement.instruction.*(source_operands[i])).identifier != BASIC_BLOCK_EXEC_INST_COUNT)
+                    continue;
+                
+                ir::PTXOperand &operand = toInsert.instruction.*(source_operands[i]);
+                operand.addressMode = ir::PTXOperand::Register;
+                operand.reg = attributes.executedInstructionCountRegister;
+                operand.identifier.clear();
+            }
+        }
+        
         if(statement.instruction.opcode == ir::PTXInstruction::Vote && statement.instruction.vote == ir::PTXInstruction::Uni){
+            /* the vote is known to be unanimous for unconditional branches */
             if(attributes.originalInstruction.pg.condition == ir::PTXOperand::PT ||
                 attributes.originalInstruction.pg.condition == ir::PTXOperand::nPT)
             {
@@ -241,8 +376,8 @@ namespace transforms
                 ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
 		std::string identifier("%ctaid.x");
 		if(ptxInstruction->a.identifier.compare(identifier) == 0){
-			std::cout << "FOUND CTAID (in block " << bIndex - 1 << " and instruction " << iIndex -1 << ") : " << ptxInstruction->a.identifier << " " << ptxInstruction->a.toString() 
-				<< " " << ptxInstruction->d.toString() << std::endl;
+			report("FOUND CTAID (in block " << bIndex - 1 << " and instruction " << iIndex -1 << ") : " << ptxInstruction->a.identifier << " " << ptxInstruction->a.toString() 
+				<< " " << ptxInstruction->d.toString());
 			//dfg().erase(basicBlock, iIndex-1);
 			bIndexToInsert = bIndex - 1;
 			//iIndexToInsert = iIndex - 1;
@@ -281,24 +416,24 @@ namespace transforms
         {
 		bIndex++;
 		iIndex = 0;
-		std::cout << "New block " << bIndex-1 << std::endl;
+		report("New block " << bIndex-1);
 		if(bIndex - 1 != bIndexToInsert)
 			continue;
-		std::cout << "Block to be inserted in " << bIndex-1 << std::endl;
+		report("Block to be inserted in " << bIndex-1);
            if(basicBlock->instructions().empty())
               continue;
-	   std::cout << "Block is not empty" << std::endl;
+	   report("Block is not empty");
 
             for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = basicBlock->instructions().begin();
                 instruction != basicBlock->instructions().end(); ++instruction)
             {
 		    iIndex++;
-		    std::cout << "Block " << bIndex-1 << " instruction " << iIndex-1 << std::endl;
+		    report("Block " << bIndex-1 << " instruction " << iIndex-1);
 		if(iIndex - 1 != iIndexToInsert)
 			continue;
-		std::cout << "Instruction to be inserted before " << iIndex-1 << std::endl;
+		report("Instruction to be inserted before " << iIndex-1);
                 ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
-		std::cout << "Inserting in Block " << bIndex - 1 << " and before instruction " << iIndex - 1 << " : " << ptxInstruction->toString() << std::endl;
+		report("Inserting in Block " << bIndex - 1 << " and before instruction " << iIndex - 1 << " : " << ptxInstruction->toString());
 		dfg().insert(basicBlock, inst, iIndex-1);
 		
 		break;
@@ -317,7 +452,7 @@ namespace transforms
             {
                 continue;
             }
-	    std::cout << "insertBefore inserting " << toInsert.instruction.toString() << std::endl;
+	    report("insertBefore inserting " << toInsert.instruction.toString());
             dfg().insert(basicBlock, toInsert.instruction, loc++);
 	        count++;
         }
@@ -346,6 +481,14 @@ namespace transforms
         attributes.basicBlockCount = dfg().size() - 2;
         
         
+        const UniformBranches *branches = 0;
+        if(uniformBranches != 0)
+        {
+            UniformBranchMap::const_iterator kernel = uniformBranches->find(kernelName);
+            if(kernel != uniformBranches->end())
+                branches = &kernel->second;
+        }
+        
         analysis::DataflowGraph::iterator block = dfg().begin();
         ++block;
         
@@ -359,6 +502,9 @@ namespace transforms
             /* Update basicBlockInstructionCount to include all instructions in the basic block by default */
             attributes.basicBlockInstructionCount = basicBlock->instructions().size();
             unsigned int loc = 0;
+            
+            /* a block ends with at most one branch */
+            bool uniformBranch = branches != 0 && branches->uniform(basicBlock->label());
                         
             attributes.instructionId = 0;
             /* Iterating through each instruction */
@@ -372,7 +518,18 @@ namespace transforms
                 
                 if(instrumentationConditionsMet(*ptxInstruction, translationBlock))
                 {
-                    loc += insertBefore(translationBlock, attributes, basicBlock, loc);
+                    /* a uniform branch never diverges, only the warps taking 
+                        it are counted */
+                    if(uniformBranch && ptxInstruction->opcode == ir::PTXInstruction::Bra)
+                    {
+                        unsigned int counter = std::distance(branches->labels.begin(), 
+                            branches->labels.find(basicBlock->label()));
+                        loc += insertUniformBranchCount(basicBlock, loc, counter, 
+                            branches->labels.size());
+                    }
+                    else
+                        loc += insertBefore(translationBlock, attributes, basicBlock, loc);
+                    
                     attributes.instructionId++;
                 }
                 loc++;
@@ -390,6 +547,30 @@ namespace transforms
         attributes.basicBlockInstructionCount = 0;
         attributes.basicBlockCount = dfg().size() - 2;
         
+        /* per-block instruction counts cannot be rebuilt from chords */
+        bool placed = counterPlacements != 0 && 
+            !translationBlock.specifier.checkForPredication;
+        
+        CounterPlacement placement;
+        unsigned int vertex = CounterPlacement::Exit;
+        
+        /* counted loops add their instruction counts once at the exit */
+        bool hoisting = hoistable(translationBlock);
+        std::vector<std::pair<CountedLoop, StaticAttributes> > hoistedLoops;
+        NaturalLoopMap loops;
+        
+        if(hoisting)
+            loops = naturalLoops();
+        
+        if(placed)
+        {
+            placement = placeCounters();
+            (*counterPlacements)[kernelName] = placement;
+            
+            /* counters are indexed by chord rather than by block */
+            attributes.basicBlockCount = placement.counters();
+        }
+        
         analysis::DataflowGraph::iterator block = dfg().begin();
         ++block;
         
@@ -397,8 +578,24 @@ namespace transforms
         for( analysis::DataflowGraph::iterator basicBlock = block; 
             basicBlock != dfg().end(); ++basicBlock )
         {        
+           if(basicBlock == --dfg().end())
+              continue;
+           
+           ++vertex;
+           
            if(basicBlock->instructions().empty())
               continue;
+           
+           if(placed)
+           {
+              if(placement.counter(vertex) == -1)
+                  continue;
+              
+              attributes.basicBlockId = placement.counter(vertex);
+           }
+           
+            CountedLoop loop;
+            bool hoisted = hoisting && countedLoop(basicBlock, loops, loop);
                 
             attributes.basicBlockInstructionCount = 0;
             attributes.basicBlockExecutedInstructionCount = 0;
@@ -415,6 +612,13 @@ namespace transforms
                     if(translationBlock.specifier.checkForPredication && 
                         (ptxInstruction->pg.condition == ir::PTXOperand::Pred || ptxInstruction->pg.condition == ir::PTXOperand::InvPred))
                     {
+                        /* the back edge is taken on all but the last iteration */
+                        if(hoisted)
+                        {
+                            loop.latchInstructions++;
+                            continue;
+                        }
+                        
                         bool isPredInstCount = false;
                         ir::PTXOperand guard;
                     
@@ -552,7 +756,10 @@ namespace transforms
             if(translationBlock.label == EXIT_BASIC_BLOCK)
                 loc = basicBlock->instructions().size() - 1;
             
-            insertBefore(translationBlock, attributes, basicBlock, loc);
+            if(hoisted)
+                hoistedLoops.push_back(std::make_pair(loop, attributes));
+            else
+                insertBefore(translationBlock, attributes, basicBlock, loc);
             
             if(translationBlock.specifier.checkForPredication)
             {
@@ -577,9 +784,536 @@ namespace transforms
             }
             
             attributes.basicBlockId++;          
-        }    
+        }
+        
+        /* inserted last so that no block counts the code of another */
+        for(std::vector<std::pair<CountedLoop, StaticAttributes> >::const_iterator 
+            hoistedLoop = hoistedLoops.begin(); hoistedLoop != hoistedLoops.end(); ++hoistedLoop)
+        {
+            hoistLoopCount(translationBlock, hoistedLoop->second, hoistedLoop->first);
+        }
+    }
+    
+    unsigned int CToPTXInstrumentationPass::insertUniformBranchCount(analysis::DataflowGraph::iterator basicBlock, 
+        unsigned int loc, unsigned int counter, unsigned int counters)
+    {
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        
+        std::vector<ir::PTXInstruction> code;
+        
+        //setp.eq.u64 %true, 0, 0;
+        ir::PTXInstruction setp(ir::PTXInstruction::SetP);
+        setp.type = type;
+        setp.comparisonOperator = ir::PTXInstruction::Eq;
+        setp.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, dfg().newRegister());
+        setp.a = ir::PTXOperand(0, type);
+        setp.b = ir::PTXOperand(0, type);
+        code.push_back(setp);
+        
+        //vote.ballot.b32 %active, %true;
+        ir::PTXInstruction ballot(ir::PTXInstruction::Vote);
+        ballot.vote = ir::PTXInstruction::Ballot;
+        ballot.type = ir::PTXOperand::b32;
+        ballot.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, dfg().newRegister());
+        ballot.a = setp.d;
+        code.push_back(ballot);
+        
+        //mov.u32 %lower, %lanemask_lt;
+        ir::PTXInstruction lanes(ir::PTXInstruction::Mov);
+        lanes.type = ir::PTXOperand::u32;
+        lanes.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+        lanes.a = ir::PTXOperand(ir::PTXOperand::lanemask_lt);
+        code.push_back(lanes);
+        
+        //and.b32 %before, %active, %lower;
+        ir::PTXInstruction before(ir::PTXInstruction::And);
+        before.type = ir::PTXOperand::b32;
+        before.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, dfg().newRegister());
+        before.a = ballot.d;
+        before.b = lanes.d;
+        code.push_back(before);
+        
+        /* the least active thread counts for the warp */
+        //setp.eq.b32 %leader, %before, 0;
+        ir::PTXInstruction leader(ir::PTXInstruction::SetP);
+        leader.type = ir::PTXOperand::b32;
+        leader.comparisonOperator = ir::PTXInstruction::Eq;
+        leader.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, dfg().newRegister());
+        leader.a = before.d;
+        leader.b = ir::PTXOperand(0, ir::PTXOperand::b32);
+        code.push_back(leader);
+        
+        //mov.u64 %address, __lynx_global_mem_base_address__;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = type;
+        mov.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        mov.a = ir::PTXOperand(ir::PTXOperand::Address, type, GLOBAL_MEM_BASE_ADDRESS);
+        code.push_back(mov);
+        
+        //ld.global.u64 %base, [%address];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Global;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        ld.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, mov.d.reg);
+        code.push_back(ld);
+        
+        /* the counters of the uniform branches precede the ones of the 
+            inserted code */
+        //sub.u64 %slot, %base, offset;
+        ir::PTXInstruction slot(ir::PTXInstruction::Sub);
+        slot.type = type;
+        slot.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        slot.a = ld.d;
+        slot.b = ir::PTXOperand((counters - counter) * sizeof(size_t), type);
+        code.push_back(slot);
+        
+        //@%leader atom.global.add.u64 %old, [%slot], 1;
+        ir::PTXInstruction atom(ir::PTXInstruction::Atom);
+        atom.type = type;
+        atom.atomicOperation = ir::PTXInstruction::AtomicAdd;
+        atom.addressSpace = ir::PTXInstruction::Global;
+        atom.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        atom.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, slot.d.reg);
+        atom.b = ir::PTXOperand(1, type);
+        atom.pg = leader.d;
+        code.push_back(atom);
+        
+        for(std::vector<ir::PTXInstruction>::const_iterator instruction = code.begin();
+            instruction != code.end(); ++instruction)
+        {
+            dfg().insert(basicBlock, *instruction, loc++);
+        }
+        
+        return code.size();
+    }
+    
+    bool CToPTXInstrumentationPass::hoistable(TranslationBlock translationBlock)
+    {
+        if(!loopHoisting || !translationBlock.specifier.checkForPredication)
+            return false;
+        
+        /* only a single counter advanced by the executed instruction count 
+            scales with the number of iterations */
+        bool executed = false;
+        unsigned int updates = 0;
+        
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = translationBlock.statements.begin();
+            statement != translationBlock.statements.end(); ++statement) 
+        {
+            ir::PTXOperand ir::PTXInstruction::* source_operands[] = 
+                { &ir::PTXInstruction::a, & ir::PTXInstruction::b, & ir::PTXInstruction::c};
+            
+            for (int i = 0; i < 3; i++) 
+            {
+                const ir::PTXOperand &operand = statement->instruction.*(source_operands[i]);
+                
+                if(operand.identifier == BASIC_BLOCK_PRED_INST_COUNT)
+                    return false;
+                if(operand.identifier == BASIC_BLOCK_EXEC_INST_COUNT)
+                    executed = true;
+            }
+            
+            if(statement->instruction.opcode == ir::PTXInstruction::Atom ||
+                statement->instruction.opcode == ir::PTXInstruction::St)
+                updates++;
+        }
+        
+        return executed && updates == 1;
+    }
+    
+    bool CToPTXInstrumentationPass::countedLoop(analysis::DataflowGraph::iterator block, 
+        const NaturalLoopMap & loops, CountedLoop & loop)
+    {
+        if(block->instructions().empty())
+            return false;
+        
+        NaturalLoopMap::const_iterator innermost = innermostLoop(loops, block->label());
+        
+        if(innermost == loops.end())
+            return false;
+            
+        const std::set<std::string> & members = innermost->second;
+        
+        loop = CountedLoop();
+        loop.body = block;
+        loop.header = loop.preheader = loop.exit = dfg().end();
+        
+        analysis::DataflowGraph::iterator latch = dfg().end();
+        std::vector<analysis::DataflowGraph::iterator> body;
+        
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            if(members.count(basicBlock->label()) == 0)
+                continue;
+            
+            body.push_back(basicBlock);
+            
+            if(basicBlock->label() == innermost->first)
+                loop.header = basicBlock;
+        }
+        
+        /* the header is entered once from the preheader and again from a 
+            single latch */
+        if(loop.header->predecessors().size() != 2)
+            return false;
+        
+        for( analysis::DataflowGraph::BlockPointerSet::const_iterator predecessor = loop.header->predecessors().begin();
+            predecessor != loop.header->predecessors().end(); ++predecessor )
+        {
+            if(members.count((*predecessor)->label()) != 0)
+                latch = *predecessor;
+            else
+                loop.preheader = *predecessor;
+        }
+        
+        if(latch == dfg().end() || loop.preheader == dfg().end())
+            return false;
+        
+        /* the only edge leaving the loop goes from the latch to the exit */
+        for(std::vector<analysis::DataflowGraph::iterator>::const_iterator member = body.begin();
+            member != body.end(); ++member)
+        {
+            for( analysis::DataflowGraph::BlockPointerSet::const_iterator successor = (*member)->successors().begin();
+                successor != (*member)->successors().end(); ++successor )
+            {
+                if(members.count((*successor)->label()) != 0)
+                    continue;
+                
+                if(*member != latch || loop.exit != dfg().end())
+                    return false;
+                
+                loop.exit = *successor;
+            }
+        }
+        
+        if(loop.exit == dfg().end() || loop.preheader == dfg().begin() || 
+            loop.exit == --dfg().end() || loop.exit->instructions().empty())
+            return false;
+        
+        /* the count is added at the exit, which may only be reached from the
+            latch or by skipping the loop from the preheader */
+        for( analysis::DataflowGraph::BlockPointerSet::const_iterator predecessor = loop.exit->predecessors().begin();
+            predecessor != loop.exit->predecessors().end(); ++predecessor )
+        {
+            if(*predecessor != latch && *predecessor != loop.preheader)
+                return false;
+        }
+        
+        ir::PTXInstruction *branch = (ir::PTXInstruction *)latch->instructions().back().i;
+        
+        if(branch->opcode != ir::PTXInstruction::Bra || 
+            (branch->pg.condition != ir::PTXOperand::Pred && branch->pg.condition != ir::PTXOperand::InvPred))
+            return false;
+        
+        analysis::DominatorTree & dominatorTree = 
+            static_cast<analysis::DominatorTree&>(*getAnalysis("DominatorTreeAnalysis"));
+        
+        /* outside of nested loops, the blocks dominating the latch run once 
+            per iteration */
+        if(!dominatorTree.dominates(block->block(), latch->block()))
+            return false;
+        
+        /* every instruction but the conditional back edge runs whenever the 
+            block does */
+        for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = block->instructions().begin();
+            instruction != block->instructions().end(); ++instruction)
+        {
+            ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
+            
+            if(ptxInstruction != branch && 
+                (ptxInstruction->pg.condition == ir::PTXOperand::Pred || ptxInstruction->pg.condition == ir::PTXOperand::InvPred))
+                return false;
+        }
+        
+        std::map<analysis::DataflowGraph::RegisterId, unsigned int> definitions;
+        
+        for(std::vector<analysis::DataflowGraph::iterator>::const_iterator member = body.begin();
+            member != body.end(); ++member)
+        {
+            for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = (*member)->instructions().begin();
+                instruction != (*member)->instructions().end(); ++instruction)
+            {
+                for( analysis::DataflowGraph::RegisterPointerVector::const_iterator destination = instruction->d.begin();
+                    destination != instruction->d.end(); ++destination)
+                {
+                    definitions[*destination->pointer]++;
+                }
+            }
+        }
+        
+        /* the induction register is only updated by a constant step, in a 
+            block that runs once per iteration */
+        for(std::vector<analysis::DataflowGraph::iterator>::const_iterator member = body.begin();
+            member != body.end(); ++member)
+        {
+            if(innermostLoop(loops, (*member)->label()) != innermost ||
+                !dominatorTree.dominates((*member)->block(), latch->block()))
+                continue;
+            
+            for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = (*member)->instructions().begin();
+                instruction != (*member)->instructions().end(); ++instruction)
+            {
+                ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
+                
+                if(ptxInstruction->opcode != ir::PTXInstruction::Add && ptxInstruction->opcode != ir::PTXInstruction::Sub)
+                    continue;
+                
+                if(ptxInstruction->type != ir::PTXOperand::s32 && ptxInstruction->type != ir::PTXOperand::u32 &&
+                    ptxInstruction->type != ir::PTXOperand::s64 && ptxInstruction->type != ir::PTXOperand::u64)
+                    continue;
+                    
+                if(ptxInstruction->pg.condition == ir::PTXOperand::Pred || ptxInstruction->pg.condition == ir::PTXOperand::InvPred ||
+                    ptxInstruction->d.addressMode != ir::PTXOperand::Register ||
+                    ptxInstruction->a.addressMode != ir::PTXOperand::Register ||
+                    ptxInstruction->b.addressMode != ir::PTXOperand::Immediate ||
+                    ptxInstruction->d.reg != ptxInstruction->a.reg ||
+                    definitions[ptxInstruction->d.reg] != 1 ||
+                    ptxInstruction->b.imm_int == 0)
+                    continue;
+                
+                loop.induction = ptxInstruction->d;
+                loop.induction.type = ptxInstruction->type;
+                loop.step = ptxInstruction->opcode == ir::PTXInstruction::Add ? 
+                    ptxInstruction->b.imm_int : -ptxInstruction->b.imm_int;
+                
+                return true;
+            }
+        }
+        
+        return false;
+    }
+    
+    void CToPTXInstrumentationPass::hoistLoopCount(TranslationBlock translationBlock, StaticAttributes attributes, 
+        const CountedLoop & loop)
+    {
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        ir::PTXOperand::DataType inductionType = 
+            (ir::PTXOperand::bytes(loop.induction.type) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        
+        ir::PTXOperand induction(ir::PTXOperand::Register, inductionType, loop.induction.reg);
+        
+        //mov.u32 %start, %i;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = inductionType;
+        mov.d = ir::PTXOperand(ir::PTXOperand::Register, inductionType, dfg().newRegister());
+        mov.a = induction;
+        
+        /* the start value is saved on every path out of the preheader */
+        unsigned int loc = loop.preheader->instructions().size();
+        if(loc > 0 && ((ir::PTXInstruction *)loop.preheader->instructions().back().i)->opcode == ir::PTXInstruction::Bra)
+            loc--;
+        
+        dfg().insert(loop.preheader, mov, loc);
+        
+        std::vector<ir::PTXInstruction> code;
+        
+        //sub.u32 %distance, %i, %start;
+        ir::PTXInstruction sub(ir::PTXInstruction::Sub);
+        sub.type = inductionType;
+        sub.d = ir::PTXOperand(ir::PTXOperand::Register, inductionType, dfg().newRegister());
+        sub.a = loop.step > 0 ? induction : mov.d;
+        sub.b = loop.step > 0 ? mov.d : induction;
+        code.push_back(sub);
+        
+        ir::PTXOperand iterations = sub.d;
+        unsigned long long step = loop.step > 0 ? loop.step : -loop.step;
+        
+        if(step != 1)
+        {
+            //div.u32 %iterations, %distance, step;
+            ir::PTXInstruction div(ir::PTXInstruction::Div);
+            div.type = inductionType;
+            div.d = ir::PTXOperand(ir::PTXOperand::Register, inductionType, dfg().newRegister());
+            div.a = iterations;
+            div.b = ir::PTXOperand(step, inductionType);
+            code.push_back(div);
+            
+            iterations = div.d;
+        }
+        
+        if(inductionType != type)
+        {
+            //cvt.u64.u32 %iterations, %iterations;
+            ir::PTXInstruction cvt(ir::PTXInstruction::Cvt);
+            cvt.type = type;
+            cvt.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            cvt.a = iterations;
+            code.push_back(cvt);
+            
+            iterations = cvt.d;
+        }
+        
+        ir::PTXOperand count(ir::PTXOperand::Register, type, dfg().newRegister());
+        
+        if(loop.latchInstructions > 0)
+        {
+            /* zero iterations when the loop was skipped */
+            //max.u64 %taken, %iterations, 1;
+            ir::PTXInstruction max(ir::PTXInstruction::Max);
+            max.type = type;
+            max.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            max.a = iterations;
+            max.b = ir::PTXOperand(1, type);
+            code.push_back(max);
+            
+            //sub.u64 %taken, %taken, 1;
+            ir::PTXInstruction taken(ir::PTXInstruction::Sub);
+            taken.type = type;
+            taken.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            taken.a = max.d;
+            taken.b = ir::PTXOperand(1, type);
+            code.push_back(taken);
+            
+            //mul.lo.u64 %taken, %taken, latch;
+            ir::PTXInstruction latch(ir::PTXInstruction::Mul);
+            latch.type = type;
+            latch.modifier = ir::PTXInstruction::lo;
+            latch.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            latch.a = taken.d;
+            latch.b = ir::PTXOperand(loop.latchInstructions, type);
+            code.push_back(latch);
+            
+            //mad.lo.u64 %count, %iterations, executed, %taken;
+            ir::PTXInstruction mad(ir::PTXInstruction::Mad);
+            mad.type = type;
+            mad.modifier = ir::PTXInstruction::lo;
+            mad.d = count;
+            mad.a = iterations;
+            mad.b = ir::PTXOperand(attributes.basicBlockExecutedInstructionCount, type);
+            mad.c = latch.d;
+            code.push_back(mad);
+        }
+        else
+        {
+            //mul.lo.u64 %count, %iterations, executed;
+            ir::PTXInstruction mul(ir::PTXInstruction::Mul);
+            mul.type = type;
+            mul.modifier = ir::PTXInstruction::lo;
+            mul.d = count;
+            mul.a = iterations;
+            mul.b = ir::PTXOperand(attributes.basicBlockExecutedInstructionCount, type);
+            code.push_back(mul);
+        }
+        
+        loc = 0;
+        for(std::vector<ir::PTXInstruction>::const_iterator instruction = code.begin();
+            instruction != code.end(); ++instruction)
+        {
+            dfg().insert(loop.exit, *instruction, loc++);
+        }
+        
+        attributes.scaledExecutedInstructionCount = true;
+        attributes.executedInstructionCountRegister = count.reg;
+        
+        insertBefore(translationBlock, attributes, loop.exit, loc);
+        
+        report("Hoisted the instruction count of block " << loop.body->label() 
+            << " of loop " << loop.header->label() << " to its exit " << loop.exit->label());
+    }
+
+    NaturalLoopMap CToPTXInstrumentationPass::naturalLoops()
+    {
+        analysis::DominatorTree & dominatorTree = 
+            static_cast<analysis::DominatorTree&>(*getAnalysis("DominatorTreeAnalysis"));
+        
+        NaturalLoopMap loops;
+        
+        /* a back edge goes to a block dominating its tail, the loop holds 
+            the blocks reaching the tail without passing the header */
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            for( analysis::DataflowGraph::BlockPointerSet::const_iterator successor = basicBlock->successors().begin();
+                successor != basicBlock->successors().end(); ++successor )
+            {
+                if(!dominatorTree.dominates((*successor)->block(), basicBlock->block()))
+                    continue;
+                    
+                std::set<std::string> & body = loops[(*successor)->label()];
+                std::vector<analysis::DataflowGraph::iterator> stack;
+                
+                body.insert((*successor)->label());
+                if(body.insert(basicBlock->label()).second)
+                    stack.push_back(basicBlock);
+                
+                while(!stack.empty())
+                {
+                    analysis::DataflowGraph::iterator member = stack.back();
+                    stack.pop_back();
+                    
+                    for( analysis::DataflowGraph::BlockPointerSet::const_iterator predecessor = member->predecessors().begin();
+                        predecessor != member->predecessors().end(); ++predecessor )
+                    {
+                        if(body.insert((*predecessor)->label()).second)
+                            stack.push_back(*predecessor);
+                    }
+                }
+            }
+        }
+        
+        return loops;
     }
 
+    CounterPlacement CToPTXInstrumentationPass::placeCounters()
+    {
+        typedef std::map<std::string, unsigned int> VertexMap;
+        
+        CounterPlacement placement;
+        VertexMap vertices;
+        
+        analysis::DataflowGraph::iterator entry = dfg().begin();
+        analysis::DataflowGraph::iterator exit = --dfg().end();
+        
+        vertices[entry->label()] = CounterPlacement::Entry;
+        vertices[exit->label()] = CounterPlacement::Exit;
+        
+        /* vertices follow the order in which blocks are instrumented */
+        for( analysis::DataflowGraph::iterator basicBlock = ++dfg().begin(); 
+            basicBlock != exit; ++basicBlock )
+        {
+            vertices[basicBlock->label()] = 
+                placement.addVertex(!basicBlock->instructions().empty());
+        }
+        
+        /* static loop depth from the natural loops of the back edges */
+        NaturalLoopMap loops = naturalLoops();
+        std::vector<unsigned int> depth(placement.vertices(), 0);
+        
+        for(NaturalLoopMap::const_iterator loop = loops.begin();
+            loop != loops.end(); ++loop)
+        {
+            for(std::set<std::string>::const_iterator member = loop->second.begin(); 
+                member != loop->second.end(); ++member)
+            {
+                depth[vertices[*member]]++;
+            }
+        }
+        
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            unsigned int tail = vertices[basicBlock->label()];
+            
+            for( analysis::DataflowGraph::BlockPointerSet::const_iterator successor = basicBlock->successors().begin();
+                successor != basicBlock->successors().end(); ++successor )
+            {
+                unsigned int head = vertices[(*successor)->label()];
+                
+                placement.addEdge(tail, head, 
+                    std::pow(10.0, (double)std::min(depth[tail], depth[head])));
+            }
+        }
+        
+        placement.place();
+        
+        report("Kernel " << kernelName << ": " << placement.counters() 
+            << " counters for " << dfg().size() - 2 << " basic blocks");
+        
+        return placement;
+    }
+    
     void CToPTXInstrumentationPass::instrumentKernel(TranslationBlock translationBlock) 
     {
         StaticAttributes attributes;
@@ -689,32 +1423,659 @@ namespace transforms
     }
 
 
-/*******************************************************************************************
-
-    runOnKernel
-
-********************************************************************************************/
-
-    void CToPTXInstrumentationPass::runOnKernel( ir::IRKernel & k)
-	{
-		report("CToPTXInstrumentationPass::runOnKernel");
-		report("DFG (before erase) begin....");
-		std::ostream out(NULL);
-		dfg().writeLite(out);
-		report("DFG (before erase) end....");
-	    std::vector<TranslationBlock> translationBlocks;
-
+    bool CToPTXInstrumentationPass::stageable(ir::IRKernel & k)
+    {
+        analysis::DominatorTree & dominatorTree = 
+            static_cast<analysis::DominatorTree&>(*getAnalysis("DominatorTreeAnalysis"));
+        analysis::PostdominatorTree & postdominatorTree = 
+            static_cast<analysis::PostdominatorTree&>(*getAnalysis("PostDominatorTreeAnalysis"));
+        
+        /* the flush runs once, in front of the kernel's exit; a kernel that
+            can leave early keeps updating global memory directly */
+        unsigned int exits = 0;
+        bool predicated = false;
+        analysis::DataflowGraph::iterator exitBlock = dfg().end();
+        
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = basicBlock->instructions().begin();
+                instruction != basicBlock->instructions().end(); ++instruction)
+            {
+                ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
+                if(!ptxInstruction->isExit())
+                    continue;
+                    
+                exits++;
+                exitBlock = basicBlock;
+                predicated = ptxInstruction->pg.condition != ir::PTXOperand::PT;
+            }
+        }
+        
+        if(exits != 1 || predicated)
+        {
+            report("Kernel " << k.name << " has " << exits 
+                << (predicated ? " predicated" : "")
+                << " exit points, counters are not staged");
+            return false;
+        }
+        
+        /* without a loop every update runs at most once per thread, the 
+            shared array and the two barriers would cost more than they save */
+        bool loop = false;
+        
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end() && !loop; ++basicBlock )
+        {
+            for( analysis::DataflowGraph::BlockPointerSet::const_iterator successor = basicBlock->successors().begin();
+                successor != basicBlock->successors().end(); ++successor )
+            {
+                if(dominatorTree.dominates((*successor)->block(), basicBlock->block()))
+                {
+                    loop = true;
+                    break;
+                }
+            }
+        }
+        
+        if(!loop)
+        {
+            report("Kernel " << k.name << " has no loop, counters are not staged");
+            return false;
+        }
+        
+        /* the barriers are only legal where every warp has reconverged: the 
+            exit block must be reached by every thread, and no divergent 
+            branch may reconverge at the exit block itself since the threads 
+            of such a warp are allowed to run to the exit one path at a time */
+        analysis::DataflowGraph::iterator entryBlock = ++dfg().begin();
+        
+        if(!postdominatorTree.postDominates(exitBlock->block(), entryBlock->block()))
+        {
+            report("The exit of kernel " << k.name << " does not postdominate "
+                << "its entry, counters are not staged");
+            return false;
+        }
+        
+        const UniformBranches *branches = 0;
+        if(stagingBranches != 0)
+        {
+            UniformBranchMap::const_iterator kernel = stagingBranches->find(kernelName);
+            if(kernel != stagingBranches->end())
+                branches = &kernel->second;
+        }
+        
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            if(basicBlock->instructions().empty())
+                continue;
+                
+            ir::PTXInstruction *branch = (ir::PTXInstruction *)basicBlock->instructions().back().i;
+            
+            if(branch->opcode != ir::PTXInstruction::Bra || 
+                (branch->pg.condition != ir::PTXOperand::Pred && 
+                branch->pg.condition != ir::PTXOperand::InvPred))
+                continue;
+                
+            if(branches != 0 && branches->uniform(basicBlock->label()))
+                continue;
+                
+            if(postdominatorTree.getPostDominator(basicBlock->block()) == exitBlock->block())
+            {
+                report("The divergent branch of block " << basicBlock->label() 
+                    << " in kernel " << k.name << " reconverges at the exit, "
+                    << "counters are not staged");
+                return false;
+            }
+        }
+        
+        return true;
+    }
+
+    unsigned int CToPTXInstrumentationPass::stageCounters(ir::IRKernel & k, ir::PTXKernel::PTXStatementVector & statements)
+    {
+        if(!stageable(k))
+            return 0;
+
+        /* inserted code that branches could leave a warp divergent at the
+            flush as well */
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            if(statement->directive == ir::PTXStatement::Instr &&
+                statement->instruction.opcode == ir::PTXInstruction::Bra &&
+                (statement->instruction.pg.condition == ir::PTXOperand::Pred ||
+                statement->instruction.pg.condition == ir::PTXOperand::InvPred))
+            {
+                report("The instrumentation of kernel " << k.name
+                    << " branches, counters are not staged");
+                return 0;
+            }
+        }
+
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        
+        /* counters are atomics at a constant offset from the global base, or
+            a load, add and store of the same address computed from it */
+        std::set<std::string> addresses;
+        std::map<std::string, std::string> pointers;
+        std::map<std::string, ir::PTXKernel::PTXStatementVector::iterator> loads;
+        std::map<std::string, ir::PTXKernel::PTXStatementVector::iterator> sums;
+        std::vector<ir::PTXKernel::PTXStatementVector::iterator> atomics;
+        std::map<ir::PTXKernel::PTXStatementVector::iterator, std::string> stores;
+        std::set<ir::PTXKernel::PTXStatementVector::iterator> updates;
+        std::map<std::string, unsigned int> reads;
+        unsigned int counters = 0;
+        
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            const ir::PTXOperand * sources[] = { &statement->instruction.a, 
+                &statement->instruction.b, &statement->instruction.c };
+            
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                if(statement->directive == ir::PTXStatement::Instr &&
+                    !sources[i]->identifier.empty())
+                    reads[sources[i]->identifier]++;
+            }
+        }
+        
+        for(ir::PTXKernel::PTXStatementVector::iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            if(statement->directive != ir::PTXStatement::Instr)
+                continue;
+                
+            const ir::PTXInstruction & instruction = statement->instruction;
+            
+            if(instruction.opcode == ir::PTXInstruction::Mov &&
+                instruction.a.addressMode == ir::PTXOperand::Address &&
+                instruction.a.identifier == GLOBAL_MEM_BASE_ADDRESS)
+            {
+                addresses.insert(instruction.d.identifier);
+            }
+            else if(instruction.opcode == ir::PTXInstruction::Ld &&
+                instruction.addressSpace == ir::PTXInstruction::Global &&
+                addresses.count(instruction.a.identifier) != 0)
+            {
+                pointers[instruction.d.identifier] = instruction.d.identifier;
+            }
+            else if(instruction.opcode == ir::PTXInstruction::Atom &&
+                instruction.atomicOperation == ir::PTXInstruction::AtomicAdd &&
+                instruction.addressSpace == ir::PTXInstruction::Global &&
+                instruction.a.addressMode == ir::PTXOperand::Indirect &&
+                pointers.count(instruction.a.identifier) != 0 &&
+                pointers[instruction.a.identifier] == instruction.a.identifier &&
+                instruction.a.offset >= 0 && 
+                instruction.a.offset % sizeof(size_t) == 0)
+            {
+                counters = std::max(counters, 
+                    (unsigned int)(instruction.a.offset / sizeof(size_t)) + 1);
+                atomics.push_back(statement);
+            }
+            else if((instruction.opcode == ir::PTXInstruction::Add ||
+                instruction.opcode == ir::PTXInstruction::Sub) &&
+                instruction.a.addressMode == ir::PTXOperand::Register &&
+                pointers.count(instruction.a.identifier) != 0)
+            {
+                pointers[instruction.d.identifier] = pointers[instruction.a.identifier];
+            }
+            else if(instruction.opcode == ir::PTXInstruction::Add &&
+                instruction.b.addressMode == ir::PTXOperand::Register &&
+                pointers.count(instruction.b.identifier) != 0)
+            {
+                pointers[instruction.d.identifier] = pointers[instruction.b.identifier];
+            }
+            else if(instruction.opcode == ir::PTXInstruction::Ld &&
+                instruction.addressSpace == ir::PTXInstruction::Global &&
+                instruction.a.addressMode == ir::PTXOperand::Indirect &&
+                pointers.count(instruction.a.identifier) != 0 &&
+                instruction.type == type &&
+                reads[instruction.d.identifier] == 1)
+            {
+                loads[instruction.d.identifier] = statement;
+            }
+            else if(instruction.opcode == ir::PTXInstruction::Add &&
+                instruction.a.addressMode == ir::PTXOperand::Register &&
+                loads.count(instruction.a.identifier) != 0 &&
+                reads[instruction.d.identifier] == 1)
+            {
+                sums[instruction.d.identifier] = loads[instruction.a.identifier];
+            }
+            else if(instruction.opcode == ir::PTXInstruction::St &&
+                instruction.addressSpace == ir::PTXInstruction::Global &&
+                instruction.d.addressMode == ir::PTXOperand::Indirect &&
+                instruction.a.addressMode == ir::PTXOperand::Register &&
+                sums.count(instruction.a.identifier) != 0)
+            {
+                /* the store must write back to the address that was read */
+                const ir::PTXInstruction & load = sums[instruction.a.identifier]->instruction;
+                
+                if(load.a.identifier == instruction.d.identifier &&
+                    load.a.offset == instruction.d.offset &&
+                    load.pg.condition == instruction.pg.condition &&
+                    load.pg.identifier == instruction.pg.identifier &&
+                    instruction.d.offset % sizeof(size_t) == 0)
+                {
+                    stores[statement] = pointers[instruction.d.identifier];
+                    updates.insert(sums[instruction.a.identifier]);
+                }
+            }
+        }
+        
+        /* a store counter may be at any index below basicBlockCount() */
+        if(!stores.empty())
+            counters = std::max(counters, (unsigned int)dfg().size() - 2);
+        
+        if((atomics.empty() && stores.empty()) || counters > MAX_STAGED_COUNTERS)
+            return 0;
+        
+        for(std::vector<ir::PTXKernel::PTXStatementVector::iterator>::iterator 
+            atomic = atomics.begin(); atomic != atomics.end(); ++atomic)
+        {
+            ir::PTXInstruction & instruction = (*atomic)->instruction;
+            
+            instruction.addressSpace = ir::PTXInstruction::Shared;
+            instruction.a.addressMode = ir::PTXOperand::Address;
+            instruction.a.identifier = STAGED_COUNTERS;
+        }
+        
+        newRegisterMap[STAGED_COUNTER_INDEX] = dfg().newRegister();
+        newRegisterMap[STAGED_COUNTER_BASE] = dfg().newRegister();
+        
+        ir::PTXOperand index(ir::PTXOperand::Register, type, STAGED_COUNTER_INDEX);
+        ir::PTXOperand staged(ir::PTXOperand::Register, type, STAGED_COUNTER_BASE);
+        ir::PTXOperand count(ir::PTXOperand::Register, type, BASIC_BLOCK_COUNT);
+        
+        ir::PTXKernel::PTXStatementVector rewritten;
+        
+        for(ir::PTXKernel::PTXStatementVector::iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            /* the value read from global memory is replaced by zero, the add
+                then computes the increment of the counter */
+            if(updates.count(statement) != 0)
+            {
+                ir::PTXStatement zero = *statement;
+                zero.instruction = ir::PTXInstruction(ir::PTXInstruction::Mov);
+                zero.instruction.type = type;
+                zero.instruction.d = statement->instruction.d;
+                zero.instruction.a = ir::PTXOperand(0, type);
+                zero.instruction.pg = statement->instruction.pg;
+                rewritten.push_back(zero);
+                continue;
+            }
+            
+            std::map<ir::PTXKernel::PTXStatementVector::iterator, std::string>::const_iterator 
+                store = stores.find(statement);
+            
+            if(store == stores.end())
+            {
+                rewritten.push_back(*statement);
+                continue;
+            }
+            
+            const ir::PTXInstruction & original = statement->instruction;
+            
+            ir::PTXOperand base(ir::PTXOperand::Register, type, store->second);
+            ir::PTXOperand address(ir::PTXOperand::Register, type, original.d.identifier);
+            
+            ir::PTXStatement code(ir::PTXStatement::Instr);
+            ir::PTXInstruction & instruction = code.instruction;
+            
+            //sub.u64 %index, %address, %base;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Sub);
+            instruction.type = type;
+            instruction.d = index;
+            instruction.a = address;
+            instruction.b = base;
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+            
+            //shr.u64 %index, %index, 3;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Shr);
+            instruction.type = type;
+            instruction.d = index;
+            instruction.a = index;
+            instruction.b = ir::PTXOperand(sizeof(size_t) == 8 ? 3 : 2, ir::PTXOperand::u32);
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+            
+            if(original.d.offset != 0)
+            {
+                //add.u64 %index, %index, offset / 8;
+                instruction = ir::PTXInstruction(ir::PTXInstruction::Add);
+                instruction.type = type;
+                instruction.d = index;
+                instruction.a = index;
+                instruction.b = ir::PTXOperand(original.d.offset / sizeof(size_t), type);
+                instruction.pg = original.pg;
+                rewritten.push_back(code);
+            }
+            
+            /* the host only sums counters with the same index modulo 
+                basicBlockCount(), a CTA adds them up in one slot */
+            
+            //rem.u64 %index, %index, basicBlockCount;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Rem);
+            instruction.type = type;
+            instruction.d = index;
+            instruction.a = index;
+            instruction.b = count;
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+            
+            //mov.u64 %staged, __lynx_staged_counters;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Mov);
+            instruction.type = type;
+            instruction.d = staged;
+            instruction.a = ir::PTXOperand(ir::PTXOperand::Address, type, STAGED_COUNTERS);
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+            
+            //mad.lo.u64 %index, %index, 8, %staged;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Mad);
+            instruction.type = type;
+            instruction.modifier = ir::PTXInstruction::lo;
+            instruction.d = index;
+            instruction.a = index;
+            instruction.b = ir::PTXOperand(sizeof(size_t), type);
+            instruction.c = staged;
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+            
+            //atom.shared.add.u64 %index, [%index], %sum;
+            instruction = ir::PTXInstruction(ir::PTXInstruction::Atom);
+            instruction.type = type;
+            instruction.atomicOperation = ir::PTXInstruction::AtomicAdd;
+            instruction.addressSpace = ir::PTXInstruction::Shared;
+            instruction.d = index;
+            instruction.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, STAGED_COUNTER_INDEX);
+            instruction.b = original.a;
+            instruction.pg = original.pg;
+            rewritten.push_back(code);
+        }
+        
+        statements = rewritten;
+        
+        ir::PTXStatement shared(ir::PTXStatement::Shared);
+        shared.name = STAGED_COUNTERS;
+        shared.array.stride = ir::PTXStatement::ArrayStrideVector(1, counters);
+        shared.alignment = sizeof(size_t);
+        shared.type = type;
+        
+        ir::PTXKernel *ptxKernel = (ir::PTXKernel *)&k;
+        ptxKernel->locals.insert(std::make_pair(shared.name, ir::Local(shared)));
+        
+        report("Staging " << counters << " counters of kernel " << k.name 
+            << " in shared memory, " << atomics.size() << " atomic and " 
+            << stores.size() << " stored updates");
+        
+        return counters;
+    }
+    
+    void CToPTXInstrumentationPass::stagedCounterOwners(unsigned int counters, std::vector<ir::PTXInstruction> & code, 
+        std::vector<analysis::DataflowGraph::RegisterId> & owners)
+    {
+        /* counter i belongs to the thread whose linear id in the CTA is 
+            i modulo the CTA size, so neighbouring threads touch neighbouring
+            counters */
+        ir::PTXOperand::SpecialRegister specials[] = { ir::PTXOperand::tid, ir::PTXOperand::ntid };
+        ir::PTXOperand::VectorIndex indices[] = { ir::PTXOperand::ix, ir::PTXOperand::iy, ir::PTXOperand::iz };
+        ir::PTXOperand dimensions[2][3];
+        
+        for(unsigned int s = 0; s < 2; s++)
+        {
+            for(unsigned int i = 0; i < 3; i++)
+            {
+                ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+                mov.type = ir::PTXOperand::u32;
+                mov.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+                mov.a = ir::PTXOperand(specials[s], indices[i], ir::PTXOperand::u32);
+                mov.a.vec = ir::PTXOperand::v1;
+                code.push_back(mov);
+                
+                dimensions[s][i] = mov.d;
+            }
+        }
+        
+        //mad.lo.u32 %thread, %tid.z, %ntid.y, %tid.y;
+        ir::PTXInstruction mad(ir::PTXInstruction::Mad);
+        mad.type = ir::PTXOperand::u32;
+        mad.modifier = ir::PTXInstruction::lo;
+        mad.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+        mad.a = dimensions[0][2];
+        mad.b = dimensions[1][1];
+        mad.c = dimensions[0][1];
+        code.push_back(mad);
+        
+        //mad.lo.u32 %thread, %thread, %ntid.x, %tid.x;
+        mad.a = mad.d;
+        mad.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+        mad.b = dimensions[1][0];
+        mad.c = dimensions[0][0];
+        code.push_back(mad);
+        
+        ir::PTXOperand thread = mad.d;
+        
+        //mul.lo.u32 %threads, %ntid.x, %ntid.y;
+        ir::PTXInstruction mul(ir::PTXInstruction::Mul);
+        mul.type = ir::PTXOperand::u32;
+        mul.modifier = ir::PTXInstruction::lo;
+        mul.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+        mul.a = dimensions[1][0];
+        mul.b = dimensions[1][1];
+        code.push_back(mul);
+        
+        //mul.lo.u32 %threads, %threads, %ntid.z;
+        mul.a = mul.d;
+        mul.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+        mul.b = dimensions[1][2];
+        code.push_back(mul);
+        
+        ir::PTXOperand threads = mul.d;
+        
+        for(unsigned int counter = 0; counter < counters; counter++)
+        {
+            //rem.u32 %owner, counter, %threads;
+            ir::PTXInstruction rem(ir::PTXInstruction::Rem);
+            rem.type = ir::PTXOperand::u32;
+            rem.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, dfg().newRegister());
+            rem.a = ir::PTXOperand(counter, ir::PTXOperand::u32);
+            rem.b = threads;
+            code.push_back(rem);
+            
+            //setp.eq.u32 %owns, %thread, %owner;
+            ir::PTXInstruction setp(ir::PTXInstruction::SetP);
+            setp.type = ir::PTXOperand::u32;
+            setp.comparisonOperator = ir::PTXInstruction::Eq;
+            setp.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, dfg().newRegister());
+            setp.a = thread;
+            setp.b = rem.d;
+            code.push_back(setp);
+            
+            owners.push_back(setp.d.reg);
+        }
+    }
+    
+    void CToPTXInstrumentationPass::insertStagedCounterPrologue(unsigned int counters)
+    {
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        
+        std::vector<ir::PTXInstruction> code;
+        std::vector<analysis::DataflowGraph::RegisterId> owners;
+        
+        stagedCounterOwners(counters, code, owners);
+        
+        for(unsigned int counter = 0; counter < counters; counter++)
+        {
+            //@%owns st.shared.u64 [__lynx_staged_counters + offset], 0;
+            ir::PTXInstruction st(ir::PTXInstruction::St);
+            st.type = type;
+            st.addressSpace = ir::PTXInstruction::Shared;
+            st.d = ir::PTXOperand(ir::PTXOperand::Address, type, STAGED_COUNTERS, counter * sizeof(size_t));
+            st.a = ir::PTXOperand(0, type);
+            st.pg = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, owners[counter]);
+            code.push_back(st);
+        }
+        
+        //bar.sync 0;
+        ir::PTXInstruction bar(ir::PTXInstruction::Bar);
+        bar.d = ir::PTXOperand(0, ir::PTXOperand::u32);
+        code.push_back(bar);
+        
+        analysis::DataflowGraph::iterator block = dfg().begin();
+	    ++block;
+	    
+	    unsigned int loc = 0;
+	    for(std::vector<ir::PTXInstruction>::const_iterator instruction = code.begin();
+	        instruction != code.end(); ++instruction)
+	    {
+	        dfg().insert(block, *instruction, loc++);
+	    }
+    }
+    
+    void CToPTXInstrumentationPass::insertStagedCounterFlush(unsigned int counters)
+    {
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        
+        std::vector<ir::PTXInstruction> code;
+        std::vector<analysis::DataflowGraph::RegisterId> owners;
+        
+        //bar.sync 0;
+        ir::PTXInstruction bar(ir::PTXInstruction::Bar);
+        bar.d = ir::PTXOperand(0, ir::PTXOperand::u32);
+        code.push_back(bar);
+        
+        stagedCounterOwners(counters, code, owners);
+        
+        //mov.u64 %address, __lynx_global_mem_base_address__;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = type;
+        mov.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        mov.a = ir::PTXOperand(ir::PTXOperand::Address, type, GLOBAL_MEM_BASE_ADDRESS);
+        code.push_back(mov);
+        
+        //ld.global.u64 %base, [%address];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Global;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+        ld.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, mov.d.reg);
+        code.push_back(ld);
+        
+        ir::PTXOperand base = ld.d;
+        
+        for(unsigned int counter = 0; counter < counters; counter++)
+        {
+            ir::PTXOperand owns(ir::PTXOperand::Register, ir::PTXOperand::pred, owners[counter]);
+            
+            //@%owns ld.shared.u64 %value, [__lynx_staged_counters + offset];
+            ir::PTXInstruction value(ir::PTXInstruction::Ld);
+            value.type = type;
+            value.addressSpace = ir::PTXInstruction::Shared;
+            value.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            value.a = ir::PTXOperand(ir::PTXOperand::Address, type, STAGED_COUNTERS, counter * sizeof(size_t));
+            value.pg = owns;
+            code.push_back(value);
+            
+            //setp.ne.and.u64 %update, %value, 0, %owns;
+            ir::PTXInstruction setp(ir::PTXInstruction::SetP);
+            setp.type = type;
+            setp.comparisonOperator = ir::PTXInstruction::Ne;
+            setp.booleanOperator = ir::PTXInstruction::BoolAnd;
+            setp.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, dfg().newRegister());
+            setp.a = value.d;
+            setp.b = ir::PTXOperand(0, type);
+            setp.c = owns;
+            code.push_back(setp);
+            
+            //@%update atom.global.add.u64 %old, [%base + offset], %value;
+            ir::PTXInstruction atom(ir::PTXInstruction::Atom);
+            atom.type = type;
+            atom.atomicOperation = ir::PTXInstruction::AtomicAdd;
+            atom.addressSpace = ir::PTXInstruction::Global;
+            atom.d = ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+            atom.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, base.reg, counter * sizeof(size_t));
+            atom.b = value.d;
+            atom.pg = setp.d;
+            code.push_back(atom);
+        }
+        
+        /* insert in front of the exit, after any ON_KERNEL_EXIT code */
+        for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            unsigned int loc = 0;
+            
+            for( analysis::DataflowGraph::InstructionVector::const_iterator instruction = basicBlock->instructions().begin();
+                instruction != basicBlock->instructions().end(); ++instruction, ++loc)
+            {
+                ir::PTXInstruction *ptxInstruction = (ir::PTXInstruction *)instruction->i;
+                if(!ptxInstruction->isExit())
+                    continue;
+                    
+                for(std::vector<ir::PTXInstruction>::const_iterator inst = code.begin();
+                    inst != code.end(); ++inst)
+                {
+                    dfg().insert(basicBlock, *inst, loc++);
+                }
+                
+                return;
+            }
+        }
+    }
+
+
+/*******************************************************************************************
+
+    runOnKernel
+
+********************************************************************************************/
+
+    void CToPTXInstrumentationPass::runOnKernel( ir::IRKernel & k)
+	{
+		report("CToPTXInstrumentationPass::runOnKernel");
+		kernelName = k.name;
+		report("DFG (before erase) begin....");
+		std::ostream out(NULL);
+		dfg().writeLite(out);
+		report("DFG (before erase) end....");
+	    std::vector<TranslationBlock> translationBlocks;
+
+ 	    unsigned long originalSize = kernelSize();
+	    
         optimize(translation.statements);
+        
+        if(optimizeInstrumentation)
+        {
+            propagateCopies(translation.statements);
+            eliminateDeadCode(translation.statements);
+        }
 	   
 	    for(translator::CToPTXData::RegisterVector::const_iterator reg = translation.registers.begin();
 	        reg != translation.registers.end(); ++reg) {
 	        newRegisterMap[*reg] = dfg().newRegister();   
 	    }
+	    
+	    /* staging rewrites the statements for this kernel only */
+	    ir::PTXKernel::PTXStatementVector statements = translation.statements;
+	    unsigned int stagedCounters = 0;
+	    
+	    if(sharedCounterStaging)
+	        stagedCounters = stageCounters(k, statements);
+	    
+	    ir::PTXKernel::PTXStatementVector invariants;
+	    
+	    if(optimizeInstrumentation)
+	        hoistInvariants(statements, invariants);
         
         TranslationBlock initialBlock;
         
-        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = translation.statements.begin();
-            statement != translation.statements.end(); ++statement) {
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement) {
             
             if(statement->directive == ir::PTXStatement::Param)
             {   
@@ -896,6 +2257,42 @@ namespace transforms
             
         /* insert initial translation block at the beginning of the kernel -- this is the default case */
         instrumentKernel(initialBlock);
+        
+        insertInvariants(invariants);
+        
+        /* the prologue goes in last so that it precedes all other inserted code */
+        if(stagedCounters > 0)
+        {
+            insertStagedCounterFlush(stagedCounters);
+            insertStagedCounterPrologue(stagedCounters);
+        }
+        
+        unsigned int optimizedInstructions = 0;
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            if(statement->directive == ir::PTXStatement::Instr)
+                optimizedInstructions++;
+        }
+        
+        report("Kernel " << k.name << ": " << translatedInstructions 
+            << " instrumentation instructions before optimization, " 
+            << optimizedInstructions << " after (" << invariants.size() 
+            << " computed once at entry), " << kernelSize() - originalSize 
+            << " instructions inserted");
+	}
+	
+	unsigned long CToPTXInstrumentationPass::kernelSize()
+	{
+	    unsigned long size = 0;
+	    
+	    for( analysis::DataflowGraph::iterator basicBlock = dfg().begin(); 
+            basicBlock != dfg().end(); ++basicBlock )
+        {
+            size += basicBlock->instructions().size();
+        }
+        
+        return size;
 	}
 	
     void CToPTXInstrumentationPass::initialize(const ir::Module& m )
@@ -1022,15 +2419,282 @@ namespace transforms
 
 	}
 	
+	void CToPTXInstrumentationPass::propagateCopies(ir::PTXKernel::PTXStatementVector & statements)
+	{
+	    /* where each translated register is defined */
+	    std::map<std::string, unsigned int> definitions;
+	    std::map<std::string, unsigned int> definedAt;
+	    
+	    for(unsigned int s = 0; s < statements.size(); s++)
+	    {
+	        const ir::PTXInstruction & instruction = statements[s].instruction;
+	        
+	        if(statements[s].directive != ir::PTXStatement::Instr ||
+	            instruction.d.identifier.empty())
+	            continue;
+	        
+	        definitions[instruction.d.identifier]++;
+	        definedAt[instruction.d.identifier] = s;
+	    }
+	    
+	    std::vector<bool> erased(statements.size(), false);
+	    unsigned int copies = 0;
+	    
+	    for(unsigned int s = 0; s < statements.size(); s++)
+	    {
+	        const ir::PTXInstruction & copy = statements[s].instruction;
+	        
+	        //mov %d, %a;
+	        if(statements[s].directive != ir::PTXStatement::Instr ||
+	            copy.opcode != ir::PTXInstruction::Mov ||
+	            copy.pg.condition == ir::PTXOperand::Pred || copy.pg.condition == ir::PTXOperand::InvPred ||
+	            copy.d.addressMode != ir::PTXOperand::Register ||
+	            copy.a.addressMode != ir::PTXOperand::Register ||
+	            translatedRegisters.count(copy.d.identifier) == 0 ||
+	            translatedRegisters.count(copy.a.identifier) == 0 ||
+	            copy.d.type != copy.a.type)
+	            continue;
+	        
+	        /* both are single definitions, the source defined before the copy */
+	        if(definitions[copy.d.identifier] != 1 || definitions[copy.a.identifier] != 1 ||
+	            definedAt[copy.a.identifier] > s)
+	            continue;
+	        
+	        /* every read follows the copy in the same inserted sequence */
+	        std::vector<ir::PTXOperand *> reads;
+	        bool local = true;
+	        bool sequence = true;
+	        
+	        for(unsigned int u = 0; u < statements.size() && local; u++)
+	        {
+	            if(u > s && isTargetLabel(statements[u]))
+	                sequence = false;
+	            
+	            if(u == s || statements[u].directive != ir::PTXStatement::Instr)
+	                continue;
+	            
+	            ir::PTXInstruction & instruction = statements[u].instruction;
+	            ir::PTXOperand * operands[] = { &instruction.a, &instruction.b, 
+	                &instruction.c, &instruction.pg, &instruction.d };
+	            
+	            for(int i = 0; i < 5; i++)
+	            {
+	                if(operands[i]->identifier != copy.d.identifier)
+	                    continue;
+	                
+	                if(operands[i] == &instruction.d && operands[i]->addressMode == ir::PTXOperand::Register)
+	                    continue;
+	                
+	                if(u < s || !sequence || 
+	                    (operands[i]->addressMode != ir::PTXOperand::Register && 
+	                    operands[i]->addressMode != ir::PTXOperand::Indirect))
+	                {
+	                    local = false;
+	                    break;
+	                }
+	                
+	                reads.push_back(operands[i]);
+	            }
+	        }
+	        
+	        if(!local)
+	            continue;
+	        
+	        for(std::vector<ir::PTXOperand *>::iterator read = reads.begin();
+	            read != reads.end(); ++read)
+	        {
+	            (*read)->identifier = copy.a.identifier;
+	        }
+	        
+	        erased[s] = true;
+	        definitions[copy.d.identifier] = 0;
+	        copies++;
+	    }
+	    
+	    ir::PTXKernel::PTXStatementVector propagated;
+	    for(unsigned int s = 0; s < statements.size(); s++)
+	    {
+	        if(!erased[s])
+	            propagated.push_back(statements[s]);
+	    }
+	    
+	    statements = propagated;
+	    
+	    report("Propagated " << copies << " copies");
+	}
+	
+	void CToPTXInstrumentationPass::eliminateDeadCode(ir::PTXKernel::PTXStatementVector & statements)
+	{
+	    unsigned int eliminated = 0;
+	    bool changed = true;
+	    
+	    while(changed)
+	    {
+	        changed = false;
+	        
+	        std::map<std::string, unsigned int> uses;
+	        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+                statement != statements.end(); ++statement)
+            {
+                if(statement->directive == ir::PTXStatement::Instr)
+                    countUses(statement->instruction, uses);
+            }
+            
+            ir::PTXKernel::PTXStatementVector live;
+            for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+                statement != statements.end(); ++statement)
+            {
+                const ir::PTXInstruction & instruction = statement->instruction;
+                
+                /* static attributes and function placeholders are resolved 
+                    at insertion time and are left alone */
+                bool translated = true;
+                const ir::PTXOperand * sources[] = { &instruction.a, &instruction.b, &instruction.c };
+                for(int i = 0; i < 3; i++)
+                {
+                    if(!sources[i]->identifier.empty() && 
+                        translatedRegisters.count(sources[i]->identifier) == 0)
+                        translated = false;
+                }
+                
+                if(statement->directive == ir::PTXStatement::Instr && translated &&
+                    isPure(instruction) &&
+                    instruction.d.addressMode == ir::PTXOperand::Register &&
+                    translatedRegisters.count(instruction.d.identifier) != 0 &&
+                    uses[instruction.d.identifier] == 0)
+                {
+                    eliminated++;
+                    changed = true;
+                    continue;
+                }
+                
+                live.push_back(*statement);
+            }
+            
+            statements = live;
+	    }
+	    
+	    report("Eliminated " << eliminated << " dead instrumentation instructions");
+	}
+	
+	void CToPTXInstrumentationPass::hoistInvariants(ir::PTXKernel::PTXStatementVector & statements, 
+	    ir::PTXKernel::PTXStatementVector & invariants)
+	{
+	    std::map<std::string, unsigned int> definitions;
+	    
+	    for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            if(statement->directive == ir::PTXStatement::Instr &&
+                !statement->instruction.d.identifier.empty())
+                definitions[statement->instruction.d.identifier]++;
+        }
+        
+        /* values computed from special registers and immediates only, such
+            as the global thread, warp, block and SM ids, are the same at 
+            every insertion point */
+        std::set<std::string> invariant;
+        ir::PTXKernel::PTXStatementVector remaining;
+        
+        for(ir::PTXKernel::PTXStatementVector::const_iterator statement = statements.begin();
+            statement != statements.end(); ++statement)
+        {
+            const ir::PTXInstruction & instruction = statement->instruction;
+            
+            bool hoist = statement->directive == ir::PTXStatement::Instr &&
+                isPure(instruction) && 
+                instruction.opcode != ir::PTXInstruction::SetP &&
+                instruction.opcode != ir::PTXInstruction::SelP &&
+                instruction.pg.condition != ir::PTXOperand::Pred && 
+                instruction.pg.condition != ir::PTXOperand::InvPred &&
+                instruction.d.addressMode == ir::PTXOperand::Register &&
+                translatedRegisters.count(instruction.d.identifier) != 0 &&
+                definitions[instruction.d.identifier] == 1;
+            
+            /* unary operations only read a, mad also reads c */
+            unsigned int sources = 2;
+            if(instruction.opcode == ir::PTXInstruction::Mov || 
+                instruction.opcode == ir::PTXInstruction::Cvt ||
+                instruction.opcode == ir::PTXInstruction::Not ||
+                instruction.opcode == ir::PTXInstruction::Popc)
+                sources = 1;
+            else if(instruction.opcode == ir::PTXInstruction::Mad)
+                sources = 3;
+            
+            const ir::PTXOperand * operands[] = { &instruction.a, &instruction.b, &instruction.c };
+            
+            for(unsigned int i = 0; i < sources && hoist; i++)
+            {
+                const ir::PTXOperand & operand = *operands[i];
+                
+                if(operand.addressMode == ir::PTXOperand::Immediate && operand.identifier.empty())
+                    continue;
+                if(operand.addressMode == ir::PTXOperand::Special && isThreadInvariant(operand))
+                    continue;
+                if(operand.addressMode == ir::PTXOperand::Register && invariant.count(operand.identifier) != 0)
+                    continue;
+                
+                hoist = false;
+            }
+            
+            if(hoist)
+            {
+                invariant.insert(instruction.d.identifier);
+                invariants.push_back(*statement);
+            }
+            else
+            {
+                remaining.push_back(*statement);
+            }
+        }
+        
+        statements = remaining;
+	}
+	
+	void CToPTXInstrumentationPass::insertInvariants(const ir::PTXKernel::PTXStatementVector & invariants)
+	{
+	    if(invariants.empty() || dfg().empty())
+	        return;
+	    
+	    analysis::DataflowGraph::iterator block = dfg().begin();
+	    ++block;
+	    
+	    StaticAttributes attributes;
+	    unsigned int loc = 0;
+	    
+	    for(ir::PTXKernel::PTXStatementVector::const_iterator statement = invariants.begin();
+            statement != invariants.end(); ++statement)
+        {
+            ir::PTXStatement toInsert = prepareStatementToInsert(*statement, attributes);
+            dfg().insert(block, toInsert.instruction, loc++);
+        }
+	}
+	
     CToPTXInstrumentationPass::CToPTXInstrumentationPass(translator::CToPTXData
         translation)
-		: KernelPass(Analysis::StringVector({"DataflowGraphAnalysis"}), "CToPTXInstrumentationPass" ),
-        translation(translation)
+		: KernelPass(Analysis::StringVector({"DataflowGraphAnalysis", "DominatorTreeAnalysis", 
+            "PostDominatorTreeAnalysis"}), "CToPTXInstrumentationPass" ),
+        translation(translation), sharedCounterStaging(false), counterPlacements(0),
+        loopHoisting(false), optimizeInstrumentation(true),
+        uniformBranches(0), stagingBranches(0)
 	{
 	    report("CToPTXInstrumentationPass::CToPTXInstrumentationPass...");
 	    parameterMap = translation.parameterMap;
 	 
 	    functionNames = { COMPUTE_BASE_ADDRESS, GET_PREDICATE_VALUE };
+	    
+	    translatedRegisters.insert(translation.registers.begin(), translation.registers.end());
+	    for(FunctionNameVector::const_iterator function = functionNames.begin();
+	        function != functionNames.end(); ++function)
+	        translatedRegisters.erase(*function);
+	    
+	    translatedInstructions = 0;
+	    for(ir::PTXKernel::PTXStatementVector::const_iterator statement = translation.statements.begin();
+            statement != translation.statements.end(); ++statement)
+        {
+            if(statement->directive == ir::PTXStatement::Instr)
+                translatedInstructions++;
+        }
 	 
 	    instructionClasses = { ON_MEM_READ, ON_MEM_WRITE, ON_PREDICATED, ON_BRANCH, ON_CALL, ON_BARRIER, ON_ATOMIC, ON_ARITH_OP, ON_FLOATING_POINT, ON_TEXTURE };
 	    addressSpaceSpecifiers = { GLOBAL, LOCAL, SHARED, CONST, PARAM, TEXTURE };
@@ -1102,6 +2766,16 @@ namespace transforms
 	    dataTypeMap[ir::PTXOperand::f64] = TYPE_FP;
 	}
 	
+	StaticAttributes::StaticAttributes()
+	    : scaledExecutedInstructionCount(false), executedInstructionCountRegister(0)
+	    {
+	    }
+	    
+	CountedLoop::CountedLoop()
+	    : step(0), latchInstructions(0)
+	    {
+	    }
+	    
 	InstrumentationSpecifier::InstrumentationSpecifier()
 	    : checkForPredication(false), isPredicated(false)
 	    {
@@ -8,6 +8,7 @@
 #define C_TO_PTX_MODULE_PASS_CPP_INCLUDED
 
 #include <lynx/transforms/interface/CToPTXModulePass.h>
+#include <lynx/trace/interface/MemoryTrace.h>
 #include <ocelot/ir/interface/Module.h>
 #include <ocelot/ir/interface/PTXStatement.h>
 #include <ocelot/ir/interface/PTXInstruction.h>
@@ -16,6 +17,9 @@
 #include <ocelot/analysis/interface/DataflowGraph.h>
 
 #include <hydrazine/interface/Exception.h>
+
+#include <cstddef>
+
 #define REPORT_BASE 1 
 namespace transforms
 {
@@ -23,7 +27,7 @@ namespace transforms
     Pass::StringVector CToPTXModulePass::getDependentPasses() const
     {
 	    Pass::StringVector dependentPasses;
-	    dependentPasses.push_back("CToPTXInstrumentationPass");
+	    dependentPasses.push_back(instrumentationPass);
 	    return dependentPasses;
     }
 
@@ -38,11 +42,19 @@ namespace transforms
 	    }
 
         ir::PTXKernel::Prototype prototype;
+        ir::PTXKernel * kernel = 0;
+        
         if(functionName == UNIQUE_ELEMENT_COUNT)
+            kernel = uniqueElementCount();
+        else if(functionName == UNIQUE_SEGMENT_COUNT)
+            kernel = uniqueSegmentCount();
+        else if(functionName == MEMORY_TRACE_RESERVE)
+            kernel = memoryTraceReserve();
+        
+        if(kernel)
         {
-            ir::PTXKernel * kernel = uniqueElementCount();
             prototype.callType = ir::PTXKernel::Prototype::Func;
-            prototype.identifier = UNIQUE_ELEMENT_COUNT;
+            prototype.identifier = functionName;
 
             for(ir::PTXKernel::Prototype::ArgumentVector::const_iterator arg =
                 kernel->arguments.begin(); arg != kernel->arguments.end(); ++arg)
@@ -891,15 +903,529 @@ namespace transforms
         return kernel;
 	
 	}
+	
+	ir::PTXKernel * CToPTXModulePass::uniqueSegmentCount()
+	{
+	    /* counts the segments accessed by each half warp like 
+	        uniqueElementCount. The lowest remaining lane is the leader, every
+	        lane of its half warp accessing the same segment is peeled off,
+	        and the loop ends once no lane remains. The remaining lanes are a
+	        ballot, so all lanes leave the loop together and take part in 
+	        every shfl */
+        ir::PTXKernel::PTXStatementVector statements;
+        ir::PTXStatement stmt = ir::PTXStatement(ir::PTXStatement::Instr);
+
+        ir::PTXOperand::DataType type = (sizeof(size_t) == 8 ? ir::PTXOperand::u64: ir::PTXOperand::u32);
+        ir::PTXOperand::DataType half = ir::PTXOperand::u32;
+
+        ir::PTXStatement segmentAddress = ir::PTXStatement(ir::PTXStatement::Param);
+        segmentAddress.name = "segmentAddress";
+        segmentAddress.type = type;
+
+        ir::PTXStatement segmentCount = ir::PTXStatement(ir::PTXStatement::Param);
+        segmentCount.name = "segmentCount";
+        segmentCount.type = type;
+        
+        //ld.param.u64 %segment, [segmentAddress];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Param;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, "segment");
+        ld.a = ir::PTXOperand(ir::PTXOperand::Address, type, segmentAddress.name);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        //setp.eq.u32 %segmentActive, 0, 0;
+        ir::PTXInstruction active(ir::PTXInstruction::SetP);
+        active.type = half;
+        active.comparisonOperator = ir::PTXInstruction::Eq;
+        active.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, "segmentActive");
+        active.a = ir::PTXOperand(0, half);
+        active.b = ir::PTXOperand(0, half);
+        
+        stmt.instruction = active;
+        statements.push_back(stmt);
+        
+        //vote.ballot.b32 %remaining, %segmentActive;
+        ir::PTXInstruction remaining(ir::PTXInstruction::Vote);
+        remaining.vote = ir::PTXInstruction::Ballot;
+        remaining.type = ir::PTXOperand::b32;
+        remaining.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, "segmentRemaining");
+        remaining.a = active.d;
+        
+        stmt.instruction = remaining;
+        statements.push_back(stmt);
+        
+        //mov.u32 %lane, %laneid;
+        ir::PTXInstruction lane(ir::PTXInstruction::Mov);
+        lane.type = half;
+        lane.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentLane");
+        lane.a = ir::PTXOperand(ir::PTXOperand::laneId);
+        
+        stmt.instruction = lane;
+        statements.push_back(stmt);
+        
+        //shr.u32 %halfWarp, %lane, 4;
+        ir::PTXInstruction halfWarp(ir::PTXInstruction::Shr);
+        halfWarp.type = half;
+        halfWarp.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentHalfWarp");
+        halfWarp.a = lane.d;
+        halfWarp.b = ir::PTXOperand(4, half);
+        
+        stmt.instruction = halfWarp;
+        statements.push_back(stmt);
+        
+        /* shfl moves 32 bits at a time */
+        std::vector<ir::PTXOperand> parts;
+        
+        //cvt.u32.u64 %lo, %segment;
+        ir::PTXInstruction lo(ir::PTXInstruction::Cvt);
+        lo.type = half;
+        lo.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentLo");
+        lo.a = ld.d;
+        
+        stmt.instruction = lo;
+        statements.push_back(stmt);
+        
+        parts.push_back(lo.d);
+        
+        if(type != half)
+        {
+            //shr.u64 %upper, %segment, 32;
+            ir::PTXInstruction shr(ir::PTXInstruction::Shr);
+            shr.type = type;
+            shr.d = ir::PTXOperand(ir::PTXOperand::Register, type, "segmentUpper");
+            shr.a = ld.d;
+            shr.b = ir::PTXOperand(32, half);
+            
+            stmt.instruction = shr;
+            statements.push_back(stmt);
+            
+            //cvt.u32.u64 %hi, %upper;
+            ir::PTXInstruction hi = lo;
+            hi.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentHi");
+            hi.a = shr.d;
+            
+            stmt.instruction = hi;
+            statements.push_back(stmt);
+            
+            parts.push_back(hi.d);
+        }
+        
+        //mov.u64 %count, 0;
+        ir::PTXInstruction count(ir::PTXInstruction::Mov);
+        count.type = type;
+        count.d = ir::PTXOperand(ir::PTXOperand::Register, type, "segmentTotal");
+        count.a = ir::PTXOperand(0, type);
+        
+        stmt.instruction = count;
+        statements.push_back(stmt);
+        
+        ir::PTXStatement peel(ir::PTXStatement::Label);
+        peel.name = PEEL_SEGMENT;
+        statements.push_back(peel);
+        
+        //brev.b32 %reversed, %remaining;
+        ir::PTXInstruction brev(ir::PTXInstruction::Brev);
+        brev.type = ir::PTXOperand::b32;
+        brev.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, "segmentReversed");
+        brev.a = remaining.d;
+        
+        stmt.instruction = brev;
+        statements.push_back(stmt);
+        
+        //clz.b32 %leader, %reversed;
+        ir::PTXInstruction leader(ir::PTXInstruction::Clz);
+        leader.type = ir::PTXOperand::b32;
+        leader.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentLeader");
+        leader.a = brev.d;
+        
+        stmt.instruction = leader;
+        statements.push_back(stmt);
+        
+        //shr.u32 %leaderHalfWarp, %leader, 4;
+        ir::PTXInstruction leaderHalfWarp = halfWarp;
+        leaderHalfWarp.d = ir::PTXOperand(ir::PTXOperand::Register, half, "segmentLeaderHalfWarp");
+        leaderHalfWarp.a = leader.d;
+        
+        stmt.instruction = leaderHalfWarp;
+        statements.push_back(stmt);
+        
+        //setp.eq.u32 %same, %leaderHalfWarp, %halfWarp;
+        ir::PTXInstruction same(ir::PTXInstruction::SetP);
+        same.type = half;
+        same.comparisonOperator = ir::PTXInstruction::Eq;
+        same.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, "segmentSame");
+        same.a = leaderHalfWarp.d;
+        same.b = halfWarp.d;
+        
+        stmt.instruction = same;
+        statements.push_back(stmt);
+        
+        const char *leaderParts[] = { "segmentLeaderLo", "segmentLeaderHi" };
+        
+        for(unsigned int part = 0; part < parts.size(); part++)
+        {
+            //shfl.idx.b32 %leaderPart, %part, %leader, 0x1f;
+            ir::PTXInstruction shfl(ir::PTXInstruction::Shfl);
+            shfl.shuffleMode = ir::PTXInstruction::Idx;
+            shfl.type = ir::PTXOperand::b32;
+            shfl.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, leaderParts[part]);
+            shfl.a = parts[part];
+            shfl.a.type = ir::PTXOperand::b32;
+            shfl.b = leader.d;
+            shfl.b.type = ir::PTXOperand::b32;
+            shfl.c = ir::PTXOperand(0x1f, ir::PTXOperand::b32);
+            
+            stmt.instruction = shfl;
+            statements.push_back(stmt);
+            
+            //setp.eq.and.u32 %same, %leaderPart, %part, %same;
+            ir::PTXInstruction match = same;
+            match.booleanOperator = ir::PTXInstruction::BoolAnd;
+            match.a = shfl.d;
+            match.a.type = half;
+            match.b = parts[part];
+            match.c = same.d;
+            
+            stmt.instruction = match;
+            statements.push_back(stmt);
+        }
+        
+        //vote.ballot.b32 %peeled, %same;
+        ir::PTXInstruction peeled = remaining;
+        peeled.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, "segmentPeeled");
+        peeled.a = same.d;
+        
+        stmt.instruction = peeled;
+        statements.push_back(stmt);
+        
+        //not.b32 %kept, %peeled;
+        ir::PTXInstruction kept(ir::PTXInstruction::Not);
+        kept.type = ir::PTXOperand::b32;
+        kept.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, "segmentKept");
+        kept.a = peeled.d;
+        
+        stmt.instruction = kept;
+        statements.push_back(stmt);
+        
+        //and.b32 %remaining, %remaining, %kept;
+        ir::PTXInstruction left(ir::PTXInstruction::And);
+        left.type = ir::PTXOperand::b32;
+        left.d = remaining.d;
+        left.a = remaining.d;
+        left.b = kept.d;
+        
+        stmt.instruction = left;
+        statements.push_back(stmt);
+        
+        //add.u64 %count, %count, 1;
+        ir::PTXInstruction add(ir::PTXInstruction::Add);
+        add.type = type;
+        add.d = count.d;
+        add.a = count.d;
+        add.b = ir::PTXOperand(1, type);
+        
+        stmt.instruction = add;
+        statements.push_back(stmt);
+        
+        //setp.ne.b32 %more, %remaining, 0;
+        ir::PTXInstruction more(ir::PTXInstruction::SetP);
+        more.type = ir::PTXOperand::b32;
+        more.comparisonOperator = ir::PTXInstruction::Ne;
+        more.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, "segmentMore");
+        more.a = remaining.d;
+        more.b = ir::PTXOperand(0, ir::PTXOperand::b32);
+        
+        stmt.instruction = more;
+        statements.push_back(stmt);
+        
+        //@%more bra.uni $peelSegment;
+        ir::PTXInstruction bra(ir::PTXInstruction::Bra);
+        bra.uni = true;
+        bra.d = ir::PTXOperand(ir::PTXOperand::Label, PEEL_SEGMENT);
+        bra.pg = more.d;
+        bra.pg.condition = ir::PTXOperand::Pred;
+        
+        stmt.instruction = bra;
+        statements.push_back(stmt);
+        
+        //st.param.u64 [segmentCount], %count;
+        ir::PTXInstruction st(ir::PTXInstruction::St);
+        st.type = type;
+        st.addressSpace = ir::PTXInstruction::Param;
+        st.d = ir::PTXOperand(ir::PTXOperand::Address, type, segmentCount.name);
+        st.a = count.d;
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        ir::PTXInstruction ret(ir::PTXInstruction::Ret);
+        ret.uni = true;
+        
+        stmt.instruction = ret;
+        statements.push_back(stmt);
+        
+        ir::PTXKernel *kernel = new ir::PTXKernel(statements.begin(), statements.end(), true);
+
+        kernel->name = UNIQUE_SEGMENT_COUNT;
+
+        kernel->arguments.push_back(ir::Parameter(segmentAddress, true, false));
+        kernel->arguments.push_back(ir::Parameter(segmentCount, true, true));
+
+        return kernel;
+	}
+	
+	ir::PTXKernel * CToPTXModulePass::memoryTraceReserve()
+	{
+	    /* reserves the next record of the trace ring. head only advances
+	        while the ring has room, a full ring counts the record as dropped
+	        and returns a zero slot instead of waiting for the host drain */
+        ir::PTXKernel::PTXStatementVector statements;
+        ir::PTXStatement stmt = ir::PTXStatement(ir::PTXStatement::Instr);
+
+        ir::PTXOperand::DataType type = ir::PTXOperand::u64;
+
+        ir::PTXStatement header = ir::PTXStatement(ir::PTXStatement::Param);
+        header.name = MEMORY_TRACE_HEADER;
+        header.type = type;
+
+        ir::PTXStatement slot = ir::PTXStatement(ir::PTXStatement::Param);
+        slot.name = MEMORY_TRACE_SLOT;
+        slot.type = type;
+
+        ir::PTXStatement sequence = ir::PTXStatement(ir::PTXStatement::Param);
+        sequence.name = MEMORY_TRACE_SEQUENCE;
+        sequence.type = type;
+        
+        //ld.param.u64 %header, [memoryTraceHeader];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Param;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceHeader");
+        ld.a = ir::PTXOperand(ir::PTXOperand::Address, type, header.name);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        //ld.global.u64 %capacity, [%header + capacity];
+        ld.addressSpace = ir::PTXInstruction::Global;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceCapacity");
+        ld.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, "traceHeader");
+        ld.a.offset = offsetof(trace::MemoryTraceBuffer, capacity);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        //ld.global.u64 %records, [%header + records];
+        ld.d.identifier = "traceRecords";
+        ld.a.offset = offsetof(trace::MemoryTraceBuffer, records);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        //ld.global.u64 %tailAddress, [%header + tail];
+        ld.d.identifier = "traceTailAddress";
+        ld.a.offset = offsetof(trace::MemoryTraceBuffer, tail);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        ir::PTXStatement retry(ir::PTXStatement::Label);
+        retry.name = MEMORY_TRACE_RETRY;
+        statements.push_back(retry);
+        
+        //ld.volatile.global.u64 %position, [%header + head];
+        ld.volatility = ir::PTXInstruction::Volatile;
+        ld.d.identifier = "tracePosition";
+        ld.a.offset = offsetof(trace::MemoryTraceBuffer, head);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        ir::PTXOperand position = ld.d;
+        
+        //ld.volatile.global.u64 %tail, [%tailAddress];
+        ld.d.identifier = "traceTail";
+        ld.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, "traceTailAddress");
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        //sub.u64 %used, %position, %tail;
+        ir::PTXInstruction sub(ir::PTXInstruction::Sub);
+        sub.type = type;
+        sub.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceUsed");
+        sub.a = position;
+        sub.b = ld.d;
+        
+        stmt.instruction = sub;
+        statements.push_back(stmt);
+        
+        //setp.ge.u64 %full, %used, %capacity;
+        ir::PTXInstruction setp(ir::PTXInstruction::SetP);
+        setp.type = type;
+        setp.comparisonOperator = ir::PTXInstruction::Ge;
+        setp.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, "traceFull");
+        setp.a = sub.d;
+        setp.b = ir::PTXOperand(ir::PTXOperand::Register, type, "traceCapacity");
+        
+        stmt.instruction = setp;
+        statements.push_back(stmt);
+        
+        ir::PTXOperand capacity = setp.b;
+        
+        //@%full bra $memoryTraceFull;
+        ir::PTXInstruction bra(ir::PTXInstruction::Bra);
+        bra.d = ir::PTXOperand(ir::PTXOperand::Label, MEMORY_TRACE_FULL);
+        bra.pg = setp.d;
+        bra.pg.condition = ir::PTXOperand::Pred;
+        
+        stmt.instruction = bra;
+        statements.push_back(stmt);
+        
+        //add.u64 %sequence, %position, 1;
+        ir::PTXInstruction add(ir::PTXInstruction::Add);
+        add.type = type;
+        add.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceSequence");
+        add.a = position;
+        add.b = ir::PTXOperand(1, type);
+        
+        stmt.instruction = add;
+        statements.push_back(stmt);
+        
+        //atom.global.cas.b64 %observed, [%header + head], %position, %sequence;
+        ir::PTXInstruction atom(ir::PTXInstruction::Atom);
+        atom.type = ir::PTXOperand::b64;
+        atom.addressSpace = ir::PTXInstruction::Global;
+        atom.atomicOperation = ir::PTXInstruction::AtomicCas;
+        atom.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceObserved");
+        atom.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, "traceHeader");
+        atom.a.offset = offsetof(trace::MemoryTraceBuffer, head);
+        atom.b = position;
+        atom.c = add.d;
+        
+        stmt.instruction = atom;
+        statements.push_back(stmt);
+        
+        /* another warp took the position, this only repeats while
+            reservations of other warps succeed */
+        
+        //setp.ne.u64 %raced, %observed, %position;
+        setp.comparisonOperator = ir::PTXInstruction::Ne;
+        setp.d.identifier = "traceRaced";
+        setp.a = atom.d;
+        setp.b = position;
+        
+        stmt.instruction = setp;
+        statements.push_back(stmt);
+        
+        //@%raced bra $memoryTraceRetry;
+        bra.d = ir::PTXOperand(ir::PTXOperand::Label, MEMORY_TRACE_RETRY);
+        bra.pg = setp.d;
+        bra.pg.condition = ir::PTXOperand::Pred;
+        
+        stmt.instruction = bra;
+        statements.push_back(stmt);
+        
+        //rem.u64 %index, %position, %capacity;
+        ir::PTXInstruction rem(ir::PTXInstruction::Rem);
+        rem.type = type;
+        rem.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceIndex");
+        rem.a = position;
+        rem.b = capacity;
+        
+        stmt.instruction = rem;
+        statements.push_back(stmt);
+        
+        //mad.lo.u64 %slot, %index, sizeof(record), %records;
+        ir::PTXInstruction mad(ir::PTXInstruction::Mad);
+        mad.type = type;
+        mad.modifier = ir::PTXInstruction::lo;
+        mad.d = ir::PTXOperand(ir::PTXOperand::Register, type, "traceSlot");
+        mad.a = rem.d;
+        mad.b = ir::PTXOperand(sizeof(trace::MemoryTraceRecord), type);
+        mad.c = ir::PTXOperand(ir::PTXOperand::Register, type, "traceRecords");
+        
+        stmt.instruction = mad;
+        statements.push_back(stmt);
+        
+        //st.param.u64 [memoryTraceSlot], %slot;
+        ir::PTXInstruction st(ir::PTXInstruction::St);
+        st.type = type;
+        st.addressSpace = ir::PTXInstruction::Param;
+        st.d = ir::PTXOperand(ir::PTXOperand::Address, type, slot.name);
+        st.a = mad.d;
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        //st.param.u64 [memoryTraceSequence], %sequence;
+        st.d.identifier = sequence.name;
+        st.a = add.d;
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        ir::PTXInstruction ret(ir::PTXInstruction::Ret);
+        ret.uni = false;
+        
+        stmt.instruction = ret;
+        statements.push_back(stmt);
+        
+        ir::PTXStatement full(ir::PTXStatement::Label);
+        full.name = MEMORY_TRACE_FULL;
+        statements.push_back(full);
+        
+        //atom.global.add.u64 %dropped, [%header + dropped], 1;
+        atom.type = type;
+        atom.atomicOperation = ir::PTXInstruction::AtomicAdd;
+        atom.d.identifier = "traceDropped";
+        atom.a.offset = offsetof(trace::MemoryTraceBuffer, dropped);
+        atom.b = ir::PTXOperand(1, type);
+        atom.c = ir::PTXOperand();
+        
+        stmt.instruction = atom;
+        statements.push_back(stmt);
+        
+        //st.param.u64 [memoryTraceSlot], 0;
+        st.d.identifier = slot.name;
+        st.a = ir::PTXOperand(0, type);
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        //st.param.u64 [memoryTraceSequence], 0;
+        st.d.identifier = sequence.name;
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        stmt.instruction = ret;
+        statements.push_back(stmt);
+        
+        ir::PTXKernel *kernel = new ir::PTXKernel(statements.begin(), statements.end(), true);
+
+        kernel->name = MEMORY_TRACE_RESERVE;
+
+        kernel->arguments.push_back(ir::Parameter(header, true, false));
+        kernel->arguments.push_back(ir::Parameter(slot, true, true));
+        kernel->arguments.push_back(ir::Parameter(sequence, true, true));
+
+        return kernel;
+	}
 
     CToPTXModulePass::CToPTXModulePass(std::string functionName, ir::PTXKernel::PTXStatementVector globals)
-        : ModulePass({}, "CToPTXAModulePass"), functionName(functionName), globals(globals)
+        : ModulePass({}, "CToPTXAModulePass"), functionName(functionName), globals(globals),
+        instrumentationPass("CToPTXInstrumentationPass")
     {
 report("CToPTXModulePass::CToPTXModulePass..");
     }
 
     CToPTXModulePass::CToPTXModulePass(ir::PTXKernel::PTXStatementVector globals)
-        : ModulePass({}, "CToPTXAModulePass"), functionName(""), globals(globals)
+        : ModulePass({}, "CToPTXAModulePass"), functionName(""), globals(globals),
+        instrumentationPass("CToPTXInstrumentationPass")
     {
 
     }
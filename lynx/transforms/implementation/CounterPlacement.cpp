@@ -0,0 +1,304 @@
+/*! \file CounterPlacement.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the CounterPlacement class
+*/
+
+#ifndef COUNTER_PLACEMENT_CPP_INCLUDED
+#define COUNTER_PLACEMENT_CPP_INCLUDED
+
+#include <lynx/transforms/interface/CounterPlacement.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <algorithm>
+#include <cassert>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+	/*! \brief Orders edges by decreasing estimated frequency */
+	class EdgeWeightGreater
+	{
+		public:
+			EdgeWeightGreater(const CounterPlacement::EdgeVector & edges)
+				: edges(edges) {}
+
+			bool operator()(unsigned int left, unsigned int right) const
+			{
+				return edges[left].weight > edges[right].weight;
+			}
+
+		private:
+			const CounterPlacement::EdgeVector & edges;
+	};
+
+	CounterPlacement::Edge::Edge(unsigned int tail, unsigned int head,
+		double weight) : tail(tail), head(head), weight(weight), counter(-1)
+	{
+
+	}
+
+	CounterPlacement::CounterPlacement() : _counters(0), _optimized(false)
+	{
+		/* entry and exit */
+		addVertex(false);
+		addVertex(false);
+	}
+
+	unsigned int CounterPlacement::addVertex(bool instrumentable)
+	{
+		_instrumentable.push_back(instrumentable);
+		_vertexCounters.push_back(-1);
+
+		return _instrumentable.size() - 1;
+	}
+
+	void CounterPlacement::addEdge(unsigned int tail, unsigned int head,
+		double weight)
+	{
+		assert(tail < vertices() && head < vertices());
+		_edges.push_back(Edge(tail, head, weight));
+	}
+
+	unsigned int CounterPlacement::_find(std::vector<unsigned int> & sets,
+		unsigned int vertex) const
+	{
+		while(sets[vertex] != vertex)
+		{
+			sets[vertex] = sets[sets[vertex]];
+			vertex = sets[vertex];
+		}
+
+		return vertex;
+	}
+
+	void CounterPlacement::place()
+	{
+		std::vector<unsigned int> in(vertices(), 0);
+		std::vector<unsigned int> out(vertices(), 0);
+
+		for(EdgeVector::const_iterator edge = _edges.begin();
+			edge != _edges.end(); ++edge)
+		{
+			out[edge->tail]++;
+			in[edge->head]++;
+		}
+
+		std::vector<unsigned int> sets(vertices());
+		for(unsigned int v = 0; v < vertices(); ++v)
+			sets[v] = v;
+
+		std::vector<unsigned int> measurable;
+		_optimized = true;
+
+		/* edges that no block counter can measure must be in the tree */
+		for(unsigned int e = 0; e < _edges.size(); ++e)
+		{
+			Edge & edge = _edges[e];
+			edge.counter = -1;
+
+			if((_instrumentable[edge.tail] && out[edge.tail] == 1) ||
+				(_instrumentable[edge.head] && in[edge.head] == 1))
+			{
+				measurable.push_back(e);
+				continue;
+			}
+
+			unsigned int tail = _find(sets, edge.tail);
+			unsigned int head = _find(sets, edge.head);
+
+			if(tail == head)
+			{
+				_optimized = false;
+				break;
+			}
+
+			sets[tail] = head;
+		}
+
+		std::fill(_vertexCounters.begin(), _vertexCounters.end(), -1);
+		_counters = 0;
+
+		if(!_optimized)
+		{
+			report("Unmeasurable edges form a cycle, counting every block");
+
+			for(unsigned int v = 0; v < vertices(); ++v)
+			{
+				if(_instrumentable[v])
+					_vertexCounters[v] = _counters++;
+			}
+
+			return;
+		}
+
+		/* the heaviest edges go in the tree, the rest are counted */
+		std::stable_sort(measurable.begin(), measurable.end(),
+			EdgeWeightGreater(_edges));
+
+		for(std::vector<unsigned int>::const_iterator e = measurable.begin();
+			e != measurable.end(); ++e)
+		{
+			Edge & edge = _edges[*e];
+
+			unsigned int tail = _find(sets, edge.tail);
+			unsigned int head = _find(sets, edge.head);
+
+			if(tail != head)
+			{
+				sets[tail] = head;
+				continue;
+			}
+
+			unsigned int vertex = (_instrumentable[edge.tail] &&
+				out[edge.tail] == 1) ? edge.tail : edge.head;
+
+			if(_vertexCounters[vertex] == -1)
+				_vertexCounters[vertex] = _counters++;
+
+			edge.counter = _vertexCounters[vertex];
+		}
+
+		report("Placed " << _counters << " counters for " << vertices() - 2
+			<< " blocks and " << _edges.size() << " edges");
+	}
+
+	unsigned int CounterPlacement::counters() const
+	{
+		return _counters;
+	}
+
+	int CounterPlacement::counter(unsigned int vertex) const
+	{
+		return _vertexCounters[vertex];
+	}
+
+	unsigned int CounterPlacement::vertices() const
+	{
+		return _instrumentable.size();
+	}
+
+	bool CounterPlacement::instrumentable(unsigned int vertex) const
+	{
+		return _instrumentable[vertex];
+	}
+
+	bool CounterPlacement::optimized() const
+	{
+		return _optimized;
+	}
+
+	CounterPlacement::CountVector CounterPlacement::reconstruct(
+		const CountVector & counters, Count entries) const
+	{
+		assert(counters.size() >= _counters);
+
+		CountVector counts(vertices(), 0);
+
+		if(!_optimized)
+		{
+			for(unsigned int v = 0; v < vertices(); ++v)
+			{
+				if(_vertexCounters[v] != -1)
+					counts[v] = counters[_vertexCounters[v]];
+			}
+
+			counts[Entry] = counts[Exit] = entries;
+
+			return counts;
+		}
+
+		/* net known flow into each vertex, the virtual exit->entry edge
+			carries one traversal per kernel entry */
+		CountVector balance(vertices(), 0);
+		std::vector<unsigned int> unknown(vertices(), 0);
+		std::vector<std::vector<unsigned int> > incident(vertices());
+
+		balance[Entry] += entries;
+		balance[Exit] -= entries;
+
+		CountVector values(_edges.size(), 0);
+		std::vector<bool> known(_edges.size(), false);
+
+		for(unsigned int e = 0; e < _edges.size(); ++e)
+		{
+			const Edge & edge = _edges[e];
+
+			if(edge.counter != -1)
+			{
+				known[e] = true;
+				values[e] = counters[edge.counter];
+
+				balance[edge.head] += values[e];
+				balance[edge.tail] -= values[e];
+			}
+			else
+			{
+				unknown[edge.tail]++;
+				unknown[edge.head]++;
+
+				incident[edge.tail].push_back(e);
+				incident[edge.head].push_back(e);
+			}
+		}
+
+		/* the unknown edges form a forest, peel it from the leaves */
+		std::vector<unsigned int> leaves;
+		for(unsigned int v = 0; v < vertices(); ++v)
+		{
+			if(unknown[v] == 1)
+				leaves.push_back(v);
+		}
+
+		while(!leaves.empty())
+		{
+			unsigned int v = leaves.back();
+			leaves.pop_back();
+
+			if(unknown[v] != 1)
+				continue;
+
+			std::vector<unsigned int>::const_iterator e = incident[v].begin();
+			while(known[*e])
+				++e;
+
+			const Edge & edge = _edges[*e];
+
+			/* flow in equals flow out at v */
+			Count value = edge.head == v ? -balance[v] : balance[v];
+
+			known[*e] = true;
+			values[*e] = value;
+
+			balance[edge.head] += value;
+			balance[edge.tail] -= value;
+
+			unknown[edge.tail]--;
+			unknown[edge.head]--;
+
+			unsigned int other = edge.head == v ? edge.tail : edge.head;
+			if(unknown[other] == 1)
+				leaves.push_back(other);
+		}
+
+		for(unsigned int e = 0; e < _edges.size(); ++e)
+		{
+			counts[_edges[e].head] += values[e];
+		}
+
+		counts[Entry] = counts[Exit] = entries;
+
+		return counts;
+	}
+
+}
+
+#endif
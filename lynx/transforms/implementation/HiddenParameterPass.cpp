@@ -0,0 +1,235 @@
+/*! \file HiddenParameterPass.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the HiddenParameterPass class
+*/
+
+#ifndef HIDDEN_PARAMETER_PASS_CPP_INCLUDED
+#define HIDDEN_PARAMETER_PASS_CPP_INCLUDED
+
+#include <lynx/transforms/interface/HiddenParameterPass.h>
+#include <lynx/translator/interface/CToPTXTranslator.h>
+
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+#include <ocelot/ir/interface/PTXStatement.h>
+#include <ocelot/ir/interface/Parameter.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <vector>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+    typedef std::set<ir::PTXOperand::RegisterType> RegisterSet;
+
+    static bool referencesBase(const ir::PTXOperand & operand,
+        const RegisterSet & addresses)
+    {
+        if(operand.addressMode == ir::PTXOperand::Address)
+            return operand.identifier == GLOBAL_MEM_BASE_ADDRESS;
+
+        if(!operand.array.empty())
+        {
+            for(ir::PTXOperand::Array::const_iterator
+                element = operand.array.begin();
+                element != operand.array.end(); ++element)
+            {
+                if(referencesBase(*element, addresses))
+                    return true;
+            }
+
+            return false;
+        }
+
+        if(operand.type == ir::PTXOperand::pred &&
+            (operand.condition == ir::PTXOperand::PT ||
+            operand.condition == ir::PTXOperand::nPT))
+            return false;
+
+        return operand.isRegister() && addresses.count(operand.reg) != 0;
+    }
+
+    static bool loadsBase(const ir::PTXInstruction & instruction,
+        const RegisterSet & addresses)
+    {
+        return instruction.opcode == ir::PTXInstruction::Ld &&
+            instruction.addressSpace == ir::PTXInstruction::Global &&
+            instruction.a.addressMode == ir::PTXOperand::Indirect &&
+            instruction.a.offset == 0 &&
+            addresses.count(instruction.a.reg) != 0;
+    }
+
+    static bool movesBase(const ir::PTXInstruction & instruction)
+    {
+        return instruction.opcode == ir::PTXInstruction::Mov &&
+            instruction.a.addressMode == ir::PTXOperand::Address &&
+            instruction.a.identifier == GLOBAL_MEM_BASE_ADDRESS &&
+            instruction.d.addressMode == ir::PTXOperand::Register;
+    }
+
+    void HiddenParameterPass::runOnKernel(ir::IRKernel& k)
+    {
+        if(kernels == 0 || k.function())
+            return;
+
+        for(ir::Kernel::ParameterVector::const_iterator
+            argument = k.arguments.begin(); argument != k.arguments.end();
+            ++argument)
+        {
+            if(argument->name == GLOBAL_MEM_BASE_PARAMETER)
+                return;
+        }
+
+        ir::ControlFlowGraph & cfg = *k.cfg();
+
+        /* registers holding the address of the global, which must not be
+            written by anything else */
+        RegisterSet addresses;
+        RegisterSet others;
+
+        for(ir::ControlFlowGraph::iterator block = cfg.begin();
+            block != cfg.end(); ++block)
+        {
+            for(ir::ControlFlowGraph::InstructionList::const_iterator
+                instruction = block->instructions.begin();
+                instruction != block->instructions.end(); ++instruction)
+            {
+                const ir::PTXInstruction & ptx =
+                    *(const ir::PTXInstruction *)*instruction;
+
+                if(movesBase(ptx))
+                {
+                    addresses.insert(ptx.d.reg);
+                    continue;
+                }
+
+                if(ptx.opcode == ir::PTXInstruction::St)
+                    continue;
+
+                if(ptx.d.isRegister())
+                    others.insert(ptx.d.reg);
+                if(ptx.pq.isRegister())
+                    others.insert(ptx.pq.reg);
+            }
+        }
+
+        if(addresses.empty())
+            return;
+
+        for(RegisterSet::const_iterator r = addresses.begin();
+            r != addresses.end(); ++r)
+        {
+            if(others.count(*r) != 0)
+            {
+                report("Kernel " << k.name << " redefines the base address");
+                return;
+            }
+        }
+
+        /* every use of the address must be a load of the base pointer */
+        std::vector<ir::PTXInstruction *> loads;
+
+        for(ir::ControlFlowGraph::iterator block = cfg.begin();
+            block != cfg.end(); ++block)
+        {
+            for(ir::ControlFlowGraph::InstructionList::const_iterator
+                instruction = block->instructions.begin();
+                instruction != block->instructions.end(); ++instruction)
+            {
+                ir::PTXInstruction & ptx = *(ir::PTXInstruction *)*instruction;
+
+                if(movesBase(ptx))
+                    continue;
+
+                if(loadsBase(ptx, addresses))
+                {
+                    loads.push_back(&ptx);
+                    continue;
+                }
+
+                const ir::PTXOperand * operands[] = {&ptx.pq, &ptx.d, &ptx.a,
+                    &ptx.b, &ptx.c, &ptx.pg};
+
+                for(unsigned int i = 0; i < 6; ++i)
+                {
+                    if(referencesBase(*operands[i], addresses))
+                    {
+                        report("Kernel " << k.name << " uses the base address"
+                            << " in " << ptx.toString());
+                        return;
+                    }
+                }
+            }
+        }
+
+        report("Passing the base address of kernel " << k.name
+            << " as a parameter, " << loads.size() << " loads");
+
+        ir::PTXOperand::DataType type =
+            (sizeof(size_t) == 8 ? ir::PTXOperand::u64 : ir::PTXOperand::u32);
+
+        for(std::vector<ir::PTXInstruction *>::iterator load = loads.begin();
+            load != loads.end(); ++load)
+        {
+            (*load)->addressSpace = ir::PTXInstruction::Param;
+            (*load)->a = ir::PTXOperand(ir::PTXOperand::Address, type,
+                GLOBAL_MEM_BASE_PARAMETER);
+        }
+
+        for(ir::ControlFlowGraph::iterator block = cfg.begin();
+            block != cfg.end(); ++block)
+        {
+            for(ir::ControlFlowGraph::InstructionList::iterator
+                instruction = block->instructions.begin();
+                instruction != block->instructions.end(); )
+            {
+                if(movesBase(*(const ir::PTXInstruction *)*instruction))
+                {
+                    delete *instruction;
+                    instruction = block->instructions.erase(instruction);
+                }
+                else
+                {
+                    ++instruction;
+                }
+            }
+        }
+
+        ir::PTXStatement parameter(ir::PTXStatement::Param);
+        parameter.name = GLOBAL_MEM_BASE_PARAMETER;
+        parameter.type = type;
+
+        k.arguments.push_back(ir::Parameter(parameter, true, false));
+
+        kernels->insert(k.name);
+    }
+
+    void HiddenParameterPass::initialize(const ir::Module&)
+    {
+
+    }
+
+    void HiddenParameterPass::finalize()
+    {
+
+    }
+
+    HiddenParameterPass::HiddenParameterPass()
+        : KernelPass(Analysis::StringVector(), "HiddenParameterPass"),
+        kernels(0)
+    {
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,668 @@
+/*! \file MemoryTracePass.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the MemoryTracePass class
+*/
+
+#ifndef MEMORY_TRACE_PASS_CPP_INCLUDED
+#define MEMORY_TRACE_PASS_CPP_INCLUDED
+
+#include <lynx/transforms/interface/MemoryTracePass.h>
+#include <lynx/transforms/interface/CToPTXModulePass.h>
+#include <lynx/translator/interface/CToPTXTranslator.h>
+#include <lynx/trace/interface/MemoryTrace.h>
+
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/PTXStatement.h>
+#include <ocelot/ir/interface/Module.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <cassert>
+#include <cstddef>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+    analysis::DataflowGraph& MemoryTracePass::dfg()
+	{
+		analysis::Analysis* graph = getAnalysis(
+			"DataflowGraphAnalysis");
+
+		assert(graph != 0);
+
+		return static_cast<analysis::DataflowGraph&>(*graph);
+	}
+
+	ir::PTXOperand MemoryTracePass::newRegister(ir::PTXOperand::DataType type)
+	{
+	    return ir::PTXOperand(ir::PTXOperand::Register, type, dfg().newRegister());
+	}
+
+	bool MemoryTracePass::traced(const ir::PTXInstruction & instruction) const
+	{
+	    switch(instruction.opcode)
+	    {
+	        case ir::PTXInstruction::Ld:
+	        case ir::PTXInstruction::Ldu:
+	        case ir::PTXInstruction::St:
+	        case ir::PTXInstruction::Atom:
+	        case ir::PTXInstruction::Red:
+	            break;
+	        default:
+	            return false;
+	    }
+
+	    if(instruction.addressSpace != ir::PTXInstruction::Global &&
+	        instruction.addressSpace != ir::PTXInstruction::Generic)
+	        return false;
+
+	    /* accesses that are never performed need no record */
+	    if(instruction.pg.condition == ir::PTXOperand::nPT)
+	        return false;
+
+	    switch(address(instruction).addressMode)
+	    {
+	        case ir::PTXOperand::Indirect:
+	        case ir::PTXOperand::Address:
+	        case ir::PTXOperand::Immediate:
+	            return true;
+	        default:
+	            return false;
+	    }
+	}
+
+	const ir::PTXOperand & MemoryTracePass::address(
+	    const ir::PTXInstruction & instruction) const
+	{
+	    if(instruction.opcode == ir::PTXInstruction::St ||
+	        instruction.opcode == ir::PTXInstruction::Red)
+	        return instruction.d;
+
+	    return instruction.a;
+	}
+
+	ir::PTXOperand MemoryTracePass::loadHeader(InstructionVector & code)
+	{
+	    ir::PTXOperand::DataType type = ir::PTXOperand::u64;
+
+        //mov.u64 %address, __lynx_global_mem_base_address__;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = type;
+        mov.d = newRegister(type);
+        mov.a = ir::PTXOperand(ir::PTXOperand::Address, type, GLOBAL_MEM_BASE_ADDRESS);
+        code.push_back(mov);
+
+        //ld.global.u64 %header, [%address];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Global;
+        ld.d = newRegister(type);
+        ld.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, mov.d.reg);
+        code.push_back(ld);
+
+        return ld.d;
+	}
+
+	ir::PTXOperand MemoryTracePass::broadcast(InstructionVector & code,
+	    const ir::PTXOperand & value, const ir::PTXOperand & source)
+	{
+	    ir::PTXOperand::DataType type = ir::PTXOperand::u64;
+	    ir::PTXOperand::DataType half = ir::PTXOperand::u32;
+
+	    //cvt.u32.u64 %lo, %value;
+	    ir::PTXInstruction lo(ir::PTXInstruction::Cvt);
+	    lo.type = half;
+	    lo.d = newRegister(half);
+	    lo.a = value;
+	    code.push_back(lo);
+
+	    //shr.u64 %upper, %value, 32;
+	    ir::PTXInstruction shr(ir::PTXInstruction::Shr);
+	    shr.type = type;
+	    shr.d = newRegister(type);
+	    shr.a = value;
+	    shr.b = ir::PTXOperand(32, ir::PTXOperand::u32);
+	    code.push_back(shr);
+
+	    //cvt.u32.u64 %hi, %upper;
+	    ir::PTXInstruction hi = lo;
+	    hi.d = newRegister(half);
+	    hi.a = shr.d;
+	    code.push_back(hi);
+
+	    ir::PTXOperand parts[2] = { lo.d, hi.d };
+
+	    for(unsigned int part = 0; part < 2; part++)
+	    {
+	        //shfl.idx.b32 %part, %part, %source, 0x1f;
+	        ir::PTXInstruction shfl(ir::PTXInstruction::Shfl);
+	        shfl.shuffleMode = ir::PTXInstruction::Idx;
+	        shfl.type = ir::PTXOperand::b32;
+	        shfl.d = newRegister(ir::PTXOperand::b32);
+	        shfl.a = parts[part];
+	        shfl.a.type = ir::PTXOperand::b32;
+	        shfl.b = source;
+	        shfl.c = ir::PTXOperand(0x1f, ir::PTXOperand::b32);
+	        code.push_back(shfl);
+
+	        //cvt.u64.u32 %wide, %part;
+	        ir::PTXInstruction cvt(ir::PTXInstruction::Cvt);
+	        cvt.type = type;
+	        cvt.d = newRegister(type);
+	        cvt.a = shfl.d;
+	        cvt.a.type = half;
+	        code.push_back(cvt);
+
+	        parts[part] = cvt.d;
+	    }
+
+	    //shl.b64 %upper, %hi, 32;
+	    ir::PTXInstruction shl(ir::PTXInstruction::Shl);
+	    shl.type = ir::PTXOperand::b64;
+	    shl.d = newRegister(type);
+	    shl.a = parts[1];
+	    shl.b = ir::PTXOperand(32, ir::PTXOperand::u32);
+	    code.push_back(shl);
+
+	    //or.b64 %value, %upper, %lo;
+	    ir::PTXInstruction join(ir::PTXInstruction::Or);
+	    join.type = ir::PTXOperand::b64;
+	    join.d = newRegister(type);
+	    join.a = shl.d;
+	    join.b = parts[0];
+	    code.push_back(join);
+
+	    return join.d;
+	}
+
+	void MemoryTracePass::trace(InstructionVector & code,
+	    const ir::PTXInstruction & instruction, const ir::PTXOperand & header,
+	    unsigned int instructionId)
+	{
+	    ir::PTXOperand::DataType type = ir::PTXOperand::u64;
+	    ir::PTXOperand::DataType pred = ir::PTXOperand::pred;
+
+	    /* the lanes that perform the access, everything else is executed by
+	        the whole warp so that the shuffles see every lane */
+	    ir::PTXOperand access;
+
+	    if(instruction.pg.condition == ir::PTXOperand::Pred)
+	    {
+	        access = instruction.pg;
+	    }
+	    else if(instruction.pg.condition == ir::PTXOperand::InvPred)
+	    {
+	        //not.pred %access, %pg;
+	        ir::PTXInstruction invert(ir::PTXInstruction::Not);
+	        invert.type = pred;
+	        invert.d = newRegister(pred);
+	        invert.a = instruction.pg;
+	        invert.a.condition = ir::PTXOperand::Pred;
+	        code.push_back(invert);
+
+	        access = invert.d;
+	    }
+	    else
+	    {
+	        //setp.eq.u32 %access, 0, 0;
+	        ir::PTXInstruction always(ir::PTXInstruction::SetP);
+	        always.type = ir::PTXOperand::u32;
+	        always.comparisonOperator = ir::PTXInstruction::Eq;
+	        always.d = newRegister(pred);
+	        always.a = ir::PTXOperand(0, ir::PTXOperand::u32);
+	        always.b = ir::PTXOperand(0, ir::PTXOperand::u32);
+	        code.push_back(always);
+
+	        access = always.d;
+	    }
+
+	    access.condition = ir::PTXOperand::Pred;
+
+	    /* the address accessed by this lane */
+	    const ir::PTXOperand & operand = address(instruction);
+	    ir::PTXOperand addr = newRegister(type);
+
+	    ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+	    mov.type = type;
+	    mov.d = addr;
+	    mov.a = operand;
+	    mov.a.type = type;
+	    mov.a.offset = 0;
+
+	    if(operand.addressMode == ir::PTXOperand::Indirect)
+	        mov.a.addressMode = ir::PTXOperand::Register;
+
+	    if(operand.addressMode != ir::PTXOperand::Immediate && operand.offset != 0)
+	    {
+	        //add.u64 %addr, %base, offset;
+	        ir::PTXInstruction add(ir::PTXInstruction::Add);
+	        add.type = ir::PTXOperand::s64;
+	        add.d = addr;
+	        add.a = mov.a;
+	        add.b = ir::PTXOperand((long long)operand.offset, ir::PTXOperand::s64);
+
+	        if(add.a.addressMode == ir::PTXOperand::Address)
+	        {
+	            mov.d = newRegister(type);
+	            code.push_back(mov);
+	            add.a = mov.d;
+	        }
+
+	        code.push_back(add);
+	    }
+	    else
+	    {
+	        //mov.u64 %addr, address;
+	        code.push_back(mov);
+	    }
+
+	    //vote.ballot.b32 %mask, %access;
+	    ir::PTXInstruction vote(ir::PTXInstruction::Vote);
+	    vote.vote = ir::PTXInstruction::Ballot;
+	    vote.type = ir::PTXOperand::b32;
+	    vote.d = newRegister(ir::PTXOperand::b32);
+	    vote.a = access;
+	    code.push_back(vote);
+
+	    ir::PTXOperand mask = vote.d;
+
+	    //mov.u32 %lanes, %lanemask_lt;
+	    ir::PTXInstruction lanes(ir::PTXInstruction::Mov);
+	    lanes.type = ir::PTXOperand::u32;
+	    lanes.d = newRegister(ir::PTXOperand::u32);
+	    lanes.a = ir::PTXOperand(ir::PTXOperand::lanemask_lt);
+	    code.push_back(lanes);
+
+	    //and.b32 %lower, %mask, %lanes;
+	    ir::PTXInstruction lower(ir::PTXInstruction::And);
+	    lower.type = ir::PTXOperand::b32;
+	    lower.d = newRegister(ir::PTXOperand::b32);
+	    lower.a = mask;
+	    lower.b = lanes.d;
+	    code.push_back(lower);
+
+	    //setp.eq.and.b32 %leader, %lower, 0, %access;
+	    ir::PTXInstruction leader(ir::PTXInstruction::SetP);
+	    leader.type = ir::PTXOperand::b32;
+	    leader.comparisonOperator = ir::PTXInstruction::Eq;
+	    leader.booleanOperator = ir::PTXInstruction::BoolAnd;
+	    leader.d = newRegister(pred);
+	    leader.a = lower.d;
+	    leader.b = ir::PTXOperand(0, ir::PTXOperand::b32);
+	    leader.c = access;
+	    code.push_back(leader);
+
+	    ir::PTXOperand guard = leader.d;
+	    guard.condition = ir::PTXOperand::Pred;
+
+	    //brev.b32 %reversed, %mask;
+	    ir::PTXInstruction brev(ir::PTXInstruction::Brev);
+	    brev.type = ir::PTXOperand::b32;
+	    brev.d = newRegister(ir::PTXOperand::b32);
+	    brev.a = mask;
+	    code.push_back(brev);
+
+	    //clz.b32 %first, %reversed;
+	    ir::PTXInstruction clz(ir::PTXInstruction::Clz);
+	    clz.type = ir::PTXOperand::b32;
+	    clz.d = newRegister(ir::PTXOperand::u32);
+	    clz.a = brev.d;
+	    code.push_back(clz);
+
+	    ir::PTXOperand first = clz.d;
+
+	    ir::PTXOperand base = broadcast(code, addr, first);
+
+	    //sub.s64 %delta, %addr, %base;
+	    ir::PTXInstruction sub(ir::PTXInstruction::Sub);
+	    sub.type = ir::PTXOperand::s64;
+	    sub.d = newRegister(ir::PTXOperand::s64);
+	    sub.a = addr;
+	    sub.b = base;
+	    code.push_back(sub);
+
+	    //cvt.s32.s64 %delta32, %delta;
+	    ir::PTXInstruction narrow(ir::PTXInstruction::Cvt);
+	    narrow.type = ir::PTXOperand::s32;
+	    narrow.d = newRegister(ir::PTXOperand::s32);
+	    narrow.a = sub.d;
+	    code.push_back(narrow);
+
+	    //cvt.s64.s32 %widened, %delta32;
+	    ir::PTXInstruction widen(ir::PTXInstruction::Cvt);
+	    widen.type = ir::PTXOperand::s64;
+	    widen.d = newRegister(ir::PTXOperand::s64);
+	    widen.a = narrow.d;
+	    code.push_back(widen);
+
+	    //setp.ne.and.s64 %overflow, %widened, %delta, %access;
+	    ir::PTXInstruction overflow(ir::PTXInstruction::SetP);
+	    overflow.type = ir::PTXOperand::s64;
+	    overflow.comparisonOperator = ir::PTXInstruction::Ne;
+	    overflow.booleanOperator = ir::PTXInstruction::BoolAnd;
+	    overflow.d = newRegister(pred);
+	    overflow.a = widen.d;
+	    overflow.b = sub.d;
+	    overflow.c = access;
+	    code.push_back(overflow);
+
+	    //vote.ballot.b32 %overflowMask, %overflow;
+	    ir::PTXInstruction overflows = vote;
+	    overflows.d = newRegister(ir::PTXOperand::b32);
+	    overflows.a = overflow.d;
+	    code.push_back(overflows);
+
+	    //@%leader st.param.u64 [memoryTraceHeader], %header;
+	    ir::PTXInstruction st(ir::PTXInstruction::St);
+	    st.type = type;
+	    st.addressSpace = ir::PTXInstruction::Param;
+	    st.d = ir::PTXOperand(ir::PTXOperand::Address, type, MEMORY_TRACE_HEADER);
+	    st.a = header;
+	    st.pg = guard;
+	    code.push_back(st);
+
+	    //@%leader call (memoryTraceSlot, memoryTraceSequence),
+	    //    memoryTraceReserve, (memoryTraceHeader);
+	    ir::PTXInstruction call(ir::PTXInstruction::Call);
+	    call.tailCall = false;
+	    call.a = ir::PTXOperand(ir::PTXOperand::Label, MEMORY_TRACE_RESERVE);
+	    call.b.addressMode = ir::PTXOperand::ArgumentList;
+	    call.b.array.push_back(ir::PTXOperand(ir::PTXOperand::Register, type,
+	        MEMORY_TRACE_HEADER));
+	    call.d.addressMode = ir::PTXOperand::ArgumentList;
+	    call.d.array.push_back(ir::PTXOperand(ir::PTXOperand::Register, type,
+	        MEMORY_TRACE_SLOT));
+	    call.d.array.push_back(ir::PTXOperand(ir::PTXOperand::Register, type,
+	        MEMORY_TRACE_SEQUENCE));
+	    call.pg = guard;
+	    code.push_back(call);
+
+	    //@%leader ld.param.u64 %reserved, [memoryTraceSlot];
+	    ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+	    ld.type = type;
+	    ld.addressSpace = ir::PTXInstruction::Param;
+	    ld.d = newRegister(type);
+	    ld.a = ir::PTXOperand(ir::PTXOperand::Address, type, MEMORY_TRACE_SLOT);
+	    ld.pg = guard;
+	    code.push_back(ld);
+
+	    ir::PTXOperand reserved = ld.d;
+
+	    //@%leader ld.param.u64 %sequence, [memoryTraceSequence];
+	    ld.d = newRegister(type);
+	    ld.a.identifier = MEMORY_TRACE_SEQUENCE;
+	    code.push_back(ld);
+
+	    ir::PTXOperand sequence = ld.d;
+
+	    ir::PTXOperand slot = broadcast(code, reserved, first);
+
+	    /* a zero slot means the ring was full and the record is dropped */
+
+	    //setp.ne.and.u64 %store, %slot, 0, %access;
+	    ir::PTXInstruction kept(ir::PTXInstruction::SetP);
+	    kept.type = type;
+	    kept.comparisonOperator = ir::PTXInstruction::Ne;
+	    kept.booleanOperator = ir::PTXInstruction::BoolAnd;
+	    kept.d = newRegister(pred);
+	    kept.a = slot;
+	    kept.b = ir::PTXOperand(0, type);
+	    kept.c = access;
+	    code.push_back(kept);
+
+	    ir::PTXOperand store = kept.d;
+	    store.condition = ir::PTXOperand::Pred;
+
+	    //setp.ne.and.u64 %publish, %slot, 0, %leader;
+	    kept.d = newRegister(pred);
+	    kept.c = guard;
+	    code.push_back(kept);
+
+	    guard = kept.d;
+	    guard.condition = ir::PTXOperand::Pred;
+
+	    //mov.u32 %lane, %laneid;
+	    ir::PTXInstruction lane(ir::PTXInstruction::Mov);
+	    lane.type = ir::PTXOperand::u32;
+	    lane.d = newRegister(ir::PTXOperand::u32);
+	    lane.a = ir::PTXOperand(ir::PTXOperand::laneId);
+	    code.push_back(lane);
+
+	    //mul.wide.u32 %offset, %lane, 4;
+	    ir::PTXInstruction offset(ir::PTXInstruction::Mul);
+	    offset.type = ir::PTXOperand::u32;
+	    offset.modifier = ir::PTXInstruction::wide;
+	    offset.d = newRegister(type);
+	    offset.a = lane.d;
+	    offset.b = ir::PTXOperand(sizeof(int), ir::PTXOperand::u32);
+	    code.push_back(offset);
+
+	    //add.u64 %deltaAddress, %offset, %slot;
+	    ir::PTXInstruction deltaAddress(ir::PTXInstruction::Add);
+	    deltaAddress.type = type;
+	    deltaAddress.d = newRegister(type);
+	    deltaAddress.a = offset.d;
+	    deltaAddress.b = slot;
+	    code.push_back(deltaAddress);
+
+	    //@%store st.global.s32 [%delta address + deltas], %delta32;
+	    ir::PTXInstruction delta(ir::PTXInstruction::St);
+	    delta.type = ir::PTXOperand::s32;
+	    delta.addressSpace = ir::PTXInstruction::Global;
+	    delta.d = ir::PTXOperand(ir::PTXOperand::Indirect, type, deltaAddress.d.reg);
+	    delta.d.offset = offsetof(trace::MemoryTraceRecord, deltas);
+	    delta.a = narrow.d;
+	    delta.pg = store;
+	    code.push_back(delta);
+
+	    unsigned int flags = ir::PTXOperand::bytes(instruction.type) *
+	        instruction.vec << trace::MemoryTraceRecord::SizeShift;
+
+	    if(instruction.opcode != ir::PTXInstruction::St)
+	        flags |= trace::MemoryTraceRecord::Load;
+	    if(instruction.opcode == ir::PTXInstruction::St ||
+	        instruction.opcode == ir::PTXInstruction::Atom ||
+	        instruction.opcode == ir::PTXInstruction::Red)
+	        flags |= trace::MemoryTraceRecord::Store;
+	    if(instruction.addressSpace == ir::PTXInstruction::Generic)
+	        flags |= trace::MemoryTraceRecord::Generic;
+
+	    //mov.u32 %id, instructionId;
+	    ir::PTXInstruction id(ir::PTXInstruction::Mov);
+	    id.type = ir::PTXOperand::u32;
+	    id.d = newRegister(ir::PTXOperand::u32);
+	    id.a = ir::PTXOperand(instructionId, ir::PTXOperand::u32);
+	    code.push_back(id);
+
+	    //mov.u32 %flags, flags;
+	    ir::PTXInstruction attributes = id;
+	    attributes.d = newRegister(ir::PTXOperand::u32);
+	    attributes.a = ir::PTXOperand(flags, ir::PTXOperand::u32);
+	    code.push_back(attributes);
+
+	    /* the leader fills in the header of the record */
+	    ir::PTXInstruction field(ir::PTXInstruction::St);
+	    field.type = ir::PTXOperand::u32;
+	    field.addressSpace = ir::PTXInstruction::Global;
+	    field.d = ir::PTXOperand(ir::PTXOperand::Indirect, type, slot.reg);
+	    field.pg = guard;
+
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, instructionId);
+	    field.a = id.d;
+	    code.push_back(field);
+
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, activeMask);
+	    field.a = mask;
+	    code.push_back(field);
+
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, overflowMask);
+	    field.a = overflows.d;
+	    code.push_back(field);
+
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, flags);
+	    field.a = attributes.d;
+	    code.push_back(field);
+
+	    field.type = type;
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, baseAddress);
+	    field.a = base;
+	    code.push_back(field);
+
+	    /* the record must be complete in host memory before it is
+	        published, every lane fences its own delta and the warp meets at
+	        a vote so the leader publishes after the other lanes' fences */
+
+	    //membar.sys;
+	    ir::PTXInstruction membar(ir::PTXInstruction::Membar);
+	    membar.level = ir::PTXInstruction::SystemLevel;
+	    code.push_back(membar);
+
+	    //vote.ballot.b32 %stored, %store;
+	    ir::PTXInstruction rendezvous = vote;
+	    rendezvous.d = newRegister(ir::PTXOperand::b32);
+	    rendezvous.a = store;
+	    code.push_back(rendezvous);
+
+	    //cvt.u32.u64 %sequence32, %sequence;
+	    ir::PTXInstruction cvt(ir::PTXInstruction::Cvt);
+	    cvt.type = ir::PTXOperand::u32;
+	    cvt.d = newRegister(ir::PTXOperand::u32);
+	    cvt.a = sequence;
+	    cvt.pg = guard;
+	    code.push_back(cvt);
+
+	    //@%leader st.volatile.global.u32 [%slot], %sequence32;
+	    field.type = ir::PTXOperand::u32;
+	    field.volatility = ir::PTXInstruction::Volatile;
+	    field.d.offset = offsetof(trace::MemoryTraceRecord, sequence);
+	    field.a = cvt.d;
+	    code.push_back(field);
+	}
+
+    void MemoryTracePass::runOnKernel(ir::IRKernel & k)
+	{
+	    report("MemoryTracePass::runOnKernel " << k.name);
+
+	    if(dfg().size() <= 2)
+	        return;
+
+	    std::vector<unsigned int> positions;
+	    unsigned int instructionId = 0;
+
+	    /* collect the accesses before anything is inserted, instructionId is
+	        the position of the access among the instructions of the kernel */
+	    for(analysis::DataflowGraph::iterator block = ++dfg().begin();
+	        block != --dfg().end(); ++block)
+	    {
+	        for(analysis::DataflowGraph::InstructionVector::const_iterator
+	            instruction = block->instructions().begin();
+	            instruction != block->instructions().end();
+	            ++instruction, ++instructionId)
+	        {
+	            ir::PTXInstruction *ptx = (ir::PTXInstruction *)instruction->i;
+
+	            if(!traced(*ptx))
+	                continue;
+
+	            positions.push_back(instructionId);
+
+	            if(instructions)
+	                (*instructions)[k.name][instructionId] = ptx->toString();
+	        }
+	    }
+
+	    if(positions.empty())
+	        return;
+
+	    const char *arguments[] = { MEMORY_TRACE_HEADER, MEMORY_TRACE_SLOT,
+	        MEMORY_TRACE_SEQUENCE };
+
+	    for(unsigned int argument = 0; argument < 3; argument++)
+	    {
+	        ir::PTXStatement parameter(ir::PTXStatement::Param);
+	        parameter.name = arguments[argument];
+	        parameter.type = ir::PTXOperand::u64;
+
+	        k.insertParameter(ir::Parameter(parameter, false, false), true);
+	    }
+
+	    analysis::DataflowGraph::iterator entry = ++dfg().begin();
+
+	    /* the header is loaded once, the entry block dominates every access */
+	    InstructionVector prologue;
+	    ir::PTXOperand header = loadHeader(prologue);
+
+	    std::vector<unsigned int>::const_iterator position = positions.begin();
+	    instructionId = 0;
+
+	    for(analysis::DataflowGraph::iterator block = entry;
+	        block != --dfg().end(); ++block)
+	    {
+	        unsigned int loc = 0;
+
+	        if(block == entry)
+	        {
+	            for(InstructionVector::const_iterator instruction = prologue.begin();
+	                instruction != prologue.end(); ++instruction)
+	            {
+	                dfg().insert(block, *instruction, loc++);
+	            }
+	        }
+
+	        unsigned int original = block->instructions().size() - loc;
+
+	        for(unsigned int i = 0; i < original; ++i, ++instructionId, ++loc)
+	        {
+	            if(position == positions.end() || *position != instructionId)
+	                continue;
+
+	            analysis::DataflowGraph::InstructionVector::const_iterator
+	                instruction = block->instructions().begin();
+	            std::advance(instruction, loc);
+
+	            InstructionVector code;
+	            trace(code, *(ir::PTXInstruction *)instruction->i, header,
+	                instructionId);
+
+	            for(InstructionVector::const_iterator inserted = code.begin();
+	                inserted != code.end(); ++inserted)
+	            {
+	                dfg().insert(block, *inserted, loc++);
+	            }
+
+	            ++position;
+	            ++accesses;
+	        }
+	    }
+
+	    report(" traced " << positions.size() << " memory instructions");
+	}
+
+    void MemoryTracePass::initialize(const ir::Module& m)
+	{
+
+	}
+
+    void MemoryTracePass::finalize()
+	{
+
+	}
+
+    MemoryTracePass::MemoryTracePass()
+		: KernelPass(Analysis::StringVector({"DataflowGraphAnalysis"}), "MemoryTracePass"),
+		instructions(0), accesses(0)
+	{
+
+	}
+
+}
+
+#endif
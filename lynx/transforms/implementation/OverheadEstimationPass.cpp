@@ -0,0 +1,399 @@
+/*! \file OverheadEstimationPass.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the OverheadEstimationPass class
+*/
+
+#ifndef OVERHEAD_ESTIMATION_PASS_CPP_INCLUDED
+#define OVERHEAD_ESTIMATION_PASS_CPP_INCLUDED
+
+#include <lynx/transforms/interface/OverheadEstimationPass.h>
+
+#include <ocelot/analysis/interface/DominatorTree.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+#include <ocelot/ir/interface/Module.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <set>
+#include <sstream>
+#include <vector>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+/* issue slots of an atomic compared to an arithmetic instruction */
+#define GLOBAL_ATOMIC_COST 16.0
+#define SHARED_ATOMIC_COST 4.0
+
+/* registers and resident warps of a multiprocessor */
+#define REGISTERS_PER_MULTIPROCESSOR 65536
+#define WARPS_PER_MULTIPROCESSOR 64
+#define REGISTER_ALLOCATION_UNIT 8
+
+namespace transforms
+{
+
+    KernelCost::BlockCost::BlockCost() : instructions(0), globalAtomics(0),
+        sharedAtomics(0), depth(0)
+    {
+
+    }
+
+    KernelCost::KernelCost() : registers(0), virtualRegisters(0),
+        maxRegister(0), sharedBytes(0)
+    {
+
+    }
+
+    static double weight(const std::string & label,
+        const KernelCost::BlockCost & block, const BlockWeightMap * weights)
+    {
+        if(weights)
+        {
+            BlockWeightMap::const_iterator measured = weights->find(label);
+            if(measured != weights->end())
+                return measured->second;
+        }
+
+        return std::pow(10.0, (double)block.depth);
+    }
+
+    static double cycles(const KernelCost::BlockCost & block)
+    {
+        return block.instructions + GLOBAL_ATOMIC_COST * block.globalAtomics
+            + SHARED_ATOMIC_COST * block.sharedAtomics;
+    }
+
+    static double residentWarps(unsigned int registers)
+    {
+        unsigned int allocated = std::max(registers, 1u);
+
+        allocated = (allocated + REGISTER_ALLOCATION_UNIT - 1) /
+            REGISTER_ALLOCATION_UNIT * REGISTER_ALLOCATION_UNIT;
+
+        return std::min(WARPS_PER_MULTIPROCESSOR,
+            REGISTERS_PER_MULTIPROCESSOR / (32 * (int)allocated));
+    }
+
+    OverheadEstimate::OverheadEstimate() : instructions(0), globalAtomics(0),
+        sharedAtomics(0), registers(0), sharedBytes(0), originalCycles(0),
+        instrumentedCycles(0), occupancy(1.0), slowdown(1.0)
+    {
+
+    }
+
+    OverheadEstimate::OverheadEstimate(const KernelCost & original,
+        const KernelCost & instrumented, const BlockWeightMap * weights) :
+        instructions(0), globalAtomics(0), sharedAtomics(0),
+        registers((int)instrumented.registers - (int)original.registers),
+        sharedBytes((int)instrumented.sharedBytes -
+            (int)original.sharedBytes),
+        originalCycles(0), instrumentedCycles(0), occupancy(1.0),
+        slowdown(1.0)
+    {
+        for(KernelCost::BlockCostMap::const_iterator
+            block = original.blocks.begin();
+            block != original.blocks.end(); ++block)
+        {
+            originalCycles += weight(block->first, block->second, weights) *
+                cycles(block->second);
+        }
+
+        /* blocks added by the instrumentation are weighted by their own
+            loop depth */
+        for(KernelCost::BlockCostMap::const_iterator
+            block = instrumented.blocks.begin();
+            block != instrumented.blocks.end(); ++block)
+        {
+            KernelCost::BlockCost before;
+
+            KernelCost::BlockCostMap::const_iterator match =
+                original.blocks.find(block->first);
+
+            if(match != original.blocks.end())
+                before = match->second;
+
+            const KernelCost::BlockCost & weighted =
+                match != original.blocks.end() ? before : block->second;
+
+            instrumentedCycles += weight(block->first, weighted, weights) *
+                cycles(block->second);
+
+            int inserted = (int)block->second.instructions -
+                (int)before.instructions;
+
+            if(inserted != 0)
+                blocks[block->first] = inserted;
+
+            instructions += inserted;
+            globalAtomics += (int)block->second.globalAtomics -
+                (int)before.globalAtomics;
+            sharedAtomics += (int)block->second.sharedAtomics -
+                (int)before.sharedAtomics;
+        }
+
+        occupancy = residentWarps(original.registers) /
+            residentWarps(instrumented.registers);
+
+        if(originalCycles > 0)
+            slowdown = instrumentedCycles / originalCycles * occupancy;
+    }
+
+    std::string OverheadEstimate::toString() const
+    {
+        std::stringstream stream;
+
+        stream << slowdown << "x estimated slowdown, " << instructions
+            << " instructions in " << blocks.size() << " blocks, "
+            << globalAtomics << " global and " << sharedAtomics
+            << " shared atomics, " << registers << " registers, "
+            << sharedBytes << " bytes of shared memory added";
+
+        return stream.str();
+    }
+
+    analysis::DataflowGraph& OverheadEstimationPass::dfg()
+    {
+        analysis::Analysis* graph = getAnalysis("DataflowGraphAnalysis");
+        assert(graph != 0);
+
+        return static_cast<analysis::DataflowGraph&>(*graph);
+    }
+
+    void OverheadEstimationPass::loopDepths(KernelCost & cost)
+    {
+        analysis::DominatorTree & dominatorTree =
+            static_cast<analysis::DominatorTree&>(
+            *getAnalysis("DominatorTreeAnalysis"));
+
+        /* natural loops of the back edges, loops sharing a header are
+            merged */
+        std::map<std::string, std::set<std::string> > loops;
+
+        for(analysis::DataflowGraph::iterator block = dfg().begin();
+            block != dfg().end(); ++block)
+        {
+            for(analysis::DataflowGraph::BlockPointerSet::const_iterator
+                successor = block->successors().begin();
+                successor != block->successors().end(); ++successor)
+            {
+                if(!dominatorTree.dominates((*successor)->block(),
+                    block->block()))
+                    continue;
+
+                std::set<std::string> & body = loops[(*successor)->label()];
+                std::vector<analysis::DataflowGraph::iterator> stack;
+
+                body.insert((*successor)->label());
+                if(body.insert(block->label()).second)
+                    stack.push_back(block);
+
+                while(!stack.empty())
+                {
+                    analysis::DataflowGraph::iterator member = stack.back();
+                    stack.pop_back();
+
+                    for(analysis::DataflowGraph::BlockPointerSet::const_iterator
+                        predecessor = member->predecessors().begin();
+                        predecessor != member->predecessors().end();
+                        ++predecessor)
+                    {
+                        if(body.insert((*predecessor)->label()).second)
+                            stack.push_back(*predecessor);
+                    }
+                }
+            }
+        }
+
+        for(std::map<std::string, std::set<std::string> >::const_iterator
+            loop = loops.begin(); loop != loops.end(); ++loop)
+        {
+            for(std::set<std::string>::const_iterator
+                member = loop->second.begin(); member != loop->second.end();
+                ++member)
+            {
+                KernelCost::BlockCostMap::iterator block =
+                    cost.blocks.find(*member);
+
+                if(block != cost.blocks.end())
+                    block->second.depth++;
+            }
+        }
+    }
+
+    static unsigned int registerWidth(const analysis::DataflowGraph::Register
+        & r)
+    {
+        if(r.type == ir::PTXOperand::pred)
+            return 0;
+
+        return ir::PTXOperand::bytes(r.type) > 4 ? 2 : 1;
+    }
+
+    unsigned int peakLiveRegisters(analysis::DataflowGraph & dfg)
+    {
+        unsigned int peak = 0;
+
+        for(analysis::DataflowGraph::iterator block = dfg.begin();
+            block != dfg.end(); ++block)
+        {
+            analysis::DataflowGraph::RegisterSet alive(block->aliveOut());
+            unsigned int live = 0;
+
+            for(analysis::DataflowGraph::RegisterSet::const_iterator
+                r = alive.begin(); r != alive.end(); ++r)
+            {
+                live += registerWidth(*r);
+            }
+
+            peak = std::max(peak, live);
+
+            for(analysis::DataflowGraph::InstructionVector::const_reverse_iterator
+                instruction = block->instructions().rbegin();
+                instruction != block->instructions().rend(); ++instruction)
+            {
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    analysis::DataflowGraph::Register r(*d);
+
+                    if(alive.erase(r))
+                        live -= registerWidth(r);
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    s = instruction->s.begin(); s != instruction->s.end(); ++s)
+                {
+                    analysis::DataflowGraph::Register r(*s);
+
+                    if(alive.insert(r).second)
+                        live += registerWidth(r);
+                }
+
+                peak = std::max(peak, live);
+            }
+        }
+
+        return peak;
+    }
+
+    unsigned int virtualRegisters(analysis::DataflowGraph & dfg)
+    {
+        std::set<analysis::DataflowGraph::RegisterId> registers;
+
+        for(analysis::DataflowGraph::iterator block = dfg.begin();
+            block != dfg.end(); ++block)
+        {
+            for(analysis::DataflowGraph::InstructionVector::const_iterator
+                instruction = block->instructions().begin();
+                instruction != block->instructions().end(); ++instruction)
+            {
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    registers.insert(*d->pointer);
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    s = instruction->s.begin(); s != instruction->s.end(); ++s)
+                {
+                    registers.insert(*s->pointer);
+                }
+            }
+        }
+
+        return registers.size();
+    }
+
+    void OverheadEstimationPass::runOnKernel(ir::IRKernel& k)
+    {
+        if(costs == 0 || k.function())
+            return;
+
+        report("Estimating the cost of kernel " << k.name);
+
+        KernelCost cost;
+
+        for(analysis::DataflowGraph::iterator block = ++dfg().begin();
+            block != --dfg().end(); ++block)
+        {
+            KernelCost::BlockCost & blockCost = cost.blocks[block->label()];
+
+            for(analysis::DataflowGraph::InstructionVector::const_iterator
+                instruction = block->instructions().begin();
+                instruction != block->instructions().end(); ++instruction)
+            {
+                const ir::PTXInstruction & ptx =
+                    *(const ir::PTXInstruction *)instruction->i;
+
+                blockCost.instructions++;
+
+                if(ptx.opcode != ir::PTXInstruction::Atom &&
+                    ptx.opcode != ir::PTXInstruction::Red)
+                    continue;
+
+                if(ptx.addressSpace == ir::PTXInstruction::Shared)
+                    blockCost.sharedAtomics++;
+                else
+                    blockCost.globalAtomics++;
+            }
+        }
+
+        loopDepths(cost);
+
+        cost.registers = peakLiveRegisters(dfg());
+        cost.virtualRegisters = virtualRegisters(dfg());
+        cost.maxRegister = dfg().maxRegister();
+        cost.sharedBytes = _moduleSharedBytes;
+
+        for(ir::Kernel::LocalMap::const_iterator local = k.locals.begin();
+            local != k.locals.end(); ++local)
+        {
+            if(local->second.space == ir::PTXInstruction::Shared)
+                cost.sharedBytes += local->second.getSize();
+        }
+
+        report(" " << cost.blocks.size() << " blocks, " << cost.registers
+            << " registers, " << cost.sharedBytes << " bytes shared");
+
+        (*costs)[k.name] = cost;
+    }
+
+    void OverheadEstimationPass::initialize(const ir::Module& m)
+    {
+        /* shared variables at module scope may be used by any kernel */
+        _moduleSharedBytes = 0;
+
+        for(ir::Module::GlobalMap::const_iterator global = m.globals().begin();
+            global != m.globals().end(); ++global)
+        {
+            if(global->second.space() == ir::PTXInstruction::Shared)
+                _moduleSharedBytes += global->second.statement.bytes();
+        }
+    }
+
+    void OverheadEstimationPass::finalize()
+    {
+
+    }
+
+    OverheadEstimationPass::OverheadEstimationPass()
+        : KernelPass(Analysis::StringVector({"DataflowGraphAnalysis",
+            "DominatorTreeAnalysis"}), "OverheadEstimationPass"),
+        costs(0), _moduleSharedBytes(0)
+    {
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,383 @@
+/*! \file RegisterReusePass.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the RegisterReusePass class
+*/
+
+#ifndef REGISTER_REUSE_PASS_CPP_INCLUDED
+#define REGISTER_REUSE_PASS_CPP_INCLUDED
+
+#include <lynx/transforms/interface/RegisterReusePass.h>
+
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <cassert>
+#include <sstream>
+#include <vector>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+    RegisterUsage::RegisterUsage() : originalRegisters(0), originalPeak(0),
+        instrumentedRegisters(0), reusedRegisters(0), registers(0), peak(0)
+    {
+
+    }
+
+    int RegisterUsage::extraRegisters() const
+    {
+        return (int)peak - (int)originalPeak;
+    }
+
+    std::string RegisterUsage::toString() const
+    {
+        std::stringstream stream;
+
+        stream << "peak live registers " << originalPeak << " -> " << peak
+            << ", virtual registers " << originalRegisters << " -> "
+            << instrumentedRegisters << " (" << registers << " after reusing "
+            << reusedRegisters << ")";
+
+        return stream.str();
+    }
+
+    analysis::DataflowGraph& RegisterReusePass::dfg()
+    {
+        analysis::Analysis* graph = getAnalysis("DataflowGraphAnalysis");
+        assert(graph != 0);
+
+        return static_cast<analysis::DataflowGraph&>(*graph);
+    }
+
+    /* registers the dataflow graph can not rename safely */
+    static void excludeOperand(const ir::PTXOperand & operand,
+        std::set<analysis::DataflowGraph::RegisterId> & excluded)
+    {
+        if(!operand.isRegister())
+            return;
+
+        if(operand.type == ir::PTXOperand::pred &&
+            (operand.condition == ir::PTXOperand::PT ||
+            operand.condition == ir::PTXOperand::nPT))
+            return;
+
+        if(operand.addressMode == ir::PTXOperand::BitBucket ||
+            !operand.identifier.empty() || operand.vec != ir::PTXOperand::v1)
+        {
+            excluded.insert(operand.reg);
+        }
+    }
+
+    void RegisterReusePass::registerTypes(RegisterTypeMap & types)
+    {
+        RegisterIdSet excluded;
+
+        for(analysis::DataflowGraph::iterator block = dfg().begin();
+            block != dfg().end(); ++block)
+        {
+            for(analysis::DataflowGraph::InstructionVector::const_iterator
+                instruction = block->instructions().begin();
+                instruction != block->instructions().end(); ++instruction)
+            {
+                const ir::PTXInstruction & ptx =
+                    *(const ir::PTXInstruction *)instruction->i;
+
+                /* the dataflow graph treats a predicated definition as a
+                    kill although the old value survives in other threads */
+                bool predicated = ptx.pg.condition != ir::PTXOperand::PT;
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    std::pair<RegisterTypeMap::iterator, bool> type =
+                        types.insert(std::make_pair(*d->pointer, d->type));
+
+                    if(predicated || type.first->second != d->type)
+                        excluded.insert(*d->pointer);
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    s = instruction->s.begin(); s != instruction->s.end(); ++s)
+                {
+                    std::pair<RegisterTypeMap::iterator, bool> type =
+                        types.insert(std::make_pair(*s->pointer, s->type));
+
+                    if(type.first->second != s->type)
+                        excluded.insert(*s->pointer);
+                }
+
+                const ir::PTXOperand * operands[] = {&ptx.pq, &ptx.d, &ptx.a,
+                    &ptx.b, &ptx.c, &ptx.pg};
+
+                for(unsigned int i = 0; i < 6; ++i)
+                {
+                    if(operands[i]->array.empty())
+                    {
+                        excludeOperand(*operands[i], excluded);
+                        continue;
+                    }
+
+                    for(ir::PTXOperand::Array::const_iterator
+                        element = operands[i]->array.begin();
+                        element != operands[i]->array.end(); ++element)
+                    {
+                        excludeOperand(*element, excluded);
+                    }
+                }
+            }
+        }
+
+        for(RegisterIdSet::const_iterator r = excluded.begin();
+            r != excluded.end(); ++r)
+        {
+            types.erase(*r);
+        }
+    }
+
+    static void interfere(std::map<analysis::DataflowGraph::RegisterId,
+        std::set<analysis::DataflowGraph::RegisterId> > & interferences,
+        analysis::DataflowGraph::RegisterId a,
+        analysis::DataflowGraph::RegisterId b,
+        const std::set<analysis::DataflowGraph::RegisterId> & added)
+    {
+        if(a == b)
+            return;
+
+        /* only the interferences of added registers are ever queried */
+        if(added.count(a))
+            interferences[a].insert(b);
+        if(added.count(b))
+            interferences[b].insert(a);
+    }
+
+    void RegisterReusePass::interference(InterferenceMap & interferences,
+        const RegisterTypeMap & types, RegisterId maxRegister)
+    {
+        RegisterIdSet added;
+
+        for(RegisterTypeMap::const_iterator type =
+            types.upper_bound(maxRegister); type != types.end(); ++type)
+        {
+            added.insert(type->first);
+        }
+
+        for(analysis::DataflowGraph::iterator block = dfg().begin();
+            block != dfg().end(); ++block)
+        {
+            /* registers alive at the start of a block, there may be no
+                definition that sees the others alive */
+            for(analysis::DataflowGraph::RegisterSet::const_iterator
+                a = block->aliveIn().begin(); a != block->aliveIn().end(); ++a)
+            {
+                if(!added.count(a->id))
+                    continue;
+
+                for(analysis::DataflowGraph::RegisterSet::const_iterator
+                    b = block->aliveIn().begin(); b != block->aliveIn().end();
+                    ++b)
+                {
+                    interfere(interferences, a->id, b->id, added);
+                }
+            }
+
+            RegisterIdSet alive;
+
+            for(analysis::DataflowGraph::RegisterSet::const_iterator
+                r = block->aliveOut().begin(); r != block->aliveOut().end();
+                ++r)
+            {
+                alive.insert(r->id);
+            }
+
+            for(analysis::DataflowGraph::InstructionVector::const_reverse_iterator
+                instruction = block->instructions().rbegin();
+                instruction != block->instructions().rend(); ++instruction)
+            {
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    for(RegisterIdSet::const_iterator r = alive.begin();
+                        r != alive.end(); ++r)
+                    {
+                        interfere(interferences, *d->pointer, *r, added);
+                    }
+
+                    for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                        other = instruction->d.begin();
+                        other != instruction->d.end(); ++other)
+                    {
+                        interfere(interferences, *d->pointer, *other->pointer,
+                            added);
+                    }
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    alive.erase(*d->pointer);
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::const_iterator
+                    s = instruction->s.begin(); s != instruction->s.end(); ++s)
+                {
+                    alive.insert(*s->pointer);
+                }
+            }
+        }
+    }
+
+    unsigned int RegisterReusePass::reuseRegisters(RegisterId maxRegister)
+    {
+        typedef std::vector<RegisterId> RegisterIdVector;
+        typedef std::map<analysis::DataflowGraph::Type, RegisterIdVector>
+            CandidateMap;
+        typedef std::map<RegisterId, RegisterIdVector> MemberMap;
+
+        RegisterTypeMap types;
+        registerTypes(types);
+
+        InterferenceMap interferences;
+        interference(interferences, types, maxRegister);
+
+        /* the registers an added register may take, original registers
+            come first so that added ones are folded into them */
+        CandidateMap candidates;
+        MemberMap members;
+        RegisterRenameMap renames;
+
+        for(RegisterTypeMap::const_iterator type = types.begin();
+            type != types.end(); ++type)
+        {
+            RegisterIdVector & available = candidates[type->second];
+
+            if(type->first <= maxRegister)
+            {
+                available.push_back(type->first);
+                members[type->first].push_back(type->first);
+                continue;
+            }
+
+            const RegisterIdSet & interfering = interferences[type->first];
+            bool renamed = false;
+
+            for(RegisterIdVector::const_iterator
+                candidate = available.begin();
+                candidate != available.end() && !renamed; ++candidate)
+            {
+                const RegisterIdVector & taken = members[*candidate];
+                bool free = true;
+
+                for(RegisterIdVector::const_iterator member = taken.begin();
+                    member != taken.end() && free; ++member)
+                {
+                    free = interfering.count(*member) == 0;
+                }
+
+                if(!free)
+                    continue;
+
+                report("  reusing %r" << *candidate << " for %r"
+                    << type->first);
+
+                renames[type->first] = *candidate;
+                members[*candidate].push_back(type->first);
+                renamed = true;
+            }
+
+            if(!renamed)
+            {
+                available.push_back(type->first);
+                members[type->first].push_back(type->first);
+            }
+        }
+
+        for(analysis::DataflowGraph::iterator block = dfg().begin();
+            block != dfg().end(); ++block)
+        {
+            for(analysis::DataflowGraph::InstructionVector::iterator
+                instruction = block->instructions().begin();
+                instruction != block->instructions().end(); ++instruction)
+            {
+                for(analysis::DataflowGraph::RegisterPointerVector::iterator
+                    d = instruction->d.begin(); d != instruction->d.end(); ++d)
+                {
+                    RegisterRenameMap::const_iterator rename =
+                        renames.find(*d->pointer);
+                    if(rename != renames.end())
+                        *d->pointer = rename->second;
+                }
+
+                for(analysis::DataflowGraph::RegisterPointerVector::iterator
+                    s = instruction->s.begin(); s != instruction->s.end(); ++s)
+                {
+                    RegisterRenameMap::const_iterator rename =
+                        renames.find(*s->pointer);
+                    if(rename != renames.end())
+                        *s->pointer = rename->second;
+                }
+            }
+        }
+
+        return renames.size();
+    }
+
+    void RegisterReusePass::runOnKernel(ir::IRKernel& k)
+    {
+        if(original == 0 || usage == 0 || k.function())
+            return;
+
+        KernelCostMap::const_iterator cost = original->find(k.name);
+        if(cost == original->end())
+            return;
+
+        report("Reusing registers of kernel " << k.name);
+
+        RegisterUsage registers;
+        registers.originalRegisters = cost->second.virtualRegisters;
+        registers.originalPeak = cost->second.registers;
+
+        /* renaming to a register that is dead does not change liveness */
+        registers.peak = peakLiveRegisters(dfg());
+        registers.instrumentedRegisters = virtualRegisters(dfg());
+
+        if(reuse)
+            registers.reusedRegisters = reuseRegisters(cost->second.maxRegister);
+
+        registers.registers = registers.instrumentedRegisters -
+            registers.reusedRegisters;
+
+        report(" " << registers.toString());
+
+        (*usage)[k.name] = registers;
+    }
+
+    void RegisterReusePass::initialize(const ir::Module&)
+    {
+
+    }
+
+    void RegisterReusePass::finalize()
+    {
+
+    }
+
+    RegisterReusePass::RegisterReusePass()
+        : KernelPass(Analysis::StringVector({"DataflowGraphAnalysis"}),
+            "RegisterReusePass"), original(0), reuse(true), usage(0)
+    {
+
+    }
+
+}
+
+#endif
@@ -0,0 +1,103 @@
+/*! \file UniformBranchPass.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the UniformBranchPass class
+*/
+
+#ifndef UNIFORM_BRANCH_PASS_CPP_INCLUDED
+#define UNIFORM_BRANCH_PASS_CPP_INCLUDED
+
+#include <lynx/transforms/interface/UniformBranchPass.h>
+
+#include <ocelot/analysis/interface/DivergenceAnalysis.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+
+#include <hydrazine/interface/debug.h>
+
+#include <cassert>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+// whether debugging messages are printed
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+    UniformBranches::UniformBranches() : branches(0)
+    {
+
+    }
+
+    bool UniformBranches::uniform(const std::string & label) const
+    {
+        return labels.count(label) != 0;
+    }
+
+    void UniformBranchPass::runOnKernel(ir::IRKernel& k)
+    {
+        if(branches == 0 || k.function())
+            return;
+
+        analysis::Analysis* analysis = getAnalysis("DivergenceAnalysis");
+        assert(analysis != 0);
+
+        analysis::DivergenceAnalysis & divergence =
+            static_cast<analysis::DivergenceAnalysis&>(*analysis);
+        const analysis::DataflowGraph & dfg = *divergence.getDFG();
+
+        UniformBranches & kernel = (*branches)[k.name];
+        kernel = UniformBranches();
+
+        for(analysis::DataflowGraph::const_iterator block = dfg.begin();
+            block != dfg.end(); ++block)
+        {
+            if(block->instructions().empty())
+                continue;
+
+            const analysis::DataflowGraph::Instruction & last =
+                block->instructions().back();
+            const ir::PTXInstruction & ptx =
+                *(const ir::PTXInstruction *)last.i;
+
+            if(ptx.opcode != ir::PTXInstruction::Bra ||
+                ptx.pg.condition == ir::PTXOperand::PT ||
+                ptx.pg.condition == ir::PTXOperand::nPT)
+                continue;
+
+            ++kernel.branches;
+
+            if(ptx.uni || !divergence.isDivInstruction(last))
+            {
+                report("  branch ending " << block->label() << " is uniform");
+                kernel.labels.insert(block->label());
+            }
+        }
+
+        report("Kernel " << k.name << ": " << kernel.labels.size() << " of "
+            << kernel.branches << " branches are uniform");
+    }
+
+    void UniformBranchPass::initialize(const ir::Module&)
+    {
+
+    }
+
+    void UniformBranchPass::finalize()
+    {
+
+    }
+
+    UniformBranchPass::UniformBranchPass()
+        : KernelPass(Analysis::StringVector({"DivergenceAnalysis"}),
+            "UniformBranchPass"), branches(0)
+    {
+
+    }
+
+}
+
+#endif
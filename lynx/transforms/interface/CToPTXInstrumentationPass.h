@@ -8,6 +8,8 @@
 #define C_TO_PTX_INSTRUMENTATION_PASS_H_INCLUDED
 
 #include <lynx/translator/interface/CToPTXTranslator.h>
+#include <lynx/transforms/interface/CounterPlacement.h>
+#include <lynx/transforms/interface/UniformBranchPass.h>
 
 #include <ocelot/transforms/interface/Pass.h>
 #include <ocelot/analysis/interface/DataflowGraph.h>
@@ -16,9 +18,16 @@
 #include <ocelot/ir/interface/PTXOperand.h>
 
 #include <map>
+#include <set>
 #include <algorithm>
 #include <vector>
 
+/* CTA-local staging of counters */
+#define STAGED_COUNTERS                 "__lynx_staged_counters"
+#define STAGED_COUNTER_INDEX            "__lynx_staged_index"
+#define STAGED_COUNTER_BASE             "__lynx_staged_base"
+#define MAX_STAGED_COUNTERS             256
+
 namespace ir
 {
 	class Module;
@@ -76,6 +85,42 @@ namespace transforms
             unsigned int instructionId;
             unsigned int kernelInstructionCount;
             ir::PTXInstruction originalInstruction;
+            
+            /*! \brief if set, the executed instruction count is read from 
+                this register instead of being encoded as an immediate */
+            bool scaledExecutedInstructionCount;
+            analysis::DataflowGraph::RegisterId executedInstructionCountRegister;
+            
+            StaticAttributes();
+    };
+    
+    /*! \brief The blocks of the natural loops of a kernel by the label of 
+        their header, loops sharing a header are merged */
+    typedef std::map<std::string, std::set<std::string> > NaturalLoopMap;
+    
+    /*! \brief A block run once per iteration of a loop whose trip count 
+        follows from the change of an induction register between entry and 
+        exit */
+    class CountedLoop {
+    
+        public:
+        
+            //! the block whose count is hoisted
+            analysis::DataflowGraph::iterator body;
+            //! the loop header
+            analysis::DataflowGraph::iterator header;
+            //! the only predecessor of the header outside of the loop
+            analysis::DataflowGraph::iterator preheader;
+            //! the block following the latch, the only one leaving the loop
+            analysis::DataflowGraph::iterator exit;
+            //! the induction register, updated once per iteration
+            ir::PTXOperand induction;
+            //! the constant update of the induction register
+            long long step;
+            //! instrumented instructions guarded by the back edge predicate
+            unsigned int latchInstructions;
+            
+            CountedLoop();
     };
 
 	/*! \brief A class for an instrumentation pass that adds generated PTX from
@@ -100,6 +145,8 @@ namespace transforms
             std::vector<std::string> types;
             ConstantsMap constants;
             FunctionNameVector functionNames;
+            std::set<std::string> translatedRegisters;
+            unsigned int translatedInstructions;
 			
 		protected:
 		    analysis::DataflowGraph& dfg();
@@ -114,9 +161,48 @@ namespace transforms
 			
 			FunctionParameterMap parameterMap;
 			
+			/*! \brief accumulate counter updates, atomic or load-add-store, 
+			    in a per-CTA shared array that is flushed to global memory at 
+			    kernel exit. Only kernels with a loop and a single exit that 
+			    every warp reaches reconverged are staged. */
+			bool sharedCounterStaging;
+			
+			/*! \brief if set, basic block counters are placed on spanning 
+			    tree chords only and the placement of each kernel is 
+			    recorded here */
+			CounterPlacementMap *counterPlacements;
+			
+			/*! \brief per-block executed instruction counts of the blocks 
+			    run once per iteration of a counted loop are added once at 
+			    the loop exit */
+			bool loopHoisting;
+			
+			/*! \brief propagate copies, remove dead statements and compute 
+			    thread invariant values once at kernel entry */
+			bool optimizeInstrumentation;
+			
+			/*! \brief if set, no code is inserted at the branches recorded 
+			    here. The warps executing each of them are counted instead in 
+			    one of the counters just below the base address, ordered by 
+			    the label of the block ending with the branch. */
+			const UniformBranchMap *uniformBranches;
+			
+			/*! \brief branches that can not diverge, used to decide whether 
+			    the staged counters can be flushed behind a barrier; without 
+			    them every conditional branch is taken to be divergent */
+			const UniformBranchMap *stagingBranches;
+			
 	    private:
 	    
 	        void optimize(ir::PTXKernel::PTXStatementVector & statements);
+	        
+	        void propagateCopies(ir::PTXKernel::PTXStatementVector & statements);
+	        void eliminateDeadCode(ir::PTXKernel::PTXStatementVector & statements);
+	        void hoistInvariants(ir::PTXKernel::PTXStatementVector & statements, 
+	            ir::PTXKernel::PTXStatementVector & invariants);
+	        void insertInvariants(const ir::PTXKernel::PTXStatementVector & invariants);
+	        
+	        unsigned long kernelSize();
 	    
 	        ir::PTXStatement prepareStatementToInsert(ir::PTXStatement statement, StaticAttributes attributes);
 	        bool instrumentationConditionsMet(ir::PTXInstruction instruction, TranslationBlock translationBlock);
@@ -132,6 +218,27 @@ namespace transforms
 			unsigned int kernelInstructionCount(TranslationBlock translationBlock);
 			ir::PTXStatement computeBaseAddress(ir::PTXStatement statement, ir::PTXInstruction original);
 			
+			bool stageable(ir::IRKernel & k);
+			unsigned int stageCounters(ir::IRKernel & k, ir::PTXKernel::PTXStatementVector & statements);
+			void stagedCounterOwners(unsigned int counters, std::vector<ir::PTXInstruction> & code, 
+			    std::vector<analysis::DataflowGraph::RegisterId> & owners);
+			void insertStagedCounterPrologue(unsigned int counters);
+			void insertStagedCounterFlush(unsigned int counters);
+			
+			NaturalLoopMap naturalLoops();
+			CounterPlacement placeCounters();
+			
+			bool hoistable(TranslationBlock translationBlock);
+			bool countedLoop(analysis::DataflowGraph::iterator block, 
+			    const NaturalLoopMap & loops, CountedLoop & loop);
+			void hoistLoopCount(TranslationBlock translationBlock, StaticAttributes attributes, 
+			    const CountedLoop & loop);
+			
+			unsigned int insertUniformBranchCount(analysis::DataflowGraph::iterator basicBlock, 
+			    unsigned int loc, unsigned int counter, unsigned int counters);
+			
+			std::string kernelName;
+			
 		public:
 			/*! \brief Initialize the pass using a specific kernel */
 			void initialize( const ir::Module& m );
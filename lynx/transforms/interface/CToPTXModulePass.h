@@ -22,6 +22,14 @@
 /* function names */
 
 #define UNIQUE_ELEMENT_COUNT            "uniqueElementCount"
+#define UNIQUE_SEGMENT_COUNT            "uniqueSegmentCount"
+#define MEMORY_TRACE_RESERVE            "memoryTraceReserve"
+
+/* memory trace call arguments */
+
+#define MEMORY_TRACE_HEADER             "memoryTraceHeader"
+#define MEMORY_TRACE_SLOT               "memoryTraceSlot"
+#define MEMORY_TRACE_SEQUENCE           "memoryTraceSequence"
 
 /* label names */
 
@@ -40,6 +48,9 @@
 #define INST_COUNT_LOOP_INC             "$instCountLoopInc"
 #define UPDATE_COUNTER                  "$updateCounter"
 #define STORE_RESULTS                   "$storeResults"
+#define MEMORY_TRACE_RETRY              "$memoryTraceRetry"
+#define MEMORY_TRACE_FULL               "$memoryTraceFull"
+#define PEEL_SEGMENT                    "$peelSegment"
 
 namespace ir
 {
@@ -59,6 +70,9 @@ namespace transforms
 			FunctionParameterMap parameterMap;
             std::string functionName;
             ir::PTXKernel::PTXStatementVector globals;
+            
+            /*! \brief the kernel pass inserting calls to functionName */
+            std::string instrumentationPass;
 	
 		public:
         			
@@ -74,6 +88,8 @@ namespace transforms
 			
         private:
 			ir::PTXKernel * uniqueElementCount();
+			ir::PTXKernel * uniqueSegmentCount();
+			ir::PTXKernel * memoryTraceReserve();
 	};
 }
 
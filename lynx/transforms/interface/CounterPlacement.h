@@ -0,0 +1,112 @@
+/*! \file CounterPlacement.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the CounterPlacement class, which places basic
+		block execution counters on the chords of a maximum spanning tree
+*/
+
+#ifndef COUNTER_PLACEMENT_H_INCLUDED
+#define COUNTER_PLACEMENT_H_INCLUDED
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace transforms
+{
+
+	/*! \brief Knuth-style optimal counter placement for block execution counts.
+
+		The control flow graph, closed by a virtual edge from the exit back to
+		the entry, is covered by a maximum spanning tree whose edge weights
+		estimate execution frequency. Only the chords need to be counted, the
+		remaining edge counts (and from them all block counts) follow from
+		flow conservation. A chord is counted by instrumenting its tail when
+		that is its only out-edge, or its head when that is its only in-edge;
+		edges that can be counted neither way are forced into the tree. If
+		that is impossible every instrumentable block is counted directly.
+	*/
+	class CounterPlacement
+	{
+		public:
+			typedef long long Count;
+			typedef std::vector<Count> CountVector;
+			typedef std::vector<unsigned int> VertexVector;
+
+			/*! \brief vertex 0 is the kernel entry, vertex 1 the exit */
+			enum {
+				Entry = 0,
+				Exit = 1
+			};
+
+			class Edge
+			{
+				public:
+					Edge(unsigned int tail = 0, unsigned int head = 0,
+						double weight = 0.0);
+
+				public:
+					unsigned int tail;
+					unsigned int head;
+					double weight;
+
+					//! counter measuring this chord, -1 for tree edges
+					int counter;
+			};
+
+			typedef std::vector<Edge> EdgeVector;
+
+		public:
+			CounterPlacement();
+
+			/*! \brief Add a block, returning its vertex id. Blocks that
+				cannot hold code (empty, entry, exit) are not instrumentable */
+			unsigned int addVertex(bool instrumentable);
+
+			/*! \brief Add a control flow edge with an estimated frequency */
+			void addEdge(unsigned int tail, unsigned int head, double weight);
+
+			/*! \brief Select the chords and assign their counters */
+			void place();
+
+		public:
+			/*! \brief The number of counters per thread */
+			unsigned int counters() const;
+
+			/*! \brief The counter held by a vertex, -1 if none */
+			int counter(unsigned int vertex) const;
+
+			/*! \brief The number of vertices */
+			unsigned int vertices() const;
+
+			/*! \brief Can the vertex hold a counter? */
+			bool instrumentable(unsigned int vertex) const;
+
+			/*! \brief Are counters placed on chords (rather than on every
+				block)? */
+			bool optimized() const;
+
+			/*! \brief Rebuild the execution count of every vertex from the
+				counter values and the number of kernel entries (threads) */
+			CountVector reconstruct(const CountVector & counters,
+				Count entries) const;
+
+		private:
+			unsigned int _find(std::vector<unsigned int> & sets,
+				unsigned int vertex) const;
+
+		private:
+			std::vector<bool> _instrumentable;
+			EdgeVector _edges;
+
+			//! counter id of each vertex, -1 if not instrumented
+			std::vector<int> _vertexCounters;
+			unsigned int _counters;
+			bool _optimized;
+	};
+
+	typedef std::map<std::string, CounterPlacement> CounterPlacementMap;
+
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*! \file HiddenParameterPass.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the HiddenParameterPass class
+*/
+
+#ifndef HIDDEN_PARAMETER_PASS_H_INCLUDED
+#define HIDDEN_PARAMETER_PASS_H_INCLUDED
+
+#include <ocelot/transforms/interface/Pass.h>
+
+#include <set>
+#include <string>
+
+#define GLOBAL_MEM_BASE_PARAMETER "__lynx_global_mem_base_parameter__"
+
+namespace ir
+{
+	class Module;
+}
+
+namespace transforms
+{
+
+    /*! \brief Passes the instrumentation buffer of a kernel as an extra
+        parameter instead of through the global variable named by
+        GLOBAL_MEM_BASE_ADDRESS.
+
+        Every load of the base pointer from the global becomes a load of
+        the parameter, which is appended to the parameters of the kernel
+        so that the launch can append the pointer to the parameter block.
+        A kernel is left untouched if the address of the global is used in
+        any other way.
+    */
+	class HiddenParameterPass : public KernelPass
+	{
+		public:
+		    typedef std::set<std::string> KernelSet;
+
+		public:
+            HiddenParameterPass();
+
+			void initialize(const ir::Module& m);
+			/*! \brief Run the pass on a specific kernel in the module */
+			void runOnKernel(ir::IRKernel& k);
+			void finalize();
+
+        public:
+            //! where the names of the rewritten kernels are recorded
+            KernelSet *kernels;
+	};
+
+}
+
+#endif
@@ -0,0 +1,97 @@
+/*! \file MemoryTracePass.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the MemoryTracePass class
+*/
+
+#ifndef MEMORY_TRACE_PASS_H_INCLUDED
+#define MEMORY_TRACE_PASS_H_INCLUDED
+
+#include <ocelot/transforms/interface/Pass.h>
+#include <ocelot/analysis/interface/DataflowGraph.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+#include <ocelot/ir/interface/PTXOperand.h>
+
+#include <map>
+#include <string>
+#include <vector>
+
+namespace ir
+{
+	class Module;
+    class PTXKernel;
+}
+
+namespace transforms
+{
+
+    /*! \brief Records every global (and generic) memory access of a warp in
+        the device trace ring described by trace::MemoryTraceBuffer.
+
+        Before each access all lanes of the warp exchange their addresses
+        with shfl, the lowest active lane reserves a record by calling
+        memoryTraceReserve, every active lane stores its delta from the
+        lowest lane's address and the leader publishes the record by
+        writing its sequence number last. The module pass must add the
+        memoryTraceReserve function and the global holding the ring header.
+
+        A full ring never blocks the kernel, the reservation returns a zero
+        slot and the warp skips the record. The lanes fence their stores
+        and meet at a vote before the leader publishes, so the record does
+        not rely on the lanes storing in lock step. The emitted PTX predates
+        bar.warp.sync, the vote is the warp rendezvous it can express.
+    */
+	class MemoryTracePass : public KernelPass
+	{
+	    public:
+
+	        typedef std::vector<ir::PTXInstruction> InstructionVector;
+
+	        /*! \brief instruction text by instructionId */
+	        typedef std::map<unsigned int, std::string> InstructionMap;
+	        typedef std::map<std::string, InstructionMap> KernelInstructionMap;
+
+		public:
+
+            MemoryTracePass();
+
+			void initialize(const ir::Module& m);
+			/*! \brief Run the pass on a specific kernel in the module */
+			void runOnKernel(ir::IRKernel& k);
+			void finalize();
+
+		public:
+
+		    /*! \brief where the traced instructions of each kernel are
+		        recorded, 0 if they are not needed */
+		    KernelInstructionMap *instructions;
+
+		    /*! \brief number of memory instructions instrumented */
+		    unsigned long accesses;
+
+        private:
+            analysis::DataflowGraph& dfg();
+
+            /*! \brief Is the instruction a traced memory access? */
+            bool traced(const ir::PTXInstruction & instruction) const;
+
+            /*! \brief The operand holding the address of an access */
+            const ir::PTXOperand & address(const ir::PTXInstruction & instruction) const;
+
+            /*! \brief Load the address of the ring header */
+            ir::PTXOperand loadHeader(InstructionVector & code);
+
+            /*! \brief Code recording one execution of instruction */
+            void trace(InstructionVector & code,
+                const ir::PTXInstruction & instruction,
+                const ir::PTXOperand & header, unsigned int instructionId);
+
+            /*! \brief Broadcast a 64 bit value from lane source */
+            ir::PTXOperand broadcast(InstructionVector & code,
+                const ir::PTXOperand & value, const ir::PTXOperand & source);
+
+            ir::PTXOperand newRegister(ir::PTXOperand::DataType type);
+	};
+}
+
+#endif
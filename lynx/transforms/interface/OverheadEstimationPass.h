@@ -0,0 +1,142 @@
+/*! \file OverheadEstimationPass.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the OverheadEstimationPass class, which
+	    records the static cost of each kernel so that an instrumented kernel
+	    can be compared with its original version before it is launched
+*/
+
+#ifndef OVERHEAD_ESTIMATION_PASS_H_INCLUDED
+#define OVERHEAD_ESTIMATION_PASS_H_INCLUDED
+
+#include <ocelot/transforms/interface/Pass.h>
+#include <ocelot/analysis/interface/DataflowGraph.h>
+
+#include <map>
+#include <string>
+
+namespace ir
+{
+	class Module;
+}
+
+namespace transforms
+{
+
+	/*! \brief The static cost of one kernel */
+	class KernelCost
+	{
+		public:
+			class BlockCost
+			{
+				public:
+					BlockCost();
+
+				public:
+					unsigned int instructions;
+					unsigned int globalAtomics;
+					unsigned int sharedAtomics;
+					//! number of natural loops containing the block
+					unsigned int depth;
+			};
+
+			typedef std::map<std::string, BlockCost> BlockCostMap;
+
+		public:
+			KernelCost();
+
+		public:
+			//! blocks by label, without the entry and exit
+			BlockCostMap blocks;
+			//! most 32 bit registers that are alive at the same time
+			unsigned int registers;
+			//! distinct virtual registers the kernel references
+			unsigned int virtualRegisters;
+			//! the highest register id, registers added later are above it
+			analysis::DataflowGraph::RegisterId maxRegister;
+			//! bytes of shared memory the kernel may use
+			unsigned int sharedBytes;
+	};
+
+	typedef std::map<std::string, KernelCost> KernelCostMap;
+
+	/*! \brief The most 32 bit registers alive at once in a kernel */
+	unsigned int peakLiveRegisters(analysis::DataflowGraph & dfg);
+
+	/*! \brief The distinct virtual registers referenced by a kernel */
+	unsigned int virtualRegisters(analysis::DataflowGraph & dfg);
+
+	/*! \brief measured execution counts of the blocks of a kernel */
+	typedef std::map<std::string, double> BlockWeightMap;
+
+	/*! \brief The predicted cost of instrumenting a kernel.
+
+		Every block is weighted by its measured execution count or, when
+		there is none, by 10^depth of the loops around it. The cycles of a
+		kernel are the weighted sum of its instructions, with atomics
+		counting as several issue slots. The slowdown is the ratio of the
+		cycles, scaled by the loss of occupancy (resident warps per
+		multiprocessor) caused by the added registers.
+	*/
+	class OverheadEstimate
+	{
+		public:
+			typedef std::map<std::string, int> BlockInstructionMap;
+
+		public:
+			OverheadEstimate();
+			OverheadEstimate(const KernelCost & original,
+				const KernelCost & instrumented,
+				const BlockWeightMap * weights = 0);
+
+			std::string toString() const;
+
+		public:
+			//! instructions inserted into each block, new blocks included
+			BlockInstructionMap blocks;
+			//! static instructions inserted in total
+			int instructions;
+			int globalAtomics;
+			int sharedAtomics;
+			int registers;
+			int sharedBytes;
+
+			double originalCycles;
+			double instrumentedCycles;
+			//! resident warps before over resident warps after
+			double occupancy;
+			//! instrumented over original execution time
+			double slowdown;
+	};
+
+	typedef std::map<std::string, OverheadEstimate> OverheadEstimateMap;
+
+	/*! \brief Records the KernelCost of every kernel of a module */
+	class OverheadEstimationPass : public KernelPass
+	{
+		public:
+			OverheadEstimationPass();
+
+			void initialize(const ir::Module& m);
+			/*! \brief Run the pass on a specific kernel in the module */
+			void runOnKernel(ir::IRKernel& k);
+			void finalize();
+
+		public:
+			//! where the cost of each kernel is recorded
+			KernelCostMap *costs;
+
+		private:
+			analysis::DataflowGraph& dfg();
+
+			/*! \brief The loop depth of every block */
+			void loopDepths(KernelCost & cost);
+
+		private:
+			//! shared memory declared at module scope
+			unsigned int _moduleSharedBytes;
+	};
+
+}
+
+#endif
@@ -0,0 +1,106 @@
+/*! \file RegisterReusePass.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the RegisterReusePass class, which renames
+	    the registers added by instrumentation to registers that are dead
+	    wherever the added ones are alive
+*/
+
+#ifndef REGISTER_REUSE_PASS_H_INCLUDED
+#define REGISTER_REUSE_PASS_H_INCLUDED
+
+#include <lynx/transforms/interface/OverheadEstimationPass.h>
+
+#include <ocelot/transforms/interface/Pass.h>
+#include <ocelot/analysis/interface/DataflowGraph.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace transforms
+{
+
+	/*! \brief The registers of a kernel before and after instrumentation */
+	class RegisterUsage
+	{
+		public:
+			RegisterUsage();
+
+			/*! \brief peak live registers added by the instrumentation */
+			int extraRegisters() const;
+
+			std::string toString() const;
+
+		public:
+			//! distinct virtual registers of the original kernel
+			unsigned int originalRegisters;
+			//! peak live 32 bit registers of the original kernel
+			unsigned int originalPeak;
+			//! distinct virtual registers after instrumentation
+			unsigned int instrumentedRegisters;
+			//! added registers renamed to a dead register
+			unsigned int reusedRegisters;
+			//! distinct virtual registers after reuse
+			unsigned int registers;
+			//! peak live 32 bit registers after instrumentation
+			unsigned int peak;
+	};
+
+	typedef std::map<std::string, RegisterUsage> RegisterUsageMap;
+
+	/*! \brief Renames every register added by instrumentation to a register
+		of the same type that does not interfere with it.
+
+		Registers are the original registers of the kernel, in id order,
+		followed by the added registers that could not be renamed. Two
+		registers interfere if one is defined while the other is alive or
+		both are alive at the start of a block, liveness is taken from the
+		aliveIn/aliveOut sets of the dataflow graph. Registers that are
+		defined under a predicate, accessed as a vector element, named by
+		an identifier or used with more than one type are never renamed or
+		reused.
+	*/
+	class RegisterReusePass : public KernelPass
+	{
+		public:
+			RegisterReusePass();
+
+			void initialize(const ir::Module& m);
+			/*! \brief Run the pass on a specific kernel in the module */
+			void runOnKernel(ir::IRKernel& k);
+			void finalize();
+
+		public:
+			//! the costs of the kernels before they were instrumented
+			const KernelCostMap *original;
+			//! rename added registers, otherwise only measure
+			bool reuse;
+			//! where the registers of each kernel are recorded
+			RegisterUsageMap *usage;
+
+		private:
+			typedef analysis::DataflowGraph::RegisterId RegisterId;
+			typedef std::set<RegisterId> RegisterIdSet;
+			typedef std::map<RegisterId, RegisterIdSet> InterferenceMap;
+			typedef std::map<RegisterId, analysis::DataflowGraph::Type>
+				RegisterTypeMap;
+			typedef std::map<RegisterId, RegisterId> RegisterRenameMap;
+
+		private:
+			analysis::DataflowGraph& dfg();
+
+			/*! \brief The type of every register that may be renamed */
+			void registerTypes(RegisterTypeMap & types);
+
+			/*! \brief The registers each added register interferes with */
+			void interference(InterferenceMap & interferences,
+				const RegisterTypeMap & types, RegisterId maxRegister);
+
+			/*! \brief Rename the added registers, returns how many were */
+			unsigned int reuseRegisters(RegisterId maxRegister);
+	};
+
+}
+
+#endif
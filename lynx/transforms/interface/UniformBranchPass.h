@@ -0,0 +1,72 @@
+/*! \file UniformBranchPass.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the UniformBranchPass class, which finds the
+	    conditional branches that divergence analysis proves warp uniform
+*/
+
+#ifndef UNIFORM_BRANCH_PASS_H_INCLUDED
+#define UNIFORM_BRANCH_PASS_H_INCLUDED
+
+#include <ocelot/transforms/interface/Pass.h>
+
+#include <map>
+#include <set>
+#include <string>
+
+namespace ir
+{
+	class Module;
+}
+
+namespace transforms
+{
+
+	/*! \brief The conditional branches of a kernel */
+	class UniformBranches
+	{
+		public:
+			typedef std::set<std::string> LabelSet;
+
+		public:
+			UniformBranches();
+
+			/*! \brief Is the branch ending the block proven uniform? */
+			bool uniform(const std::string & label) const;
+
+		public:
+			//! labels of the blocks ending with a uniform branch
+			LabelSet labels;
+			//! conditional branches in the kernel
+			unsigned int branches;
+	};
+
+	typedef std::map<std::string, UniformBranches> UniformBranchMap;
+
+	/*! \brief Records the conditional branches whose predicate divergence
+		analysis proves to hold the same value in every thread.
+
+		A branch is uniform if it is marked .uni or its predicate does not
+		depend on a divergent value. The path count of isPossibleDivBranch
+		is not used, it clears branches that may still split a warp as long
+		as the paths reconverge trivially. Blocks are identified by their
+		labels, which survive the SSA round trip of the analysis.
+	*/
+	class UniformBranchPass : public KernelPass
+	{
+		public:
+			UniformBranchPass();
+
+			void initialize(const ir::Module& m);
+			/*! \brief Run the pass on a specific kernel in the module */
+			void runOnKernel(ir::IRKernel& k);
+			void finalize();
+
+		public:
+			//! where the branches of each kernel are recorded
+			UniformBranchMap *branches;
+	};
+
+}
+
+#endif
@@ -0,0 +1,338 @@
+/*!
+	\file TestCounterPlacement.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the CounterPlacement class. Threads walk hand built
+		and random control flow graphs, and the block counts rebuilt from
+		the placed counters must match the counts of the walks.
+*/
+
+#ifndef TEST_COUNTER_PLACEMENT_CPP_INCLUDED
+#define TEST_COUNTER_PLACEMENT_CPP_INCLUDED
+
+#include <lynx/transforms/interface/CounterPlacement.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Compare reconstructed block counts with brute force */
+	class TestCounterPlacement : public Test
+	{
+		private:
+			typedef transforms::CounterPlacement CounterPlacement;
+			typedef std::vector<unsigned int> VertexVector;
+			typedef std::vector<VertexVector> SuccessorVector;
+
+		private:
+			void _addEdge(CounterPlacement& placement,
+				SuccessorVector& successors, unsigned int tail,
+				unsigned int head, double weight);
+
+			bool _check(const std::string& graph,
+				CounterPlacement& placement,
+				const SuccessorVector& successors);
+
+			bool _testLoop();
+			bool _testDiamond();
+			bool _testMultipleExits();
+			bool _testUnmeasurableCycle();
+			bool _testRandom();
+
+			bool doTest();
+
+		public:
+			TestCounterPlacement();
+
+		public:
+			unsigned int threads;
+			unsigned int graphs;
+	};
+
+	void TestCounterPlacement::_addEdge(CounterPlacement& placement,
+		SuccessorVector& successors, unsigned int tail, unsigned int head,
+		double weight)
+	{
+		placement.addEdge(tail, head, weight);
+
+		successors.resize(placement.vertices());
+		successors[tail].push_back(head);
+	}
+
+	/*! Every thread walks from the entry to the exit taking a random
+		out-edge at each block. The counts of the walks are the brute force
+		result, the counters of the visited vertices are what the kernel
+		would have recorded. */
+	bool TestCounterPlacement::_check(const std::string& graph,
+		CounterPlacement& placement, const SuccessorVector& successors)
+	{
+		placement.place();
+
+		CounterPlacement::CountVector expected(placement.vertices(), 0);
+		CounterPlacement::CountVector counters(placement.counters(), 0);
+
+		for(unsigned int t = 0; t < threads; ++t)
+		{
+			unsigned int vertex = CounterPlacement::Entry;
+
+			while(true)
+			{
+				expected[vertex]++;
+
+				if(placement.counter(vertex) != -1)
+				{
+					counters[placement.counter(vertex)]++;
+				}
+
+				if(vertex == CounterPlacement::Exit) break;
+
+				const VertexVector& out = successors[vertex];
+				vertex = out[random() % out.size()];
+			}
+		}
+
+		CounterPlacement::CountVector counts =
+			placement.reconstruct(counters, threads);
+
+		for(unsigned int v = 0; v < placement.vertices(); ++v)
+		{
+			/* without chords only instrumented blocks are known */
+			if(!placement.optimized() && placement.counter(v) == -1
+				&& v != CounterPlacement::Entry
+				&& v != CounterPlacement::Exit)
+			{
+				continue;
+			}
+
+			if(counts[v] != expected[v])
+			{
+				status << graph << ": block " << v << " executed "
+					<< expected[v] << " times, reconstructed " << counts[v]
+					<< " from " << placement.counters() << " counters.\n";
+				return false;
+			}
+		}
+
+		return true;
+	}
+
+	/*! entry -> A -> B <-> C, B -> D -> exit */
+	bool TestCounterPlacement::_testLoop()
+	{
+		CounterPlacement placement;
+		SuccessorVector successors;
+
+		unsigned int a = placement.addVertex(true);
+		unsigned int b = placement.addVertex(true);
+		unsigned int c = placement.addVertex(true);
+		unsigned int d = placement.addVertex(true);
+
+		_addEdge(placement, successors, CounterPlacement::Entry, a, 1.0);
+		_addEdge(placement, successors, a, b, 1.0);
+		_addEdge(placement, successors, b, c, 10.0);
+		_addEdge(placement, successors, c, b, 10.0);
+		_addEdge(placement, successors, b, d, 1.0);
+		_addEdge(placement, successors, d, CounterPlacement::Exit, 1.0);
+
+		if(!_check("loop", placement, successors)) return false;
+
+		if(!placement.optimized() || placement.counters() >= 4)
+		{
+			status << "loop: expected chord counters, got "
+				<< placement.counters() << ".\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! entry -> A -> {B, C} -> D -> exit */
+	bool TestCounterPlacement::_testDiamond()
+	{
+		CounterPlacement placement;
+		SuccessorVector successors;
+
+		unsigned int a = placement.addVertex(true);
+		unsigned int b = placement.addVertex(true);
+		unsigned int c = placement.addVertex(true);
+		unsigned int d = placement.addVertex(true);
+
+		_addEdge(placement, successors, CounterPlacement::Entry, a, 1.0);
+		_addEdge(placement, successors, a, b, 0.5);
+		_addEdge(placement, successors, a, c, 0.5);
+		_addEdge(placement, successors, b, d, 0.5);
+		_addEdge(placement, successors, c, d, 0.5);
+		_addEdge(placement, successors, d, CounterPlacement::Exit, 1.0);
+
+		if(!_check("diamond", placement, successors)) return false;
+
+		if(placement.counters() != 1)
+		{
+			status << "diamond: expected one counter, got "
+				<< placement.counters() << ".\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! Three blocks leave the kernel, one through an empty block, and a
+		nested loop sits on one of the paths */
+	bool TestCounterPlacement::_testMultipleExits()
+	{
+		CounterPlacement placement;
+		SuccessorVector successors;
+
+		unsigned int a = placement.addVertex(true);
+		unsigned int b = placement.addVertex(true);
+		unsigned int c = placement.addVertex(true);
+		unsigned int d = placement.addVertex(true);
+		unsigned int e = placement.addVertex(true);
+		unsigned int empty = placement.addVertex(false);
+
+		_addEdge(placement, successors, CounterPlacement::Entry, a, 1.0);
+		_addEdge(placement, successors, a, b, 0.5);
+		_addEdge(placement, successors, a, c, 0.5);
+		_addEdge(placement, successors, b, CounterPlacement::Exit, 0.25);
+		_addEdge(placement, successors, b, empty, 0.25);
+		_addEdge(placement, successors, empty, CounterPlacement::Exit, 0.25);
+		_addEdge(placement, successors, c, d, 5.0);
+		_addEdge(placement, successors, d, e, 50.0);
+		_addEdge(placement, successors, e, d, 45.0);
+		_addEdge(placement, successors, e, c, 4.5);
+		_addEdge(placement, successors, e, CounterPlacement::Exit, 0.5);
+
+		return _check("multiple exits", placement, successors);
+	}
+
+	/*! Two empty blocks joined by parallel edges can not be measured, so
+		every instrumentable block is counted directly */
+	bool TestCounterPlacement::_testUnmeasurableCycle()
+	{
+		CounterPlacement placement;
+		SuccessorVector successors;
+
+		unsigned int a = placement.addVertex(true);
+		unsigned int first = placement.addVertex(false);
+		unsigned int second = placement.addVertex(false);
+		unsigned int b = placement.addVertex(true);
+
+		_addEdge(placement, successors, CounterPlacement::Entry, a, 1.0);
+		_addEdge(placement, successors, a, first, 0.5);
+		_addEdge(placement, successors, a, b, 0.5);
+		_addEdge(placement, successors, first, second, 0.25);
+		_addEdge(placement, successors, first, second, 0.25);
+		_addEdge(placement, successors, second, b, 0.5);
+		_addEdge(placement, successors, second, CounterPlacement::Exit, 0.5);
+		_addEdge(placement, successors, b, CounterPlacement::Exit, 1.0);
+
+		if(!_check("unmeasurable cycle", placement, successors)) return false;
+
+		if(placement.optimized())
+		{
+			status << "unmeasurable cycle: expected every block counted.\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! Random graphs with a path to the exit from every block */
+	bool TestCounterPlacement::_testRandom()
+	{
+		for(unsigned int g = 0; g < graphs; ++g)
+		{
+			CounterPlacement placement;
+			SuccessorVector successors;
+
+			unsigned int blocks = 1 + random() % 12;
+			unsigned int first = placement.vertices();
+
+			for(unsigned int b = 0; b < blocks; ++b)
+			{
+				placement.addVertex(random() % 5 != 0);
+			}
+
+			_addEdge(placement, successors, CounterPlacement::Entry, first,
+				1.0);
+
+			for(unsigned int b = first; b < first + blocks; ++b)
+			{
+				unsigned int next = b + 1 < first + blocks
+					? b + 1 : (unsigned int)CounterPlacement::Exit;
+				_addEdge(placement, successors, b, next, random() % 100);
+
+				unsigned int extra = random() % 3;
+				for(unsigned int e = 0; e < extra; ++e)
+				{
+					unsigned int head = random() % (blocks + 1);
+					head = head == blocks
+						? (unsigned int)CounterPlacement::Exit : first + head;
+					_addEdge(placement, successors, b, head, random() % 100);
+				}
+			}
+
+			std::stringstream name;
+			name << "random graph " << g;
+
+			if(!_check(name.str(), placement, successors)) return false;
+		}
+
+		return true;
+	}
+
+	bool TestCounterPlacement::doTest()
+	{
+		bool passed = _testLoop() && _testDiamond() && _testMultipleExits()
+			&& _testUnmeasurableCycle() && _testRandom();
+
+		if(passed)
+		{
+			status << "Reconstructed counts matched " << threads
+				<< " simulated threads on the hand built graphs and "
+				<< graphs << " random graphs.\n";
+		}
+
+		return passed;
+	}
+
+	TestCounterPlacement::TestCounterPlacement()
+	{
+		name = "TestCounterPlacement";
+
+		description = "Places chord counters on a loop, a diamond, a graph ";
+		description += "with several exits and a graph whose empty blocks ";
+		description += "force counting every block, then on random graphs. ";
+		description += "Simulated threads walk each graph and the block ";
+		description += "counts rebuilt from the counters must equal the ";
+		description += "counts of the walks.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestCounterPlacement test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-t", "--threads", test.threads, 1000,
+		"Threads walking each graph.");
+	parser.parse("-g", "--graphs", test.graphs, 1000,
+		"Random graphs to check.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
@@ -0,0 +1,486 @@
+/*!
+	\file TestLoopHoisting.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the hoisting of executed instruction counts out of
+		counted loops in the CToPTXInstrumentationPass. A kernel with a
+		single block loop followed by a loop of two blocks is instrumented
+		with a basic block count and compared against a golden listing.
+*/
+
+#ifndef TEST_LOOP_HOISTING_CPP_INCLUDED
+#define TEST_LOOP_HOISTING_CPP_INCLUDED
+
+#include <lynx/transforms/interface/CToPTXInstrumentationPass.h>
+
+#include <ocelot/transforms/interface/PassManager.h>
+
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Compare the hoisted loop counts with golden PTX */
+	class TestLoopHoisting : public Test
+	{
+		private:
+			typedef ir::Module::StatementVector StatementVector;
+			typedef std::vector<std::string> StringVector;
+
+		private:
+			static ir::PTXOperand _register(unsigned int id,
+				ir::PTXOperand::DataType type);
+			static void _instruction(StatementVector& statements,
+				const ir::PTXInstruction& instruction);
+			static void _label(StatementVector& statements,
+				const std::string& name);
+
+			/*! \brief %r1 counts a single block loop up by one, %r3 a
+				loop of a header and a latch up by four */
+			static StatementVector _kernel();
+
+			/*! \brief a basic block count adding the executed instructions
+				of each block to a counter */
+			static translator::CToPTXData _translation();
+
+			/*! \brief instrument the kernel and list the blocks in program
+				order */
+			StringVector _instrument(bool hoisting);
+
+			bool _compare(const std::string& test, const StringVector& result,
+				const char** golden);
+
+			bool _testHoisted();
+			bool _testPerIteration();
+
+			bool doTest();
+
+		public:
+			TestLoopHoisting();
+	};
+
+	ir::PTXOperand TestLoopHoisting::_register(unsigned int id,
+		ir::PTXOperand::DataType type)
+	{
+		ir::PTXOperand operand(ir::PTXOperand::Register, type, id);
+
+		std::stringstream name;
+		name << (type == ir::PTXOperand::pred ? "%p" : "%r") << id;
+		operand.identifier = name.str();
+
+		return operand;
+	}
+
+	void TestLoopHoisting::_instruction(StatementVector& statements,
+		const ir::PTXInstruction& instruction)
+	{
+		ir::PTXStatement statement(ir::PTXStatement::Instr);
+		statement.instruction = instruction;
+
+		statements.push_back(statement);
+	}
+
+	void TestLoopHoisting::_label(StatementVector& statements,
+		const std::string& name)
+	{
+		ir::PTXStatement statement(ir::PTXStatement::Label);
+		statement.name = name;
+
+		statements.push_back(statement);
+	}
+
+	TestLoopHoisting::StatementVector TestLoopHoisting::_kernel()
+	{
+		typedef ir::PTXInstruction PTXInstruction;
+		typedef ir::PTXOperand PTXOperand;
+
+		StatementVector statements;
+
+		ir::PTXStatement version(ir::PTXStatement::Version);
+		version.major = 2;
+		version.minor = 3;
+		statements.push_back(version);
+
+		ir::PTXStatement target(ir::PTXStatement::Target);
+		target.targets.push_back("sm_21");
+		statements.push_back(target);
+
+		ir::PTXStatement entry(ir::PTXStatement::Entry);
+		entry.name = "kernel";
+		statements.push_back(entry);
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::StartScope));
+
+		PTXInstruction move(PTXInstruction::Mov);
+		move.type = PTXOperand::u32;
+		move.a = PTXOperand(0, PTXOperand::u32);
+
+		move.d = _register(1, PTXOperand::u32);
+		_instruction(statements, move);
+
+		move.d = _register(2, PTXOperand::u32);
+		_instruction(statements, move);
+
+		/* a loop of a single block */
+		_label(statements, "$Lself");
+
+		PTXInstruction sum(PTXInstruction::Add);
+		sum.type = PTXOperand::u32;
+		sum.d = _register(2, PTXOperand::u32);
+		sum.a = _register(2, PTXOperand::u32);
+		sum.b = _register(1, PTXOperand::u32);
+		_instruction(statements, sum);
+
+		PTXInstruction increment(PTXInstruction::Add);
+		increment.type = PTXOperand::u32;
+		increment.d = _register(1, PTXOperand::u32);
+		increment.a = _register(1, PTXOperand::u32);
+		increment.b = PTXOperand(1, PTXOperand::u32);
+		_instruction(statements, increment);
+
+		PTXInstruction compare(PTXInstruction::SetP);
+		compare.type = PTXOperand::u32;
+		compare.comparisonOperator = PTXInstruction::Lt;
+		compare.d = _register(1, PTXOperand::pred);
+		compare.a = _register(1, PTXOperand::u32);
+		compare.b = PTXOperand(16, PTXOperand::u32);
+		_instruction(statements, compare);
+
+		PTXInstruction branch(PTXInstruction::Bra);
+		branch.d = PTXOperand("$Lself");
+		branch.pg = _register(1, PTXOperand::pred);
+		branch.pg.condition = PTXOperand::Pred;
+		branch.uni = false;
+		_instruction(statements, branch);
+
+		/* the exit of the first loop is the preheader of the second */
+		_label(statements, "$Lnext");
+
+		move.d = _register(3, PTXOperand::u32);
+		_instruction(statements, move);
+
+		/* a loop of a header falling through to its latch */
+		_label(statements, "$Lheader");
+
+		sum.b = _register(3, PTXOperand::u32);
+		_instruction(statements, sum);
+
+		increment.d = increment.a = _register(3, PTXOperand::u32);
+		increment.b = PTXOperand(4, PTXOperand::u32);
+		_instruction(statements, increment);
+
+		_label(statements, "$Llatch");
+
+		compare.d = _register(2, PTXOperand::pred);
+		compare.a = _register(3, PTXOperand::u32);
+		compare.b = PTXOperand(64, PTXOperand::u32);
+		_instruction(statements, compare);
+
+		branch.d = PTXOperand("$Lheader");
+		branch.pg = _register(2, PTXOperand::pred);
+		branch.pg.condition = PTXOperand::Pred;
+		_instruction(statements, branch);
+
+		_label(statements, "$Ldone");
+
+		_instruction(statements, PTXInstruction(PTXInstruction::Exit));
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::EndScope));
+
+		return statements;
+	}
+
+	translator::CToPTXData TestLoopHoisting::_translation()
+	{
+		translator::CToPTXData translation;
+
+		ir::PTXStatement label(ir::PTXStatement::Label);
+		label.name = ENTER_BASIC_BLOCK;
+		translation.statements.push_back(label);
+
+		ir::PTXOperand counter(ir::PTXOperand::Register,
+			ir::PTXOperand::u64, 0);
+		counter.identifier = "%counter";
+
+		ir::PTXOperand address(ir::PTXOperand::Indirect,
+			ir::PTXOperand::u64, 0);
+		address.identifier = "%address";
+
+		ir::PTXStatement statement(ir::PTXStatement::Instr);
+
+		//ld.global.u64 %counter, [%address];
+		ir::PTXInstruction& ld = statement.instruction;
+		ld = ir::PTXInstruction(ir::PTXInstruction::Ld);
+		ld.type = ir::PTXOperand::u64;
+		ld.addressSpace = ir::PTXInstruction::Global;
+		ld.d = counter;
+		ld.a = address;
+		translation.statements.push_back(statement);
+
+		//add.u64 %counter, %counter, executed;
+		ir::PTXInstruction& add = statement.instruction;
+		add = ir::PTXInstruction(ir::PTXInstruction::Add);
+		add.type = ir::PTXOperand::u64;
+		add.d = add.a = counter;
+		add.b = ir::PTXOperand(ir::PTXOperand::Address,
+			ir::PTXOperand::u64, 0);
+		add.b.identifier = BASIC_BLOCK_EXEC_INST_COUNT;
+		translation.statements.push_back(statement);
+
+		//st.global.u64 [%address], %counter;
+		ir::PTXInstruction& st = statement.instruction;
+		st = ir::PTXInstruction(ir::PTXInstruction::St);
+		st.type = ir::PTXOperand::u64;
+		st.addressSpace = ir::PTXInstruction::Global;
+		st.d = address;
+		st.a = counter;
+		translation.statements.push_back(statement);
+
+		translation.registers.push_back("%counter");
+		translation.registers.push_back("%address");
+
+		return translation;
+	}
+
+	TestLoopHoisting::StringVector TestLoopHoisting::_instrument(
+		bool hoisting)
+	{
+		ir::Module module("loops", _kernel());
+
+		transforms::CToPTXInstrumentationPass pass(_translation());
+		pass.loopHoisting = hoisting;
+		pass.optimizeInstrumentation = false;
+
+		{
+			transforms::PassManager manager(&module);
+			manager.addPass(&pass);
+			manager.runOnModule();
+			manager.releasePasses();
+		}
+
+		ir::ControlFlowGraph::BlockPointerVector sequence =
+			module.getKernel("kernel")->cfg()->executable_sequence();
+
+		StringVector result;
+
+		for(ir::ControlFlowGraph::BlockPointerVector::const_iterator
+			block = sequence.begin(); block != sequence.end(); ++block)
+		{
+			if((*block)->instructions.empty()) continue;
+
+			result.push_back((*block)->label() + ":");
+
+			for(ir::ControlFlowGraph::InstructionList::const_iterator
+				instruction = (*block)->instructions.begin();
+				instruction != (*block)->instructions.end(); ++instruction)
+			{
+				result.push_back((*instruction)->toString() + ";");
+			}
+		}
+
+		return result;
+	}
+
+	bool TestLoopHoisting::_compare(const std::string& test,
+		const StringVector& result, const char** golden)
+	{
+		size_t lines = 0;
+		while(golden[lines] != 0) ++lines;
+
+		bool matched = result.size() == lines;
+
+		for(size_t i = 0; matched && i < lines; ++i)
+		{
+			matched = result[i] == golden[i];
+		}
+
+		if(!matched)
+		{
+			status << test << ": the instrumented kernel does not match the "
+				<< "golden listing.\n emitted:\n";
+
+			for(StringVector::const_iterator line = result.begin();
+				line != result.end(); ++line)
+			{
+				status << "  " << *line << "\n";
+			}
+
+			status << " expected:\n";
+
+			for(size_t i = 0; i < lines; ++i)
+			{
+				status << "  " << golden[i] << "\n";
+			}
+		}
+
+		return matched;
+	}
+
+	/*! Each loop saves its induction register in the preheader, the
+		blocks of the loop add their executed instructions times the trip
+		count at the exit, and the predicated back edge once less */
+	bool TestLoopHoisting::_testHoisted()
+	{
+		static const char* golden[] = {
+			"BB_1_2:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 2;",
+			"st.global.u64 [%r6], %r5;",
+			"mov.u32 %r0, 0;",
+			"mov.u32 %r1, 0;",
+			"mov.u32 %r7, %r0;",
+			"BB_1_3:",
+			"add.u32 %r1, %r1, %r0;",
+			"add.u32 %r0, %r0, 1;",
+			"setp.lt.u32 %p2, %r0, 16;",
+			"@%p2 bra BB_1_3;",
+			"BB_1_4:",
+			"sub.u32 %r8, %r0, %r7;",
+			"cvt.u64.u32 %r9, %r8;",
+			"max.u64 %r11, %r9, 1;",
+			"sub.u64 %r12, %r11, 1;",
+			"mul.lo.u64 %r13, %r12, 1;",
+			"mad.lo.u64 %r10, %r9, 3, %r13;",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, %r10;",
+			"st.global.u64 [%r6], %r5;",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 1;",
+			"st.global.u64 [%r6], %r5;",
+			"mov.u32 %r3, 0;",
+			"mov.u32 %r14, %r3;",
+			"mov.u32 %r19, %r3;",
+			"BB_1_5:",
+			"add.u32 %r1, %r1, %r3;",
+			"add.u32 %r3, %r3, 4;",
+			"BB_1_6:",
+			"setp.lt.u32 %p4, %r3, 64;",
+			"@%p4 bra BB_1_5;",
+			"BB_1_7:",
+			"sub.u32 %r20, %r3, %r19;",
+			"div.u32 %r21, %r20, 4;",
+			"cvt.u64.u32 %r22, %r21;",
+			"max.u64 %r24, %r22, 1;",
+			"sub.u64 %r25, %r24, 1;",
+			"mul.lo.u64 %r26, %r25, 1;",
+			"mad.lo.u64 %r23, %r22, 1, %r26;",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, %r23;",
+			"st.global.u64 [%r6], %r5;",
+			"sub.u32 %r15, %r3, %r14;",
+			"div.u32 %r16, %r15, 4;",
+			"cvt.u64.u32 %r17, %r16;",
+			"mul.lo.u64 %r18, %r17, 2;",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, %r18;",
+			"st.global.u64 [%r6], %r5;",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 1;",
+			"st.global.u64 [%r6], %r5;",
+			"exit;",
+			0
+		};
+
+		return _compare("hoisted", _instrument(true), golden);
+	}
+
+	/*! Without hoisting every block adds its count on every iteration */
+	bool TestLoopHoisting::_testPerIteration()
+	{
+		static const char* golden[] = {
+			"BB_1_2:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 2;",
+			"st.global.u64 [%r6], %r5;",
+			"mov.u32 %r0, 0;",
+			"mov.u32 %r1, 0;",
+			"BB_1_3:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 3;",
+			"selp.u64 %r7, 1, 0, %p2;",
+			"add.u64 %r5, %r5, %r7;",
+			"st.global.u64 [%r6], %r5;",
+			"add.u32 %r1, %r1, %r0;",
+			"add.u32 %r0, %r0, 1;",
+			"setp.lt.u32 %p2, %r0, 16;",
+			"@%p2 bra BB_1_3;",
+			"BB_1_4:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 1;",
+			"st.global.u64 [%r6], %r5;",
+			"mov.u32 %r3, 0;",
+			"BB_1_5:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 2;",
+			"st.global.u64 [%r6], %r5;",
+			"add.u32 %r1, %r1, %r3;",
+			"add.u32 %r3, %r3, 4;",
+			"BB_1_6:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 1;",
+			"selp.u64 %r8, 1, 0, %p4;",
+			"add.u64 %r5, %r5, %r8;",
+			"st.global.u64 [%r6], %r5;",
+			"setp.lt.u32 %p4, %r3, 64;",
+			"@%p4 bra BB_1_5;",
+			"BB_1_7:",
+			"ld.global.u64 %r5, [%r6];",
+			"add.u64 %r5, %r5, 1;",
+			"st.global.u64 [%r6], %r5;",
+			"exit;",
+			0
+		};
+
+		return _compare("per iteration", _instrument(false), golden);
+	}
+
+	bool TestLoopHoisting::doTest()
+	{
+		bool passed = _testHoisted() && _testPerIteration();
+
+		if(passed)
+		{
+			status << "The counts of a single block loop and of a loop of "
+				<< "two blocks were hoisted to their exits as in the golden "
+				<< "PTX.\n";
+		}
+
+		return passed;
+	}
+
+	TestLoopHoisting::TestLoopHoisting()
+	{
+		name = "TestLoopHoisting";
+
+		description = "Instruments a kernel holding a single block loop ";
+		description += "and a loop of a header and a latch with a basic ";
+		description += "block count, with and without loop hoisting. The ";
+		description += "blocks of the instrumented kernel must match a ";
+		description += "golden listing.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestLoopHoisting test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
@@ -9,6 +9,7 @@
 
 #include <lynx/translator/interface/CToPTXTranslator.h>
 #include <lynx/translator/interface/CToPTXInterface.h>
+#include <lynx/transforms/interface/CToPTXModulePass.h>
 
 #include <hydrazine/interface/Exception.h>
 
@@ -923,7 +924,7 @@ namespace translator
         inst.a.addressMode = ir::PTXOperand::Register;
         inst.a.identifier = callName;
         inst.b.addressMode = ir::PTXOperand::Immediate;
-        inst.b.imm_int = ~0x3f;
+        inst.b.imm_int = ~(long long)(segmentSize - 1);
 
 	    specialRegisterMap["andResult"] = callName;
         
@@ -1090,6 +1091,12 @@ namespace translator
     void CToPTXTranslator::generateUniqueElementCount(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, 
         virtual_insn *insn, std::string callName, unsigned long uInput)
     {
+        /* each lane holds its own segment address */
+        if(shuffleUniqueElementCount && !specialRegisterMap["andResult"].empty())
+        {
+            generateShuffleUniqueElementCount(stmt, type, insn);
+            return;
+        }
     
         parameterMap[callName] = uInput;
 
@@ -1230,6 +1237,60 @@ namespace translator
     
     }
     
+    void CToPTXTranslator::generateShuffleUniqueElementCount(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn)
+    {
+        /* the segments are peeled off one leader at a time by the 
+            uniqueSegmentCount function, so the work follows the number of 
+            segments rather than the size of the warp. The call is not 
+            guarded, all lanes present at the instrumented instruction have 
+            to take part even if only a leader uses the result */
+        ir::PTXStatement segmentAddress = ir::PTXStatement(ir::PTXStatement::Param);
+        segmentAddress.name = "segmentAddress";
+        segmentAddress.type = type;
+        statements.push_back(segmentAddress);
+        
+        ir::PTXStatement segmentCount = ir::PTXStatement(ir::PTXStatement::Param);
+        segmentCount.name = "segmentCount";
+        segmentCount.type = type;
+        statements.push_back(segmentCount);
+        
+        //st.param.u64 [segmentAddress], %segment;
+        ir::PTXInstruction st(ir::PTXInstruction::St);
+        st.type = type;
+        st.addressSpace = ir::PTXInstruction::Param;
+        st.d = ir::PTXOperand(ir::PTXOperand::Address, type, segmentAddress.name);
+        st.a = ir::PTXOperand(ir::PTXOperand::Register, type, specialRegisterMap["andResult"]);
+        
+        stmt.instruction = st;
+        statements.push_back(stmt);
+        
+        //call (segmentCount), uniqueSegmentCount, (segmentAddress);
+        ir::PTXInstruction call(ir::PTXInstruction::Call);
+        call.tailCall = false;
+        call.a = ir::PTXOperand(ir::PTXOperand::Label, UNIQUE_SEGMENT_COUNT);
+        call.b.addressMode = ir::PTXOperand::ArgumentList;
+        call.b.array.push_back(ir::PTXOperand(ir::PTXOperand::Register, type, segmentAddress.name));
+        call.d.addressMode = ir::PTXOperand::ArgumentList;
+        call.d.array.push_back(ir::PTXOperand(ir::PTXOperand::Register, type, segmentCount.name));
+        
+        stmt.instruction = call;
+        statements.push_back(stmt);
+        
+        //ld.param.u64 %count, [segmentCount];
+        ir::PTXInstruction ld(ir::PTXInstruction::Ld);
+        ld.type = type;
+        ld.addressSpace = ir::PTXInstruction::Param;
+        ld.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+        ld.a = ir::PTXOperand(ir::PTXOperand::Address, type, segmentCount.name);
+        
+        stmt.instruction = ld;
+        statements.push_back(stmt);
+        
+        specialRegisterMap["uniqueElementCount"] = ld.d.identifier;
+        
+        registerMap[REG + boost::lexical_cast<std::string>(insn->opnds.calli.src)] = ld.d.identifier;  
+    }
+    
     void CToPTXTranslator::generateDivergentWarp(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, 
         virtual_insn *insn)
     {
@@ -1273,6 +1334,14 @@ namespace translator
     
     void CToPTXTranslator::generateAtomicIncrement(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, unsigned int uInput)
     {
+        /* the address is always the global base plus an immediate offset, so
+            every lane of the warp targets the same counter */
+        if(warpAggregatedAtomics && !baseReg.empty())
+        {
+            generateWarpAggregatedIncrement(stmt, type, insn, uInput);
+            return;
+        }
+    
         inst.opcode = ir::PTXInstruction::Atom;
         inst.atomicOperation = ir::PTXInstruction::AtomicAdd;
             
@@ -1301,6 +1370,12 @@ namespace translator
     
     void CToPTXTranslator::generateAtomicAdd(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string regInput)
     {
+        if(warpAggregatedAtomics && !baseReg.empty())
+        {
+            generateWarpAggregatedAdd(stmt, type, insn, regInput);
+            return;
+        }
+    
         inst.opcode = ir::PTXInstruction::Atom;
         inst.atomicOperation = ir::PTXInstruction::AtomicAdd;
             
@@ -1326,6 +1401,402 @@ namespace translator
         registerMap[REG + boost::lexical_cast<std::string>(insn->opnds.calli.src)] = inst.d.identifier;  
     }
 
+
+    std::string CToPTXTranslator::generateRegister()
+    {
+        std::string reg = COD_REG + boost::lexical_cast<std::string>(++maxRegister);
+        registers.push_back(reg);
+        
+        return reg;
+    }
+    
+    std::string CToPTXTranslator::generatePredicateRegister()
+    {
+        std::string pred = COD_PRED + boost::lexical_cast<std::string>(++maxPredicate);
+        registers.push_back(pred);
+        
+        return pred;
+    }
+    
+    std::string CToPTXTranslator::generateTruePredicate(ir::PTXStatement stmt)
+    {
+        //setp.eq.u32 %p, 0, 0; (unguarded, set in every active lane)
+        ir::PTXInstruction inst(ir::PTXInstruction::SetP);
+        inst.type = ir::PTXOperand::u32;
+        inst.comparisonOperator = ir::PTXInstruction::Eq;
+        inst.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        inst.a = ir::PTXOperand(0, ir::PTXOperand::u32);
+        inst.b = ir::PTXOperand(0, ir::PTXOperand::u32);
+        
+        stmt.instruction = inst;
+        statements.push_back(stmt);
+        
+        return inst.d.identifier;
+    }
+    
+    std::string CToPTXTranslator::generateGuardPredicate(ir::PTXStatement stmt, std::string truePredicate)
+    {
+        ir::PTXInstruction inst(ir::PTXInstruction::SetP);
+        ir::PTXOperand unguarded = inst.pg;
+        
+        setPredicate(inst);
+        if(inst.pg.condition == ir::PTXOperand::PT)
+            return truePredicate.empty() ? generateTruePredicate(stmt) : truePredicate;
+        
+        /* materialize the guard as a value that is false (rather than stale) 
+            in lanes the guard disables, so that it can be voted on */
+        
+        //setp.ne.u32 %p, 0, 0;
+        inst.pg = unguarded;
+        inst.type = ir::PTXOperand::u32;
+        inst.comparisonOperator = ir::PTXInstruction::Ne;
+        inst.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        inst.a = ir::PTXOperand(0, ir::PTXOperand::u32);
+        inst.b = ir::PTXOperand(0, ir::PTXOperand::u32);
+        
+        stmt.instruction = inst;
+        statements.push_back(stmt);
+        
+        //@%guard setp.eq.u32 %p, 0, 0;
+        inst.comparisonOperator = ir::PTXInstruction::Eq;
+        
+        setPredicate(inst);
+        stmt.instruction = inst;
+        statements.push_back(stmt);
+        
+        return inst.d.identifier;
+    }
+    
+    void CToPTXTranslator::generateWarpAggregatedIncrement(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, unsigned int uInput)
+    {
+        std::string guard = generateGuardPredicate(stmt);
+        
+        //vote.ballot.b32 %mask, %guard;
+        ir::PTXInstruction vote(ir::PTXInstruction::Vote);
+        vote.vote = ir::PTXInstruction::Ballot;
+        vote.type = ir::PTXOperand::b32;
+        vote.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+        vote.a = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, guard);
+        
+        stmt.instruction = vote;
+        statements.push_back(stmt);
+        
+        //mov.u32 %lanes, %lanemask_lt;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = ir::PTXOperand::u32;
+        mov.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, generateRegister());
+        mov.a = ir::PTXOperand(ir::PTXOperand::lanemask_lt, ir::PTXOperand::u32);
+        mov.a.addressMode = ir::PTXOperand::Special;
+        
+        stmt.instruction = mov;
+        statements.push_back(stmt);
+        
+        //and.b32 %lower, %mask, %lanes;
+        ir::PTXInstruction lower(ir::PTXInstruction::And);
+        lower.type = ir::PTXOperand::b32;
+        lower.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+        lower.a = vote.d;
+        lower.b = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, mov.d.identifier);
+        
+        stmt.instruction = lower;
+        statements.push_back(stmt);
+        
+        /* the leader is the lowest participating lane */
+        
+        //setp.eq.and.b32 %leader, %lower, 0, %guard;
+        ir::PTXInstruction leader(ir::PTXInstruction::SetP);
+        leader.type = ir::PTXOperand::b32;
+        leader.comparisonOperator = ir::PTXInstruction::Eq;
+        leader.booleanOperator = ir::PTXInstruction::BoolAnd;
+        leader.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        leader.a = lower.d;
+        leader.b = ir::PTXOperand(0, ir::PTXOperand::b32);
+        leader.c = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, guard);
+        
+        stmt.instruction = leader;
+        statements.push_back(stmt);
+        
+        //popc.b32 %count, %mask;
+        ir::PTXInstruction popc(ir::PTXInstruction::Popc);
+        popc.type = ir::PTXOperand::b32;
+        popc.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, generateRegister());
+        popc.a = vote.d;
+        
+        stmt.instruction = popc;
+        statements.push_back(stmt);
+        
+        ir::PTXOperand count = popc.d;
+        
+        if(type != ir::PTXOperand::u32)
+        {
+            //cvt.u64.u32 %count, %count;
+            ir::PTXInstruction cvt(ir::PTXInstruction::Cvt);
+            cvt.type = type;
+            cvt.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+            cvt.a = popc.d;
+            
+            stmt.instruction = cvt;
+            statements.push_back(stmt);
+            
+            count = cvt.d;
+        }
+        
+        //@%leader atom.global.add.u64 %old, [%base + offset], %count;
+        ir::PTXInstruction atom(ir::PTXInstruction::Atom);
+        atom.atomicOperation = ir::PTXInstruction::AtomicAdd;
+        atom.addressSpace = ir::PTXInstruction::Global;
+        atom.type = type;
+        atom.pg = leader.d;
+        atom.pg.condition = ir::PTXOperand::Pred;
+        atom.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+        atom.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, baseReg, uInput * sizeof(size_t));
+        atom.b = count;
+        
+        stmt.instruction = atom;
+        statements.push_back(stmt);
+        
+        /* only meaningful in the leader lane; atomicIncrement() returns void */
+        registerMap[REG + boost::lexical_cast<std::string>(insn->opnds.calli.src)] = atom.d.identifier;  
+    }
+    
+    void CToPTXTranslator::generateWarpAggregatedAdd(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string regInput)
+    {
+        std::string active = generateTruePredicate(stmt);
+        std::string guard = generateGuardPredicate(stmt, active);
+        
+        //vote.ballot.b32 %warp, %active;
+        ir::PTXInstruction vote(ir::PTXInstruction::Vote);
+        vote.vote = ir::PTXInstruction::Ballot;
+        vote.type = ir::PTXOperand::b32;
+        vote.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+        vote.a = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, active);
+        
+        stmt.instruction = vote;
+        statements.push_back(stmt);
+        
+        /* shuffling from an inactive lane is undefined, so the reduction is
+            only used when the whole warp is present; partial warps keep the
+            per-lane atomics */
+        
+        //setp.eq.b32 %full, %warp, 0xffffffff;
+        ir::PTXInstruction full(ir::PTXInstruction::SetP);
+        full.type = ir::PTXOperand::b32;
+        full.comparisonOperator = ir::PTXInstruction::Eq;
+        full.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        full.a = vote.d;
+        full.b = ir::PTXOperand(0xffffffffu, ir::PTXOperand::b32);
+        
+        stmt.instruction = full;
+        statements.push_back(stmt);
+        
+        //setp.ne.and.b32 %single, %warp, 0xffffffff, %guard;
+        ir::PTXInstruction single = full;
+        single.comparisonOperator = ir::PTXInstruction::Ne;
+        single.booleanOperator = ir::PTXInstruction::BoolAnd;
+        single.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        single.c = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, guard);
+        
+        stmt.instruction = single;
+        statements.push_back(stmt);
+        
+        //mov.u32 %lanes, %lanemask_lt;
+        ir::PTXInstruction mov(ir::PTXInstruction::Mov);
+        mov.type = ir::PTXOperand::u32;
+        mov.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::u32, generateRegister());
+        mov.a = ir::PTXOperand(ir::PTXOperand::lanemask_lt, ir::PTXOperand::u32);
+        mov.a.addressMode = ir::PTXOperand::Special;
+        
+        stmt.instruction = mov;
+        statements.push_back(stmt);
+        
+        /* lane 0 of a full warp issues the aggregated atomic */
+        
+        //setp.eq.and.u32 %leader, %lanes, 0, %full;
+        ir::PTXInstruction leader(ir::PTXInstruction::SetP);
+        leader.type = ir::PTXOperand::u32;
+        leader.comparisonOperator = ir::PTXInstruction::Eq;
+        leader.booleanOperator = ir::PTXInstruction::BoolAnd;
+        leader.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, generatePredicateRegister());
+        leader.a = mov.d;
+        leader.b = ir::PTXOperand(0, ir::PTXOperand::u32);
+        leader.c = full.d;
+        
+        stmt.instruction = leader;
+        statements.push_back(stmt);
+        
+        ir::PTXOperand value(ir::PTXOperand::Register, type, registerMap[regInput]);
+        
+        /* lanes disabled by the guard contribute nothing */
+        
+        //selp.u64 %sum, %value, 0, %guard;
+        ir::PTXInstruction selp(ir::PTXInstruction::SelP);
+        selp.type = type;
+        selp.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+        selp.a = value;
+        selp.b = ir::PTXOperand(0, type);
+        selp.c = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::pred, guard);
+        
+        stmt.instruction = selp;
+        statements.push_back(stmt);
+        
+        ir::PTXOperand sum = selp.d;
+        
+        /* butterfly reduction, shfl moves 32 bits at a time so 64-bit values 
+            are split into halves and reassembled every step */
+        for(unsigned int offset = 16; offset > 0; offset >>= 1)
+        {
+            ir::PTXOperand::DataType half = ir::PTXOperand::u32;
+            
+            ir::PTXInstruction shfl(ir::PTXInstruction::Shfl);
+            shfl.shuffleMode = ir::PTXInstruction::Bfly;
+            shfl.type = ir::PTXOperand::b32;
+            shfl.b = ir::PTXOperand(offset, ir::PTXOperand::b32);
+            shfl.c = ir::PTXOperand(0x1f, ir::PTXOperand::b32);
+            
+            ir::PTXOperand other;
+            
+            if(type == ir::PTXOperand::u32)
+            {
+                //shfl.bfly.b32 %other, %sum, offset, 0x1f;
+                shfl.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+                shfl.a = sum;
+                
+                stmt.instruction = shfl;
+                statements.push_back(stmt);
+                
+                other = shfl.d;
+                other.type = type;
+            }
+            else
+            {
+                //cvt.u32.u64 %lo, %sum;
+                ir::PTXInstruction lo(ir::PTXInstruction::Cvt);
+                lo.type = half;
+                lo.d = ir::PTXOperand(ir::PTXOperand::Register, half, generateRegister());
+                lo.a = sum;
+                
+                stmt.instruction = lo;
+                statements.push_back(stmt);
+                
+                //shr.u64 %upper, %sum, 32;
+                ir::PTXInstruction shr(ir::PTXInstruction::Shr);
+                shr.type = type;
+                shr.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+                shr.a = sum;
+                shr.b = ir::PTXOperand(32, ir::PTXOperand::u32);
+                
+                stmt.instruction = shr;
+                statements.push_back(stmt);
+                
+                //cvt.u32.u64 %hi, %upper;
+                ir::PTXInstruction hi = lo;
+                hi.d = ir::PTXOperand(ir::PTXOperand::Register, half, generateRegister());
+                hi.a = shr.d;
+                
+                stmt.instruction = hi;
+                statements.push_back(stmt);
+                
+                //shfl.bfly.b32 %otherLo, %lo, offset, 0x1f;
+                shfl.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+                shfl.a = lo.d;
+                
+                stmt.instruction = shfl;
+                statements.push_back(stmt);
+                
+                ir::PTXOperand otherLo = shfl.d;
+                
+                //shfl.bfly.b32 %otherHi, %hi, offset, 0x1f;
+                shfl.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b32, generateRegister());
+                shfl.a = hi.d;
+                
+                stmt.instruction = shfl;
+                statements.push_back(stmt);
+                
+                ir::PTXOperand otherHi = shfl.d;
+                
+                //cvt.u64.u32 %wideLo, %otherLo;
+                ir::PTXInstruction wideLo(ir::PTXInstruction::Cvt);
+                wideLo.type = type;
+                wideLo.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+                wideLo.a = otherLo;
+                wideLo.a.type = half;
+                
+                stmt.instruction = wideLo;
+                statements.push_back(stmt);
+                
+                //cvt.u64.u32 %wideHi, %otherHi;
+                ir::PTXInstruction wideHi = wideLo;
+                wideHi.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+                wideHi.a = otherHi;
+                wideHi.a.type = half;
+                
+                stmt.instruction = wideHi;
+                statements.push_back(stmt);
+                
+                //shl.b64 %wideHi, %wideHi, 32;
+                ir::PTXInstruction shl(ir::PTXInstruction::Shl);
+                shl.type = ir::PTXOperand::b64;
+                shl.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b64, generateRegister());
+                shl.a = wideHi.d;
+                shl.a.type = ir::PTXOperand::b64;
+                shl.b = ir::PTXOperand(32, ir::PTXOperand::u32);
+                
+                stmt.instruction = shl;
+                statements.push_back(stmt);
+                
+                //or.b64 %other, %wideLo, %wideHi;
+                ir::PTXInstruction join(ir::PTXInstruction::Or);
+                join.type = ir::PTXOperand::b64;
+                join.d = ir::PTXOperand(ir::PTXOperand::Register, ir::PTXOperand::b64, generateRegister());
+                join.a = wideLo.d;
+                join.a.type = ir::PTXOperand::b64;
+                join.b = shl.d;
+                
+                stmt.instruction = join;
+                statements.push_back(stmt);
+                
+                other = join.d;
+                other.type = type;
+            }
+            
+            //add.u64 %sum, %sum, %other;
+            ir::PTXInstruction add(ir::PTXInstruction::Add);
+            add.type = type;
+            add.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+            add.a = sum;
+            add.b = other;
+            
+            stmt.instruction = add;
+            statements.push_back(stmt);
+            
+            sum = add.d;
+        }
+        
+        //@%leader atom.global.add.u64 %old, [%base], %sum;
+        ir::PTXInstruction atom(ir::PTXInstruction::Atom);
+        atom.atomicOperation = ir::PTXInstruction::AtomicAdd;
+        atom.addressSpace = ir::PTXInstruction::Global;
+        atom.type = type;
+        atom.pg = leader.d;
+        atom.pg.condition = ir::PTXOperand::Pred;
+        atom.d = ir::PTXOperand(ir::PTXOperand::Register, type, generateRegister());
+        atom.a = ir::PTXOperand(ir::PTXOperand::Indirect, type, baseReg, 0);
+        atom.b = sum;
+        
+        stmt.instruction = atom;
+        statements.push_back(stmt);
+        
+        //@%single atom.global.add.u64 %old, [%base], %value;
+        atom.pg = single.d;
+        atom.pg.condition = ir::PTXOperand::Pred;
+        atom.b = value;
+        
+        stmt.instruction = atom;
+        statements.push_back(stmt);
+        
+        /* only meaningful in the issuing lane; atomicAdd() returns void */
+        registerMap[REG + boost::lexical_cast<std::string>(insn->opnds.calli.src)] = atom.d.identifier;  
+    }
      
     int CToPTXTranslator::translate(dill_stream c, void *info_ptr, void *i)
     {
@@ -2149,7 +2620,9 @@ namespace translator
     }
     
     CToPTXTranslator::CToPTXTranslator()
-        : maxRegister(0), maxPredicate(0), uInput(0)
+        : maxRegister(0), maxPredicate(0), uInput(0),
+        warpAggregatedAtomics(true), shuffleUniqueElementCount(false),
+        segmentSize(64)
     {
         memoryType = GLOBAL_MEM;
     
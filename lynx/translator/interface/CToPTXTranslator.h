@@ -223,6 +223,19 @@ namespace translator {
             unsigned int uInput;
             std::string regInput;
 
+            /*! \brief lower atomicIncrement and atomicAdd to a single atomic
+                per warp, issued by an elected leader lane */
+            bool warpAggregatedAtomics;
+
+            /*! \brief count unique memory segments per half warp with
+                shfl/ballot in the uniqueSegmentCount function instead of
+                the shared memory uniqueElementCount function */
+            bool shuffleUniqueElementCount;
+
+            /*! \brief bytes per memory segment (a power of two), addresses
+                returned by computeBaseAddress are aligned to it */
+            unsigned int segmentSize;
+
 		    private:
 		        void generateBlockId(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
 		        void generateSMId(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
@@ -237,9 +250,16 @@ namespace translator {
 		        void generateComputeBaseAddress(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string callName);
 		        void generateLeastActiveThreadInWarp(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
 		        void generateUniqueElementCount(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string callName, unsigned long uInput);
+		        void generateShuffleUniqueElementCount(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
                 void generateActiveThreadCount(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
 		        void generateAtomicIncrement(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, unsigned int uInput);
 		        void generateAtomicAdd(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string regInput);
+		        void generateWarpAggregatedIncrement(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, unsigned int uInput);
+		        void generateWarpAggregatedAdd(ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string regInput);
+		        std::string generateTruePredicate(ir::PTXStatement stmt);
+		        std::string generateGuardPredicate(ir::PTXStatement stmt, std::string truePredicate = "");
+		        std::string generateRegister();
+		        std::string generatePredicateRegister();
 		        void generateDivergentWarp(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn);
                 void generateSyncThreads(ir::PTXInstruction inst, ir::PTXStatement stmt);
 		        void generateStaticAttributes(ir::PTXInstruction inst, ir::PTXStatement stmt, ir::PTXOperand::DataType type, virtual_insn *insn, std::string callName);
@@ -0,0 +1,385 @@
+/*!
+	\file TestWarpAggregatedAtomics.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the warp aggregated lowering of atomicIncrement and
+		atomicAdd in the CToPTXTranslator. The PTX emitted for each call is
+		compared against a golden listing.
+*/
+
+#ifndef TEST_WARP_AGGREGATED_ATOMICS_CPP_INCLUDED
+#define TEST_WARP_AGGREGATED_ATOMICS_CPP_INCLUDED
+
+#include <lynx/translator/interface/CToPTXTranslator.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <cctype>
+#include <cstring>
+#include <map>
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Compare the translated atomics with golden PTX */
+	class TestWarpAggregatedAtomics : public Test
+	{
+		private:
+			typedef translator::CToPTXTranslator CToPTXTranslator;
+			typedef std::vector<std::string> StringVector;
+
+		private:
+			static virtual_insn _instruction(int classCode, int insnCode = 0);
+
+			/*! \brief feed the COD instructions of
+				'call(globalMem, offset[, value])' to the translator and
+				return the PTX of the call with registers renamed in order
+				of appearance */
+			StringVector _translate(const std::string& call,
+				unsigned long offset, bool guarded);
+
+			bool _compare(const std::string& test, const StringVector& result,
+				const char** golden);
+
+			bool _testIncrement();
+			bool _testGuardedIncrement();
+			bool _testAdd();
+			bool _testPerLane();
+
+			bool doTest();
+
+		public:
+			TestWarpAggregatedAtomics();
+	};
+
+	/*! COD pushes unsigned long arguments with type 7 and pointers with
+		type 8 */
+	enum
+	{
+		UnsignedLong = 7,
+		Pointer = 8,
+		BaseAddress = 100,
+		Value = 5,
+		Result = 6
+	};
+
+	virtual_insn TestWarpAggregatedAtomics::_instruction(int classCode,
+		int insnCode)
+	{
+		virtual_insn insn;
+		std::memset(&insn, 0, sizeof(insn));
+
+		insn.class_code = classCode;
+		insn.insn_code = insnCode;
+
+		return insn;
+	}
+
+	TestWarpAggregatedAtomics::StringVector
+		TestWarpAggregatedAtomics::_translate(const std::string& call,
+		unsigned long offset, bool guarded)
+	{
+		CToPTXTranslator& translator = CToPTXTranslator::translator();
+		translator.clear();
+
+		if(guarded)
+		{
+			translator.targetId = ON_INSTRUCTION;
+
+			translator::PredicateInfo predicate;
+			predicate.id = "%guard";
+			predicate.targetId = ON_INSTRUCTION;
+			predicate.inv = false;
+			translator.predicateList.push_back(predicate);
+		}
+
+		//lea %base, globalMem
+		virtual_insn lea = _instruction(iclass_lea);
+		lea.opnds.a3.src1 = BaseAddress;
+		translator.translate(0, 0, &lea);
+
+		//set %r5, 42
+		virtual_insn set = _instruction(iclass_set);
+		set.opnds.a3i.dest = Value;
+		set.opnds.a3i.u.imm = 42;
+		translator.translate(0, 0, &set);
+
+		size_t first = translator.statements.size();
+
+		virtual_insn push = _instruction(iclass_pushi, Pointer);
+		push.opnds.a3i.u.imm = GLOBAL_MEM;
+		translator.translate(0, 0, &push);
+
+		push = _instruction(iclass_pushi, UnsignedLong);
+		push.opnds.a3i.u.imm = offset;
+		translator.translate(0, 0, &push);
+
+		if(call == "atomicAdd")
+		{
+			push = _instruction(iclass_push, UnsignedLong);
+			push.opnds.a1.src = Value;
+			translator.translate(0, 0, &push);
+		}
+
+		virtual_insn invoke = _instruction(iclass_call);
+		invoke.opnds.calli.src = Result;
+		invoke.opnds.calli.xfer_name = (char*)call.c_str();
+		translator.translate(0, 0, &invoke);
+
+		/* cod numbers registers from one translation to the next, the
+			listing names them by first appearance instead */
+		std::map<std::string, std::string> names;
+		StringVector result;
+
+		for(size_t i = first; i < translator.statements.size(); ++i)
+		{
+			std::string line = translator.statements[i].toString();
+			std::string renamed;
+
+			for(size_t c = 0; c < line.size(); )
+			{
+				bool predicate = line.compare(c, 5, "%codp") == 0;
+
+				if(!predicate && line.compare(c, 5, "%codr") != 0)
+				{
+					renamed += line[c++];
+					continue;
+				}
+
+				size_t end = c + 5;
+				while(end < line.size() && std::isdigit(line[end])) ++end;
+
+				std::string name = line.substr(c, end - c);
+
+				if(names.count(name) == 0)
+				{
+					std::stringstream canonical;
+					canonical << (predicate ? "%p" : "%r") << names.size();
+					names[name] = canonical.str();
+				}
+
+				renamed += names[name];
+				c = end;
+			}
+
+			result.push_back(renamed);
+		}
+
+		translator.clear();
+		translator.targetId.clear();
+
+		return result;
+	}
+
+	bool TestWarpAggregatedAtomics::_compare(const std::string& test,
+		const StringVector& result, const char** golden)
+	{
+		size_t lines = 0;
+		while(golden[lines] != 0) ++lines;
+
+		bool matched = result.size() == lines;
+
+		for(size_t i = 0; matched && i < lines; ++i)
+		{
+			matched = result[i] == golden[i];
+		}
+
+		if(!matched)
+		{
+			status << test << ": the emitted PTX does not match the golden "
+				<< "listing.\n emitted:\n";
+
+			for(StringVector::const_iterator line = result.begin();
+				line != result.end(); ++line)
+			{
+				status << "  " << *line << "\n";
+			}
+
+			status << " expected:\n";
+
+			for(size_t i = 0; i < lines; ++i)
+			{
+				status << "  " << golden[i] << "\n";
+			}
+		}
+
+		return matched;
+	}
+
+	/*! The lowest active lane adds the population count of the ballot */
+	bool TestWarpAggregatedAtomics::_testIncrement()
+	{
+		static const char* golden[] = {
+			"setp.eq.u32 %p0, 0, 0;",
+			"vote.ballot.b32 %r1, %p0;",
+			"mov.u32 %r2, %lanemask_lt;",
+			"and.b32 %r3, %r1, %r2;",
+			"setp.eq.and.b32 %p4, %r3, 0, %p0;",
+			"popc.b32 %r5, %r1;",
+			"cvt.u64.u32 %r6, %r5;",
+			"@%p4 atom.global.add.u64 %r7, [%r8 + 24], %r6;",
+			0
+		};
+
+		return _compare("increment",
+			_translate("atomicIncrement", 3, false), golden);
+	}
+
+	/*! A guarded increment only counts the lanes the guard enables, the
+		guard is materialized so that disabled lanes vote false */
+	bool TestWarpAggregatedAtomics::_testGuardedIncrement()
+	{
+		static const char* golden[] = {
+			"setp.ne.u32 %p0, 0, 0;",
+			"@%guard setp.eq.u32 %p0, 0, 0;",
+			"vote.ballot.b32 %r1, %p0;",
+			"mov.u32 %r2, %lanemask_lt;",
+			"and.b32 %r3, %r1, %r2;",
+			"setp.eq.and.b32 %p4, %r3, 0, %p0;",
+			"popc.b32 %r5, %r1;",
+			"cvt.u64.u32 %r6, %r5;",
+			"@%p4 atom.global.add.u64 %r7, [%r8 + 8], %r6;",
+			0
+		};
+
+		return _compare("guarded increment",
+			_translate("atomicIncrement", 1, true), golden);
+	}
+
+	/*! Full warps reduce the values with a shfl.bfly tree over the two
+		halves of each value and lane 0 issues one atomic, the lanes of a
+		partial warp keep their own atomics */
+	bool TestWarpAggregatedAtomics::_testAdd()
+	{
+		static const char* golden[] = {
+			"setp.eq.u32 %p0, 0, 0;",
+			"vote.ballot.b32 %r1, %p0;",
+			"setp.eq.b32 %p2, %r1, 4294967295;",
+			"setp.ne.and.b32 %p3, %r1, 4294967295, %p0;",
+			"mov.u32 %r4, %lanemask_lt;",
+			"setp.eq.and.u32 %p5, %r4, 0, %p2;",
+			"selp.u64 %r6, %r7, 0, %p0;",
+			"cvt.u32.u64 %r8, %r6;",
+			"shr.u64 %r9, %r6, 32;",
+			"cvt.u32.u64 %r10, %r9;",
+			"shfl.bfly.b32 %r11, %r8, 16, 31;",
+			"shfl.bfly.b32 %r12, %r10, 16, 31;",
+			"cvt.u64.u32 %r13, %r11;",
+			"cvt.u64.u32 %r14, %r12;",
+			"shl.b64 %r15, %r14, 32;",
+			"or.b64 %r16, %r13, %r15;",
+			"add.u64 %r17, %r6, %r16;",
+			"cvt.u32.u64 %r18, %r17;",
+			"shr.u64 %r19, %r17, 32;",
+			"cvt.u32.u64 %r20, %r19;",
+			"shfl.bfly.b32 %r21, %r18, 8, 31;",
+			"shfl.bfly.b32 %r22, %r20, 8, 31;",
+			"cvt.u64.u32 %r23, %r21;",
+			"cvt.u64.u32 %r24, %r22;",
+			"shl.b64 %r25, %r24, 32;",
+			"or.b64 %r26, %r23, %r25;",
+			"add.u64 %r27, %r17, %r26;",
+			"cvt.u32.u64 %r28, %r27;",
+			"shr.u64 %r29, %r27, 32;",
+			"cvt.u32.u64 %r30, %r29;",
+			"shfl.bfly.b32 %r31, %r28, 4, 31;",
+			"shfl.bfly.b32 %r32, %r30, 4, 31;",
+			"cvt.u64.u32 %r33, %r31;",
+			"cvt.u64.u32 %r34, %r32;",
+			"shl.b64 %r35, %r34, 32;",
+			"or.b64 %r36, %r33, %r35;",
+			"add.u64 %r37, %r27, %r36;",
+			"cvt.u32.u64 %r38, %r37;",
+			"shr.u64 %r39, %r37, 32;",
+			"cvt.u32.u64 %r40, %r39;",
+			"shfl.bfly.b32 %r41, %r38, 2, 31;",
+			"shfl.bfly.b32 %r42, %r40, 2, 31;",
+			"cvt.u64.u32 %r43, %r41;",
+			"cvt.u64.u32 %r44, %r42;",
+			"shl.b64 %r45, %r44, 32;",
+			"or.b64 %r46, %r43, %r45;",
+			"add.u64 %r47, %r37, %r46;",
+			"cvt.u32.u64 %r48, %r47;",
+			"shr.u64 %r49, %r47, 32;",
+			"cvt.u32.u64 %r50, %r49;",
+			"shfl.bfly.b32 %r51, %r48, 1, 31;",
+			"shfl.bfly.b32 %r52, %r50, 1, 31;",
+			"cvt.u64.u32 %r53, %r51;",
+			"cvt.u64.u32 %r54, %r52;",
+			"shl.b64 %r55, %r54, 32;",
+			"or.b64 %r56, %r53, %r55;",
+			"add.u64 %r57, %r47, %r56;",
+			"@%p5 atom.global.add.u64 %r58, [%r59], %r57;",
+			"@%p3 atom.global.add.u64 %r58, [%r59], %r7;",
+			0
+		};
+
+		return _compare("add", _translate("atomicAdd", 0, false), golden);
+	}
+
+	/*! Without aggregation every lane issues its own atomic */
+	bool TestWarpAggregatedAtomics::_testPerLane()
+	{
+		static const char* golden[] = {
+			"atom.global.add.u64 %r0, [%r1 + 16], 1;",
+			0
+		};
+
+		CToPTXTranslator::translator().warpAggregatedAtomics = false;
+
+		StringVector result = _translate("atomicIncrement", 2, false);
+
+		CToPTXTranslator::translator().warpAggregatedAtomics = true;
+
+		return _compare("per lane increment", result, golden);
+	}
+
+	bool TestWarpAggregatedAtomics::doTest()
+	{
+		bool passed = _testIncrement() && _testGuardedIncrement()
+			&& _testAdd() && _testPerLane();
+
+		if(passed)
+		{
+			status << "The ballot/popc increment, the shfl.bfly add tree, "
+				<< "the partial warp fallback and the per lane atomics "
+				<< "matched their golden PTX.\n";
+		}
+
+		return passed;
+	}
+
+	TestWarpAggregatedAtomics::TestWarpAggregatedAtomics()
+	{
+		name = "TestWarpAggregatedAtomics";
+
+		description = "Translates atomicIncrement, a guarded ";
+		description += "atomicIncrement and atomicAdd from the COD ";
+		description += "instructions of a call, and atomicIncrement with ";
+		description += "aggregation disabled. The PTX of each call, with ";
+		description += "registers renamed in order of appearance, must ";
+		description += "match a golden listing.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestWarpAggregatedAtomics test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
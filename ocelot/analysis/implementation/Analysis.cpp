@@ -9,6 +9,9 @@
 
 #include <ocelot/transforms/interface/PassManager.h>
 
+// Hydrazine Includes
+#include <hydrazine/interface/debug.h>
+
 // Standard Library Includes
 #include <cassert>
 
@@ -38,6 +41,16 @@ KernelAnalysis::KernelAnalysis(const std::string& n,
 
 }
 
+bool KernelAnalysis::detach()
+{
+	return false;
+}
+
+void KernelAnalysis::attach(ir::IRKernel&)
+{
+	assertM(false, "Analysis " << name << " cannot be attached to a kernel.");
+}
+
 ModuleAnalysis::ModuleAnalysis(const std::string& n,
 	const StringVector& r)
 : Analysis(n, r)
@@ -648,6 +648,65 @@ void DataflowGraph::analyze(ir::IRKernel& kernel)
 	}
 }
 
+bool DataflowGraph::detach()
+{
+	/* renamed registers are written back to the kernel */
+	if( _ssa ) return false;
+
+	_blockIds.clear();
+	
+	for( iterator block = begin(); block != end(); ++block )
+	{
+		_blockIds.push_back( block->id() );
+		block->_instructions.clear();
+		block->_block = ir::ControlFlowGraph::iterator();
+	}
+	
+	_cfg = 0;
+	
+	return true;
+}
+
+void DataflowGraph::attach( ir::IRKernel& kernel )
+{
+	report( "Attaching to kernel " << kernel.name );
+
+	_cfg = kernel.cfg();
+	
+	typedef std::unordered_map< ir::ControlFlowGraph::BasicBlock::Id, 
+		ir::ControlFlowGraph::iterator > IdMap;
+	IdMap map;
+	
+	for( ir::ControlFlowGraph::iterator block = _cfg->begin(); 
+		block != _cfg->end(); ++block )
+	{
+		map.insert( std::make_pair( block->id, block ) );
+	}
+	
+	assert( _blockIds.size() == _blocks.size() );
+	
+	std::vector< ir::ControlFlowGraph::BasicBlock::Id >::const_iterator 
+		id = _blockIds.begin();
+	for( iterator block = begin(); block != end(); ++block, ++id )
+	{
+		IdMap::iterator mapping = map.find( *id );
+		assert( mapping != map.end() );
+		
+		block->_block = mapping->second;
+		
+		for( ir::ControlFlowGraph::InstructionList::const_iterator 
+			fi = block->_block->instructions.begin(); 
+			fi != block->_block->instructions.end(); ++fi )
+		{
+			block->_instructions.push_back( convert( 
+				*static_cast< ir::PTXInstruction* >( *fi ) ) );
+			block->_instructions.back().block = block;
+		}
+	}
+	
+	_blockIds.clear();
+}
+
 DataflowGraph::iterator DataflowGraph::begin()
 {
 	return _blocks.begin();
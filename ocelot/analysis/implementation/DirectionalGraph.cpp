@@ -7,14 +7,39 @@
 
 #include <ocelot/analysis/interface/DirectionalGraph.h>
 
+// Standard Library Includes
+#include <algorithm>
+#include <iterator>
+
 namespace analysis
 {
 
+/*!\brief Number of nodes of the compressed graph */
+size_t DirectionalGraph::CompressedGraph::size() const{
+	return ids.size();
+}
+
+/*!\brief Finds the dense index of a node id by bisection */
+unsigned int DirectionalGraph::CompressedGraph::index(
+	const node_type &nodeId ) const{
+	id_vector::const_iterator id = std::lower_bound(ids.begin(),
+		ids.end(), nodeId);
+
+	if( id == ids.end() || *id != nodeId )
+		return invalid;
+
+	return id - ids.begin();
+}
+
+DirectionalGraph::DirectionalGraph() : version(0){
+}
+
 /*!\brief Clears the graph data */
 void DirectionalGraph::clear(){
 	outArrows.clear();
 	inArrows.clear();
 	nodes.clear();
+	version++;
 }
 
 /*!\brief Clears the graph data */
@@ -24,7 +49,8 @@ DirectionalGraph::~DirectionalGraph(){
 
 /*!\brief Insert a node with nodeId. A duplicated ids is ignored */
 void DirectionalGraph::insertNode( const node_type &nodeId ){
-	nodes.insert(nodeId);
+	if( nodes.insert(nodeId).second )
+		version++;
 }
 
 /*!\brief Number of nodes on the graph */
@@ -70,6 +96,8 @@ bool DirectionalGraph::eraseNode( const node_type &nodeId ){
 	if( nodes.find(nodeId) == nodes.end() )
 		return false;
 
+	version++;
+
 	/* 2) Tests If there are outgoing arrows */
 	arrows = outArrows.find(nodeId);
 	if( arrows != outArrows.end() ){
@@ -144,6 +172,8 @@ const DirectionalGraph::node_set DirectionalGraph::getInNodesSet(
  */
 int DirectionalGraph::insertEdge( const node_type &fromNode,
 	const node_type &toNode, const bool createNewNodes ){
+	version++;
+
 	/* 1) Tests if can create new nodes */
 	if( createNewNodes ){
 		/* 1.1) Create ongoing and destination nodes */
@@ -246,6 +276,7 @@ int DirectionalGraph::eraseEdge( const node_type &fromNode,
 	}
 
 	/* 2) Remove edges */
+	version++;
 	outArrows[fromNode].erase(toNode);
 	inArrows[toNode].erase(fromNode);
 
@@ -264,6 +295,63 @@ int DirectionalGraph::eraseEdge( const node_type &fromNode,
 
 	return 0;
 }
+/*!\brief The current version of the nodes and edges */
+unsigned int DirectionalGraph::getVersion() const{
+	return version;
+}
+
+/*!\brief Fills a row array from a map of arrows, walking the map and the
+	sorted ids in step */
+static void compressArrows( const DirectionalGraph::arrows_map &arrows,
+	DirectionalGraph::CompressedGraph &graph,
+	DirectionalGraph::CompressedGraph::index_vector &offsets,
+	DirectionalGraph::CompressedGraph::index_vector &indices ){
+	typedef DirectionalGraph::CompressedGraph CompressedGraph;
+
+	offsets.assign(graph.size() + 1, 0);
+	indices.clear();
+
+	DirectionalGraph::arrows_map::const_iterator row = arrows.begin();
+
+	for( unsigned int i = 0; i < graph.size(); i++ ){
+		offsets[i] = indices.size();
+
+		while( row != arrows.end() && row->first < graph.ids[i] )
+			row++;
+
+		if( row == arrows.end() || row->first != graph.ids[i] )
+			continue;
+
+		DirectionalGraph::const_node_iterator node = row->second.begin();
+
+		for( ; node != row->second.end(); node++ ){
+			unsigned int index = graph.index(*node);
+
+			if( index != CompressedGraph::invalid )
+				indices.push_back(index);
+		}
+	}
+
+	offsets[graph.size()] = indices.size();
+}
+
+/*!\brief Builds the compressed form of the graph
+ * 1) Number the nodes and the extra nodes in the order of their ids
+ * 2) Copy outgoing and incoming arrows into rows of dense indices
+ */
+void DirectionalGraph::compress( CompressedGraph &graph,
+	const node_set &extraNodes ) const{
+	/* 1) Number the nodes and the extra nodes in the order of their ids */
+	graph.ids.clear();
+	graph.ids.reserve(nodes.size() + extraNodes.size());
+	std::set_union(nodes.begin(), nodes.end(), extraNodes.begin(),
+		extraNodes.end(), std::back_inserter(graph.ids));
+
+	/* 2) Copy outgoing and incoming arrows into rows of dense indices */
+	compressArrows(outArrows, graph, graph.outOffsets, graph.outNodes);
+	compressArrows(inArrows, graph, graph.inOffsets, graph.inNodes);
+}
+
 /* Prints graph in dot language */
 std::ostream& DirectionalGraph::print( std::ostream& out ) const{
 	out << "digraph DataFlowGraph{" << std::endl;
@@ -74,6 +74,32 @@ void DivergenceAnalysis::analyze(ir::IRKernel &k)
 	_analyzeControlFlow();
 }
 
+/*! \brief The results refer to registers and block ids only */
+bool DivergenceAnalysis::detach()
+{
+	_kernel = 0;
+	
+	return true;
+}
+
+/*! \brief The conversion to SSA numbers the registers of a kernel with the
+	same content as before, so the divergence graph still applies */
+void DivergenceAnalysis::attach(ir::IRKernel &k)
+{
+	Analysis* dfgAnalysis = getAnalysis("DataflowGraphAnalysis");
+	assert(dfgAnalysis != 0);
+
+	DataflowGraph &dfg = static_cast<DataflowGraph&>(*dfgAnalysis);
+
+	dfg.convertToSSAType(DataflowGraph::Gated);
+
+	assert(dfg.ssa());
+
+	_kernel = &k;
+
+	report("Attaching Divergence analysis to kernel '" << k.name << "'")
+}
+
 /*! \brief Tests if a block ends with a divergent branch
 	instruction (isDivBranchInstr) */
 bool DivergenceAnalysis::isDivBlock(
@@ -98,7 +124,7 @@ bool DivergenceAnalysis::isDivBlock(const DataflowGraph::iterator &block) const
 /*!\brief Tests if all threads enter the block in a convergent state */
 bool DivergenceAnalysis::isEntryDiv(
 	const DataflowGraph::iterator &block ) const {
-	return _notDivergentBlocks.count(block) == 0;
+	return _notDivergentBlocks.count(block->id()) == 0;
 }
 		
 
@@ -218,7 +244,7 @@ void DivergenceAnalysis::_convergenceAnalysis()
 	for (auto block = dfg.begin(); block != dfg.end(); ++block) {
 		if (divergentBlocks.count(block) == 0) {
 			report("  " << block->label() << " is assumed convergent.");
-			_notDivergentBlocks.insert(block);
+			_notDivergentBlocks.insert(block->id());
 		}
 	}
 }
@@ -236,6 +262,17 @@ static bool isDivergenceSource(const ir::PTXOperand& operand)
 	return false;
 }
 
+/*! \brief One operand stands for all reads of a divergent special register,
+	so that the divergence graph keeps no pointers into the kernel */
+static const ir::PTXOperand* canonicalDivergenceSource(
+	const ir::PTXOperand& operand)
+{
+	static const ir::PTXOperand tidX(ir::PTXOperand::tid, ir::PTXOperand::ix);
+	static const ir::PTXOperand laneId(ir::PTXOperand::laneId);
+
+	return operand.special == ir::PTXOperand::laneId ? &laneId : &tidX;
+}
+
 void DivergenceAnalysis::_analyzeDataFlow()
 {
 	Analysis* dfg = getAnalysis("DataflowGraphAnalysis");
@@ -286,13 +323,16 @@ void DivergenceAnalysis::_analyzeDataFlow()
 			if (typeid(ir::PTXInstruction) == typeid(*(ii->i))) {
 				ptxInstruction = static_cast<ir::PTXInstruction*> (ii->i);
 				if (isDivergenceSource(ptxInstruction->a)) {
-					divergenceSources.insert(&ptxInstruction->a);
+					divergenceSources.insert(
+						canonicalDivergenceSource(ptxInstruction->a));
 				}
 				if (isDivergenceSource(ptxInstruction->b)) {
-					divergenceSources.insert(&ptxInstruction->b);
+					divergenceSources.insert(
+						canonicalDivergenceSource(ptxInstruction->b));
 				}
 				if (isDivergenceSource(ptxInstruction->c)) {
-					divergenceSources.insert(&ptxInstruction->c);
+					divergenceSources.insert(
+						canonicalDivergenceSource(ptxInstruction->c));
 				}
 
 				if (ptxInstruction->opcode == ir::PTXInstruction::Atom){
@@ -11,6 +11,10 @@
 // Hydrazine Includes
 #include <hydrazine/interface/debug.h>
 
+// Standard Library Includes
+#include <algorithm>
+#include <vector>
+
 // Preprocessor Macros
 #ifdef REPORT_BASE
 #undef REPORT_BASE
@@ -28,6 +32,7 @@ void DivergenceGraph::clear(){
 	_specials.clear();
 	_divergenceSources.clear();
 	_convergenceSources.clear();
+	_insertedArrows.clear();
 	_upToDate = true;
 }
 
@@ -36,6 +41,7 @@ void DivergenceGraph::insertSpecialSource( const ir::PTXOperand* tid ){
 	_upToDate = false;
 	if( _specials.find(tid) == _specials.end() ){
 		_specials.insert(std::make_pair(tid, node_set()));
+		version++;
 	}
 }
 
@@ -43,6 +49,7 @@ void DivergenceGraph::insertSpecialSource( const ir::PTXOperand* tid ){
 void DivergenceGraph::eraseSpecialSource( const ir::PTXOperand* tid ){
 	_upToDate = false;
 	_specials.erase(tid);
+	version++;
 }
 
 /*!\brief Define a node as being divergent,
@@ -56,6 +63,7 @@ void DivergenceGraph::setAsDiv(const node_type &node)
 	if (nodes.find(node) == nodes.end()) {
 		_upToDate = false;
 		nodes.insert(node);
+		version++;
 	}
 }
 
@@ -67,6 +75,7 @@ void DivergenceGraph::forceConvergent(const node_type &node) {
 	if (nodes.find(node) == nodes.end()) {
 		_upToDate = false;
 		nodes.insert(node);
+		version++;
 	}
 }
 
@@ -97,12 +106,48 @@ bool DivergenceGraph::eraseNode( const node_iterator &node ){
 	return DirectionalGraph::eraseNode(*node);
 }
 
+/*!\brief Tests if there is an arrow from a node to another */
+static bool hasArrow( const DirectionalGraph::arrows_map &arrows,
+	const DirectionalGraph::node_type &fromNode,
+	const DirectionalGraph::node_type &toNode ){
+	DirectionalGraph::arrows_map::const_iterator row = arrows.find(fromNode);
+
+	return row != arrows.end() && row->second.count(toNode) != 0;
+}
+
 /*!\brief Inserts a edge[arrow] between two nodes of the graph
-	/ Can create nodes if they don't exist */
+	/ Can create nodes if they don't exist. A new arrow between nodes of
+	the compressed graph is merged into it later instead of building it
+	again, as the control flow analysis inserts arrows one branch at a
+	time and propagates after each */
 int DivergenceGraph::insertEdge( const node_type &fromNode,
 	const node_type &toNode, const bool createNewNodes ){
 	_upToDate = false;
-	return DirectionalGraph::insertEdge(fromNode, toNode, createNewNodes);
+
+	bool compressed = _compressedVersion == version;
+	bool inserted = !hasArrow(outArrows, fromNode, toNode);
+
+	int result = DirectionalGraph::insertEdge(fromNode, toNode,
+		createNewNodes);
+
+	if( !compressed || !hasArrow(outArrows, fromNode, toNode) ){
+		return result;
+	}
+
+	unsigned int from = _compressed.index(fromNode);
+	unsigned int to = _compressed.index(toNode);
+
+	if( from == CompressedGraph::invalid || to == CompressedGraph::invalid ){
+		return result;
+	}
+
+	if( inserted ){
+		_insertedArrows.push_back(std::make_pair(from, to));
+	}
+
+	_compressedVersion = version;
+
+	return result;
 }
 
 /*!\brief Inserts a edge[arrow] between two nodes of the graph
@@ -116,6 +161,7 @@ int DivergenceGraph::insertEdge( const ir::PTXOperand* origin,
 	}
 
 	_specials[origin].insert(toNode);
+	version++;
 	return 0;
 }
 
@@ -178,7 +224,86 @@ size_t DivergenceGraph::divNodesCount() const{
 	return _divergentNodes.size();
 }
 
+/*!\brief Marks a node divergent and queues it, if it was not already */
+static void markDivergent( std::vector<bool> &divergent,
+	std::vector<unsigned int> &worklist, unsigned int node ){
+	if( node == DirectionalGraph::CompressedGraph::invalid
+		|| divergent[node] ){
+		return;
+	}
+
+	divergent[node] = true;
+	worklist.push_back(node);
+}
+
+/*!\brief Merges arrows into the rows of a compressed graph, each row
+	stays sorted. Arrows go from first to second, or the other way if
+	reversed */
+static void mergeArrows(
+	DirectionalGraph::CompressedGraph::index_vector &offsets,
+	DirectionalGraph::CompressedGraph::index_vector &indices,
+	std::vector<std::pair<unsigned int, unsigned int> > arrows,
+	bool reversed ){
+	typedef std::vector<std::pair<unsigned int, unsigned int> > arrow_vector;
+
+	if( reversed ){
+		for( arrow_vector::iterator arrow = arrows.begin();
+			arrow != arrows.end(); arrow++ ){
+			std::swap(arrow->first, arrow->second);
+		}
+	}
+
+	std::sort(arrows.begin(), arrows.end());
+
+	DirectionalGraph::CompressedGraph::index_vector merged;
+	merged.reserve(indices.size() + arrows.size());
+
+	arrow_vector::const_iterator arrow = arrows.begin();
+	unsigned int begin = offsets[0];
+
+	for( unsigned int row = 0; row + 1 < offsets.size(); row++ ){
+		unsigned int end = offsets[row + 1];
+		offsets[row] = merged.size();
+
+		for( unsigned int edge = begin; edge != end; edge++ ){
+			for( ; arrow != arrows.end() && arrow->first == row
+				&& arrow->second < indices[edge]; arrow++ ){
+				merged.push_back(arrow->second);
+			}
+
+			merged.push_back(indices[edge]);
+		}
+
+		for( ; arrow != arrows.end() && arrow->first == row; arrow++ ){
+			merged.push_back(arrow->second);
+		}
+
+		begin = end;
+	}
+
+	offsets.back() = merged.size();
+	indices.swap(merged);
+}
+
+/*!\brief Tests if no node in a row of the compressed graph is divergent */
+static bool allConvergent( const std::vector<bool> &divergent,
+	const DirectionalGraph::CompressedGraph::index_vector &offsets,
+	const DirectionalGraph::CompressedGraph::index_vector &indices,
+	unsigned int node ){
+	for( unsigned int edge = offsets[node]; edge != offsets[node + 1];
+		edge++ ){
+		if( divergent[indices[edge]] ){
+			return false;
+		}
+	}
+
+	return true;
+}
+
 /*!\brief Computes divergence spread
+ * 0) Rebuild the compressed graph if nodes or edges changed, or merge
+ 	the edges inserted since, every node is then a dense index and
+ 	divergence a bit per index
  * 1) Clear preview divergent nodes list
  * 2) Set all nodes that are directly dependent of a divergent
  	source {tidX, tidY, tidZ and laneid } as new divergent nodes
@@ -190,17 +315,58 @@ size_t DivergenceGraph::divNodesCount() const{
  * 4.1.1) Go to step 4 after step 4.3 until there are new divergent nodes
  * 4.2) Insert the node to the divergent nodes list
  * 4.3) Remove the node from the new divergent list
+ * 6) Copy the divergent bits back into the divergent nodes list
  */
 void DivergenceGraph::computeDivergence(){
 	report("Computing divergence");
-	
+
 	if( _upToDate ){
 		report(" already up to date.");
 		return;
 	}
+
+	/* 0) Rebuild the compressed graph if nodes or edges changed, the
+		destinations of special registers and the sources need not be
+		nodes of the graph */
+	if( _compressedVersion != version ){
+		node_set extraNodes(_divergenceSources);
+		extraNodes.insert(_convergenceSources.begin(),
+			_convergenceSources.end());
+
+		std::map<const ir::PTXOperand*, node_set>::const_iterator
+			special = _specials.begin();
+
+		for( ; special != _specials.end(); special++ ){
+			extraNodes.insert(special->second.begin(),
+				special->second.end());
+		}
+
+		compress(_compressed, extraNodes);
+		_compressedVersion = version;
+		_insertedArrows.clear();
+
+		report(" Compressed " << _compressed.size() << " nodes, "
+			<< _compressed.outNodes.size() << " edges.");
+	}else if( !_insertedArrows.empty() ){
+		mergeArrows(_compressed.outOffsets, _compressed.outNodes,
+			_insertedArrows, false);
+		mergeArrows(_compressed.inOffsets, _compressed.inNodes,
+			_insertedArrows, true);
+
+		report(" Merged " << _insertedArrows.size()
+			<< " inserted edges into the compressed graph.");
+		_insertedArrows.clear();
+	}
+
+	const CompressedGraph::index_vector &outOffsets = _compressed.outOffsets;
+	const CompressedGraph::index_vector &outNodes = _compressed.outNodes;
+	const CompressedGraph::index_vector &inOffsets = _compressed.inOffsets;
+	const CompressedGraph::index_vector &inNodes = _compressed.inNodes;
+
 	/* 1) Clear preview divergent nodes list */
 	_divergentNodes.clear();
-	node_set newDivergenceNodes;
+	std::vector<bool> divergent(_compressed.size(), false);
+	std::vector<unsigned int> newDivergenceNodes;
 
 	/* 2) Set all nodes that are directly dependent of a divergent
 		source {tidX and laneid } as divergent */
@@ -214,12 +380,12 @@ void DivergenceGraph::computeDivergence(){
 			if( isDivSource(divergence->first) ){
 				const_node_iterator node = divergence->second.begin();
 				const_node_iterator endNode = divergence->second.end();
-				
-				report(" Node r" << *node
-					<< " is a special divergent register.");
 
 				for( ; node != endNode; node++ ){
-					newDivergenceNodes.insert(*node);
+					report(" Node r" << *node
+						<< " is a special divergent register.");
+					markDivergent(divergent, newDivergenceNodes,
+						_compressed.index(*node));
 				}
 			}
 		}
@@ -232,39 +398,32 @@ void DivergenceGraph::computeDivergence(){
 		node_iterator divergenceEnd = _divergenceSources.end();
 
 		for( ; divergence != divergenceEnd; divergence++ ){
-			newDivergenceNodes.insert(*divergence);
+			markDivergent(divergent, newDivergenceNodes,
+				_compressed.index(*divergence));
 			report(" Node r" << *divergence << " is a new divergent register.");
 		}
 	}
 
-	/* 4) For each new divergent nodes */
+	/* 4) For each new divergent nodes, the bit of a node is set when it
+		is queued so every node is visited at most once */
 	report(" Propagating divergence");
-	while( newDivergenceNodes.size() != 0 ){
-		node_type originNode = *newDivergenceNodes.begin();
-		node_set newReachedNodes = getOutNodesSet(originNode);
-		node_iterator current = newReachedNodes.begin();
-		node_iterator last = newReachedNodes.end();
+	while( !newDivergenceNodes.empty() ){
+		unsigned int originNode = newDivergenceNodes.back();
+		newDivergenceNodes.pop_back();
 
 		/* 4.1) Set all non divergent nodes that depend directly on
 			the divergent node as new divergent nodes */
-		for( ; current != last; current++ ){
-			if( !isDivNode(*current) ){
-				/* 4.1.1) Go to step 4 after step 4.3 until there are
-					new divergent nodes */
-				report("  propagated from r" << originNode
-					<< " -> r" << *current);
-				newDivergenceNodes.insert(*current);
-			}
+		for( unsigned int edge = outOffsets[originNode];
+			edge != outOffsets[originNode + 1]; edge++ ){
+			report("  propagated from r" << _compressed.ids[originNode]
+				<< " -> r" << _compressed.ids[outNodes[edge]]);
+			markDivergent(divergent, newDivergenceNodes, outNodes[edge]);
 		}
-
-		/* 4.2) Insert the node to the divergent nodes list */
-		_divergentNodes.insert(originNode);
-		/* 4.3) Remove the node from the new divergent list */
-		newDivergenceNodes.erase(originNode);
 	}
-	
-	/* 5) propagate convergence from sources */
-	node_set notDivergenceNodes;
+
+	/* 5) propagate convergence from sources, in the order of the node ids
+		as the result depends on it */
+	std::set<unsigned int> notDivergenceNodes;
 
 	{
 		/* 5.1) Set all nodes that are explicitly defined as convergence
@@ -274,85 +433,68 @@ void DivergenceGraph::computeDivergence(){
 		node_iterator convergenceEnd = _convergenceSources.end();
 
 		for( ; convergence != convergenceEnd; convergence++ ){
-			notDivergenceNodes.insert(*convergence);
-			node_iterator divergence = _divergentNodes.find(*convergence);
-			
-			if (divergence != _divergentNodes.end()) {
-				notDivergenceNodes.insert(*convergence);
+			unsigned int node = _compressed.index(*convergence);
+			assert(node != CompressedGraph::invalid);
+
+			notDivergenceNodes.insert(node);
+
+			if( divergent[node] ){
 				report(" Node r" << *convergence <<
 					" is a new convergent register.");
 			}
 		}
 	}
-	
+
 	report(" Propagating convergence");
 	while( notDivergenceNodes.size() != 0 ) {
-		node_type originNode = *notDivergenceNodes.begin();
-		
-		_divergentNodes.erase(originNode);
-		notDivergenceNodes.erase(originNode);
+		unsigned int originNode = *notDivergenceNodes.begin();
+
+		divergent[originNode] = false;
+		notDivergenceNodes.erase(notDivergenceNodes.begin());
 
 		/* 5.2) Propagate forward */
-		node_set newReachedNodes = getOutNodesSet(originNode);
-		node_iterator current = newReachedNodes.begin();
-		node_iterator last = newReachedNodes.end();
-		for( ; current != last; current++ ) {
-			if( isDivNode(*current) ) {
-				
-				node_set predecessorNodes = getInNodesSet(*current);
-				
-				bool allConvergent = true;
-				
-				node_iterator predecessor = predecessorNodes.begin();
-				node_iterator lastPredecessor = predecessorNodes.end();
-
-				for( ; predecessor != lastPredecessor; predecessor++ ) {
-					if (isDivNode(*predecessor)) {
-						allConvergent = false;
-						break;
-					}
-				}
-				
-				if (!allConvergent) continue;
-				
-				report("  propagated forward from r" << originNode
-					<< " -> r" << *current);
-				notDivergenceNodes.insert(*current);
+		for( unsigned int edge = outOffsets[originNode];
+			edge != outOffsets[originNode + 1]; edge++ ) {
+			unsigned int current = outNodes[edge];
+
+			if( !divergent[current] ) continue;
+
+			if( !allConvergent(divergent, inOffsets, inNodes, current) ) {
+				continue;
 			}
+
+			report("  propagated forward from r"
+				<< _compressed.ids[originNode]
+				<< " -> r" << _compressed.ids[current]);
+			notDivergenceNodes.insert(current);
 		}
-		
+
 		/* 5.3) Propagate backward */
-		newReachedNodes = getInNodesSet(originNode);
-		current         = newReachedNodes.begin();
-		last            = newReachedNodes.end();
-		
-		for( ; current != last; current++ ) {
-			if( isDivNode(*current) ) {
-				
-				node_set successorNodes = getOutNodesSet(*current);
-				
-				bool allConvergent = true;
-				
-				node_iterator successor     = successorNodes.begin();
-				node_iterator lastSuccessor = successorNodes.end();
-
-				for( ; successor != lastSuccessor; successor++ ) {
-					if (isDivNode(*successor)) {
-						allConvergent = false;
-						break;
-					}
-				}
-				
-				report("  propagated backward from r" << originNode
-					<< " -> r" << *current);
-				
-				if (!allConvergent) {
-					_divergentNodes.erase(*current);
-					continue;
-				}
-				
-				notDivergenceNodes.insert(*current);
+		for( unsigned int edge = inOffsets[originNode];
+			edge != inOffsets[originNode + 1]; edge++ ) {
+			unsigned int current = inNodes[edge];
+
+			if( !divergent[current] ) continue;
+
+			report("  propagated backward from r"
+				<< _compressed.ids[originNode]
+				<< " -> r" << _compressed.ids[current]);
+
+			if( !allConvergent(divergent, outOffsets, outNodes, current) ) {
+				divergent[current] = false;
+				continue;
 			}
+
+			notDivergenceNodes.insert(current);
+		}
+	}
+
+	/* 6) Copy the divergent bits back into the divergent nodes list, in
+		order so that every insertion is at the end */
+	for( unsigned int node = 0; node != divergent.size(); node++ ) {
+		if( divergent[node] ) {
+			_divergentNodes.insert(_divergentNodes.end(),
+				_compressed.ids[node]);
 		}
 	}
 
@@ -0,0 +1,253 @@
+/*! \file DominatorEngine.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the DominatorEngine class
+*/
+
+// Ocelot Includes
+#include <ocelot/analysis/interface/DominatorEngine.h>
+
+// Hydrazine Includes
+#include <hydrazine/interface/debug.h>
+
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+namespace analysis
+{
+
+DominatorEngine::DominatorEngine(int nodes)
+: _nodes(nodes) {
+}
+
+void DominatorEngine::addEdge(int from, int to) {
+	assert(from >= 0 && from < _nodes);
+	assert(to >= 0 && to < _nodes);
+
+	_edges.push_back(Edge(from, to));
+}
+
+void DominatorEngine::addBlocks(ir::ControlFlowGraph& cfg, bool reverse) {
+	blocks.clear();
+	nodes.clear();
+	_edges.clear();
+
+	for (ir::ControlFlowGraph::iterator block = cfg.begin();
+		block != cfg.end(); ++block) {
+		nodes[block] = blocks.size();
+		blocks.push_back(block);
+	}
+
+	_nodes = blocks.size();
+
+	for (int n = 0; n < _nodes; n++) {
+		const ir::ControlFlowGraph::BlockPointerVector& neighbors = reverse
+			? blocks[n]->predecessors : blocks[n]->successors;
+
+		for (ir::ControlFlowGraph::const_pointer_iterator
+			neighbor = neighbors.begin(); neighbor != neighbors.end();
+			++neighbor) {
+			addEdge(n, nodes[*neighbor]);
+		}
+	}
+
+	report("Added " << _nodes << " blocks and " << _edges.size()
+		<< " edges");
+}
+
+/*! Computes the dominator tree with the semi-NCA algorithm described in
+	"Linear-Time Algorithms for Dominators and Related Problems" by
+		Loukas Georgiadis
+
+	Semidominators are found as in Lengauer-Tarjan, with path compression
+	but without balancing. Each immediate dominator is then the nearest
+	common ancestor in the partial dominator tree of the parent and the
+	semidominator of a node, found by walking up from the parent.
+ */
+void DominatorEngine::computeDominators(int root) {
+	_compress();
+
+	order.clear();
+	position.assign(_nodes, -1);
+	idom.clear();
+	frontiers.clear();
+
+	if (_nodes == 0) return;
+
+	assert(root >= 0 && root < _nodes);
+
+	// number the nodes in pre-order and post-order without recursion
+	IndexVector preorder(_nodes, -1);
+	IndexVector vertex;
+	IndexVector parent;
+	IndexVector stack;
+	IndexVector cursor;
+
+	preorder[root] = 0;
+	vertex.push_back(root);
+	parent.push_back(0);
+	stack.push_back(root);
+	cursor.push_back(_outOffsets[root]);
+
+	while (!stack.empty()) {
+		int node = stack.back();
+
+		if (cursor.back() != _outOffsets[node + 1]) {
+			int successor = _successors[cursor.back()++];
+
+			if (preorder[successor] != -1) continue;
+
+			preorder[successor] = vertex.size();
+			parent.push_back(preorder[node]);
+			vertex.push_back(successor);
+			stack.push_back(successor);
+			cursor.push_back(_outOffsets[successor]);
+		}
+		else {
+			position[node] = order.size();
+			order.push_back(node);
+			stack.pop_back();
+			cursor.pop_back();
+		}
+	}
+
+	int reached = vertex.size();
+
+	report("Reached " << reached << " of " << _nodes << " nodes");
+
+	// semidominators, in reverse pre-order
+	_semi.resize(reached);
+	_label.resize(reached);
+	_ancestor.assign(reached, -1);
+
+	for (int i = 0; i < reached; i++) {
+		_semi[i] = i;
+		_label[i] = i;
+	}
+
+	for (int i = reached - 1; i > 0; i--) {
+		int node = vertex[i];
+
+		for (int edge = _inOffsets[node]; edge != _inOffsets[node + 1];
+			edge++) {
+			int p = preorder[_predecessors[edge]];
+			if (p == -1) continue;
+
+			int u = _eval(p);
+			if (_semi[u] < _semi[i]) {
+				_semi[i] = _semi[u];
+			}
+		}
+
+		_ancestor[i] = parent[i];
+	}
+
+	// immediate dominators, in pre-order
+	IndexVector dominator(parent);
+
+	for (int i = 1; i < reached; i++) {
+		while (dominator[i] > _semi[i]) {
+			dominator[i] = dominator[dominator[i]];
+		}
+	}
+
+	idom.resize(reached);
+	for (int i = 0; i < reached; i++) {
+		idom[position[vertex[i]]] = position[vertex[dominator[i]]];
+	}
+}
+
+/*! Computes dominance frontiers using the method described in
+	"A simple and fast dominance algorithm" by
+		Keith D. Cooper, Timothy J. Harvey, and Ken Kennedy
+ */
+void DominatorEngine::computeFrontiers() {
+	frontiers.assign(order.size(), IndexVector());
+
+	for (int n = 0; n < (int)order.size(); n++) {
+		int node = order[n];
+
+		bool root = idom[n] == n;
+
+		if (_inOffsets[node + 1] - _inOffsets[node] < 2 && !root) continue;
+
+		for (int edge = _inOffsets[node]; edge != _inOffsets[node + 1];
+			edge++) {
+			int runner = position[_predecessors[edge]];
+			if (runner == -1) continue;
+
+			// nothing strictly dominates the root, so the walk includes it
+			while (root || runner != idom[n]) {
+				// runs for the same node are adjacent
+				if (frontiers[runner].empty() || frontiers[runner].back() != n) {
+					frontiers[runner].push_back(n);
+				}
+				if (idom[runner] == runner) break;
+				runner = idom[runner];
+			}
+		}
+	}
+}
+
+void DominatorEngine::_compress() {
+	_outOffsets.assign(_nodes + 1, 0);
+	_inOffsets.assign(_nodes + 1, 0);
+
+	for (EdgeVector::const_iterator edge = _edges.begin();
+		edge != _edges.end(); ++edge) {
+		_outOffsets[edge->first + 1]++;
+		_inOffsets[edge->second + 1]++;
+	}
+
+	for (int n = 0; n < _nodes; n++) {
+		_outOffsets[n + 1] += _outOffsets[n];
+		_inOffsets[n + 1] += _inOffsets[n];
+	}
+
+	_successors.resize(_edges.size());
+	_predecessors.resize(_edges.size());
+
+	// keep the order in which edges were added
+	IndexVector out(_outOffsets.begin(), _outOffsets.end() - 1);
+	IndexVector in(_inOffsets.begin(), _inOffsets.end() - 1);
+
+	for (EdgeVector::const_iterator edge = _edges.begin();
+		edge != _edges.end(); ++edge) {
+		_successors[out[edge->first]++] = edge->second;
+		_predecessors[in[edge->second]++] = edge->first;
+	}
+}
+
+int DominatorEngine::_eval(int v) {
+	if (_ancestor[v] == -1) return v;
+
+	_compressPath(v);
+
+	return _label[v];
+}
+
+void DominatorEngine::_compressPath(int v) {
+	_pathStack.clear();
+
+	for (int u = v; _ancestor[_ancestor[u]] != -1; u = _ancestor[u]) {
+		_pathStack.push_back(u);
+	}
+
+	// from the top of the path down, as the recursive form would
+	while (!_pathStack.empty()) {
+		int u = _pathStack.back();
+		int a = _ancestor[u];
+		_pathStack.pop_back();
+
+		if (_semi[_label[a]] < _semi[_label[u]]) {
+			_label[u] = _label[a];
+		}
+		_ancestor[u] = _ancestor[a];
+	}
+}
+
+}
+
@@ -8,6 +8,7 @@
 
 // Ocelot Includes
 #include <ocelot/analysis/interface/DominatorTree.h>
+#include <ocelot/analysis/interface/DominatorEngine.h>
 #include <ocelot/ir/interface/IRKernel.h>
 #include <ocelot/ir/interface/Instruction.h>
 
@@ -15,6 +16,9 @@
 #include <hydrazine/interface/string.h>
 #include <hydrazine/interface/debug.h>
 
+// Standard Library Includes
+#include <unordered_map>
+
 #ifdef REPORT_BASE
 #undef REPORT_BASE
 #endif
@@ -35,21 +39,68 @@ void DominatorTree::analyze(ir::IRKernel& kernel) {
 	
 	report("Building dominator tree.");
 	cfg = kernel.cfg();
-	report(" Starting with reverse post order sequence");
-	// form a vector of the basic blocks in reverse post-order
-	ir::ControlFlowGraph::BlockPointerVector 
-		post_order = cfg->topological_sequence();
-	
-	ir::ControlFlowGraph::reverse_pointer_iterator it = post_order.rbegin();
-	ir::ControlFlowGraph::reverse_pointer_iterator end = post_order.rend();
-	for (; it != end; ++it) {
-		blocks.push_back(*it);
-		blocksToIndex[*it] = (int)blocks.size()-1;
-		i_dom.push_back(-1);
-		report("  " << (*it)->label());
+
+	blocks.clear();
+	blocksToIndex.clear();
+	
+	DominatorEngine engine;
+	engine.addBlocks(*cfg, false);
+	
+	report(" Computing tree");
+	engine.computeDominators(engine.nodes[cfg->get_entry_block()]);
+	engine.computeFrontiers();
+
+	report(" Blocks in post order sequence");
+	// form a vector of the reachable basic blocks in post-order
+	for (int n = 0; n < (int)engine.order.size(); n++) {
+		blocks.push_back(engine.blocks[engine.order[n]]);
+		blocksToIndex[blocks.back()] = n;
+		report("  " << blocks.back()->label());
 	}
 	
-	computeDT();
+	i_dom.swap(engine.idom);
+	frontiers.swap(engine.frontiers);
+
+	dominated.assign(blocks.size(), std::vector<int>());
+	for (int n = 0; n < (int)blocks.size(); n++) {
+		if (i_dom[n] >= 0) {
+			dominated[i_dom[n]].push_back(n);
+		}
+	}
+}
+
+bool DominatorTree::detach() {
+	_blockIds.clear();
+	for (int n = 0; n < (int)blocks.size(); n++) {
+		_blockIds.push_back(blocks[n]->id);
+	}
+
+	blocks.clear();
+	blocksToIndex.clear();
+	cfg = 0;
+
+	return true;
+}
+
+void DominatorTree::attach(ir::IRKernel& kernel) {
+	report("Attaching dominator tree to kernel " << kernel.name);
+	cfg = kernel.cfg();
+
+	std::unordered_map<ir::ControlFlowGraph::BasicBlock::Id,
+		ir::ControlFlowGraph::iterator> idsToBlocks;
+	for (auto block = cfg->begin(); block != cfg->end(); ++block) {
+		idsToBlocks.insert(std::make_pair(block->id, block));
+	}
+
+	for (int n = 0; n < (int)_blockIds.size(); n++) {
+		auto block = idsToBlocks.find(_blockIds[n]);
+		assert(block != idsToBlocks.end());
+
+		blocks.push_back(block->second);
+		blocksToIndex[blocks.back()] = n;
+	}
+
+	_blockIds.clear();
 }
 
 std::ostream& DominatorTree::write(std::ostream& out) {
@@ -137,57 +188,19 @@ ir::ControlFlowGraph::BlockPointerVector DominatorTree::getDominatedBlocks(
 	return dominatedBlocks;
 }
 
-/*! Computes the dominator tree from a CFG using algorithm desrcibed in
-	"A simple and fast dominance algorithm" by 
-		Keith D. Cooper, Timothy J. Harvey, and Ken Kennedy
- */
-void DominatorTree::computeDT() {
-	int start_node = blocksToIndex[cfg->get_entry_block()];
-
-	bool changed = true;
-	i_dom[start_node] = start_node;
-
-	while (changed) {
-		changed = false;
-
-		// reverse post-order
-		for (int b_ind = 0; b_ind < (int)blocks.size(); b_ind++) {
-			if (b_ind == start_node) continue;
-			
-			ir::ControlFlowGraph::iterator b = blocks[b_ind];
-			int new_idom = 0;
-			bool processed = false;
-
-			ir::ControlFlowGraph::pointer_iterator 
-				pred_it = b->predecessors.begin();
-			for (; pred_it != b->predecessors.end(); ++pred_it) {
-				int p = blocksToIndex[*pred_it];
-				if (i_dom[p] != -1) {
-					if( !processed ) {
-						new_idom = p;
-						processed = true;
-					}
-					else {
-						new_idom = intersect(p, new_idom);
-					}
-				}
-			}
-			
-			if( processed ) {			
-				if (i_dom[b_ind] != new_idom) {
-					i_dom[b_ind] = new_idom;
-					changed = true;
-				}
-			}
-		}
-	}
-
-	dominated.resize(blocks.size());
-	for (int n = 0; n < (int)blocks.size(); n++) {
-		if (i_dom[n] >= 0) {
-			dominated[i_dom[n]].push_back(n);
-		}
+ir::ControlFlowGraph::BlockPointerVector DominatorTree::getDominanceFrontier(
+	ir::ControlFlowGraph::const_iterator block) {
+	ir::ControlFlowGraph::BlockPointerVector frontierBlocks;
+	
+	int n = blocksToIndex[block];
+	
+	for (auto frontierBlock = frontiers[n].begin();
+		frontierBlock != frontiers[n].end(); ++frontierBlock) {
+		
+		frontierBlocks.push_back(blocks[*frontierBlock]);
 	}
+	
+	return frontierBlocks;
 }
 
 int DominatorTree::intersect(int b1, int b2) const {
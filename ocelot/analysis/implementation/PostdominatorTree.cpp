@@ -10,6 +10,7 @@
 
 // Ocelot Includes
 #include <ocelot/analysis/interface/PostdominatorTree.h>
+#include <ocelot/analysis/interface/DominatorEngine.h>
 #include <ocelot/ir/interface/Instruction.h>
 #include <ocelot/ir/interface/IRKernel.h>
 
@@ -18,7 +19,7 @@
 #include <hydrazine/interface/debug.h>
 
 // Standard Library Includes
-#include <unordered_set>
+#include <unordered_map>
 
 #ifdef REPORT_BASE
 #undef REPORT_BASE
@@ -39,24 +40,38 @@ PostdominatorTree::~PostdominatorTree() {
 }
 
 void PostdominatorTree::analyze(ir::IRKernel& kernel) {
-	// form a vector of the basic blocks in post-order
 	report("Building post-dominator tree.");
 	cfg = kernel.cfg();
-	report(" Starting with post order sequence");
-	// form a vector of the basic blocks in post-order
-	ir::ControlFlowGraph::BlockPointerVector 
-		post_order = cfg->reverse_topological_sequence();
-	
-	ir::ControlFlowGraph::reverse_pointer_iterator it = post_order.rbegin();
-	ir::ControlFlowGraph::reverse_pointer_iterator end = post_order.rend();
-	for (; it != end; ++it) {
-		blocks.push_back(*it);
-		blocksToIndex[*it] = (int)blocks.size()-1;
-		p_dom.push_back(-1);
-		report("  " << (*it)->label());
+
+	blocks.clear();
+	blocksToIndex.clear();
+	
+	// the post-dominator tree is the dominator tree of the reversed CFG
+	DominatorEngine engine;
+	engine.addBlocks(*cfg, true);
+	
+	report(" Computing tree");
+	engine.computeDominators(engine.nodes[cfg->get_exit_block()]);
+	
+	report(" Computing frontiers");
+	engine.computeFrontiers();
+
+	report(" Blocks in post order sequence of the reversed CFG");
+	for (int n = 0; n < (int)engine.order.size(); n++) {
+		blocks.push_back(engine.blocks[engine.order[n]]);
+		blocksToIndex[blocks.back()] = n;
+		report("  " << blocks.back()->label());
 	}
 	
-	computeDT();
+	p_dom.swap(engine.idom);
+	frontiers.swap(engine.frontiers);
+
+	dominated.assign(blocks.size(), IndexVector());
+	for (int n = 0; n < (int)blocks.size(); n++) {
+		if (p_dom[n] >= 0) {
+			dominated[p_dom[n]].push_back(n);
+		}
+	}
 }
 
 bool PostdominatorTree::postDominates(ir::ControlFlowGraph::iterator block, 
@@ -97,89 +112,6 @@ ir::ControlFlowGraph::iterator PostdominatorTree::getCommonPostDominator(
 	return blocks[n];
 }
 
-/*! Computes the dominator tree from a CFG using algorithm __*/
-void PostdominatorTree::computeDT() {
-	int end_node = blocksToIndex[cfg->get_exit_block()];
-
-	bool changed = true;
-	p_dom[end_node] = end_node;
-
-	report( " Computing tree" );
-
-	while (changed) {
-		changed = false;
-
-		// post-order
-		for (int b_ind = 0; b_ind < (int)blocks.size(); b_ind++) {
-			if (b_ind == end_node)  continue;
-
-			ir::ControlFlowGraph::iterator b = blocks[b_ind];
-			assert(!b->successors.empty());
-			int new_pdom = 0;
-			bool processed = false;
-
-			ir::ControlFlowGraph::pointer_iterator 
-				succ_it = b->successors.begin();
-			for (; succ_it != b->successors.end(); ++succ_it) {
-				int p = blocksToIndex[*succ_it];
-				assert(p<(int)p_dom.size());
-				if (p_dom[p] != -1) {
-					if( !processed ) {
-						new_pdom = p;
-						processed = true;
-					}
-					else {
-						new_pdom = intersect(p, new_pdom);
-					}
-				}
-			}
-		
-			if( processed ) {			
-				if (p_dom[b_ind] != new_pdom) {
-					p_dom[b_ind] = new_pdom;
-					changed = true;
-				}
-			}
-		}
-	}
-	
-	dominated.resize(blocks.size());
-	for (int n = 0; n < (int)blocks.size(); n++) {
-		if (p_dom[n] >= 0) {
-			dominated[p_dom[n]].push_back(n);
-		}
-	}
-	
-	report(" Computing frontiers")
-	
-	frontiers.resize(blocks.size());
-	for (int b_ind = 0; b_ind < (int)blocks.size(); b_ind++) {
-	
-		ir::ControlFlowGraph::iterator block = blocks[b_ind];
-			
-		if(block->successors.size() < 2) continue;
-
-		typedef std::unordered_set<int> BasicBlockSet;
-		
-		BasicBlockSet blocksWithThisBlockInTheirFrontier;
-		
-		for (auto successor : block->successors) {
-			auto runner = successor;
-			
-			while (runner != getPostDominator(block)) {
-				blocksWithThisBlockInTheirFrontier.insert(
-					blocksToIndex[runner]);
-				
-				runner = getPostDominator(runner);
-			}
-		}
-		
-		for (auto frontierBlock : blocksWithThisBlockInTheirFrontier) {
-			frontiers[b_ind].push_back(frontierBlock);
-		}
-	}
-}
-
 int PostdominatorTree::intersect(int b1, int b2) const {
 	int finger1 = b1;
 	int finger2 = b2;
@@ -210,6 +142,40 @@ PostdominatorTree::BlockPointerVector
 	return frontierBlocks;
 }
 
+bool PostdominatorTree::detach() {
+	_blockIds.clear();
+	for (int n = 0; n < (int)blocks.size(); n++) {
+		_blockIds.push_back(blocks[n]->id);
+	}
+
+	blocks.clear();
+	blocksToIndex.clear();
+	cfg = 0;
+
+	return true;
+}
+
+void PostdominatorTree::attach(ir::IRKernel& kernel) {
+	report("Attaching post-dominator tree to kernel " << kernel.name);
+	cfg = kernel.cfg();
+
+	std::unordered_map<ir::ControlFlowGraph::BasicBlock::Id,
+		ir::ControlFlowGraph::iterator> idsToBlocks;
+	for (auto block = cfg->begin(); block != cfg->end(); ++block) {
+		idsToBlocks.insert(std::make_pair(block->id, block));
+	}
+
+	for (int n = 0; n < (int)_blockIds.size(); n++) {
+		auto block = idsToBlocks.find(_blockIds[n]);
+		assert(block != idsToBlocks.end());
+
+		blocks.push_back(block->second);
+		blocksToIndex[blocks.back()] = n;
+	}
+
+	_blockIds.clear();
+}
+
 std::ostream& PostdominatorTree::write(std::ostream& out) {
 
 	out << "digraph {\n";
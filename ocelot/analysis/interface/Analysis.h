@@ -72,6 +72,15 @@ public:
 public:
 	virtual void analyze(ir::IRKernel& kernel) = 0;
 
+public:
+	/*! \brief Replace the pointers into the kernel by block ids, so that
+		the analysis outlives the kernel, false if it cannot be detached */
+	virtual bool detach();
+
+	/*! \brief Point a detached analysis at a kernel with the content it
+		was computed on */
+	virtual void attach(ir::IRKernel& kernel);
+
 };
 
 /*! \brief An analysis over a complete module */
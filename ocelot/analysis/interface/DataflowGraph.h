@@ -341,6 +341,8 @@ class DataflowGraph : public KernelAnalysis
 		SsaType _ssa;
 		RegisterId _maxRegister;
 		PhiPredicateMap _phiPredicateMap;
+		/*! \brief The ids of the blocks while the graph is detached */
+		std::vector< ir::ControlFlowGraph::BasicBlock::Id > _blockIds;
 
 	public:
 		/*! \brief Convert from a PTXInstruction to an Instruction  */
@@ -350,6 +352,14 @@ class DataflowGraph : public KernelAnalysis
 		/*! \brief Build from a kernel CFG */
 		void analyze( ir::IRKernel& kernel );
 
+	public:
+		/*! \brief Keep the blocks and the live ranges, drop the
+			instructions, not possible in SSA form */
+		bool detach();
+		/*! \brief Convert the instructions of a kernel with the content
+			the graph was built from */
+		void attach( ir::IRKernel& kernel );
+
 	public:
 		/*! \brief The constructor */
 		DataflowGraph();
@@ -11,6 +11,7 @@
 #include <ostream>
 #include <set>
 #include <map>
+#include <vector>
 
 namespace analysis {
 class DirectionalGraph
@@ -30,6 +31,34 @@ class DirectionalGraph
 
 		typedef std::pair<int, node_iterator> node_action_info;
 
+		/*!\brief A read only copy of the graph in compressed sparse row
+			form. Nodes are numbered densely in the order of their ids, the
+			arrows leaving node i are outNodes[outOffsets[i]] up to
+			outNodes[outOffsets[i + 1]], arrows arriving likewise. */
+		class CompressedGraph
+		{
+			public:
+				typedef std::vector<node_type> id_vector;
+				typedef std::vector<unsigned int> index_vector;
+
+				/*!\brief The index of a missing node */
+				static const unsigned int invalid = (unsigned int)-1;
+
+			public:
+				/*!\brief Node ids, sorted */
+				id_vector ids;
+				index_vector outOffsets;
+				index_vector outNodes;
+				index_vector inOffsets;
+				index_vector inNodes;
+
+			public:
+				/*!\brief Number of nodes */
+				size_t size() const;
+				/*!\brief The dense index of a node id, or invalid */
+				unsigned int index( const node_type &nodeId ) const;
+		};
+
 	protected:
 		/*!\brief The set with the graph nodes */
 		std::set<node_type> nodes;
@@ -39,8 +68,12 @@ class DirectionalGraph
 		/*!\brief For each node, maps from which other nodes
 			it has a edge[arrow] coming from */
 		std::map<node_type, node_set> outArrows;
+		/*!\brief Changes whenever a node or an edge[arrow] is inserted or
+			removed, so that compressed copies can tell they are stale */
+		unsigned int version;
 
 	public:
+		DirectionalGraph();
 		~DirectionalGraph();
 		void clear();
 		void insertNode( const node_type &nodeId );
@@ -57,6 +90,12 @@ class DirectionalGraph
 			const node_type &toNode, const bool createNewNodes = true );
 		int eraseEdge( const node_type &fromNode,
 			const node_type &toNode, const bool removeIsolatedNodes = false );
+		/*!\brief The current version of the nodes and edges */
+		unsigned int getVersion() const;
+		/*!\brief Builds the compressed form of the graph, extraNodes are
+			numbered as nodes without edges */
+		void compress( CompressedGraph &graph,
+			const node_set &extraNodes = node_set() ) const;
 		std::ostream& print( std::ostream& out ) const;
 };
 
@@ -27,6 +27,8 @@ class DivergenceAnalysis : public KernelAnalysis
 public:
 	typedef std::set<BranchInfo>              branch_set;
 	typedef std::unordered_set<DataflowGraph::iterator> block_set;
+	typedef std::unordered_set<ir::ControlFlowGraph::BasicBlock::Id>
+		block_id_set;
 	typedef DataflowGraph::InstructionVector::const_iterator
 		const_instruction_iterator;
 
@@ -35,6 +37,12 @@ public:
 	
 	virtual void analyze( ir::IRKernel& k );
 
+	/*!\brief Keeps the divergent registers and convergent blocks */
+	virtual bool detach();
+	/*!\brief Converts the dataflow graph of a kernel with the content the
+		analysis was computed on to the same gated SSA form */
+	virtual void attach( ir::IRKernel& k );
+
 	/*!\brief Tests if a block ends with a divergent branch instruction */
 	bool isDivBlock(const DataflowGraph::const_iterator &block) const;
 	/*!\brief Tests if a block ends with a divergent branch instruction */
@@ -119,8 +127,8 @@ protected:
 	ir::IRKernel *_kernel;
 	/*!\brief Holds the variables marks of divergent blocks */
 	DivergenceGraph _divergGraph;
-	/*!\brief Set with all not divergent blocks in the kernel*/
-	block_set  _notDivergentBlocks;
+	/*!\brief Set with the ids of all not divergent blocks in the kernel*/
+	block_id_set _notDivergentBlocks;
 	bool _doCFGanalysis;
 	bool _includeConditionalConvergence;
 
@@ -9,6 +9,10 @@
 #include <ocelot/analysis/interface/DirectionalGraph.h>
 #include <ocelot/ir/interface/PTXOperand.h>
 
+namespace test {
+	class TestDivergenceGraph;
+}
+
 namespace analysis {
 
 class DivergenceGraph: public DirectionalGraph
@@ -28,11 +32,20 @@ class DivergenceGraph: public DirectionalGraph
 		/*!\brief Defines if the divergence graph has been
 			altered since the last computeDivergence() call */
 		bool _upToDate;
+		/*!\brief The graph computeDivergence() propagates over, rebuilt
+			when the nodes or edges changed since */
+		CompressedGraph _compressed;
+		/*!\brief The version of the graph _compressed was built from */
+		unsigned int _compressedVersion;
+		/*!\brief Arrows inserted between nodes of _compressed since it was
+			built, as dense indices, merged into it by computeDivergence() */
+		std::vector<std::pair<unsigned int, unsigned int> > _insertedArrows;
 
 	public:
 		void clear();
 
-		DivergenceGraph() : DirectionalGraph(), _upToDate(true){};
+		DivergenceGraph() : DirectionalGraph(), _upToDate(true),
+			_compressedVersion((unsigned int)-1){};
 		~DivergenceGraph() {clear();};
 		void insertSpecialSource( const ir::PTXOperand* tid );
 		void eraseSpecialSource( const ir::PTXOperand* tid );
@@ -60,6 +73,8 @@ class DivergenceGraph: public DirectionalGraph
 		void computeDivergence();
 		std::string getSpecialName( const ir::PTXOperand* in ) const;
 		std::ostream& print( std::ostream& out ) const;
+
+	friend class test::TestDivergenceGraph;
 };
 
 std::ostream& operator<<( std::ostream& out, const DivergenceGraph& graph );
@@ -0,0 +1,106 @@
+/*! \file DominatorEngine.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the DominatorEngine class
+*/
+
+#ifndef IR_DOMINATORENGINE_H_INCLUDED
+#define IR_DOMINATORENGINE_H_INCLUDED
+
+// Ocelot Includes
+#include <ocelot/ir/interface/ControlFlowGraph.h>
+
+// Standard Library Includes
+#include <vector>
+
+namespace analysis {
+
+/*!
+	Computes immediate dominators and dominance frontiers with the semi-NCA
+	algorithm of Georgiadis, a variant of Lengauer-Tarjan, on a graph whose
+	nodes are dense indices. The edges are kept in compressed sparse row
+	form. The dominator and the post dominator trees share it, the latter
+	by adding the edges of the control flow graph reversed.
+
+	Results are numbered in the post-order of a depth first search from
+	the root, so every node comes before its dominators and the root is
+	last. Nodes not reachable from the root are left out.
+*/
+class DominatorEngine {
+
+public:
+	typedef std::vector<int> IndexVector;
+	typedef std::vector<IndexVector> IndexArrayVector;
+
+public:
+	/*! Create an engine for a graph with a number of nodes and no edges */
+	DominatorEngine(int nodes = 0);
+
+public:
+	/*! Add an edge between two nodes */
+	void addEdge(int from, int to);
+
+	/*! Number the blocks of a CFG as nodes and add its edges, reversed
+		if reverse is set */
+	void addBlocks(ir::ControlFlowGraph& cfg, bool reverse);
+
+	/*! Compute the dominator tree of the nodes reachable from root */
+	void computeDominators(int root);
+
+	/*! Compute the dominance frontiers, after the dominators */
+	void computeFrontiers();
+
+public:
+	/*! The block of each node, if they were added with addBlocks */
+	ir::ControlFlowGraph::BlockPointerVector blocks;
+
+	/*! The node of each block, if they were added with addBlocks */
+	ir::ControlFlowGraph::BlockMap nodes;
+
+	/*! The node at each position of the post-order */
+	IndexVector order;
+
+	/*! The position of each node in the post-order, or -1 if unreachable */
+	IndexVector position;
+
+	/*! nth element stores the position of the immediate dominator
+		of the node at position n, the root is its own dominator */
+	IndexVector idom;
+
+	/*! nth element stores the positions in the dominance frontier
+		of the node at position n */
+	IndexArrayVector frontiers;
+
+private:
+	typedef std::pair<int, int> Edge;
+	typedef std::vector<Edge> EdgeVector;
+
+private:
+	void _compress();
+	int _eval(int v);
+	void _compressPath(int v);
+
+private:
+	/*! The number of nodes */
+	int _nodes;
+	/*! The edges in the order they were added */
+	EdgeVector _edges;
+
+	/*! The successors of node i are _successors[_outOffsets[i]] up to
+		_successors[_outOffsets[i + 1]], the predecessors likewise */
+	IndexVector _outOffsets;
+	IndexVector _successors;
+	IndexVector _inOffsets;
+	IndexVector _predecessors;
+
+	/*! Depth first search state, indexed by pre-order number */
+	IndexVector _semi;
+	IndexVector _label;
+	IndexVector _ancestor;
+	IndexVector _pathStack;
+};
+
+}
+
+#endif
+
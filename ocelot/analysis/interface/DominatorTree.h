@@ -33,6 +33,10 @@ public:
 public:
 	void analyze(ir::IRKernel& kernel);
 
+public:
+	bool detach();
+	void attach(ir::IRKernel& kernel);
+
 public:		
 	/*! Writes a representation of the DominatorTree to an output stream */
 	std::ostream& write(std::ostream &out);
@@ -40,7 +44,8 @@ public:
 	/*! Parent control flow graph */
 	ir::ControlFlowGraph *cfg;
 
-	/*! the basic blocks in the CFG and dominator tree */
+	/*! the reachable basic blocks in the CFG and dominator tree,
+		in post-order so that every block comes before its dominators */
 	ir::ControlFlowGraph::BlockPointerVector blocks;
 
 	/*! nth element stores the immediate 
@@ -51,6 +56,10 @@ public:
 		n is the immediate dominator */
 	std::vector< std::vector<int> > dominated;
 
+	/*! nth element stores a list of elements in the 
+		dominance frontier of n */
+	std::vector< std::vector<int> > frontiers;
+
 	/*! Mapping from a BasicBlock to an index into the blocks vector */
 	ir::ControlFlowGraph::BlockMap blocksToIndex;
 
@@ -71,9 +80,17 @@ public:
 	ir::ControlFlowGraph::BlockPointerVector getDominatedBlocks(
 		ir::ControlFlowGraph::const_iterator block);
 	
+	/*! Get the dominance frontier of a block, where phi instructions
+		for values defined in the block are placed */
+	ir::ControlFlowGraph::BlockPointerVector getDominanceFrontier(
+		ir::ControlFlowGraph::const_iterator block);
+	
 private:
-	void computeDT();
 	int intersect(int b1, int b2) const;
+
+private:
+	/*! ids of the blocks vector while the tree is detached */
+	std::vector<ir::ControlFlowGraph::BasicBlock::Id> _blockIds;
 };
 	
 }
@@ -40,6 +40,10 @@ namespace analysis
 	
 	public:
 		void analyze(ir::IRKernel& kernel);
+
+	public:
+		bool detach();
+		void attach(ir::IRKernel& kernel);
 		
 	public:
 		/*! Writes a representation of the DominatorTree to an output stream */
@@ -64,7 +68,9 @@ namespace analysis
 		/*! Parent control flow graph */
 		ir::ControlFlowGraph* cfg;
 	
-		/*! store of the basic blocks in the dominator tree in post-order */
+		/*! store of the basic blocks that reach the exit in the dominator
+			tree, in post-order so that every block comes before its
+			post-dominators */
 		BlockPointerVector blocks;
 	
 		/*! nth element stores the immediate post-dominator 
@@ -76,15 +82,18 @@ namespace analysis
 		IndexArrayVector dominated;
 	
 		/*!  nth element stores a list of elements in the post dominance
-			frontier of n */
+			frontier of n, the branches that n is control dependent on */
 		IndexArrayVector frontiers;
 	
 		/*! Map from a BasicBlock pointer to an index into the blocks vector */
 		ir::ControlFlowGraph::BlockMap blocksToIndex;	
 
 	private:
-		void computeDT();
 		int intersect(int b1, int b2) const;
+
+	private:
+		/*! ids of the blocks vector while the tree is detached */
+		std::vector<ir::ControlFlowGraph::BasicBlock::Id> _blockIds;
 	};
 	
 }
@@ -0,0 +1,751 @@
+/*!
+	\file TestDivergenceGraph.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for DivergenceGraph::computeDivergence. Compares the
+		propagation over the compressed graph with the previous walk over
+		the node sets on random graphs, and times both on a graph with
+		10^5 nodes. Then times DivergenceAnalysis::analyze on a large
+		synthetic kernel, and both propagations over the graph it built.
+*/
+
+#ifndef TEST_DIVERGENCE_GRAPH_CPP_INCLUDED
+#define TEST_DIVERGENCE_GRAPH_CPP_INCLUDED
+
+#include <ocelot/analysis/interface/DivergenceGraph.h>
+#include <ocelot/analysis/interface/DivergenceAnalysis.h>
+
+#include <ocelot/transforms/interface/PassManager.h>
+#include <ocelot/transforms/interface/Pass.h>
+
+#include <ocelot/ir/interface/Module.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+#include <hydrazine/interface/Timer.h>
+
+#include <algorithm>
+#include <set>
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Check the compressed propagation against the set walk */
+	class TestDivergenceGraph : public Test
+	{
+		private:
+			typedef analysis::DivergenceGraph DivergenceGraph;
+			typedef DivergenceGraph::node_type node_type;
+			typedef DivergenceGraph::node_set node_set;
+			typedef std::vector<node_set> NodeSetVector;
+			typedef ir::Module::StatementVector StatementVector;
+
+			/*! \brief The sources of a graph, mirrored for the reference */
+			class Sources
+			{
+				public:
+					node_set divergent;
+					node_set convergent;
+					//! destinations of the divergent special registers
+					NodeSetVector specials;
+			};
+
+			/*! \brief Runs the divergence analysis of a kernel again, timed,
+				and keeps the graph it built */
+			class AnalyzePass : public transforms::KernelPass
+			{
+				public:
+					AnalyzePass();
+
+				public:
+					void runOnKernel(ir::IRKernel& kernel);
+
+				public:
+					DivergenceGraph graph;
+					double seconds;
+			};
+
+		private:
+			void _randomGraph(DivergenceGraph& graph, Sources& sources,
+				unsigned int nodes, unsigned int edges);
+
+			void _reference(const DivergenceGraph& graph,
+				const Sources& sources, node_set& divergent);
+
+			/*! \brief the sources of a graph built by the analysis */
+			static void _sources(const DivergenceGraph& graph,
+				Sources& sources);
+
+			static ir::PTXOperand _register(unsigned int id,
+				ir::PTXOperand::DataType type);
+			static void _instruction(StatementVector& statements,
+				const ir::PTXInstruction& instruction);
+
+			StatementVector _largeKernel(unsigned int diamonds);
+
+			bool _compare(const std::string& test, DivergenceGraph& graph,
+				const Sources& sources);
+
+			bool _testRandom();
+			bool _testLarge();
+			bool _testAnalysis();
+
+			bool doTest();
+
+		public:
+			TestDivergenceGraph();
+
+		public:
+			unsigned int graphs;
+			unsigned int maxNodes;
+			unsigned int largeNodes;
+			unsigned int diamonds;
+
+		private:
+			ir::PTXOperand _tidX;
+			ir::PTXOperand _tidY;
+			ir::PTXOperand _laneId;
+	};
+
+	TestDivergenceGraph::AnalyzePass::AnalyzePass() :
+		KernelPass(Analysis::StringVector({"DivergenceAnalysis"}),
+			"AnalyzePass"), seconds(0.0)
+	{
+
+	}
+
+	/*! The pass manager already ran the analysis and the ones it needs, so
+		only the divergence analysis itself is timed */
+	void TestDivergenceGraph::AnalyzePass::runOnKernel(ir::IRKernel& kernel)
+	{
+		analysis::DivergenceAnalysis& divergence =
+			static_cast<analysis::DivergenceAnalysis&>(
+			*getAnalysis("DivergenceAnalysis"));
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		divergence.analyze(kernel);
+		timer.stop();
+
+		seconds = timer.seconds();
+		graph = divergence.getDivergenceGraph();
+	}
+
+	/*! Random edges, with some special register destinations and sources
+		that are not nodes of the graph */
+	void TestDivergenceGraph::_randomGraph(DivergenceGraph& graph,
+		Sources& sources, unsigned int nodes, unsigned int edges)
+	{
+		graph.clear();
+		sources = Sources();
+		sources.specials.resize(2);
+
+		for(unsigned int n = 0; n < nodes; ++n)
+		{
+			graph.insertNode(n);
+		}
+
+		for(unsigned int e = 0; e < edges; ++e)
+		{
+			graph.insertEdge((node_type)(random() % nodes),
+				(node_type)(random() % nodes));
+		}
+
+		unsigned int specials = 1 + random() % (nodes / 8 + 1);
+
+		for(unsigned int s = 0; s < specials; ++s)
+		{
+			node_type node = random() % (nodes + nodes / 4 + 1);
+
+			switch(random() % 3)
+			{
+				case 0:
+					graph.insertEdge(&_tidX, node);
+					sources.specials[0].insert(node);
+					break;
+				case 1:
+					graph.insertEdge(&_laneId, node);
+					sources.specials[1].insert(node);
+					break;
+				default:
+					graph.insertEdge(&_tidY, node);
+					break;
+			}
+		}
+
+		unsigned int marked = random() % (nodes / 8 + 2);
+
+		for(unsigned int m = 0; m < marked; ++m)
+		{
+			node_type node = random() % nodes;
+
+			if(random() % 2)
+			{
+				graph.setAsDiv(node);
+				sources.divergent.insert(node);
+			}
+			else
+			{
+				graph.forceConvergent(node);
+				sources.convergent.insert(node);
+			}
+		}
+	}
+
+	/*! The propagation as it was before the compressed graph, over the
+		node sets of the same graph */
+	void TestDivergenceGraph::_reference(const DivergenceGraph& graph,
+		const Sources& sources, node_set& divergent)
+	{
+		divergent.clear();
+		node_set newDivergenceNodes(sources.divergent);
+
+		for(NodeSetVector::const_iterator special = sources.specials.begin();
+			special != sources.specials.end(); ++special)
+		{
+			newDivergenceNodes.insert(special->begin(), special->end());
+		}
+
+		while(!newDivergenceNodes.empty())
+		{
+			node_type originNode = *newDivergenceNodes.begin();
+			node_set newReachedNodes = graph.getOutNodesSet(originNode);
+
+			for(node_set::const_iterator current = newReachedNodes.begin();
+				current != newReachedNodes.end(); ++current)
+			{
+				if(divergent.count(*current) == 0)
+				{
+					newDivergenceNodes.insert(*current);
+				}
+			}
+
+			divergent.insert(originNode);
+			newDivergenceNodes.erase(originNode);
+		}
+
+		node_set notDivergenceNodes(sources.convergent);
+
+		while(!notDivergenceNodes.empty())
+		{
+			node_type originNode = *notDivergenceNodes.begin();
+
+			divergent.erase(originNode);
+			notDivergenceNodes.erase(originNode);
+
+			node_set newReachedNodes = graph.getOutNodesSet(originNode);
+
+			for(node_set::const_iterator current = newReachedNodes.begin();
+				current != newReachedNodes.end(); ++current)
+			{
+				if(divergent.count(*current) == 0) continue;
+
+				node_set predecessors = graph.getInNodesSet(*current);
+				bool allConvergent = true;
+
+				for(node_set::const_iterator predecessor =
+					predecessors.begin(); predecessor != predecessors.end();
+					++predecessor)
+				{
+					if(divergent.count(*predecessor) != 0)
+					{
+						allConvergent = false;
+						break;
+					}
+				}
+
+				if(allConvergent) notDivergenceNodes.insert(*current);
+			}
+
+			newReachedNodes = graph.getInNodesSet(originNode);
+
+			for(node_set::const_iterator current = newReachedNodes.begin();
+				current != newReachedNodes.end(); ++current)
+			{
+				if(divergent.count(*current) == 0) continue;
+
+				node_set successors = graph.getOutNodesSet(*current);
+				bool allConvergent = true;
+
+				for(node_set::const_iterator successor = successors.begin();
+					successor != successors.end(); ++successor)
+				{
+					if(divergent.count(*successor) != 0)
+					{
+						allConvergent = false;
+						break;
+					}
+				}
+
+				if(!allConvergent)
+				{
+					divergent.erase(*current);
+					continue;
+				}
+
+				notDivergenceNodes.insert(*current);
+			}
+		}
+	}
+
+	void TestDivergenceGraph::_sources(const DivergenceGraph& graph,
+		Sources& sources)
+	{
+		sources = Sources();
+		sources.divergent = graph._divergenceSources;
+		sources.convergent = graph._convergenceSources;
+
+		for(std::map<const ir::PTXOperand*, node_set>::const_iterator
+			special = graph._specials.begin();
+			special != graph._specials.end(); ++special)
+		{
+			if(graph.isDivSource(special->first))
+			{
+				sources.specials.push_back(special->second);
+			}
+		}
+	}
+
+	ir::PTXOperand TestDivergenceGraph::_register(unsigned int id,
+		ir::PTXOperand::DataType type)
+	{
+		ir::PTXOperand operand(ir::PTXOperand::Register, type, id);
+
+		std::stringstream name;
+		name << (type == ir::PTXOperand::pred ? "%p" : "%r") << id;
+		operand.identifier = name.str();
+
+		return operand;
+	}
+
+	void TestDivergenceGraph::_instruction(StatementVector& statements,
+		const ir::PTXInstruction& instruction)
+	{
+		ir::PTXStatement statement(ir::PTXStatement::Instr);
+		statement.instruction = instruction;
+
+		statements.push_back(statement);
+	}
+
+	/*! A chain of if-then-else diamonds whose sides both assign a
+		register, so that the join block has a phi. Registers 1 to 16 only
+		read each other and start from constants, registers 17 to 32 may
+		read any register and start from the thread id. A diamond branches
+		on registers of one of the halves and its sides only write that
+		half, so the branches on the second half are divergent and add
+		control dependences that the analysis propagates again, while the
+		first half stays convergent. */
+	TestDivergenceGraph::StatementVector TestDivergenceGraph::_largeKernel(
+		unsigned int diamonds)
+	{
+		typedef ir::PTXInstruction PTXInstruction;
+		typedef ir::PTXOperand PTXOperand;
+
+		StatementVector statements;
+
+		ir::PTXStatement version(ir::PTXStatement::Version);
+		version.major = 2;
+		version.minor = 3;
+		statements.push_back(version);
+
+		ir::PTXStatement target(ir::PTXStatement::Target);
+		target.targets.push_back("sm_21");
+		statements.push_back(target);
+
+		ir::PTXStatement entry(ir::PTXStatement::Entry);
+		entry.name = "large";
+		statements.push_back(entry);
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::StartScope));
+
+		for(unsigned int r = 1; r <= 32; ++r)
+		{
+			PTXInstruction move(PTXInstruction::Mov);
+			move.type = PTXOperand::u32;
+			move.d = _register(r, PTXOperand::u32);
+			move.a = r > 16 ? PTXOperand(PTXOperand::tid, PTXOperand::ix)
+				: PTXOperand((unsigned int)random() % 16, PTXOperand::u32);
+
+			_instruction(statements, move);
+		}
+
+		for(unsigned int d = 0; d < diamonds; ++d)
+		{
+			std::stringstream prefix;
+			prefix << "$L" << d;
+
+			/* the registers the branch reads and the sides write */
+			unsigned int first = random() % 2 == 0 ? 1 : 17;
+			unsigned int destination = first + random() % 16;
+
+			for(unsigned int side = 0; side < 3; ++side)
+			{
+				ir::PTXStatement label(ir::PTXStatement::Label);
+				label.name = prefix.str() + (side == 0 ? ""
+					: (side == 1 ? "_then" : "_else"));
+				statements.push_back(label);
+
+				unsigned int adds = 1 + random() % 3;
+
+				for(unsigned int a = 0; a < adds; ++a)
+				{
+					unsigned int r = side == 0 ? 1 + random() % 32
+						: (a + 1 == adds ? destination : first + random() % 16);
+					unsigned int sources = r > 16 ? 32 : 16;
+
+					PTXInstruction add(PTXInstruction::Add);
+					add.type = PTXOperand::u32;
+					add.d = _register(r, PTXOperand::u32);
+					add.a = _register(1 + random() % sources, PTXOperand::u32);
+					add.b = _register(1 + random() % sources, PTXOperand::u32);
+
+					_instruction(statements, add);
+				}
+
+				if(side == 0)
+				{
+					PTXInstruction compare(PTXInstruction::SetP);
+					compare.type = PTXOperand::u32;
+					compare.comparisonOperator = PTXInstruction::Lt;
+					compare.d = _register(33 + d, PTXOperand::pred);
+					compare.a = _register(first + random() % 16,
+						PTXOperand::u32);
+					compare.b = PTXOperand((unsigned int)random() % 16,
+						PTXOperand::u32);
+
+					_instruction(statements, compare);
+
+					PTXInstruction branch(PTXInstruction::Bra);
+					branch.d = PTXOperand(prefix.str() + "_else");
+					branch.pg = _register(33 + d, PTXOperand::pred);
+					branch.pg.condition = PTXOperand::Pred;
+					branch.uni = false;
+
+					_instruction(statements, branch);
+				}
+				else
+				{
+					std::stringstream join;
+					join << "$L" << (d + 1);
+
+					PTXInstruction branch(PTXInstruction::Bra);
+					branch.d = PTXOperand(join.str());
+					branch.uni = true;
+
+					_instruction(statements, branch);
+				}
+			}
+		}
+
+		std::stringstream last;
+		last << "$L" << diamonds;
+
+		ir::PTXStatement label(ir::PTXStatement::Label);
+		label.name = last.str();
+		statements.push_back(label);
+
+		_instruction(statements, PTXInstruction(PTXInstruction::Exit));
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::EndScope));
+
+		return statements;
+	}
+
+	bool TestDivergenceGraph::_compare(const std::string& test,
+		DivergenceGraph& graph, const Sources& sources)
+	{
+		node_set expected;
+		_reference(graph, sources, expected);
+
+		graph.computeDivergence();
+
+		if(graph.getDivNodes() != expected)
+		{
+			status << test << ": " << graph.divNodesCount()
+				<< " divergent nodes, the set walk found " << expected.size()
+				<< ".\n";
+			return false;
+		}
+
+		return true;
+	}
+
+	/*! Each graph is computed, then its sources change, which reuses the
+		compressed graph, then edges are added, which are merged into it,
+		then an edge to a new node is added, which rebuilds it */
+	bool TestDivergenceGraph::_testRandom()
+	{
+		DivergenceGraph graph;
+		Sources sources;
+
+		for(unsigned int g = 0; g < graphs; ++g)
+		{
+			unsigned int nodes = 1 + random() % maxNodes;
+			_randomGraph(graph, sources, nodes, random() % (2 * nodes + 1));
+
+			if(!_compare("random graph", graph, sources)) return false;
+
+			node_type node = random() % nodes;
+
+			if(sources.divergent.count(node) != 0)
+			{
+				graph.unsetAsDiv(node);
+				sources.divergent.erase(node);
+			}
+			else
+			{
+				graph.setAsDiv(node);
+				sources.divergent.insert(node);
+			}
+
+			if(!_compare("changed sources", graph, sources)) return false;
+
+			unsigned int edges = 1 + random() % 4;
+
+			for(unsigned int e = 0; e < edges; ++e)
+			{
+				graph.insertEdge((node_type)(random() % nodes),
+					(node_type)(random() % nodes));
+			}
+
+			if(!_compare("added edges", graph, sources)) return false;
+
+			graph.insertEdge((node_type)(random() % nodes), (node_type)nodes);
+
+			if(!_compare("added node", graph, sources)) return false;
+		}
+
+		status << "Matched the set walk on " << graphs
+			<< " random graphs.\n";
+
+		return true;
+	}
+
+	/*! A sparse graph shaped like the data flow of a large kernel, each
+		register reads one or two recent registers and a few read the
+		thread id */
+	bool TestDivergenceGraph::_testLarge()
+	{
+		DivergenceGraph graph;
+		Sources sources;
+		sources.specials.resize(2);
+
+		for(unsigned int n = 0; n < largeNodes; ++n)
+		{
+			graph.insertNode(n);
+
+			unsigned int operands = 1 + random() % 2;
+
+			for(unsigned int o = 0; o < operands && n > 0; ++o)
+			{
+				unsigned int distance = 1 + random() % std::min(n, 64u);
+				graph.insertEdge(n - distance, n);
+			}
+
+			if(random() % 1000 == 0)
+			{
+				graph.insertEdge(&_tidX, n);
+				sources.specials[0].insert(n);
+			}
+			else if(random() % 1000 == 0)
+			{
+				graph.forceConvergent(n);
+				sources.convergent.insert(n);
+			}
+		}
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		node_set expected;
+		_reference(graph, sources, expected);
+		timer.stop();
+		double walkSeconds = timer.seconds();
+
+		timer.start();
+		graph.computeDivergence();
+		timer.stop();
+		double compressedSeconds = timer.seconds();
+
+		if(graph.getDivNodes() != expected)
+		{
+			status << "The " << largeNodes << " node graph has "
+				<< graph.divNodesCount() << " divergent nodes, the set walk "
+				<< "found " << expected.size() << ".\n";
+			return false;
+		}
+
+		/* only the sources change, the compressed graph is reused */
+		graph.setAsDiv(largeNodes / 2);
+
+		timer.start();
+		graph.computeDivergence();
+		timer.stop();
+		double reusedSeconds = timer.seconds();
+
+		status << "Graph with " << largeNodes << " nodes, "
+			<< expected.size() << " divergent:\n";
+		status << " set walk: " << (walkSeconds * 1000.0) << " ms\n";
+		status << " compressed graph: " << (compressedSeconds * 1000.0)
+			<< " ms\n";
+		status << " compressed graph reused: " << (reusedSeconds * 1000.0)
+			<< " ms\n";
+
+		return true;
+	}
+
+	/*! The analysis propagates once for the data flow and again each time
+		a divergent branch adds control dependences, the propagation over
+		the graph it built is timed with both storages, from scratch and
+		after inserting an edge like a divergent branch does */
+	bool TestDivergenceGraph::_testAnalysis()
+	{
+		ir::Module module("large", _largeKernel(diamonds));
+
+		AnalyzePass pass;
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		{
+			transforms::PassManager manager(&module);
+			manager.addPass(&pass);
+			manager.runOnModule();
+			manager.releasePasses();
+		}
+		timer.stop();
+		double managerSeconds = timer.seconds();
+
+		DivergenceGraph& graph = pass.graph;
+		node_set analyzed = graph.getDivNodes();
+
+		Sources sources;
+		_sources(graph, sources);
+
+		timer.start();
+		node_set expected;
+		_reference(graph, sources, expected);
+		timer.stop();
+		double walkSeconds = timer.seconds();
+
+		/* propagate again as the analysis did, first building the
+			compressed graph */
+		graph._upToDate = false;
+		graph._compressedVersion = (unsigned int)-1;
+
+		timer.start();
+		graph.computeDivergence();
+		timer.stop();
+		double compressedSeconds = timer.seconds();
+
+		if(graph.getDivNodes() != expected || analyzed != expected)
+		{
+			status << "The analysis of a kernel with " << diamonds
+				<< " diamonds found " << analyzed.size() << " divergent "
+				<< "registers, the set walk over its graph " << expected.size()
+				<< ".\n";
+			return false;
+		}
+
+		graph._upToDate = false;
+
+		timer.start();
+		graph.computeDivergence();
+		timer.stop();
+		double reusedSeconds = timer.seconds();
+
+		graph.insertEdge(*graph.getBeginNode(), *--graph.getEndNode());
+
+		timer.start();
+		_reference(graph, sources, expected);
+		timer.stop();
+		double insertedWalkSeconds = timer.seconds();
+
+		timer.start();
+		graph.computeDivergence();
+		timer.stop();
+		double mergedSeconds = timer.seconds();
+
+		if(graph.getDivNodes() != expected)
+		{
+			status << "After inserting an edge the compressed graph has "
+				<< graph.divNodesCount() << " divergent nodes, the set walk "
+				<< "found " << expected.size() << ".\n";
+			return false;
+		}
+
+		status << "Kernel with " << diamonds << " diamonds, "
+			<< graph.nodesCount() << " registers, " << expected.size()
+			<< " divergent:\n";
+		status << " analysis with the analyses it needs: "
+			<< (managerSeconds * 1000.0) << " ms\n";
+		status << " analyze: " << (pass.seconds * 1000.0) << " ms\n";
+		status << " one propagation, set walk: " << (walkSeconds * 1000.0)
+			<< " ms\n";
+		status << " one propagation, compressed graph: "
+			<< (compressedSeconds * 1000.0) << " ms\n";
+		status << " one propagation, compressed graph reused: "
+			<< (reusedSeconds * 1000.0) << " ms\n";
+		status << " after an inserted edge, set walk: "
+			<< (insertedWalkSeconds * 1000.0) << " ms\n";
+		status << " after an inserted edge, compressed graph merged: "
+			<< (mergedSeconds * 1000.0) << " ms\n";
+
+		return true;
+	}
+
+	bool TestDivergenceGraph::doTest()
+	{
+		return _testRandom() && _testLarge() && _testAnalysis();
+	}
+
+	TestDivergenceGraph::TestDivergenceGraph() :
+		_tidX(ir::PTXOperand::tid, ir::PTXOperand::ix),
+		_tidY(ir::PTXOperand::tid, ir::PTXOperand::iy),
+		_laneId(ir::PTXOperand::laneId)
+	{
+		name = "TestDivergenceGraph";
+
+		description = "Builds random graphs with divergent and convergent ";
+		description += "sources and special registers, some of them outside ";
+		description += "of the graph, and compares the divergent nodes with ";
+		description += "the previous walk over the node sets, again after ";
+		description += "changing a source, adding edges and adding a node. ";
+		description += "Then times both on a graph with 10^5 nodes. Finally ";
+		description += "times the divergence analysis of a large kernel of ";
+		description += "if-then-else diamonds, checks its result against ";
+		description += "the set walk over the graph it built, and times ";
+		description += "one propagation over that graph with both storages, ";
+		description += "from scratch and after inserting an edge.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestDivergenceGraph test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-g", "--graphs", test.graphs, 2000,
+		"Random graphs to compare with the set walk.");
+	parser.parse("-n", "--nodes", test.maxNodes, 40,
+		"Maximum nodes in a random graph.");
+	parser.parse("-l", "--large", test.largeNodes, 100000,
+		"Nodes in the timed graph.");
+	parser.parse("-d", "--diamonds", test.diamonds, 250,
+		"If-then-else diamonds in the timed kernel.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
@@ -0,0 +1,496 @@
+/*!
+	\file TestDominatorEngine.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the DominatorEngine class. Compares immediate
+		dominators and dominance frontiers with brute force on random
+		graphs and times a graph with 10^5 nodes.
+*/
+
+#ifndef TEST_DOMINATOR_ENGINE_CPP_INCLUDED
+#define TEST_DOMINATOR_ENGINE_CPP_INCLUDED
+
+#include <ocelot/analysis/interface/DominatorEngine.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+#include <hydrazine/interface/Timer.h>
+
+#include <algorithm>
+#include <set>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Check the semi-NCA engine against reference computations */
+	class TestDominatorEngine : public Test
+	{
+		private:
+			typedef std::vector<int> IndexVector;
+			typedef std::vector<IndexVector> IndexArrayVector;
+			typedef std::vector<bool> BitVector;
+			typedef std::set<int> IndexSet;
+			typedef std::vector<IndexSet> IndexSetVector;
+
+		private:
+			void _randomGraph(int nodes, int edges, IndexArrayVector& graph);
+			void _cfgLikeGraph(int nodes, IndexArrayVector& graph);
+
+			void _reachable(const IndexArrayVector& graph, int root,
+				int removed, BitVector& reached);
+
+			void _bruteForce(const IndexArrayVector& graph, int root,
+				IndexVector& idom, IndexSetVector& frontiers);
+			void _iterative(const IndexArrayVector& graph, int root,
+				IndexVector& idom);
+
+			void _engineResult(analysis::DominatorEngine& engine,
+				IndexVector& idom, IndexSetVector& frontiers);
+
+			bool _testRandom();
+			bool _testLarge();
+
+			bool doTest();
+
+		public:
+			TestDominatorEngine();
+
+		public:
+			unsigned int graphs;
+			unsigned int maxNodes;
+			unsigned int largeNodes;
+	};
+
+	void TestDominatorEngine::_randomGraph(int nodes, int edges,
+		IndexArrayVector& graph)
+	{
+		graph.assign(nodes, IndexVector());
+
+		for(int e = 0; e < edges; ++e)
+		{
+			graph[random() % nodes].push_back(random() % nodes);
+		}
+	}
+
+	/*! A chain with random forward branches and loop back edges, shaped
+		like the CFG of a large kernel */
+	void TestDominatorEngine::_cfgLikeGraph(int nodes, IndexArrayVector& graph)
+	{
+		graph.assign(nodes, IndexVector());
+
+		for(int n = 0; n + 1 < nodes; ++n)
+		{
+			graph[n].push_back(n + 1);
+
+			switch(random() % 4)
+			{
+				case 0:
+				{
+					graph[n].push_back(std::min(nodes - 1,
+						n + 2 + (int)(random() % 16)));
+					break;
+				}
+				case 1:
+				{
+					graph[n].push_back(std::max(0,
+						n - 1 - (int)(random() % 64)));
+					break;
+				}
+				default: break;
+			}
+		}
+	}
+
+	void TestDominatorEngine::_reachable(const IndexArrayVector& graph,
+		int root, int removed, BitVector& reached)
+	{
+		reached.assign(graph.size(), false);
+
+		if(root == removed) return;
+
+		IndexVector stack(1, root);
+		reached[root] = true;
+
+		while(!stack.empty())
+		{
+			int node = stack.back();
+			stack.pop_back();
+
+			for(IndexVector::const_iterator successor = graph[node].begin();
+				successor != graph[node].end(); ++successor)
+			{
+				if(*successor == removed || reached[*successor]) continue;
+
+				reached[*successor] = true;
+				stack.push_back(*successor);
+			}
+		}
+	}
+
+	/*! d dominates v if v can not be reached once d is removed. The
+		immediate dominator is the strict dominator with the most
+		dominators of its own. */
+	void TestDominatorEngine::_bruteForce(const IndexArrayVector& graph,
+		int root, IndexVector& idom, IndexSetVector& frontiers)
+	{
+		int nodes = graph.size();
+
+		BitVector reachable;
+		_reachable(graph, root, -1, reachable);
+
+		IndexSetVector dominators(nodes);
+
+		for(int d = 0; d < nodes; ++d)
+		{
+			if(!reachable[d]) continue;
+
+			BitVector reached;
+			_reachable(graph, root, d, reached);
+
+			for(int v = 0; v < nodes; ++v)
+			{
+				if(reachable[v] && !reached[v]) dominators[v].insert(d);
+			}
+		}
+
+		idom.assign(nodes, -1);
+
+		for(int v = 0; v < nodes; ++v)
+		{
+			if(!reachable[v]) continue;
+
+			if(v == root)
+			{
+				idom[v] = root;
+				continue;
+			}
+
+			unsigned int depth = 0;
+
+			for(IndexSet::const_iterator d = dominators[v].begin();
+				d != dominators[v].end(); ++d)
+			{
+				if(*d == v) continue;
+
+				if(dominators[*d].size() > depth)
+				{
+					depth = dominators[*d].size();
+					idom[v] = *d;
+				}
+			}
+		}
+
+		frontiers.assign(nodes, IndexSet());
+
+		for(int p = 0; p < nodes; ++p)
+		{
+			if(!reachable[p]) continue;
+
+			for(IndexVector::const_iterator y = graph[p].begin();
+				y != graph[p].end(); ++y)
+			{
+				for(IndexSet::const_iterator x = dominators[p].begin();
+					x != dominators[p].end(); ++x)
+				{
+					if(*x == *y || dominators[*y].count(*x) == 0)
+					{
+						frontiers[*x].insert(*y);
+					}
+				}
+			}
+		}
+	}
+
+	/*! The iterative scheme of Cooper, Harvey and Kennedy that the engine
+		replaced, used as the reference on graphs too large for brute
+		force */
+	void TestDominatorEngine::_iterative(const IndexArrayVector& graph,
+		int root, IndexVector& idom)
+	{
+		int nodes = graph.size();
+
+		IndexArrayVector predecessors(nodes);
+		for(int n = 0; n < nodes; ++n)
+		{
+			for(IndexVector::const_iterator successor = graph[n].begin();
+				successor != graph[n].end(); ++successor)
+			{
+				predecessors[*successor].push_back(n);
+			}
+		}
+
+		// post-order numbering by an iterative depth first search
+		IndexVector postorder;
+		IndexVector number(nodes, -1);
+		BitVector visited(nodes, false);
+		std::vector<std::pair<int, unsigned int> > stack;
+
+		stack.push_back(std::make_pair(root, 0u));
+		visited[root] = true;
+
+		while(!stack.empty())
+		{
+			int node = stack.back().first;
+			unsigned int& next = stack.back().second;
+
+			if(next < graph[node].size())
+			{
+				int successor = graph[node][next++];
+				if(!visited[successor])
+				{
+					visited[successor] = true;
+					stack.push_back(std::make_pair(successor, 0u));
+				}
+			}
+			else
+			{
+				number[node] = postorder.size();
+				postorder.push_back(node);
+				stack.pop_back();
+			}
+		}
+
+		IndexVector dominator(nodes, -1);
+		dominator[root] = root;
+
+		bool changed = true;
+		while(changed)
+		{
+			changed = false;
+
+			for(IndexVector::const_reverse_iterator node = postorder.rbegin();
+				node != postorder.rend(); ++node)
+			{
+				if(*node == root) continue;
+
+				int newDominator = -1;
+
+				for(IndexVector::const_iterator
+					predecessor = predecessors[*node].begin();
+					predecessor != predecessors[*node].end(); ++predecessor)
+				{
+					if(dominator[*predecessor] == -1) continue;
+
+					if(newDominator == -1)
+					{
+						newDominator = *predecessor;
+						continue;
+					}
+
+					int finger1 = *predecessor;
+					int finger2 = newDominator;
+					while(finger1 != finger2)
+					{
+						while(number[finger1] < number[finger2])
+						{
+							finger1 = dominator[finger1];
+						}
+						while(number[finger2] < number[finger1])
+						{
+							finger2 = dominator[finger2];
+						}
+					}
+					newDominator = finger1;
+				}
+
+				if(dominator[*node] != newDominator)
+				{
+					dominator[*node] = newDominator;
+					changed = true;
+				}
+			}
+		}
+
+		idom.swap(dominator);
+	}
+
+	/*! Translate the engine's post-order positions back to node ids */
+	void TestDominatorEngine::_engineResult(
+		analysis::DominatorEngine& engine, IndexVector& idom,
+		IndexSetVector& frontiers)
+	{
+		int nodes = engine.position.size();
+
+		idom.assign(nodes, -1);
+		frontiers.assign(nodes, IndexSet());
+
+		for(unsigned int p = 0; p < engine.order.size(); ++p)
+		{
+			int node = engine.order[p];
+
+			idom[node] = engine.order[engine.idom[p]];
+
+			if(p < engine.frontiers.size())
+			{
+				for(IndexVector::const_iterator
+					f = engine.frontiers[p].begin();
+					f != engine.frontiers[p].end(); ++f)
+				{
+					frontiers[node].insert(engine.order[*f]);
+				}
+			}
+		}
+	}
+
+	bool TestDominatorEngine::_testRandom()
+	{
+		for(unsigned int g = 0; g < graphs; ++g)
+		{
+			int nodes = 1 + random() % maxNodes;
+			int edges = random() % (3 * nodes + 1);
+
+			IndexArrayVector graph;
+			_randomGraph(nodes, edges, graph);
+
+			int root = random() % nodes;
+
+			analysis::DominatorEngine engine(nodes);
+			for(int n = 0; n < nodes; ++n)
+			{
+				for(IndexVector::const_iterator
+					successor = graph[n].begin();
+					successor != graph[n].end(); ++successor)
+				{
+					engine.addEdge(n, *successor);
+				}
+			}
+
+			engine.computeDominators(root);
+			engine.computeFrontiers();
+
+			IndexVector engineDominators;
+			IndexSetVector engineFrontiers;
+			_engineResult(engine, engineDominators, engineFrontiers);
+
+			IndexVector expectedDominators;
+			IndexSetVector expectedFrontiers;
+			_bruteForce(graph, root, expectedDominators, expectedFrontiers);
+
+			for(int n = 0; n < nodes; ++n)
+			{
+				if(engineDominators[n] != expectedDominators[n])
+				{
+					status << "Graph " << g << " (" << nodes << " nodes, "
+						<< edges << " edges, root " << root
+						<< "): immediate dominator of node " << n << " is "
+						<< engineDominators[n] << ", expected "
+						<< expectedDominators[n] << ".\n";
+					return false;
+				}
+
+				if(engineFrontiers[n] != expectedFrontiers[n])
+				{
+					status << "Graph " << g << " (" << nodes << " nodes, "
+						<< edges << " edges, root " << root
+						<< "): dominance frontier of node " << n
+						<< " differs.\n";
+					return false;
+				}
+			}
+		}
+
+		status << "Matched brute force on " << graphs << " random graphs.\n";
+
+		return true;
+	}
+
+	bool TestDominatorEngine::_testLarge()
+	{
+		IndexArrayVector graph;
+		_cfgLikeGraph(largeNodes, graph);
+
+		hydrazine::Timer timer;
+
+		timer.start();
+
+		analysis::DominatorEngine engine(largeNodes);
+		for(unsigned int n = 0; n < largeNodes; ++n)
+		{
+			for(IndexVector::const_iterator successor = graph[n].begin();
+				successor != graph[n].end(); ++successor)
+			{
+				engine.addEdge(n, *successor);
+			}
+		}
+
+		engine.computeDominators(0);
+
+		timer.stop();
+		double dominatorSeconds = timer.seconds();
+
+		timer.start();
+		engine.computeFrontiers();
+		timer.stop();
+		double frontierSeconds = timer.seconds();
+
+		timer.start();
+		IndexVector expected;
+		_iterative(graph, 0, expected);
+		timer.stop();
+		double iterativeSeconds = timer.seconds();
+
+		IndexVector engineDominators;
+		IndexSetVector engineFrontiers;
+		_engineResult(engine, engineDominators, engineFrontiers);
+
+		if(engineDominators != expected)
+		{
+			status << "Immediate dominators of the " << largeNodes
+				<< " node graph differ from the iterative algorithm.\n";
+			return false;
+		}
+
+		status << "Graph with " << largeNodes << " nodes:\n";
+		status << " semi-NCA dominators: " << (dominatorSeconds * 1000.0)
+			<< " ms\n";
+		status << " dominance frontiers: " << (frontierSeconds * 1000.0)
+			<< " ms\n";
+		status << " iterative dominators: " << (iterativeSeconds * 1000.0)
+			<< " ms\n";
+
+		return true;
+	}
+
+	bool TestDominatorEngine::doTest()
+	{
+		return _testRandom() && _testLarge();
+	}
+
+	TestDominatorEngine::TestDominatorEngine()
+	{
+		name = "TestDominatorEngine";
+
+		description = "Builds random graphs with unreachable nodes, self ";
+		description += "loops and repeated edges, and compares the immediate ";
+		description += "dominators and dominance frontiers of the semi-NCA ";
+		description += "engine with a brute force computation. Then times ";
+		description += "the engine on a CFG shaped graph with 10^5 nodes and ";
+		description += "checks it against the iterative algorithm.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestDominatorEngine test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-g", "--graphs", test.graphs, 2000,
+		"Random graphs to compare with brute force.");
+	parser.parse("-n", "--nodes", test.maxNodes, 40,
+		"Maximum nodes in a random graph.");
+	parser.parse("-l", "--large", test.largeNodes, 100000,
+		"Nodes in the timed graph.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
@@ -13,8 +13,12 @@
 #include <hydrazine/interface/compression.h>
 #include <hydrazine/interface/ELFFile.h>
 
+// Boost Includes
+#include <boost/thread/locks.hpp>
+
 // Standard Library Includes
 #include <cstring>
+#include <cstdlib>
 #include <sstream>
 #include <fstream>
 
@@ -25,8 +29,25 @@
 
 #define REPORT_BASE 1
 
+/*! \brief The architecture in a profile name such as compute_35 or sm_20 */
+static unsigned int profileArchitecture(const char* profile) {
+	const char* separator = std::strrchr(profile, '_');
+	
+	if(separator == 0) return 0;
+	
+	return std::strtoul(separator + 1, 0, 10);
+}
+
+////////////////////////////////////////////////////////////////////////////////
+cuda::FatBinaryContext::Image::Image(ImageKind k, unsigned int a,
+	const char* d, unsigned long long s, unsigned long long u)
+: kind(k), architecture(a), data(d), size(s), uncompressedSize(u) {
+
+}
+
 ////////////////////////////////////////////////////////////////////////////////
-cuda::FatBinaryContext::FatBinaryContext(const void *ptr): cubin_ptr(ptr) {
+cuda::FatBinaryContext::FatBinaryContext(const void *ptr): cubin_ptr(ptr),
+	_name(0), _decompressedPTX(new DecompressedPTX) {
 
 	report("FatBinaryContext(" << ptr << ")");
 
@@ -38,30 +59,18 @@ cuda::FatBinaryContext::FatBinaryContext(const void *ptr): cubin_ptr(ptr) {
 		assertM(binary->ptx != 0, "binary contains no PTX");
 		assertM(binary->ptx->ptx != 0, "binary contains no PTX");
 
-		unsigned int ptxVersion = 0;
-
-		report("Getting the highest PTX version");
+		for(unsigned int i = 0; binary->ptx[i].ptx != 0; ++i) {
+			_images.push_back(Image(PTX,
+				profileArchitecture(binary->ptx[i].gpuProfileName),
+				binary->ptx[i].ptx));
+		}
 
-		for(unsigned int i = 0; ; ++i)
-		{
-			if((binary->ptx[i].ptx) == 0) break;
-	
-			std::string computeCapability = binary->ptx[i].gpuProfileName;
-			std::string versionString(computeCapability.begin() + 8,
-				computeCapability.end());
-	
-			std::stringstream version;
-			unsigned int thisVersion = 0;
-		
-			version << versionString;
-			version >> thisVersion;
-			if(thisVersion > ptxVersion)
-			{
-				ptxVersion = thisVersion;
-				_ptx = binary->ptx[i].ptx;
-			}
-		}		
-		report(" Selected version " << ptxVersion);
+		for(unsigned int i = 0; binary->cubin != 0 &&
+			binary->cubin[i].cubin != 0; ++i) {
+			_images.push_back(Image(Cubin,
+				profileArchitecture(binary->cubin[i].gpuProfileName),
+				binary->cubin[i].cubin));
+		}
 	}
 	else if (*(int*)cubin_ptr == __cudaFatMAGIC2) {
 		report("Found new fat binary format!");
@@ -73,35 +82,51 @@ cuda::FatBinaryContext::FatBinaryContext(const void *ptr): cubin_ptr(ptr) {
 				
 		char* base = (char*)(header + 1);
 		long long unsigned int offset = 0;
-		__cudaFatCudaBinary2EntryRec* entry = (__cudaFatCudaBinary2EntryRec*)(base);
+		bool namedByPTX = false;
 		
-		while (!(entry->type & FATBIN_2_PTX) && offset < header->length) {
-			entry = (__cudaFatCudaBinary2EntryRec*)(base + offset);
+		while (offset < header->length) {
+			__cudaFatCudaBinary2EntryRec* entry =
+				(__cudaFatCudaBinary2EntryRec*)(base + offset);
 			offset += entry->binary + entry->binarySize;
-		}
-		_name = (char*)entry + entry->name;		
-                std::cout << _name << std::endl;
-		if (entry->type & FATBIN_2_PTX) {
-			_ptx  = (char*)entry + entry->binary;
-		}
-		else {
-			_ptx = 0;
+			
+			const char* name = (char*)entry + entry->name;
+			
+			if (entry->type & FATBIN_2_PTX) {
+				/* the object is named after its first PTX where there is one */
+				if (!namedByPTX) {
+					_name = name;
+					namedByPTX = true;
+				}
+				
+				_images.push_back(Image(PTX, entry->architecture,
+					(char*)entry + entry->binary, entry->binarySize,
+					(entry->flags & COMPRESSED_PTX) ?
+					entry->uncompressedBinarySize : 0));
+			}
+			else if (entry->type & FATBIN_2_ELF) {
+				if (_name == 0) _name = name;
+
+				
+				_images.push_back(Image(Cubin, entry->architecture,
+					(char*)entry + entry->binary, entry->binarySize));
+			}
 		}
 		
-		if(entry->flags & COMPRESSED_PTX)
-		{
-			_decompressedPTX.resize(entry->uncompressedBinarySize + 1);
-			_decompressPTX(entry->binarySize);
-		}
+		if (_name != 0) report(_name);
 	}
 	else {
 		assertM(false, "unknown fat binary magic number "
 			<< std::hex << *(int*)cubin_ptr);		
-		_name = 0;
-		_ptx = 0;
 	}
 	
-	if (!_ptx) {
+	for (ImageVector::const_iterator image = _images.begin();
+		image != _images.end(); ++image) {
+		report(" " << (image->kind == PTX ? "PTX" : "cubin")
+			<< " for sm_" << image->architecture
+			<< (image->uncompressedSize != 0 ? " (compressed)" : ""));
+	}
+	
+	if (selectPTX(0) == -1) {
 		report("registered, contains NO PTX");
 	}
 	else {
@@ -109,7 +134,8 @@ cuda::FatBinaryContext::FatBinaryContext(const void *ptr): cubin_ptr(ptr) {
 	}
 }
 
-cuda::FatBinaryContext::FatBinaryContext(): cubin_ptr(0), _name(0), _ptx(0) {
+cuda::FatBinaryContext::FatBinaryContext(): cubin_ptr(0), _name(0),
+	_decompressedPTX(new DecompressedPTX) {
 
 }
 
@@ -118,18 +144,81 @@ const char* cuda::FatBinaryContext::name() const {
 }	
 
 const char* cuda::FatBinaryContext::ptx() const {
-	if(!_decompressedPTX.empty()) return (const char*) _decompressedPTX.data();
+	return ptx(0);
+}
+
+const char* cuda::FatBinaryContext::ptx(unsigned int architecture) const {
+	int index = selectPTX(architecture);
+	
+	if(index == -1) return 0;
+	
+	const Image& image = _images[index];
+	
+	if(image.uncompressedSize == 0) return image.data;
 	
-	return _ptx;
+	return _decompressPTX(index);
 }
 
-void cuda::FatBinaryContext::_decompressPTX(unsigned int compressedBinarySize) {
-	uint64_t decompressedSize = _decompressedPTX.size() - 1;
+int cuda::FatBinaryContext::selectPTX(unsigned int architecture) const {
+	int oldest = -1;
+	int supported = -1;
+	
+	/* PTX for newer targets uses instructions the parser does not know */
+	if(architecture == 0 || architecture > parsedArchitecture) {
+		architecture = parsedArchitecture;
+	}
+	
+	for(int i = 0; i != (int)_images.size(); ++i) {
+		const Image& image = _images[i];
+		
+		if(image.kind != PTX) continue;
+		
+		if(oldest == -1 || image.architecture < _images[oldest].architecture) {
+			oldest = i;
+		}
+		
+		if(image.architecture <= architecture && (supported == -1 ||
+			image.architecture > _images[supported].architecture)) {
+			supported = i;
+		}
+	}
+	
+	if(supported != -1) return supported;
+	
+	return oldest;
+}
 
-	hydrazine::decompress(_decompressedPTX.data(), decompressedSize, _ptx,
-		compressedBinarySize - 1);
+const cuda::FatBinaryContext::ImageVector&
+	cuda::FatBinaryContext::images() const {
+	return _images;
+}
 
-	_decompressedPTX.back() = '\0';
+const char* cuda::FatBinaryContext::_decompressPTX(int index) const {
+	boost::lock_guard<boost::mutex> lock(_decompressedPTX->mutex);
+	
+	ByteVectorMap::iterator decompressed =
+		_decompressedPTX->images.find(index);
+	
+	if(decompressed != _decompressedPTX->images.end()) {
+		return decompressed->second.data();
+	}
+	
+	const Image& image = _images[index];
+	
+	report("Decompressing PTX for sm_" << image.architecture << " ("
+		<< image.size << " to " << image.uncompressedSize << " bytes)");
+	
+	ByteVector& ptx = _decompressedPTX->images[index];
+	ptx.resize(image.uncompressedSize + 1);
+	
+	uint64_t decompressedSize = image.uncompressedSize;
+
+	hydrazine::decompress(ptx.data(), decompressedSize, image.data,
+		image.size - 1);
+
+	ptx.back() = '\0';
+	
+	return ptx.data();
 }
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -10,12 +10,48 @@
 // Ocelot Includes
 #include <ocelot/cuda/interface/cudaFatBinary.h>
 
+// Boost Includes
+#include <boost/thread/mutex.hpp>
+
 // Standard Library Includes
+#include <map>
+#include <memory>
 #include <vector>
 
 namespace cuda {
 	/*!	\brief Class allowing sharing of a fat binary among threads	*/
 	class FatBinaryContext {
+	public:
+		/*! \brief The kinds of image a fat binary holds */
+		enum ImageKind {
+			PTX,
+			Cubin
+		};
+
+		/*! \brief One PTX or binary image in a fat binary */
+		class Image {
+		public:
+			Image(ImageKind kind = PTX, unsigned int architecture = 0,
+				const char* data = 0, unsigned long long size = 0,
+				unsigned long long uncompressedSize = 0);
+
+		public:
+			ImageKind kind;
+			//! the targeted compute capability, as major * 10 + minor
+			unsigned int architecture;
+			//! the image as stored in the fat binary
+			const char* data;
+			//! the stored size in bytes, 0 if unknown
+			unsigned long long size;
+			//! the size once decompressed, 0 if the image is not compressed
+			unsigned long long uncompressedSize;
+		};
+
+		typedef std::vector<Image> ImageVector;
+
+		/*! \brief The newest architecture whose PTX the parser reads */
+		static const unsigned int parsedArchitecture = 50;
+
 	public:
 		FatBinaryContext(const void *);
 		FatBinaryContext();
@@ -25,20 +61,38 @@ namespace cuda {
 		
 	public:
 		const char *name() const;
+		/*! \brief The PTX for the newest architecture the parser reads */
 		const char *ptx() const;
+		/*! \brief The PTX for a device of an architecture (major * 10 +
+			minor, 0 for the newest), decompressed on first use */
+		const char *ptx(unsigned int architecture) const;
 
-	private:
-		void _decompressPTX(unsigned int compressedBinarySize);
+		/*! \brief The index of the PTX image for a device of an
+			architecture, the newest one that both the device and the 
+			parser support or else the oldest one, -1 if there is no PTX */
+		int selectPTX(unsigned int architecture) const;
+
+		/*! \brief Every PTX and binary image in the fat binary */
+		const ImageVector& images() const;
 
 	private:
-		const char* _name;
-		const char* _ptx;
+		const char* _decompressPTX(int index) const;
 
 	private:
 		typedef std::vector<char> ByteVector;
+		typedef std::map<int, ByteVector> ByteVectorMap;
+
+		/*! \brief The decompressed PTX images, shared by all copies */
+		class DecompressedPTX {
+		public:
+			boost::mutex mutex;
+			ByteVectorMap images;
+		};
 
 	private:
-		ByteVector _decompressedPTX;
+		const char* _name;
+		ImageVector _images;
+		std::shared_ptr<DecompressedPTX> _decompressedPTX;
 	
 	};
 }
@@ -113,7 +113,8 @@ typedef struct __cudaFatCudaBinary2HeaderRec {
 } __cudaFatCudaBinary2Header;
 
 enum FatBin2EntryType {
-	FATBIN_2_PTX = 0x1
+	FATBIN_2_PTX = 0x1,
+	FATBIN_2_ELF = 0x2
 };
 
 typedef struct __cudaFatCudaBinary2EntryRec { 
@@ -122,8 +123,8 @@ typedef struct __cudaFatCudaBinary2EntryRec {
 	unsigned long long int binarySize;
 	unsigned int           unknown2;
 	unsigned int           kindOffset;
-	unsigned int           unknown3;
-	unsigned int           unknown4;
+	unsigned int           version;      /* minor in the low, major in the high half */
+	unsigned int           architecture; /* compute capability, e.g. 35 */
 	unsigned int           name;
 	unsigned int           nameSize;
 	unsigned long long int flags;
@@ -12,7 +12,12 @@
 #include <hydrazine/interface/debug.h>
 #include <hydrazine/interface/Version.h>
 #include <hydrazine/interface/Exception.h>
+#include <hydrazine/interface/BufferStream.h>
 
+#include <boost/bind.hpp>
+#include <boost/thread/thread.hpp>
+
+#include <algorithm>
 #include <fstream>
 #include <cassert>
 
@@ -52,7 +57,7 @@ ir::Module::Module(std::istream& stream, const std::string& path)
 	_version.minor = 3;
 	_version.major = 2;
 
-        std::cout << "ir::Module::Module" << std::endl;
+        report("ir::Module::Module");
 
 	load(stream, path);
 }
@@ -89,6 +94,7 @@ const ir::Module& ir::Module::operator=(const Module& m) {
 	unload();
 	
 	_ptxPointer = m._ptxPointer;
+	_ptxSource  = m._ptxSource;
 	_loaded     = m.loaded();
 
 	if(loaded()) {
@@ -157,7 +163,7 @@ bool ir::Module::load(const std::string& path) {
 	if (file.is_open()) {
 		parser::PTXParser parser;
 		parser.fileName = _modulePath;
-		std::cout << "Calling PTXParser parse" << std::endl;
+		report("Calling PTXParser parse");
 		parser.parse( file );
 
 		_statements = std::move( parser.statements() );
@@ -177,7 +183,7 @@ bool ir::Module::load(const std::string& path) {
 */
 bool ir::Module::load(std::istream& stream, const std::string& path) {
 
-        std::cout << "ir::Module::load" << std::endl;
+        report("ir::Module::load");
 	
 	unload();
 	
@@ -207,6 +213,17 @@ bool ir::Module::lazyLoad(const char* source, const std::string& path) {
 	unload();
 	
 	_ptxPointer = source;
+	_ptxSource  = PTXSource();
+	_modulePath = path;
+	
+	return true;
+}
+
+bool ir::Module::lazyLoad(const PTXSource& source, const std::string& path) {
+	unload();
+	
+	_ptxPointer = 0;
+	_ptxSource  = source;
 	_modulePath = path;
 	
 	return true;
@@ -229,6 +246,11 @@ void ir::Module::loadNow() {
 	}
 	else
 	{
+		if (!_ptxPointer && _ptxSource) {
+			_ptxPointer = _ptxSource();
+			_ptxSource  = PTXSource();
+		}
+		
 		if (!_ptxPointer) {
 			report("Module::loadNow() - path: '" << path()
 				<< "' contains no PTX");
@@ -321,6 +343,82 @@ void ir::Module::writeIR( std::ostream& stream, PTXEmitter::Target emitterTarget
 	assert( loaded() );
 	report("Writing module (IR) - " << _modulePath << " - to output stream.");
 
+	_writeIRHeader(stream, emitterTarget);
+	
+	stream << "/* Kernels */\n";
+	for (KernelMap::const_iterator kernel = _kernels.begin();
+		kernel != _kernels.end(); ++kernel) {
+		(kernel->second)->writeWithEmitter(stream, emitterTarget);
+	}
+	
+	stream << "\n\n";
+}
+
+static void writeKernels(const std::vector<ir::PTXKernel*>& kernels,
+	std::vector<std::string>& buffers, ir::PTXEmitter::Target emitterTarget,
+	size_t first, size_t stride) {
+	for (size_t i = first; i < kernels.size(); i += stride) {
+		hydrazine::BufferStream stream(buffers[i]);
+		kernels[i]->writeWithEmitter(stream, emitterTarget);
+	}
+}
+
+void ir::Module::writeIR( std::string& buffer, 
+	PTXEmitter::Target emitterTarget, unsigned int threads) const {
+	assert( loaded() );
+	report("Writing module (IR) - " << _modulePath << " - to buffer.");
+
+	std::vector<PTXKernel*> kernels;
+	kernels.reserve(_kernels.size());
+	for (KernelMap::const_iterator kernel = _kernels.begin();
+		kernel != _kernels.end(); ++kernel) {
+		kernels.push_back(kernel->second);
+	}
+	
+	if (threads == 0) {
+		threads = std::max(boost::thread::hardware_concurrency(), 1u);
+	}
+	threads = std::min<size_t>(threads, kernels.size());
+	
+	// kernels are independent, emit each into its own buffer
+	std::vector<std::string> buffers(kernels.size());
+	
+	if (threads > 1) {
+		boost::thread_group workers;
+		for (unsigned int t = 1; t < threads; ++t) {
+			workers.create_thread(boost::bind(&writeKernels, 
+				boost::cref(kernels), boost::ref(buffers), emitterTarget,
+				t, threads));
+		}
+		writeKernels(kernels, buffers, emitterTarget, 0, threads);
+		workers.join_all();
+	}
+	else {
+		writeKernels(kernels, buffers, emitterTarget, 0, 1);
+	}
+	
+	size_t kernelBytes = 0;
+	for (std::vector<std::string>::const_iterator kernel = buffers.begin();
+		kernel != buffers.end(); ++kernel) {
+		kernelBytes += kernel->size();
+	}
+	
+	hydrazine::BufferStream stream(buffer, kernelBytes + 4096);
+	
+	_writeIRHeader(stream, emitterTarget);
+	
+	stream << "/* Kernels */\n";
+	stream.flush();
+	for (std::vector<std::string>::const_iterator kernel = buffers.begin();
+		kernel != buffers.end(); ++kernel) {
+		buffer.append(*kernel);
+	}
+	
+	stream << "\n\n";
+}
+
+void ir::Module::_writeIRHeader( std::ostream& stream, 
+	PTXEmitter::Target emitterTarget) const {
 	stream << "/*\n* Ocelot Version : " 
 		<< hydrazine::Version().toString() << "\n*/\n\n";
 		
@@ -372,23 +470,15 @@ void ir::Module::writeIR( std::ostream& stream, PTXEmitter::Target emitterTarget
 		stream << texture->second.toString() << "\n";
 	}
 	stream << "\n";
-	
-	stream << "/* Kernels */\n";
-	for (KernelMap::const_iterator kernel = _kernels.begin();
-		kernel != _kernels.end(); ++kernel) {
-		(kernel->second)->writeWithEmitter(stream, emitterTarget);
-	}
-	
-	stream << "\n\n";
 }
 
 
 std::string ir::Module::toString(PTXEmitter::Target emitterTarget) const {
-	std::stringstream stream;
+	std::string buffer;
 	
-	writeIR(stream, emitterTarget);
+	writeIR(buffer, emitterTarget, 1);
 
-	return stream.str();
+	return buffer;
 }
 
 ir::Texture* ir::Module::getTexture(const std::string& name) {
@@ -2466,7 +2466,7 @@ std::string ir::PTXInstruction::toString() const {
 			return result;
 		}
 		case Shfl: {
-			std::string result = guard() + "shl." + toString( shuffleMode )
+			std::string result = guard() + "shfl." + toString( shuffleMode )
 				+ "." +	PTXOperand::toString( type ) + " " + d.toString();
 
 			if( pq.addressMode != PTXOperand::Invalid && !isPt( pq ) ) {
@@ -2609,6 +2609,185 @@ std::string ir::PTXInstruction::toString() const {
 	return "";
 }
 
+static void writeGuard(std::ostream& out, const ir::PTXOperand& pg) {
+	switch( pg.condition ) {
+		case ir::PTXOperand::PT: break;
+		case ir::PTXOperand::nPT: out << "@!%pt "; break;
+		case ir::PTXOperand::InvPred: // fall through
+		case ir::PTXOperand::Pred: out << "@" << pg << " "; break;
+	}
+}
+
+void ir::PTXInstruction::write(std::ostream& out) const {
+	switch (opcode) {
+		// op.type d, a
+		case Brev: // fall through
+		case Clz:  // fall through
+		case CNot: // fall through
+		case Mov:  // fall through
+		case Not:  // fall through
+		case Popc: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "." << PTXOperand::toString( type )
+				<< " " << d << ", " << a;
+			return;
+		}
+		// op.modifiers.type d, a
+		case Abs:   // fall through
+		case Cos:   // fall through
+		case Ex2:   // fall through
+		case Lg2:   // fall through
+		case Neg:   // fall through
+		case Rcp:   // fall through
+		case Rsqrt: // fall through
+		case Sin:   // fall through
+		case Sqrt: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "."
+				<< modifierString( modifier, carry )
+				<< PTXOperand::toString( type ) << " " << d << ", " << a;
+			return;
+		}
+		// op.type d, a, b
+		case And:      // fall through
+		case CopySign: // fall through
+		case Or:       // fall through
+		case Rem:      // fall through
+		case Shl:      // fall through
+		case Shr:      // fall through
+		case Xor: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "." << PTXOperand::toString( type )
+				<< " " << d << ", " << a << ", " << b;
+			return;
+		}
+		// op.modifiers.type d, a, b
+		case Add:   // fall through
+		case AddC:  // fall through
+		case Max:   // fall through
+		case Min:   // fall through
+		case Mul24: // fall through
+		case Mul:   // fall through
+		case Sub:   // fall through
+		case SubC: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "."
+				<< modifierString( modifier, carry )
+				<< PTXOperand::toString( type ) << " " << d << ", " << a
+				<< ", " << b;
+			return;
+		}
+		// op.type d, a, b, c
+		case Bfe:  // fall through
+		case Sad:  // fall through
+		case SelP: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "." << PTXOperand::toString( type )
+				<< " " << d << ", " << a << ", " << b << ", " << c;
+			return;
+		}
+		// op.modifiers.type d, a, b, c
+		case Fma:   // fall through
+		case Mad24: // fall through
+		case Mad:   // fall through
+		case MadC: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << "."
+				<< modifierString( modifier, carry )
+				<< PTXOperand::toString( type ) << " " << d << ", " << a
+				<< ", " << b << ", " << c;
+			return;
+		}
+		case Atom: {
+			writeGuard( out, pg );
+			out << "atom." << toString( addressSpace ) << "."
+				<< toString( atomicOperation ) << "."
+				<< PTXOperand::toString( type ) << " " << d << ", [" << a
+				<< "], " << b;
+			if( c.addressMode != PTXOperand::Invalid ) {
+				out << ", " << c;
+			}
+			return;
+		}
+		case Bra: {
+			writeGuard( out, pg );
+			out << "bra" << (uni ? ".uni " : " ") << d;
+			return;
+		}
+		case Div: {
+			writeGuard( out, pg );
+			out << "div." << (divideFull ? "full." : "")
+				<< modifierString( modifier, carry )
+				<< PTXOperand::toString( type ) << " " << d << ", " << a
+				<< ", " << b;
+			return;
+		}
+		case Ld: // fall through
+		case Ldu: {
+			writeGuard( out, pg );
+			out << toString( opcode ) << ".";
+			if( volatility == Volatile ) {
+				out << "volatile.";
+			}
+			if( cacheOperation != Ca ) {
+				out << toStringLoad( cacheOperation ) << ".";
+			}
+			if( addressSpace != Generic ) {
+				out << toString( addressSpace ) << ".";
+			}
+			if( d.vec != PTXOperand::v1 ) {
+				out << toString( d.vec ) << ".";
+			}
+			out << PTXOperand::toString( type ) << " " << d << ", [" << a
+				<< "]";
+			return;
+		}
+		case SetP: {
+			writeGuard( out, pg );
+			out << "setp." << toString( comparisonOperator ) << ".";
+			if( c.addressMode != PTXOperand::Invalid ) {
+				out << toString( booleanOperator ) << ".";
+			}
+			out << PTXOperand::toString( type ) << " " << d;
+			if( pq.addressMode != PTXOperand::Invalid && !isPt( pq ) ) {
+				out << "|" << pq;
+			}
+			out << ", " << a << ", " << b;
+			if( c.addressMode != PTXOperand::Invalid ) {
+				out << ", " << c;
+			}
+			return;
+		}
+		case St: {
+			writeGuard( out, pg );
+			out << "st.";
+			if( volatility == Volatile ) {
+				out << "volatile.";
+			}
+			if( cacheOperation != Wb ) {
+				out << toStringStore( cacheOperation ) << ".";
+			}
+			if( addressSpace != Generic ) {
+				out << toString( addressSpace ) << ".";
+			}
+			if( a.vec != PTXOperand::v1 ) {
+				out << toString( a.vec ) << ".";
+			}
+			out << PTXOperand::toString( type ) << " [" << d << "], " << a;
+			return;
+		}
+		case Ret: {
+			writeGuard( out, pg );
+			out << (uni ? "ret.uni" : "ret");
+			return;
+		}
+		default: break;
+	}
+
+	// the remaining formats are rare, fall back to the string formatter
+	out << toString();
+}
+
 ir::Instruction* ir::PTXInstruction::clone(bool copy) const {
 	if (copy) {
 		return new PTXInstruction(*this);
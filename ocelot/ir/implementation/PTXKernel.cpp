@@ -820,8 +820,9 @@ void PTXKernel::writeWithEmitter(std::ostream& stream,
 				ir::PTXInstruction* inst =
 					static_cast<ir::PTXInstruction *>(*instruction);
 				
-				stream << "\t\t" << inst->toString() << "; "
-				    << inst->metadata << "\n";
+				stream << "\t\t";
+				inst->write(stream);
+				stream << "; " << inst->metadata << "\n";
 			}
 		}
 	}
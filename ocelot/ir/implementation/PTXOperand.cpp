@@ -631,7 +631,7 @@ ir::PTXOperand::~PTXOperand() {
 /*!
 	Displays a binary represetation of a 32-bit floating-point value
 */
-static std::ostream & write(std::ostream &stream, float value) {
+static std::ostream & writeFloat(std::ostream &stream, float value) {
 	union {
 		unsigned int imm_uint;
 		float value;
@@ -645,7 +645,7 @@ static std::ostream & write(std::ostream &stream, float value) {
 /*!
 	Displays a binary represetation of a 64-bit floating-point value
 */
-static std::ostream & write(std::ostream &stream, double value) {
+static std::ostream & writeFloat(std::ostream &stream, double value) {
 	union {
 		long long unsigned int imm_uint;
 		double value;
@@ -709,10 +709,10 @@ std::string ir::PTXOperand::toString() const {
 			case b64: stream << imm_int; break;
 			case f16: /* fall through */
 			case f32: {
-				write(stream, imm_single);
+				writeFloat(stream, imm_single);
 			} break;
 			case f64: {
-				write(stream, imm_float);
+				writeFloat(stream, imm_float);
 			} break;
 			default: 
 				assertM( false, "Invalid immediate type " 
@@ -820,6 +820,146 @@ std::string ir::PTXOperand::toString() const {
 	}
 }
 
+void ir::PTXOperand::write(std::ostream& out) const {
+	
+	if( addressMode == BitBucket ) {
+		out << "_";
+	} else if( addressMode == Indirect ) {
+		if ( identifier != "" ) {
+			out << identifier;
+		}
+		else {
+			out << "%r" << reg;
+		}
+	
+		// The NVIDIA driver does not support '- offset' it needs '+ -offset'
+		if( offset != 0 ) {
+			out << " + " << offset;
+		}
+	} else if( addressMode == Address ) {
+		out << identifier;
+		if( offset != 0 ) {
+			out << " + " << offset;
+		}
+	} else if( addressMode == Immediate ) {
+		switch( type ) {
+			case pred: /* fall through */
+			case s8:  /* fall through */
+			case s16: /* fall through */
+			case s32: /* fall through */
+			case s64: /* fall through */
+			case u8:  /* fall through */
+			case u16: /* fall through */
+			case u32: /* fall through */
+			case u64: /* fall through */
+			case b8:  /* fall through */
+			case b16: /* fall through */
+			case b32: /* fall through */
+			case b64: out << imm_int; break;
+			case f16: /* fall through */
+			case f32: /* fall through */
+			case f64: {
+				std::ios::fmtflags flags = out.flags();
+				char fill = out.fill();
+				if( type == f64 ) {
+					writeFloat(out, imm_float);
+				}
+				else {
+					writeFloat(out, imm_single);
+				}
+				out.flags(flags);
+				out.fill(fill);
+			} break;
+			default: 
+				assertM( false, "Invalid immediate type " 
+				+ PTXOperand::toString( type ) ); break;
+		}
+	} else if( addressMode == Special ) {
+		bool isScalar = true;
+		switch (special) {
+		case tid: // fall through
+		case ntid: // fall through
+		case ctaId: // fall through
+		case nctaId:  // fall through
+		case smId:  // fall through
+		case nsmId:  // fall through
+		case gridId:  // fall through
+			isScalar = false;
+			break;
+		default:
+			isScalar = true;
+		}
+		out << toString( special );
+		if( vec == v1 && !isScalar ) {
+			assert( array.empty() );
+			out << "." << toString( vIndex );
+		}
+	} else if( addressMode == ArgumentList ) {
+		out << "(";
+		for( Array::const_iterator fi = array.begin(); 
+			fi != array.end(); ++fi ) {
+			if( fi != array.begin() ) {
+				out << ", ";
+			}
+			fi->write(out);
+		}
+		out << ")";
+	} else if( type == pred ) {
+		switch( condition ) {
+			case PT: /* fall through */
+			case nPT: out << "%pt"; break;
+			default:
+			{
+				if( !identifier.empty() ) {
+					out << identifier;
+				}
+				else {
+					if( condition == InvPred ) out << "!";
+					out << "%p" << reg;
+				}
+				break;
+			}
+		}
+	} 
+	else if( vec != v1 && !array.empty() ) {
+		assert( ( vec == v2 && array.size() == 2 ) 
+			|| ( vec == v4 && array.size() == 4 ) );
+		out << "{";
+		for( Array::const_iterator fi = array.begin(); 
+			fi != array.end(); ++fi ) {
+			if( fi != array.begin() ) {
+				out << ", ";
+			}
+			fi->write(out);
+		}
+		out << "}";
+	}
+	else if( vec != v1 ) {
+		assert( vIndex != iAll );
+		if( !identifier.empty() ) {
+			out << identifier;
+		}
+		else {
+			out << "%r" << reg;
+		}
+		out << "." << toString(vIndex);
+	}
+	else if (addressMode == Register && array.size()) {
+		out << "{";
+		for (size_t n = 0; n < array.size(); n++) {
+			if (n) out << ", ";
+			array[n].write(out);
+		}
+		out << "}";
+	}
+	else if( !identifier.empty() ) {
+		out << identifier;
+	}
+	else {
+		out << "%r" << reg;
+	}
+}
+
 std::string ir::PTXOperand::registerName() const {
 	assertM( addressMode == Indirect || addressMode == Register
 		|| addressMode == BitBucket, "invalid register address mode "
@@ -865,4 +1005,7 @@ bool ir::PTXOperand::isVector() const {
 	return isRegister() && vec != v1;
 }
 
-
+std::ostream& operator<<(std::ostream& s, const ir::PTXOperand& o) {
+	o.write(s);
+	return s;
+}
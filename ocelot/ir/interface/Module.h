@@ -11,6 +11,7 @@
 #include <vector>
 #include <map>
 #include <set>
+#include <functional>
 #include <unordered_map>
 
 #include <ocelot/ir/interface/PTXEmitter.h>
@@ -42,6 +43,9 @@ namespace ir {
 		/*! \brief map from unique identifier to function prototype */
 		typedef std::unordered_map< std::string,
 			ir::PTXKernel::Prototype > FunctionPrototypeMap;
+		
+		/*! \brief A function producing the PTX of a lazily loaded module */
+		typedef std::function< const char*() > PTXSource;
 				
 	public:
 
@@ -80,6 +84,12 @@ namespace ir {
 			PTXEmitter::Target emitterTarget =
 			PTXEmitter::Target_OcelotIR) const;
 		
+		/*! \brief Append the module to a buffer from the IR, emitting 
+			kernels on up to 'threads' threads (0 selects the hardware 
+			concurrency) and concatenating them in order */
+		void writeIR(std::string& buffer, PTXEmitter::Target emitterTarget,
+			unsigned int threads) const;
+		
 		/*! \brief Write the module to a string from the IR */
 		std::string toString(PTXEmitter::Target emitterTarget =
 			PTXEmitter::Target_OcelotIR) const;
@@ -106,6 +116,11 @@ namespace ir {
 		bool lazyLoad(const char* source,
 			const std::string& path = "::unknown path::");
 		
+		/*!	Unloads module and loads PTX source returned by a function when
+			the module is loaded, the pointer must be valid until then */
+		bool lazyLoad(const PTXSource& source,
+			const std::string& path = "::unknown path::");
+		
 		/*! \brief Load the module if it has not already been loaded */
 		void loadNow();
 		
@@ -226,6 +241,10 @@ namespace ir {
 	private:
 		/*! After a successful parse; constructs all kernels for PTX isa. */
 		void extractPTXKernels();
+		
+		/*! \brief Write everything that precedes the kernels */
+		void _writeIRHeader(std::ostream& stream, 
+			PTXEmitter::Target emitterTarget) const;
 
 	private:
 		/*! \brief This is a copy of the original ptx source for lazy loading */
@@ -234,6 +253,9 @@ namespace ir {
 		/*! \brief This is a pointer to the original ptx source 
 			for lazy loading */
 		const char* _ptxPointer;
+		
+		/*! \brief This produces the original ptx source for lazy loading */
+		PTXSource _ptxSource;
 	
 		/*! Set of PTX statements loaded from PTX source file. This must not 
 			change after parsing, as all kernels have const_iterators into 
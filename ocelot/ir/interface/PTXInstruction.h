@@ -378,6 +378,10 @@ namespace ir {
 		/*! Returns a parsable string representation of the instruction */
 		std::string toString() const;
 
+		/*! \brief Streams the same text as toString(), writing operands
+			directly rather than concatenating their strings */
+		void write(std::ostream& out) const;
+
 		/*! \brief Clone the instruction */
 		Instruction* clone( bool copy = true ) const;
 
@@ -11,6 +11,7 @@
 #include <string>
 #include <vector>
 #include <functional>
+#include <iosfwd>
 #include <ocelot/ir/interface/Instruction.h>
 
 namespace ir {
@@ -189,6 +190,8 @@ namespace ir {
 		~PTXOperand();
 
 		std::string toString() const;
+		/*! \brief Streams the same text as toString() without temporaries */
+		void write(std::ostream& out) const;
 		std::string registerName() const;
 		unsigned int bytes() const;
 		bool isRegister() const;
@@ -274,6 +277,8 @@ namespace ir {
 	}	
 }
 
+std::ostream& operator<<(std::ostream& s, const ir::PTXOperand& o);
+
 namespace std {
 	template<> 
 	struct hash<ir::PTXOperand::DataType> {
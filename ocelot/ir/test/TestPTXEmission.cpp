@@ -0,0 +1,513 @@
+/*!
+	\file TestPTXEmission.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for streaming PTX emission. Checks that
+		PTXInstruction::write matches toString on random instructions and
+		measures emission throughput in MB/s on large synthetic modules.
+*/
+
+#ifndef TEST_PTX_EMISSION_CPP_INCLUDED
+#define TEST_PTX_EMISSION_CPP_INCLUDED
+
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+#include <hydrazine/interface/BufferStream.h>
+#include <hydrazine/interface/Timer.h>
+
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Compare streamed and concatenated instruction text, then time
+		both emitters */
+	class TestPTXEmission : public Test
+	{
+		public:
+			typedef std::vector<ir::PTXInstruction> InstructionVector;
+
+		private:
+			ir::PTXOperand::DataType _type();
+			ir::PTXOperand _register(ir::PTXOperand::DataType type);
+			ir::PTXOperand _source(ir::PTXOperand::DataType type);
+			ir::PTXOperand _address();
+			ir::PTXInstruction _instruction();
+
+			std::string _module();
+
+			bool _testEquivalence();
+			bool _testInstructionThroughput();
+			bool _testModuleThroughput();
+
+			bool doTest();
+
+		public:
+			TestPTXEmission();
+
+		public:
+			unsigned int instructions;
+			unsigned int kernels;
+			unsigned int kernelInstructions;
+	};
+
+	ir::PTXOperand::DataType TestPTXEmission::_type()
+	{
+		static const ir::PTXOperand::DataType types[] = {
+			ir::PTXOperand::s32, ir::PTXOperand::s64, ir::PTXOperand::u32,
+			ir::PTXOperand::u64, ir::PTXOperand::b32, ir::PTXOperand::f32,
+			ir::PTXOperand::f64
+		};
+
+		return types[random() % (sizeof(types) / sizeof(types[0]))];
+	}
+
+	ir::PTXOperand TestPTXEmission::_register(ir::PTXOperand::DataType type)
+	{
+		ir::PTXOperand operand(ir::PTXOperand::Register, type,
+			(ir::PTXOperand::RegisterType)(random() % 4096));
+
+		if(random() % 4 == 0)
+		{
+			std::stringstream name;
+			name << "%named" << operand.reg;
+			operand.identifier = name.str();
+		}
+
+		return operand;
+	}
+
+	ir::PTXOperand TestPTXEmission::_source(ir::PTXOperand::DataType type)
+	{
+		switch(random() % 4)
+		{
+			case 0:
+			{
+				if(type == ir::PTXOperand::f32)
+				{
+					return ir::PTXOperand((float)random() / 7.0f);
+				}
+				if(type == ir::PTXOperand::f64)
+				{
+					return ir::PTXOperand((double)random() / 7.0);
+				}
+				return ir::PTXOperand((long long int)random() - (1 << 30),
+					type);
+			}
+			case 1:
+			{
+				static const ir::PTXOperand::SpecialRegister specials[] = {
+					ir::PTXOperand::tid, ir::PTXOperand::ctaId,
+					ir::PTXOperand::laneId, ir::PTXOperand::clock
+				};
+				return ir::PTXOperand(specials[random() % 4],
+					(ir::PTXOperand::VectorIndex)(random() % 3),
+					ir::PTXOperand::u32);
+			}
+			default: break;
+		}
+
+		return _register(type);
+	}
+
+	ir::PTXOperand TestPTXEmission::_address()
+	{
+		if(random() % 2)
+		{
+			ir::PTXOperand operand = _register(ir::PTXOperand::u64);
+			operand.addressMode = ir::PTXOperand::Indirect;
+			operand.offset = (int)(random() % 64) - 32;
+			return operand;
+		}
+
+		return ir::PTXOperand(ir::PTXOperand::Address, ir::PTXOperand::u64,
+			"__global_buffer", (int)(random() % 64) - 32);
+	}
+
+	ir::PTXInstruction TestPTXEmission::_instruction()
+	{
+		static const ir::PTXInstruction::Opcode opcodes[] = {
+			ir::PTXInstruction::Abs, ir::PTXInstruction::Add,
+			ir::PTXInstruction::AddC, ir::PTXInstruction::And,
+			ir::PTXInstruction::Atom, ir::PTXInstruction::Bfe,
+			ir::PTXInstruction::Bra, ir::PTXInstruction::Brev,
+			ir::PTXInstruction::Clz, ir::PTXInstruction::CNot,
+			ir::PTXInstruction::CopySign, ir::PTXInstruction::Cos,
+			ir::PTXInstruction::Cvt, ir::PTXInstruction::Div,
+			ir::PTXInstruction::Ex2, ir::PTXInstruction::Exit,
+			ir::PTXInstruction::Fma, ir::PTXInstruction::Ld,
+			ir::PTXInstruction::Ldu, ir::PTXInstruction::Lg2,
+			ir::PTXInstruction::Mad24, ir::PTXInstruction::Mad,
+			ir::PTXInstruction::MadC, ir::PTXInstruction::Max,
+			ir::PTXInstruction::Min, ir::PTXInstruction::Mov,
+			ir::PTXInstruction::Mul24, ir::PTXInstruction::Mul,
+			ir::PTXInstruction::Neg, ir::PTXInstruction::Not,
+			ir::PTXInstruction::Or, ir::PTXInstruction::Popc,
+			ir::PTXInstruction::Rcp, ir::PTXInstruction::Rem,
+			ir::PTXInstruction::Ret, ir::PTXInstruction::Rsqrt,
+			ir::PTXInstruction::Sad, ir::PTXInstruction::SelP,
+			ir::PTXInstruction::SetP, ir::PTXInstruction::Shl,
+			ir::PTXInstruction::Shr, ir::PTXInstruction::Sin,
+			ir::PTXInstruction::Sqrt, ir::PTXInstruction::St,
+			ir::PTXInstruction::Sub, ir::PTXInstruction::SubC,
+			ir::PTXInstruction::Xor
+		};
+
+		static const unsigned int modifiers[] = {
+			0, ir::PTXInstruction::lo, ir::PTXInstruction::wide,
+			ir::PTXInstruction::rn | ir::PTXInstruction::ftz,
+			ir::PTXInstruction::approx, ir::PTXInstruction::sat
+		};
+
+		ir::PTXInstruction instruction(
+			opcodes[random() % (sizeof(opcodes) / sizeof(opcodes[0]))]);
+
+		instruction.type = _type();
+		instruction.modifier = modifiers[random() % 6];
+		instruction.carry = (random() % 8 == 0)
+			? ir::PTXInstruction::CC : ir::PTXInstruction::None;
+		instruction.uni = random() % 2;
+		instruction.divideFull = random() % 2;
+		instruction.volatility = (random() % 4 == 0)
+			? ir::PTXInstruction::Volatile : ir::PTXInstruction::Nonvolatile;
+		instruction.cacheOperation = (ir::PTXInstruction::CacheOperation)(
+			random() % 3);
+		instruction.addressSpace = (ir::PTXInstruction::AddressSpace)(
+			ir::PTXInstruction::Const + random() % 7);
+		instruction.atomicOperation = ir::PTXInstruction::AtomicAdd;
+		instruction.comparisonOperator = (ir::PTXInstruction::CmpOp)(
+			random() % 10);
+		instruction.booleanOperator = ir::PTXInstruction::BoolAnd;
+
+		switch(random() % 4)
+		{
+			case 0:
+			{
+				instruction.pg = ir::PTXOperand(ir::PTXOperand::Pred);
+				instruction.pg.reg = random() % 16;
+				break;
+			}
+			case 1:
+			{
+				instruction.pg = ir::PTXOperand(ir::PTXOperand::InvPred);
+				instruction.pg.reg = random() % 16;
+				break;
+			}
+			default: break;
+		}
+
+		instruction.d = _register(instruction.type);
+		instruction.a = _source(instruction.type);
+		instruction.b = _source(instruction.type);
+		instruction.c = _source(instruction.type);
+
+		switch(instruction.opcode)
+		{
+			case ir::PTXInstruction::Bra:
+			{
+				instruction.d = ir::PTXOperand("$BB_0_1");
+				break;
+			}
+			case ir::PTXInstruction::Atom:
+			{
+				instruction.a = _address();
+				if(random() % 2)
+				{
+					instruction.c = ir::PTXOperand();
+				}
+				break;
+			}
+			case ir::PTXInstruction::Ld: // fall through
+			case ir::PTXInstruction::Ldu:
+			{
+				instruction.a = _address();
+				if(random() % 4 == 0)
+				{
+					instruction.d.vec = ir::PTXOperand::v2;
+					instruction.d.array.push_back(
+						_register(instruction.type));
+					instruction.d.array.push_back(
+						_register(instruction.type));
+				}
+				break;
+			}
+			case ir::PTXInstruction::St:
+			{
+				instruction.d = _address();
+				if(random() % 4 == 0)
+				{
+					instruction.a = _register(instruction.type);
+					instruction.a.vec = ir::PTXOperand::v4;
+					for(unsigned int i = 0; i < 4; ++i)
+					{
+						instruction.a.array.push_back(
+							_register(instruction.type));
+					}
+				}
+				break;
+			}
+			case ir::PTXInstruction::SetP:
+			{
+				instruction.d = _register(ir::PTXOperand::pred);
+				if(random() % 2)
+				{
+					instruction.pq = _register(ir::PTXOperand::pred);
+				}
+				if(random() % 2)
+				{
+					instruction.c = _register(ir::PTXOperand::pred);
+				}
+				else
+				{
+					instruction.c = ir::PTXOperand();
+				}
+				break;
+			}
+			default: break;
+		}
+
+		return instruction;
+	}
+
+	std::string TestPTXEmission::_module()
+	{
+		std::stringstream ptx;
+
+		ptx << ".version 2.3\n";
+		ptx << ".target sm_20\n";
+		ptx << ".address_size 64\n\n";
+
+		for(unsigned int k = 0; k < kernels; ++k)
+		{
+			ptx << ".entry synthetic_" << k
+				<< "(.param .u64 __param_out)\n";
+			ptx << "{\n";
+			ptx << "\t.reg .u32 %r<64>;\n";
+			ptx << "\t.reg .u64 %rd<16>;\n";
+			ptx << "\t.reg .f32 %f<32>;\n";
+			ptx << "\t.reg .pred %p<4>;\n";
+			ptx << "\tld.param.u64 %rd0, [__param_out];\n";
+			ptx << "\tmov.u32 %r0, %tid.x;\n";
+
+			for(unsigned int i = 0; i < kernelInstructions; i += 8)
+			{
+				unsigned int r = random() % 56;
+				unsigned int f = random() % 24;
+				ptx << "$Lt_" << k << "_" << i << ":\n";
+				ptx << "\tadd.u32 %r" << r + 1 << ", %r" << r
+					<< ", " << i << ";\n";
+				ptx << "\tmul.lo.u32 %r" << r + 2 << ", %r" << r + 1
+					<< ", %r" << r << ";\n";
+				ptx << "\tmad.rn.f32 %f" << f + 1 << ", %f" << f
+					<< ", %f" << f + 2 << ", 0f3f800000;\n";
+				ptx << "\tcvt.u64.u32 %rd1, %r" << r + 2 << ";\n";
+				ptx << "\tadd.u64 %rd2, %rd0, %rd1;\n";
+				ptx << "\tld.global.f32 %f" << f << ", [%rd2+" << 4 * r
+					<< "];\n";
+				ptx << "\tst.global.f32 [%rd2+" << 4 * f << "], %f"
+					<< f + 1 << ";\n";
+				ptx << "\tsetp.lt.u32 %p1, %r" << r + 2 << ", %r"
+					<< r + 3 << ";\n";
+				ptx << "\t@%p1 bra $Lt_" << k << "_" << i << "_next;\n";
+				ptx << "$Lt_" << k << "_" << i << "_next:\n";
+			}
+
+			ptx << "\texit;\n";
+			ptx << "}\n\n";
+		}
+
+		return ptx.str();
+	}
+
+	bool TestPTXEmission::_testEquivalence()
+	{
+		for(unsigned int i = 0; i < instructions; ++i)
+		{
+			ir::PTXInstruction instruction = _instruction();
+
+			std::stringstream streamed;
+			instruction.write(streamed);
+
+			std::string expected = instruction.toString();
+
+			if(streamed.str() != expected)
+			{
+				status << "Streamed emission of instruction " << i
+					<< " differs.\n";
+				status << " expected: " << expected << "\n";
+				status << " streamed: " << streamed.str() << "\n";
+				return false;
+			}
+		}
+
+		status << "Streamed emission matched toString() on " << instructions
+			<< " random instructions.\n";
+
+		return true;
+	}
+
+	bool TestPTXEmission::_testInstructionThroughput()
+	{
+		InstructionVector program;
+		program.reserve(instructions);
+
+		for(unsigned int i = 0; i < instructions; ++i)
+		{
+			program.push_back(_instruction());
+		}
+
+		std::string concatenated;
+		std::string streamed;
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		{
+			hydrazine::BufferStream stream(concatenated);
+			for(InstructionVector::const_iterator
+				instruction = program.begin();
+				instruction != program.end(); ++instruction)
+			{
+				stream << "\t\t" << instruction->toString() << ";\n";
+			}
+		}
+		timer.stop();
+
+		double concatenatedSeconds = timer.seconds();
+
+		timer.start();
+		{
+			hydrazine::BufferStream stream(streamed);
+			for(InstructionVector::const_iterator
+				instruction = program.begin();
+				instruction != program.end(); ++instruction)
+			{
+				stream << "\t\t";
+				instruction->write(stream);
+				stream << ";\n";
+			}
+		}
+		timer.stop();
+
+		double streamedSeconds = timer.seconds();
+
+		if(concatenated != streamed)
+		{
+			status << "Streamed instruction text differs from toString().\n";
+			return false;
+		}
+
+		double megabytes = streamed.size() / (1024.0 * 1024.0);
+
+		status << "Instruction emission (" << megabytes << " MB):\n";
+		status << " toString(): " << (megabytes / concatenatedSeconds)
+			<< " MB/s\n";
+		status << " write():    " << (megabytes / streamedSeconds)
+			<< " MB/s\n";
+
+		return true;
+	}
+
+	bool TestPTXEmission::_testModuleThroughput()
+	{
+		std::string source = _module();
+
+		ir::Module module;
+		module.lazyLoad(source, "synthetic.ptx");
+		module.loadNow();
+
+		std::string serial;
+		std::string parallel;
+		std::string streamed;
+
+		hydrazine::Timer timer;
+
+		timer.start();
+		{
+			std::stringstream stream;
+			module.writeIR(stream, ir::PTXEmitter::Target_NVIDIA_PTX30);
+			streamed = stream.str();
+		}
+		timer.stop();
+
+		double streamSeconds = timer.seconds();
+
+		timer.start();
+		module.writeIR(serial, ir::PTXEmitter::Target_NVIDIA_PTX30, 1);
+		timer.stop();
+
+		double serialSeconds = timer.seconds();
+
+		timer.start();
+		module.writeIR(parallel, ir::PTXEmitter::Target_NVIDIA_PTX30, 0);
+		timer.stop();
+
+		double parallelSeconds = timer.seconds();
+
+		if(serial != parallel || serial != streamed)
+		{
+			status << "Module emission differs between the stringstream, "
+				<< "serial and parallel paths.\n";
+			return false;
+		}
+
+		double megabytes = serial.size() / (1024.0 * 1024.0);
+
+		status << "Module emission (" << kernels << " kernels, "
+			<< megabytes << " MB):\n";
+		status << " stringstream:     " << (megabytes / streamSeconds)
+			<< " MB/s\n";
+		status << " buffer, serial:   " << (megabytes / serialSeconds)
+			<< " MB/s\n";
+		status << " buffer, parallel: " << (megabytes / parallelSeconds)
+			<< " MB/s\n";
+
+		return true;
+	}
+
+	bool TestPTXEmission::doTest()
+	{
+		return _testEquivalence() && _testInstructionThroughput()
+			&& _testModuleThroughput();
+	}
+
+	TestPTXEmission::TestPTXEmission()
+	{
+		name = "TestPTXEmission";
+
+		description = "Emits random PTX instructions through the streaming ";
+		description += "writer and through toString() and requires the text ";
+		description += "to match. Then reports emission throughput in MB/s ";
+		description += "for single instructions and for a large synthetic ";
+		description += "module written through every Module::writeIR path.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestPTXEmission test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-i", "--instructions", test.instructions, 200000,
+		"Random instructions to emit.");
+	parser.parse("-k", "--kernels", test.kernels, 64,
+		"Kernels in the synthetic module.");
+	parser.parse("-n", "--kernel-instructions", test.kernelInstructions,
+		4000, "Instructions per synthetic kernel.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+
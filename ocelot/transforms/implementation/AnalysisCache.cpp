@@ -0,0 +1,357 @@
+/*! \file AnalysisCache.cpp
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The source file for the AnalysisCache class
+*/
+
+// Ocelot Includes
+#include <ocelot/transforms/interface/AnalysisCache.h>
+
+#include <ocelot/analysis/interface/Analysis.h>
+
+#include <ocelot/ir/interface/IRKernel.h>
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/ControlFlowGraph.h>
+#include <ocelot/ir/interface/PTXInstruction.h>
+
+// Hydrazine Includes
+#include <hydrazine/interface/debug.h>
+
+// Standard Library Includes
+#include <stdint.h>
+
+// Preprocessor Macros
+#ifdef REPORT_BASE
+#undef REPORT_BASE
+#endif
+
+#define REPORT_BASE 0
+
+namespace transforms
+{
+
+AnalysisCache::Content::Content(size_t h, const std::string& k, size_t i)
+: hash(h), kernel(k), instructions(i)
+{
+
+}
+
+bool AnalysisCache::Content::operator==(const Content& content) const
+{
+	return hash == content.hash && instructions == content.instructions &&
+		kernel == content.kernel;
+}
+
+bool AnalysisCache::Content::operator!=(const Content& content) const
+{
+	return !(*this == content);
+}
+
+bool AnalysisCache::Content::operator<(const Content& content) const
+{
+	if(hash != content.hash) return hash < content.hash;
+	if(instructions != content.instructions)
+	{
+		return instructions < content.instructions;
+	}
+	
+	return kernel < content.kernel;
+}
+
+AnalysisCache::Entry::Entry(Analysis* a, KeyList::iterator r)
+: analysis(a), released(r)
+{
+
+}
+
+AnalysisCache::AnalysisCache()
+: cacheable({"DataflowGraphAnalysis", "DominatorTreeAnalysis",
+	"PostDominatorTreeAnalysis", "DivergenceAnalysis"}),
+	capacity(1024), hits(0), misses(0)
+{
+
+}
+
+AnalysisCache::~AnalysisCache()
+{
+	clear();
+}
+
+AnalysisCache::Analysis* AnalysisCache::acquire(const std::string& type,
+	const Content& content)
+{
+	if(cacheable.count(type) == 0) return 0;
+
+	auto cached = _analyses.find(Key(content, type));
+
+	if(cached == _analyses.end())
+	{
+		++misses;
+		return 0;
+	}
+
+	Analysis* analysis = cached->second.analysis;
+	_released.erase(cached->second.released);
+	_analyses.erase(cached);
+
+	report("Reusing " << type << " of kernel " << content.kernel);
+
+	++hits;
+	return analysis;
+}
+
+void AnalysisCache::track(Analysis* analysis, const Content& content,
+	const Content& current)
+{
+	if(cacheable.count(analysis->name) == 0) return;
+
+	_contents[analysis] = ContentPair(content, current);
+}
+
+void AnalysisCache::release(Analysis* analysis, const Content& content)
+{
+	auto tracked = _contents.find(analysis);
+
+	if(tracked == _contents.end())
+	{
+		delete analysis;
+		return;
+	}
+
+	Key key(tracked->second.first, analysis->name);
+	bool changed = tracked->second.second != content;
+	_contents.erase(tracked);
+
+	if(changed ||
+		!static_cast<analysis::KernelAnalysis*>(analysis)->detach())
+	{
+		report("Not caching " << analysis->name << " of kernel "
+			<< content.kernel);
+
+		delete analysis;
+		return;
+	}
+
+	/* a second copy computed while the first one was in use */
+	if(_analyses.count(key) != 0)
+	{
+		delete analysis;
+		return;
+	}
+
+	_released.push_front(key);
+	_analyses.insert(std::make_pair(key, Entry(analysis, _released.begin())));
+
+	while(_analyses.size() > capacity)
+	{
+		auto oldest = _analyses.find(_released.back());
+
+		report("Evicting " << oldest->first.second << " of kernel "
+			<< oldest->first.first.kernel);
+
+		delete oldest->second.analysis;
+		_analyses.erase(oldest);
+		_released.pop_back();
+	}
+}
+
+void AnalysisCache::discard(Analysis* analysis)
+{
+	_contents.erase(analysis);
+	delete analysis;
+}
+
+void AnalysisCache::clear()
+{
+	for(auto cached = _analyses.begin(); cached != _analyses.end(); ++cached)
+	{
+		delete cached->second.analysis;
+	}
+
+	_analyses.clear();
+	_released.clear();
+}
+
+size_t AnalysisCache::size() const
+{
+	return _analyses.size();
+}
+
+static void hashBytes(uint64_t& hash, const void* data, size_t bytes)
+{
+	const unsigned char* byte = (const unsigned char*)data;
+
+	for(size_t i = 0; i < bytes; ++i)
+	{
+		hash ^= byte[i];
+		hash *= 0x100000001b3ULL;
+	}
+}
+
+template<typename T>
+static void hashValue(uint64_t& hash, const T& value)
+{
+	hashBytes(hash, &value, sizeof(value));
+}
+
+static void hashString(uint64_t& hash, const std::string& string)
+{
+	hashBytes(hash, string.data(), string.size());
+	hashBytes(hash, "", 1);
+}
+
+/*! Only the members the address mode gives a meaning are hashed, the
+	others share storage with them */
+static void hashOperand(uint64_t& hash, const ir::PTXOperand& operand)
+{
+	typedef ir::PTXOperand PTXOperand;
+
+	hashValue(hash, operand.addressMode);
+	hashValue(hash, operand.type);
+	hashValue(hash, operand.vec);
+	hashString(hash, operand.identifier);
+
+	switch(operand.addressMode)
+	{
+	case PTXOperand::Register: /* fall through */
+	case PTXOperand::Indirect:
+	{
+		hashValue(hash, operand.reg);
+		hashValue(hash, operand.offset);
+	}
+	break;
+	case PTXOperand::Immediate:
+	{
+		hashValue(hash, operand.imm_uint);
+	}
+	break;
+	case PTXOperand::Special:
+	{
+		hashValue(hash, operand.special);
+		hashValue(hash, operand.vIndex);
+	}
+	break;
+	case PTXOperand::Address:
+	{
+		hashValue(hash, operand.offset);
+	}
+	break;
+	default: break;
+	}
+
+	if(operand.type == PTXOperand::pred &&
+		operand.addressMode != PTXOperand::Immediate)
+	{
+		hashValue(hash, operand.condition);
+	}
+
+	for(auto element = operand.array.begin();
+		element != operand.array.end(); ++element)
+	{
+		hashOperand(hash, *element);
+	}
+}
+
+/*! Each union of modifiers is hashed through the member the constructor
+	initializes */
+static void hashInstruction(uint64_t& hash, const ir::Instruction& instruction)
+{
+	if(instruction.ISA != ir::Instruction::PTX)
+	{
+		hashString(hash, instruction.toString());
+		return;
+	}
+
+	const ir::PTXInstruction& ptx =
+		static_cast<const ir::PTXInstruction&>(instruction);
+
+	hashValue(hash, ptx.opcode);
+	hashValue(hash, ptx.type);
+	hashValue(hash, ptx.modifier);
+	hashValue(hash, ptx.addressSpace);
+	hashValue(hash, ptx.tailCall);
+	hashValue(hash, ptx.vec);
+	hashValue(hash, ptx.cc);
+	hashValue(hash, ptx.geometry);
+	hashValue(hash, ptx.carry);
+
+	hashOperand(hash, ptx.pg);
+	hashOperand(hash, ptx.pq);
+	hashOperand(hash, ptx.d);
+	hashOperand(hash, ptx.a);
+	hashOperand(hash, ptx.b);
+	hashOperand(hash, ptx.c);
+}
+
+/*! The hash covers everything the cached analyses read from the kernel,
+	block ids included, since detached analyses refer to blocks by id */
+AnalysisCache::Content AnalysisCache::content(const IRKernel& kernel)
+{
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	size_t instructions = 0;
+
+	hashString(hash, kernel.name);
+	hashValue(hash, kernel.function());
+
+	for(auto argument = kernel.arguments.begin();
+		argument != kernel.arguments.end(); ++argument)
+	{
+		hashString(hash, argument->toString());
+	}
+
+	for(auto parameter = kernel.parameters.begin();
+		parameter != kernel.parameters.end(); ++parameter)
+	{
+		hashString(hash, parameter->second.toString());
+	}
+
+	for(auto local = kernel.locals.begin(); local != kernel.locals.end();
+		++local)
+	{
+		hashString(hash, local->second.toString());
+	}
+
+	/* divergence analysis treats module variables in local memory as
+		divergent */
+	if(kernel.module != 0)
+	{
+		for(auto global = kernel.module->globals().begin();
+			global != kernel.module->globals().end(); ++global)
+		{
+			if(global->second.space() != ir::PTXInstruction::Local) continue;
+
+			hashString(hash, global->first);
+		}
+	}
+
+	const ir::ControlFlowGraph* cfg = kernel.cfg();
+
+	if(cfg == 0) return Content(hash, kernel.name, instructions);
+
+	hashValue(hash, cfg->get_entry_block()->id);
+	hashValue(hash, cfg->get_exit_block()->id);
+
+	for(auto block = cfg->begin(); block != cfg->end(); ++block)
+	{
+		hashValue(hash, block->id);
+		hashString(hash, block->label());
+
+		for(auto instruction = block->instructions.begin();
+			instruction != block->instructions.end(); ++instruction)
+		{
+			hashInstruction(hash, **instruction);
+			++instructions;
+		}
+
+		for(auto edge = block->out_edges.begin();
+			edge != block->out_edges.end(); ++edge)
+		{
+			hashValue(hash, (*edge)->tail->id);
+			hashValue(hash, (*edge)->type);
+		}
+	}
+
+	return Content(hash, kernel.name, instructions);
+}
+
+}
@@ -8,10 +8,12 @@
 // Ocelot Includes
 #include <ocelot/transforms/interface/PassManager.h>
 #include <ocelot/transforms/interface/PassFactory.h>
+#include <ocelot/transforms/interface/AnalysisCache.h>
 #include <ocelot/transforms/interface/Pass.h>
 
 #include <ocelot/analysis/interface/Analysis.h>
 #include <ocelot/analysis/interface/AnalysisFactory.h>
+#include <ocelot/analysis/interface/DataflowGraph.h>
 
 #include <ocelot/ir/interface/IRKernel.h>
 #include <ocelot/ir/interface/Module.h>
@@ -20,6 +22,8 @@
 #include <hydrazine/interface/debug.h>
 
 // Standard Library Includes
+#include <algorithm>
+#include <limits>
 #include <stdexcept>
 
 // Preprocessor Macros
@@ -135,8 +139,24 @@ static PassUseCountMap getPassUseCounts(const PassWaveList& waves,
 	return uses;
 }
 	
+static void freeAnalysis(analysis::Analysis* analysis, IRKernel* function,
+	const AnalysisMap& analyses, PassManager* manager)
+{
+	AnalysisCache* cache = manager->getAnalysisCache();
+
+	if(cache != 0 && cache->cacheable.count(analysis->name) != 0)
+	{
+		cache->release(analysis,
+			manager->getKernelContent(*function, analyses));
+	}
+	else
+	{
+		delete analysis;
+	}
+}
+
 static void freeUnusedDataStructures(PassUseCountMap& uses,
-	AnalysisMap& analyses)
+	AnalysisMap& analyses, IRKernel* function, PassManager* manager)
 {
 	Pass::StringVector freedAnalyses;
 	
@@ -148,6 +168,27 @@ static void freeUnusedDataStructures(PassUseCountMap& uses,
 		}
 	}
 	
+	// free users before the analyses they require, which are still in the
+	// state the users were computed with
+	for(auto type = freedAnalyses.begin(); type != freedAnalyses.end(); ++type)
+	{
+		for(auto user = type + 1; user != freedAnalyses.end(); ++user)
+		{
+			auto analysis = analyses.find(*user);
+			
+			if(analysis == analyses.end()) continue;
+			
+			auto& required = analysis->second->required;
+			
+			if(std::find(required.begin(), required.end(), *type) !=
+				required.end())
+			{
+				std::rotate(type, user, user + 1);
+				user = type;
+			}
+		}
+	}
+	
 	for(auto& analysisType : freedAnalyses)
 	{
 		auto use = uses.find(analysisType);
@@ -164,7 +205,7 @@ static void freeUnusedDataStructures(PassUseCountMap& uses,
 			
 			if(analysis != analyses.end())
 			{
-				delete analysis->second;
+				freeAnalysis(analysis->second, function, analyses, manager);
 
 				analyses.erase(analysis);
 			}
@@ -184,10 +225,30 @@ static void allocateDataStructure(PassUseCountMap& uses,
 {
 	if(analyses.count(analysisType) != 0) return;
 
-	report("  Creating analysis " << analysisType);
+	AnalysisCache* cache = manager->getAnalysisCache();
 	
-	auto newAnalysis = analysis::AnalysisFactory::createAnalysis(analysisType);
-	assert(newAnalysis != nullptr);
+	AnalysisCache::Content content;
+	analysis::Analysis* newAnalysis = nullptr;
+	
+	if(cache != 0 && cache->cacheable.count(analysisType) != 0)
+	{
+		content = manager->getKernelContent(*function, analyses);
+		newAnalysis = cache->acquire(analysisType, content);
+	}
+	
+	bool cached = newAnalysis != nullptr;
+
+	if(cached)
+	{
+		report("  Reusing cached analysis " << analysisType);
+	}
+	else
+	{
+		report("  Creating analysis " << analysisType);
+	
+		newAnalysis = analysis::AnalysisFactory::createAnalysis(analysisType);
+		assert(newAnalysis != nullptr);
+	}
 
 	newAnalysis->setPassManager(manager);
 
@@ -197,7 +258,20 @@ static void allocateDataStructure(PassUseCountMap& uses,
 	auto functionAnalysis = static_cast<analysis::KernelAnalysis*>(
 		newAnalysis);
 
-	functionAnalysis->analyze(*function);
+	if(cached)
+	{
+		functionAnalysis->attach(*function);
+	}
+	else
+	{
+		functionAnalysis->analyze(*function);
+	}
+
+	if(cache != 0 && cache->cacheable.count(analysisType) != 0)
+	{
+		cache->track(newAnalysis, content,
+			manager->getKernelContent(*function, analyses));
+	}
 
 	// free dependencies (use-counts)
 	freeDependencies(uses, newAnalysis);
@@ -454,7 +528,7 @@ static void runModulePass(Module* module, Pass* pass)
 }
 
 PassManager::PassManager(Module* module) :
-	_module(module), _analyses(0)
+	_module(module), _analyses(0), _cache(0)
 {
 	report("PassManager::PassManager...");
 	assert(_module != 0);
@@ -521,6 +595,8 @@ void PassManager::runOnKernel(IRKernel& function)
 	
 	PassUseCountMap passesUseCounts = getPassUseCounts(passes);
 	
+	_contents.clear();
+	
 	for(auto wave = passes.begin(); wave != passes.end(); ++wave)
 	{
 		for(auto pass = wave->begin(); pass != wave->end(); ++pass)
@@ -540,8 +616,10 @@ void PassManager::runOnKernel(IRKernel& function)
 		
 			runKernelPass(&function, *pass);
 			_previouslyRunPasses[(*pass)->name] = *pass;
+			_changed(&function, *pass);
 			
-			freeUnusedDataStructures(passesUseCounts, analyses);
+			freeUnusedDataStructures(passesUseCounts, analyses, &function,
+				this);
 		}
 
 		for(auto pass = wave->begin(); pass != wave->end(); ++pass)
@@ -555,6 +633,7 @@ void PassManager::runOnKernel(IRKernel& function)
 	
 	assert(passesUseCounts.empty());
 	_previouslyRunPasses.clear();
+	_contents.clear();
 }
 
 void PassManager::runOnModule()
@@ -569,6 +648,8 @@ void PassManager::runOnModule()
 
 	PassUseCountMap passesUseCounts = getPassUseCounts(passes, *_module);
 	
+	_contents.clear();
+	
 	// Run waves in order
 	for(auto wave = passes.begin(); wave != passes.end(); ++wave)
 	{
@@ -587,12 +668,14 @@ void PassManager::runOnModule()
 				allocateNewDataStructures(passesUseCounts, analyses->second,
 					function->second, (*pass)->analyses, this);
 			
-				freeUnusedDataStructures(passesUseCounts, analyses->second);
+				freeUnusedDataStructures(passesUseCounts, analyses->second,
+					function->second, this);
 			}
 			
 			_previouslyRunPasses[(*pass)->name] = *pass;
 			report("PassManager::runOnModule()::runModulePass()");	
 			runModulePass(_module, *pass);
+			_changed(0, *pass);
 		}
 	
 		// Run all function and bb passes
@@ -621,8 +704,10 @@ void PassManager::runOnModule()
 				report("PassManager::runOnModule()::runKernelPass()");	
 				runKernelPass(_module, _function, *pass);
 				_previouslyRunPasses[(*pass)->name] = *pass;
+				_changed(_function, *pass);
 			
-				freeUnusedDataStructures(passesUseCounts, analyses->second);
+				freeUnusedDataStructures(passesUseCounts, analyses->second,
+					_function, this);
 			}
 
 			for(auto pass = wave->begin(); pass != wave->end(); ++pass)
@@ -637,6 +722,7 @@ void PassManager::runOnModule()
 	
 	assert(passesUseCounts.empty());
 	_previouslyRunPasses.clear();
+	_contents.clear();
 }
 
 PassManager::Analysis* PassManager::getAnalysis(const std::string& type)
@@ -673,7 +759,8 @@ void PassManager::invalidateAnalysis(const std::string& type)
 	if(analysis != _analyses->end())
 	{
 		report("Invalidating analysis " << type);
-		delete analysis->second;
+		if(_cache != 0) _cache->discard(analysis->second);
+		else delete analysis->second;
 		_analyses->erase(analysis);
 	}
 }
@@ -686,11 +773,50 @@ void PassManager::invalidateAllAnalyses()
 	{
 		AnalysisMap::iterator analysis = _analyses->begin();
 		report("Invalidating analysis " << analysis->first);
-		delete analysis->second;
+		if(_cache != 0) _cache->discard(analysis->second);
+		else delete analysis->second;
 		_analyses->erase(analysis);
 	}
 }
 
+void PassManager::setAnalysisCache(AnalysisCache* cache)
+{
+	_cache = cache;
+}
+
+AnalysisCache* PassManager::getAnalysisCache() const
+{
+	return _cache;
+}
+
+/*! The DataflowGraphAnalysis renames the registers of the kernel while
+	it is in SSA form */
+const AnalysisCache::Content& PassManager::getKernelContent(
+	const IRKernel& kernel, const AnalysisMap& analyses)
+{
+	unsigned int form = analysis::DataflowGraph::None;
+	
+	auto dfg = analyses.find("DataflowGraphAnalysis");
+	
+	if(dfg != analyses.end())
+	{
+		form = static_cast<const analysis::DataflowGraph*>(
+			dfg->second)->ssa();
+	}
+	
+	KernelForm key(&kernel, form);
+	
+	auto content = _contents.find(key);
+	
+	if(content == _contents.end())
+	{
+		content = _contents.insert(std::make_pair(key,
+			AnalysisCache::content(kernel))).first;
+	}
+	
+	return content->second;
+}
+
 Pass* PassManager::getPass(const std::string& name)
 {
 	auto pass = _previouslyRunPasses.find(name);
@@ -915,6 +1041,32 @@ Pass* PassManager::_findPass(const std::string& name)
 	return 0;
 }
 
+/*! Only immutable passes leave the kernels as they were, a module pass may
+	change any of them */
+void PassManager::_changed(const IRKernel* kernel, const Pass* pass)
+{
+	switch(pass->type)
+	{
+	case Pass::ImmutablePass: /* fall through */
+	case Pass::ImmutableKernelPass:
+	break;
+	case Pass::ModulePass:
+	{
+		_contents.clear();
+	}
+	break;
+	case Pass::KernelPass:     /* fall through */
+	case Pass::BasicBlockPass:
+	{
+		_contents.erase(_contents.lower_bound(KernelForm(kernel, 0)),
+			_contents.upper_bound(KernelForm(kernel,
+			std::numeric_limits<unsigned int>::max())));
+	}
+	break;
+	case Pass::InvalidPass: assertM(false, "Invalid pass type.");
+	}
+}
+
 }
 
 
@@ -0,0 +1,149 @@
+/*! \file AnalysisCache.h
+	\date Monday October 19, 2026
+	\author agent <agent@local>
+	\brief The header file for the AnalysisCache class
+*/
+
+#ifndef ANALYSIS_CACHE_H_INCLUDED
+#define ANALYSIS_CACHE_H_INCLUDED
+
+// Standard Library Includes
+#include <list>
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+
+// Forward Declarations
+namespace analysis   { class Analysis; }
+namespace ir         { class IRKernel; }
+
+namespace transforms
+{
+
+/*! \brief Keeps kernel analyses alive across PassManager instances.
+
+	Analyses are keyed by the content of the kernel they were computed on,
+	so a kernel that is parsed again or copied reuses them. The pass
+	manager that created or acquired an analysis returns it to the cache
+	with the content of the kernel at that time, the analysis is kept if
+	the kernel did not change since the analysis was computed or attached
+	and the analysis can detach from the kernel. A cached analysis holds no pointers into any kernel, it
+	is attached to the kernel that acquires it.
+
+	The least recently returned analyses are deleted once more than
+	capacity are cached.
+
+	The DataflowGraphAnalysis is kept only while it is not in SSA form.
+*/
+class AnalysisCache
+{
+public:
+	typedef analysis::Analysis Analysis;
+	typedef ir::IRKernel       IRKernel;
+	typedef std::set<std::string> StringSet;
+
+	/*! \brief The content of a kernel an analysis describes */
+	class Content
+	{
+	public:
+		Content(size_t hash = 0, const std::string& kernel = "",
+			size_t instructions = 0);
+
+	public:
+		bool operator==(const Content& content) const;
+		bool operator!=(const Content& content) const;
+		bool operator<(const Content& content) const;
+
+	public:
+		/*! \brief a hash of everything the cached analyses read */
+		size_t      hash;
+		/*! \brief the name and size of the kernel, compared in case two
+			kernels hash alike */
+		std::string kernel;
+		size_t      instructions;
+	};
+
+public:
+	AnalysisCache();
+	~AnalysisCache();
+
+public:
+	/*! \brief Take a detached analysis of a kernel with the given content
+		out of the cache, or 0 if there is none */
+	Analysis* acquire(const std::string& type, const Content& content);
+
+	/*! \brief Remember the content of the kernel an analysis was computed
+		on, or attached to, and the content once it was */
+	void track(Analysis* analysis, const Content& content,
+		const Content& current);
+
+	/*! \brief Return an analysis that is no longer used along with the
+		current content of its kernel, it is kept if the content did not
+		change since it was tracked */
+	void release(Analysis* analysis, const Content& content);
+
+	/*! \brief Delete an analysis that is out of date */
+	void discard(Analysis* analysis);
+
+	/*! \brief Delete all cached analyses */
+	void clear();
+
+	/*! \brief The number of cached analyses */
+	size_t size() const;
+
+public:
+	/*! \brief The content of a kernel, hashed from the instructions and
+		operands without printing them */
+	static Content content(const IRKernel& kernel);
+
+public:
+	/*! \brief Names of the analyses that may be cached */
+	StringSet cacheable;
+
+	/*! \brief The most analyses kept in the cache */
+	size_t capacity;
+
+	/*! \brief Analyses reused and computed */
+	unsigned long hits;
+	unsigned long misses;
+
+public:
+	AnalysisCache(const AnalysisCache&) = delete;
+	const AnalysisCache& operator=(const AnalysisCache&) = delete;
+
+private:
+	typedef std::pair<Content, std::string> Key;
+	typedef std::list<Key> KeyList;
+
+	/*! \brief A detached analysis and its place in the release order */
+	class Entry
+	{
+	public:
+		Entry(Analysis* analysis = 0,
+			KeyList::iterator released = KeyList::iterator());
+
+	public:
+		Analysis*         analysis;
+		KeyList::iterator released;
+	};
+
+	typedef std::map<Key, Entry> AnalysisMap;
+	/*! \brief The content an analysis in use describes, and the content
+		of its kernel once it was computed or attached */
+	typedef std::pair<Content, Content> ContentPair;
+	typedef std::unordered_map<Analysis*, ContentPair> ContentMap;
+
+private:
+	/*! \brief Detached analyses not used by any pass manager */
+	AnalysisMap _analyses;
+	/*! \brief The keys of the detached analyses, most recently released
+		first */
+	KeyList     _released;
+	/*! \brief The kernel content of the analyses in use */
+	ContentMap  _contents;
+};
+
+}
+
+#endif
@@ -7,6 +7,9 @@
 #ifndef PASS_MANAGER_H_INCLUDED
 #define PASS_MANAGER_H_INCLUDED
 
+// Ocelot Includes
+#include <ocelot/transforms/interface/AnalysisCache.h>
+
 // Standard Library Includes
 #include <map>
 #include <unordered_map>
@@ -109,6 +112,21 @@ public:
 		need to generate them again the next time 'get' is called */
 	void invalidateAllAnalyses();
 
+public:
+	/*! \brief Keep analyses in a cache that outlives the manager instead
+		of deleting them, 0 to stop caching. The cache is not owned. */
+	void setAnalysisCache(AnalysisCache* cache);
+
+	/*! \brief The cache analyses are kept in, or 0 */
+	AnalysisCache* getAnalysisCache() const;
+
+	/*! \brief The content of a kernel as the cache keys it, while the
+		given analyses of the kernel are alive. It is hashed once for each
+		SSA form the analyses put the registers of the kernel in, until a
+		pass that may change the kernel runs. */
+	const AnalysisCache::Content& getKernelContent(const IRKernel& kernel,
+		const AnalysisMap& analyses);
+
 public:
 	/*! \brief Get a previously run pass by name */
 	Pass* getPass(const std::string& name);
@@ -126,17 +144,22 @@ private:
 	typedef std::multimap<std::string, std::string> DependenceMap;
 	typedef std::unordered_map<std::string, Pass*> PassMap;
 	typedef std::vector<std::string> StringVector;
+	typedef std::pair<const IRKernel*, unsigned int> KernelForm;
+	typedef std::map<KernelForm, AnalysisCache::Content> ContentMap;
 
 private:
 	PassWaveList _schedulePasses();
 	StringVector _getAllDependentPasses(Pass* p);
 	Pass*        _findPass(const std::string& name);
+	void         _changed(const IRKernel* kernel, const Pass* pass);
 
 private:
 	PassVector    _passes;
 	Module*       _module;
 	IRKernel*     _function;
 	AnalysisMap*  _analyses;
+	AnalysisCache* _cache;
+	ContentMap    _contents;
 	PassVector    _ownedTemporaryPasses;
 	DependenceMap _extraDependences;
 	PassMap       _previouslyRunPasses;
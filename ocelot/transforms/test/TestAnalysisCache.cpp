@@ -0,0 +1,560 @@
+/*!
+	\file TestAnalysisCache.cpp
+	\author agent <agent@local>
+	\date Monday October 19, 2026
+	\brief A test for the AnalysisCache. Random kernels are parsed into
+		several modules that share one cache, and the analyses reused from
+		the cache must describe each new copy exactly like analyses
+		computed from scratch.
+*/
+
+#ifndef TEST_ANALYSIS_CACHE_CPP_INCLUDED
+#define TEST_ANALYSIS_CACHE_CPP_INCLUDED
+
+#include <ocelot/transforms/interface/AnalysisCache.h>
+#include <ocelot/transforms/interface/PassManager.h>
+#include <ocelot/transforms/interface/Pass.h>
+
+#include <ocelot/analysis/interface/DataflowGraph.h>
+#include <ocelot/analysis/interface/DivergenceAnalysis.h>
+#include <ocelot/analysis/interface/DominatorTree.h>
+#include <ocelot/analysis/interface/PostdominatorTree.h>
+
+#include <ocelot/ir/interface/Module.h>
+#include <ocelot/ir/interface/PTXKernel.h>
+
+#include <hydrazine/interface/Test.h>
+#include <hydrazine/interface/ArgumentParser.h>
+
+#include <algorithm>
+#include <sstream>
+#include <vector>
+
+namespace test
+{
+	/*! \brief Compare cached analyses with analyses computed from scratch */
+	class TestAnalysisCache : public Test
+	{
+		private:
+			typedef ir::Module::StatementVector StatementVector;
+			typedef transforms::AnalysisCache AnalysisCache;
+
+			/*! \brief Prints the data flow graph and both dominator trees */
+			class StructurePass : public transforms::KernelPass
+			{
+				public:
+					StructurePass();
+
+				public:
+					void runOnKernel(ir::IRKernel& kernel);
+
+				public:
+					std::string result;
+			};
+
+			/*! \brief Prints the divergent blocks and instructions */
+			class DivergencePass : public transforms::KernelPass
+			{
+				public:
+					DivergencePass();
+
+				public:
+					void runOnKernel(ir::IRKernel& kernel);
+
+				public:
+					std::string result;
+			};
+
+		private:
+			static ir::PTXOperand _register(unsigned int id,
+				ir::PTXOperand::DataType type);
+			static void _instruction(StatementVector& statements,
+				const ir::PTXInstruction& instruction);
+
+			StatementVector _randomKernel(unsigned int blocks);
+
+			std::string _analyze(ir::Module& module, AnalysisCache* cache);
+
+			bool _testRandom();
+			bool _testKey();
+			bool _testCapacity();
+
+			bool doTest();
+
+		public:
+			TestAnalysisCache();
+
+		public:
+			unsigned int kernels;
+			unsigned int copies;
+			unsigned int maxBlocks;
+	};
+
+	TestAnalysisCache::StructurePass::StructurePass() :
+		KernelPass(Analysis::StringVector({"DataflowGraphAnalysis",
+			"DominatorTreeAnalysis", "PostDominatorTreeAnalysis"}),
+			"StructurePass")
+	{
+
+	}
+
+	/*! Every instruction must point back at its block, and the trees must
+		point at the graph of this kernel */
+	void TestAnalysisCache::StructurePass::runOnKernel(ir::IRKernel& kernel)
+	{
+		typedef analysis::DataflowGraph DataflowGraph;
+
+		DataflowGraph& dfg = static_cast<DataflowGraph&>(
+			*getAnalysis("DataflowGraphAnalysis"));
+		analysis::DominatorTree& dominators =
+			static_cast<analysis::DominatorTree&>(
+			*getAnalysis("DominatorTreeAnalysis"));
+		analysis::PostdominatorTree& postdominators =
+			static_cast<analysis::PostdominatorTree&>(
+			*getAnalysis("PostDominatorTreeAnalysis"));
+
+		std::stringstream stream;
+
+		for(DataflowGraph::iterator block = dfg.begin();
+			block != dfg.end(); ++block)
+		{
+			std::vector<unsigned int> alive;
+
+			for(DataflowGraph::RegisterSet::const_iterator
+				reg = block->aliveIn().begin();
+				reg != block->aliveIn().end(); ++reg)
+			{
+				alive.push_back(reg->id);
+			}
+
+			std::sort(alive.begin(), alive.end());
+
+			stream << block->label() << " alive in";
+
+			for(unsigned int r = 0; r < alive.size(); ++r)
+			{
+				stream << " " << alive[r];
+			}
+
+			stream << "\n";
+
+			for(DataflowGraph::InstructionVector::const_iterator
+				instruction = block->instructions().begin();
+				instruction != block->instructions().end(); ++instruction)
+			{
+				if(instruction->block != block)
+				{
+					stream << " instruction of another block\n";
+				}
+
+				stream << " " << instruction->i->toString() << "\n";
+			}
+		}
+
+		if(dominators.cfg != kernel.cfg() || postdominators.cfg != kernel.cfg())
+		{
+			stream << "a dominator tree of another kernel\n";
+		}
+
+		for(ir::ControlFlowGraph::iterator block = kernel.cfg()->begin();
+			block != kernel.cfg()->end(); ++block)
+		{
+			if(dominators.blocksToIndex.count(block) != 0)
+			{
+				stream << block->label() << " dominated by "
+					<< dominators.getDominator(block)->label() << "\n";
+			}
+
+			if(postdominators.blocksToIndex.count(block) != 0)
+			{
+				stream << block->label() << " postdominated by "
+					<< postdominators.getPostDominator(block)->label() << "\n";
+			}
+		}
+
+		result = stream.str();
+	}
+
+	TestAnalysisCache::DivergencePass::DivergencePass() :
+		KernelPass(Analysis::StringVector({"DivergenceAnalysis"}),
+			"DivergencePass")
+	{
+
+	}
+
+	void TestAnalysisCache::DivergencePass::runOnKernel(ir::IRKernel&)
+	{
+		typedef analysis::DataflowGraph DataflowGraph;
+
+		analysis::DivergenceAnalysis& divergence =
+			static_cast<analysis::DivergenceAnalysis&>(
+			*getAnalysis("DivergenceAnalysis"));
+		DataflowGraph& dfg = static_cast<DataflowGraph&>(
+			*getAnalysis("DataflowGraphAnalysis"));
+
+		std::stringstream stream;
+
+		if(divergence.getDFG() != &dfg)
+		{
+			stream << "the divergence of another graph\n";
+		}
+
+		for(DataflowGraph::iterator block = dfg.begin();
+			block != dfg.end(); ++block)
+		{
+			stream << block->label() << (divergence.isDivBlock(block)
+				? " divergent" : "") << (divergence.isEntryDiv(block)
+				? " entered divergent" : "") << "\n";
+
+			for(DataflowGraph::InstructionVector::const_iterator
+				instruction = block->instructions().begin();
+				instruction != block->instructions().end(); ++instruction)
+			{
+				stream << " " << instruction->i->toString()
+					<< (divergence.isDivInstruction(*instruction)
+					? " divergent" : "") << "\n";
+			}
+		}
+
+		result = stream.str();
+	}
+
+	ir::PTXOperand TestAnalysisCache::_register(unsigned int id,
+		ir::PTXOperand::DataType type)
+	{
+		ir::PTXOperand operand(ir::PTXOperand::Register, type, id);
+
+		std::stringstream name;
+		name << (type == ir::PTXOperand::pred ? "%p" : "%r") << id;
+		operand.identifier = name.str();
+
+		return operand;
+	}
+
+	void TestAnalysisCache::_instruction(StatementVector& statements,
+		const ir::PTXInstruction& instruction)
+	{
+		ir::PTXStatement statement(ir::PTXStatement::Instr);
+		statement.instruction = instruction;
+
+		statements.push_back(statement);
+	}
+
+	/*! Registers 1 to 8 start from the thread id or a constant, each block
+		adds some of them and may branch on one, forward or backward */
+	TestAnalysisCache::StatementVector TestAnalysisCache::_randomKernel(
+		unsigned int blocks)
+	{
+		typedef ir::PTXInstruction PTXInstruction;
+		typedef ir::PTXOperand PTXOperand;
+
+		StatementVector statements;
+
+		ir::PTXStatement version(ir::PTXStatement::Version);
+		version.major = 2;
+		version.minor = 3;
+		statements.push_back(version);
+
+		ir::PTXStatement target(ir::PTXStatement::Target);
+		target.targets.push_back("sm_21");
+		statements.push_back(target);
+
+		ir::PTXStatement entry(ir::PTXStatement::Entry);
+		entry.name = "kernel";
+		statements.push_back(entry);
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::StartScope));
+
+		for(unsigned int r = 1; r <= 8; ++r)
+		{
+			PTXInstruction move(PTXInstruction::Mov);
+			move.type = PTXOperand::u32;
+			move.d = _register(r, PTXOperand::u32);
+			move.a = r == 1 ? PTXOperand(PTXOperand::tid, PTXOperand::ix)
+				: PTXOperand((unsigned int)random() % 16, PTXOperand::u32);
+
+			_instruction(statements, move);
+		}
+
+		for(unsigned int b = 0; b < blocks; ++b)
+		{
+			std::stringstream label;
+			label << "$L" << b;
+
+			ir::PTXStatement statement(ir::PTXStatement::Label);
+			statement.name = label.str();
+			statements.push_back(statement);
+
+			unsigned int adds = 1 + random() % 3;
+
+			for(unsigned int a = 0; a < adds; ++a)
+			{
+				PTXInstruction add(PTXInstruction::Add);
+				add.type = PTXOperand::u32;
+				add.d = _register(2 + random() % 7, PTXOperand::u32);
+				add.a = _register(1 + random() % 8, PTXOperand::u32);
+				add.b = _register(1 + random() % 8, PTXOperand::u32);
+
+				_instruction(statements, add);
+			}
+
+			if(random() % 3 == 0) continue;
+
+			PTXInstruction compare(PTXInstruction::SetP);
+			compare.type = PTXOperand::u32;
+			compare.comparisonOperator = PTXInstruction::Lt;
+			compare.d = _register(10 + b, PTXOperand::pred);
+			compare.a = _register(1 + random() % 8, PTXOperand::u32);
+			compare.b = PTXOperand((unsigned int)random() % 16,
+				PTXOperand::u32);
+
+			_instruction(statements, compare);
+
+			std::stringstream destination;
+			destination << "$L" << (random() % blocks);
+
+			PTXInstruction branch(PTXInstruction::Bra);
+			branch.d = PTXOperand(destination.str());
+			branch.pg = _register(10 + b, PTXOperand::pred);
+			branch.pg.condition = PTXOperand::Pred;
+			branch.uni = false;
+
+			_instruction(statements, branch);
+		}
+
+		_instruction(statements, PTXInstruction(PTXInstruction::Exit));
+
+		statements.push_back(ir::PTXStatement(ir::PTXStatement::EndScope));
+
+		return statements;
+	}
+
+	/*! The structure and the divergence are printed by separate pass
+		managers, like two instrumentors running one after the other */
+	std::string TestAnalysisCache::_analyze(ir::Module& module,
+		AnalysisCache* cache)
+	{
+		StructurePass structure;
+		DivergencePass divergence;
+
+		{
+			transforms::PassManager manager(&module);
+			manager.setAnalysisCache(cache);
+			manager.addPass(&structure);
+			manager.runOnModule();
+			manager.releasePasses();
+		}
+
+		{
+			transforms::PassManager manager(&module);
+			manager.setAnalysisCache(cache);
+			manager.addPass(&divergence);
+			manager.runOnModule();
+			manager.releasePasses();
+		}
+
+		return structure.result + divergence.result;
+	}
+
+	/*! Each kernel is analyzed from scratch, then parsed again into several
+		modules that share a cache. Only the first copy may compute all
+		analyses, the others reuse them from the cache. */
+	bool TestAnalysisCache::_testRandom()
+	{
+		unsigned long computed = 0;
+		unsigned long reused = 0;
+
+		for(unsigned int k = 0; k < kernels; ++k)
+		{
+			StatementVector statements = _randomKernel(1 + random() % maxBlocks);
+
+			std::string expected;
+
+			{
+				ir::Module module("fresh", statements);
+				expected = _analyze(module, 0);
+			}
+
+			AnalysisCache cache;
+
+			for(unsigned int c = 0; c < copies; ++c)
+			{
+				ir::Module module("copy", statements);
+
+				unsigned long hits = cache.hits;
+				std::string result = _analyze(module, &cache);
+
+				if(result != expected)
+				{
+					status << "Kernel " << k << ", copy " << c << ": the "
+						<< "cached analyses differ from fresh ones.\n";
+					status << "Fresh:\n" << expected << "Cached:\n" << result;
+					return false;
+				}
+
+				if(c > 0 && cache.hits == hits)
+				{
+					status << "Kernel " << k << ", copy " << c << ": no "
+						<< "analysis was reused from the cache.\n";
+					return false;
+				}
+			}
+
+			computed += cache.misses;
+			reused += cache.hits;
+		}
+
+		status << "Matched fresh analyses on " << kernels << " random kernels "
+			<< "with " << copies << " copies each, " << reused << " analyses "
+			<< "reused and " << computed << " computed.\n";
+
+		return true;
+	}
+
+	/*! Analyses are only reused by a kernel of the same name and size, even
+		if the hash matches */
+	bool TestAnalysisCache::_testKey()
+	{
+		StatementVector statements = _randomKernel(1 + random() % maxBlocks);
+
+		AnalysisCache cache;
+
+		{
+			ir::Module module("key", statements);
+			_analyze(module, &cache);
+		}
+
+		/* the analyses leave the registers of the kernel renumbered */
+		ir::Module module("copy", statements);
+
+		AnalysisCache::Content content =
+			AnalysisCache::content(*module.getKernel("kernel"));
+
+		if(content.kernel != "kernel" || content.instructions == 0)
+		{
+			status << "The content of the kernel did not record its name "
+				<< "and size.\n";
+			return false;
+		}
+
+		AnalysisCache::Content renamed = content;
+		renamed.kernel = "other";
+
+		AnalysisCache::Content resized = content;
+		resized.instructions += 1;
+
+		if(cache.acquire("DivergenceAnalysis", renamed) != 0 ||
+			cache.acquire("DivergenceAnalysis", resized) != 0)
+		{
+			status << "An analysis was reused by a kernel of another name "
+				<< "or size with the same hash.\n";
+			return false;
+		}
+
+		analysis::Analysis* analysis =
+			cache.acquire("DivergenceAnalysis", content);
+
+		if(analysis == 0)
+		{
+			status << "The analysis of the kernel was not cached.\n";
+			return false;
+		}
+
+		delete analysis;
+
+		status << "Analyses were only reused by a kernel of the same name "
+			<< "and size.\n";
+
+		return true;
+	}
+
+	/*! The least recently released analyses are evicted */
+	bool TestAnalysisCache::_testCapacity()
+	{
+		AnalysisCache cache;
+		cache.capacity = 4;
+
+		std::vector<StatementVector> kernelStatements;
+
+		for(unsigned int k = 0; k < kernels; ++k)
+		{
+			kernelStatements.push_back(
+				_randomKernel(1 + random() % maxBlocks));
+
+			ir::Module module("capacity", kernelStatements.back());
+			_analyze(module, &cache);
+
+			if(cache.size() > cache.capacity)
+			{
+				status << "The cache holds " << cache.size() << " analyses, "
+					<< "more than its capacity of " << cache.capacity
+					<< ".\n";
+				return false;
+			}
+		}
+
+		{
+			ir::Module module("last", kernelStatements.back());
+
+			unsigned long hits = cache.hits;
+			_analyze(module, &cache);
+
+			if(cache.hits == hits)
+			{
+				status << "The analyses of the last kernel were evicted.\n";
+				return false;
+			}
+		}
+
+		status << "Kept " << cache.size() << " of at most " << cache.capacity
+			<< " analyses for " << kernels << " kernels.\n";
+
+		return true;
+	}
+
+	bool TestAnalysisCache::doTest()
+	{
+		return _testRandom() && _testKey() && _testCapacity();
+	}
+
+	TestAnalysisCache::TestAnalysisCache()
+	{
+		name = "TestAnalysisCache";
+
+		description = "Builds random kernels with loops and branches on the ";
+		description += "thread id, and parses each into several modules ";
+		description += "that share one analysis cache. The data flow graph, ";
+		description += "the dominator and postdominator trees and the ";
+		description += "divergence analysis of every copy must match the ";
+		description += "ones computed without a cache, and copies after the ";
+		description += "first must reuse cached analyses. Analyses are not ";
+		description += "reused by kernels of another name or size, and the ";
+		description += "cache keeps no more than its capacity.";
+	}
+}
+
+int main(int argc, char** argv)
+{
+	hydrazine::ArgumentParser parser(argc, argv);
+	test::TestAnalysisCache test;
+	parser.description(test.testDescription());
+
+	parser.parse("-s", "--seed", test.seed, 0,
+		"Set the random seed, 0 implies seed with time.");
+	parser.parse("-v", "--verbose", test.verbose, false,
+		"Print out status info after the test.");
+	parser.parse("-k", "--kernels", test.kernels, 200,
+		"Random kernels to analyze.");
+	parser.parse("-c", "--copies", test.copies, 3,
+		"Modules parsed from each kernel.");
+	parser.parse("-b", "--blocks", test.maxBlocks, 12,
+		"Maximum labeled blocks in a random kernel.");
+	parser.parse();
+
+	test.test();
+
+	return test.passed() ? 0 : -1;
+}
+
+#endif
+